@@ -27,6 +27,7 @@
 #include <optional>
 #include <vector>
 #include <chrono>
+#include <future>
 
 namespace sushi {
 namespace ext {
@@ -64,11 +65,40 @@ struct TimeSignature
     int denominator;
 };
 
+struct CpuTimingPercentiles
+{
+    float p50;
+    float p90;
+    float p99;
+    float p99_9;
+    float max;
+};
+
 struct CpuTimings
 {
     float avg;
     float min;
     float max;
+    CpuTimingPercentiles recent;
+    CpuTimingPercentiles since_reset;
+};
+
+enum class XrunSource
+{
+    ENGINE_OVERRUN,
+    AUDIO_FRONTEND
+};
+
+struct XrunNodeLoad
+{
+    int   id;
+    float load;
+};
+
+struct XrunCounts
+{
+    int engine_overruns;
+    int frontend_xruns;
 };
 
 enum class PluginType
@@ -217,7 +247,8 @@ enum class NotificationType
     CPU_TIMING_UPDATE,
     TRACK_UPDATE,
     PROCESSOR_UPDATE,
-    PARAMETER_CHANGE
+    PARAMETER_CHANGE,
+    XRUN
 };
 
 enum class ProcessorAction
@@ -289,6 +320,15 @@ public:
     virtual ControlStatus                           reset_track_timings(int track_id) = 0;
     virtual ControlStatus                           reset_processor_timings(int processor_id) = 0;
 
+    virtual bool                                    get_tracing_enabled() const = 0;
+    virtual void                                    set_tracing_enabled(bool enabled) = 0;
+    virtual ControlStatus                           write_trace_to_file(const std::string& filename) = 0;
+
+    virtual std::pair<ControlStatus, XrunCounts>    get_xrun_counts() const = 0;
+    virtual ControlStatus                           reset_xrun_counts() = 0;
+
+    virtual std::string                             get_metrics() const = 0;
+
 protected:
     TimingController() = default;
 };
@@ -334,6 +374,10 @@ public:
     virtual ControlStatus delete_processor_from_track(int processor_id, int track_id) = 0;
     virtual ControlStatus delete_track(int track_id) = 0;
 
+    /* Asynchronous version of the above. The returned future is ready once the operation has
+     * completed in the engine and carries its result. */
+    virtual std::future<ControlStatus> delete_processor_from_track_async(int processor_id, int track_id) = 0;
+
 protected:
     AudioGraphController() = default;
 };
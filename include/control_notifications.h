@@ -3,6 +3,7 @@
 #define SUSHI_CONTROL_NOTIFICATIONS_H
 
 #include <variant>
+#include <vector>
 #include "control_interface.h"
 
 namespace sushi {
@@ -95,6 +96,25 @@ private:
     float _value;
 };
 
+class XrunNotification : public ControlNotification
+{
+public:
+    XrunNotification(XrunSource source, float chunk_load, std::vector<XrunNodeLoad> slowest_nodes, Time timestamp)
+            : ControlNotification(NotificationType::XRUN, timestamp),
+              _source(source),
+              _chunk_load(chunk_load),
+              _slowest_nodes(std::move(slowest_nodes)) {}
+
+    XrunSource source() const {return _source;}
+    float chunk_load() const {return _chunk_load;}
+    const std::vector<XrunNodeLoad>& slowest_nodes() const {return _slowest_nodes;}
+
+private:
+    XrunSource _source;
+    float _chunk_load;
+    std::vector<XrunNodeLoad> _slowest_nodes;
+};
+
 } // ext
 } // sushi
 
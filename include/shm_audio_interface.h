@@ -0,0 +1,140 @@
+/*
+ * Copyright 2017-2021 Modern Ancient Instruments Networked AB, dba Elk
+ *
+ * SUSHI is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU Affero General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * SUSHI is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along with
+ * SUSHI.  If not, see http://www.gnu.org/licenses/
+ */
+
+/**
+ * @brief Layout of and handshake for exchanging audio with sushi through POSIX shared
+ *        memory. Header only, so that external processes can use it without linking
+ *        to sushi.
+ * @copyright 2017-2021 Modern Ancient Instruments Networked AB, dba Elk, Stockholm
+ */
+
+#ifndef SUSHI_SHM_AUDIO_INTERFACE_H
+#define SUSHI_SHM_AUDIO_INTERFACE_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <climits>
+#include <ctime>
+
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace sushi {
+namespace ext {
+
+/*
+ * The region starts with a ShmAudioHeader, followed by the input channels and then
+ * the output channels. Every channel holds chunk_size non-interleaved float samples,
+ * which is the same layout as the engine's own buffers, so that sushi processes
+ * directly in the shared region.
+ *
+ * One period is exchanged like this:
+ *  1. The client writes chunk_size samples to every input channel
+ *  2. The client increments request_count and wakes sushi
+ *  3. Sushi processes the inputs and writes the outputs
+ *  4. Sushi increments done_count and wakes the client
+ *  5. The client reads the outputs once done_count equals request_count
+ *
+ * Both counters are futex words, waiters spin briefly before sleeping in the kernel.
+ */
+
+constexpr uint32_t SHM_AUDIO_MAGIC = 0x53555348; // "SUSH"
+constexpr uint32_t SHM_AUDIO_VERSION = 1;
+constexpr int SHM_AUDIO_ALIGNMENT = 64;
+/* Times to check a counter before waiting on the futex */
+constexpr int SHM_AUDIO_SPIN_COUNT = 2000;
+
+enum class ShmAudioState : uint32_t
+{
+    STARTING,
+    RUNNING,
+    STOPPED
+};
+
+struct ShmAudioHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t chunk_size;
+    uint32_t input_channels;
+    uint32_t output_channels;
+    float    sample_rate;
+    std::atomic<ShmAudioState> state;
+
+    /* Kept on separate cache lines as they are written from different processes */
+    alignas(SHM_AUDIO_ALIGNMENT) std::atomic<uint32_t> request_count;
+    alignas(SHM_AUDIO_ALIGNMENT) std::atomic<uint32_t> done_count;
+};
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "Futex words must be lock free");
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "Futex words must be 32 bit");
+
+constexpr size_t shm_audio_buffer_offset()
+{
+    return (sizeof(ShmAudioHeader) + SHM_AUDIO_ALIGNMENT - 1) / SHM_AUDIO_ALIGNMENT * SHM_AUDIO_ALIGNMENT;
+}
+
+constexpr size_t shm_audio_region_size(int chunk_size, int input_channels, int output_channels)
+{
+    return shm_audio_buffer_offset() + sizeof(float) * chunk_size * (input_channels + output_channels);
+}
+
+inline float* shm_audio_inputs(ShmAudioHeader* header)
+{
+    return reinterpret_cast<float*>(reinterpret_cast<std::byte*>(header) + shm_audio_buffer_offset());
+}
+
+inline float* shm_audio_outputs(ShmAudioHeader* header)
+{
+    return shm_audio_inputs(header) + header->chunk_size * header->input_channels;
+}
+
+/**
+ * @brief Wake all processes waiting on a counter
+ */
+inline void shm_audio_wake(std::atomic<uint32_t>& counter)
+{
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&counter), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
+
+/**
+ * @brief Wait until a counter no longer holds a value
+ * @param counter The counter to wait on
+ * @param value The value to wait for a change from
+ * @param timeout_ns Maximum time to wait in the kernel
+ * @return The new value of the counter, or value if the wait timed out
+ */
+inline uint32_t shm_audio_wait(std::atomic<uint32_t>& counter, uint32_t value, long timeout_ns)
+{
+    for (int i = 0; i < SHM_AUDIO_SPIN_COUNT; ++i)
+    {
+        uint32_t current = counter.load(std::memory_order_acquire);
+        if (current != value)
+        {
+            return current;
+        }
+    }
+    timespec timeout{timeout_ns / 1'000'000'000, timeout_ns % 1'000'000'000};
+    /* Returns at once if the counter has already changed */
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&counter), FUTEX_WAIT, value, &timeout, nullptr, 0);
+    return counter.load(std::memory_order_acquire);
+}
+
+} // end namespace ext
+} // end namespace sushi
+
+#endif //SUSHI_SHM_AUDIO_INTERFACE_H
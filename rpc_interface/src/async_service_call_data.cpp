@@ -35,6 +35,16 @@ void CallData::stop()
     _status = CallStatus::FINISH;
 }
 
+template<class ValueType, class BlocklistType>
+SubscribeToUpdatesCallData<ValueType, BlocklistType>::~SubscribeToUpdatesCallData()
+{
+    _backlog->add(-static_cast<double>(_notifications.size()));
+    if (_active)
+    {
+        _subscriber_count->add(-1);
+    }
+}
+
 template<class ValueType, class BlocklistType>
 void SubscribeToUpdatesCallData<ValueType, BlocklistType>::proceed()
 {
@@ -50,6 +60,7 @@ void SubscribeToUpdatesCallData<ValueType, BlocklistType>::proceed()
         {
             _respawn();
             _active = true;
+            _subscriber_count->add(1);
             _populate_blocklist();
             _first_iteration = false;
         }
@@ -57,6 +68,7 @@ void SubscribeToUpdatesCallData<ValueType, BlocklistType>::proceed()
         if (_notifications.empty() == false)
         {
             auto reply = _notifications.pop();
+            _backlog->add(-1);
             if (_check_if_blocklisted(*reply.get()) == false)
             {
                 _in_completion_queue = true;
@@ -89,6 +101,8 @@ void SubscribeToUpdatesCallData<ValueType, BlocklistType>::push(std::shared_ptr<
     if (_active)
     {
         _notifications.push(notification);
+        _notification_counter->increment();
+        _backlog->add(1);
     }
     if (_in_completion_queue == false)
     {
@@ -100,6 +114,7 @@ void SubscribeToUpdatesCallData<ValueType, BlocklistType>::push(std::shared_ptr<
 // or it will not link.
 template class SubscribeToUpdatesCallData<TransportUpdate, GenericVoidValue>;
 template class SubscribeToUpdatesCallData<CpuTimings, GenericVoidValue>;
+template class SubscribeToUpdatesCallData<XrunUpdate, GenericVoidValue>;
 template class SubscribeToUpdatesCallData<TrackUpdate, GenericVoidValue>;
 template class SubscribeToUpdatesCallData<ProcessorUpdate, GenericVoidValue>;
 template class SubscribeToUpdatesCallData<ParameterValue, ParameterNotificationBlocklist>;
@@ -156,6 +171,32 @@ bool SubscribeToCpuTimingUpdatesCallData::_check_if_blocklisted(const CpuTimings
     return false;
 }
 
+void SubscribeToXrunsCallData::_respawn()
+{
+    new SubscribeToXrunsCallData(_service, _async_rpc_queue);
+}
+
+void SubscribeToXrunsCallData::_subscribe()
+{
+    _service->RequestSubscribeToXruns(&_ctx,
+                                      &_notification_blocklist,
+                                      &_responder,
+                                      _async_rpc_queue,
+                                      _async_rpc_queue,
+                                      this);
+    _service->subscribe(this);
+}
+
+void SubscribeToXrunsCallData::_unsubscribe()
+{
+    _service->unsubscribe(this);
+}
+
+bool SubscribeToXrunsCallData::_check_if_blocklisted(const XrunUpdate&)
+{
+    return false;
+}
+
 void SubscribeToTrackChangesCallData::_respawn()
 {
     new SubscribeToTrackChangesCallData(_service, _async_rpc_queue);
@@ -30,6 +30,7 @@
 #pragma GCC diagnostic pop
 
 #include "library/synchronised_fifo.h"
+#include "library/metrics.h"
 #include "control_service.h"
 
 namespace sushi_rpc {
@@ -90,8 +91,14 @@ public:
               _responder(&_ctx)
     {
         // Classes inheriting from this, should call proceed() in their constructor.
+        auto& registry = sushi::performance::MetricsRegistry::global();
+        _notification_counter = registry.counter("sushi_grpc_notifications_total", "Notifications queued for gRPC subscribers");
+        _backlog = registry.gauge("sushi_grpc_notification_backlog", "Notifications waiting to be sent to gRPC subscribers");
+        _subscriber_count = registry.gauge("sushi_grpc_subscribers", "Active gRPC notification subscribers");
     }
 
+    ~SubscribeToUpdatesCallData() override;
+
     void proceed() override;
 
     void push(std::shared_ptr<ValueType> notification);
@@ -116,6 +123,10 @@ private:
 
     bool _first_iteration{true};
     bool _active{false};
+
+    sushi::performance::Counter* _notification_counter;
+    sushi::performance::Gauge*   _backlog;
+    sushi::performance::Gauge*   _subscriber_count;
 };
 
 class SubscribeToTransportChangesCallData : public SubscribeToUpdatesCallData<TransportUpdate, GenericVoidValue>
@@ -158,6 +169,26 @@ protected:
     void _populate_blocklist() override {}
 };
 
+class SubscribeToXrunsCallData : public SubscribeToUpdatesCallData<XrunUpdate, GenericVoidValue>
+{
+public:
+    SubscribeToXrunsCallData(NotificationControlService* service,
+                             grpc::ServerCompletionQueue* async_rpc_queue)
+            : SubscribeToUpdatesCallData(service, async_rpc_queue)
+    {
+        proceed();
+    }
+
+    ~SubscribeToXrunsCallData() = default;
+
+protected:
+    void _respawn() override;
+    void _subscribe() override;
+    void _unsubscribe() override;
+    bool _check_if_blocklisted(const XrunUpdate& reply) override;
+    void _populate_blocklist() override {}
+};
+
 class SubscribeToTrackChangesCallData : public SubscribeToUpdatesCallData<TrackUpdate, GenericVoidValue>
 {
 public:
@@ -22,6 +22,7 @@
 #include "control_notifications.h"
 
 #include "async_service_call_data.h"
+#include "library/event_tracer.h"
 
 namespace sushi_rpc {
 
@@ -248,11 +249,22 @@ inline void to_grpc(sushi_rpc::TrackInfo& dest, const sushi::ext::TrackInfo& src
     }
 }
 
+inline void to_grpc(sushi_rpc::CpuTimingPercentiles& dest, const sushi::ext::CpuTimingPercentiles& src)
+{
+    dest.set_p50(src.p50);
+    dest.set_p90(src.p90);
+    dest.set_p99(src.p99);
+    dest.set_p99_9(src.p99_9);
+    dest.set_max(src.max);
+}
+
 inline void to_grpc(sushi_rpc::CpuTimings& dest, const sushi::ext::CpuTimings& src)
 {
     dest.set_average(src.avg);
     dest.set_min(src.min);
     dest.set_max(src.max);
+    to_grpc(*dest.mutable_recent(), src.recent);
+    to_grpc(*dest.mutable_since_reset(), src.since_reset);
 }
 
 inline void to_grpc(sushi_rpc::AudioConnection& dest, const sushi::ext::AudioConnection& src)
@@ -477,10 +489,65 @@ grpc::Status TimingControlService::ResetProcessorTimings(grpc::ServerContext* /*
     return to_grpc_status(status);
 }
 
+grpc::Status TimingControlService::GetTracingEnabled(grpc::ServerContext* /*context*/,
+                                                     const sushi_rpc::GenericVoidValue* /*request*/,
+                                                     sushi_rpc::GenericBoolValue* response)
+{
+    response->set_value(_controller->get_tracing_enabled());
+    return grpc::Status::OK;
+}
+
+grpc::Status TimingControlService::SetTracingEnabled(grpc::ServerContext* /*context*/,
+                                                     const sushi_rpc::GenericBoolValue* request,
+                                                     sushi_rpc::GenericVoidValue* /*response*/)
+{
+    _controller->set_tracing_enabled(request->value());
+    return grpc::Status::OK;
+}
+
+grpc::Status TimingControlService::WriteTraceToFile(grpc::ServerContext* /*context*/,
+                                                    const sushi_rpc::GenericStringValue* request,
+                                                    sushi_rpc::GenericVoidValue* /*response*/)
+{
+    auto status = _controller->write_trace_to_file(request->value());
+    return to_grpc_status(status);
+}
+
+grpc::Status TimingControlService::GetXrunCounts(grpc::ServerContext* /*context*/,
+                                                 const sushi_rpc::GenericVoidValue* /*request*/,
+                                                 sushi_rpc::XrunCounts* response)
+{
+    auto [status, counts] = _controller->get_xrun_counts();
+    if (status != sushi::ext::ControlStatus::OK)
+    {
+        return to_grpc_status(status);
+    }
+    response->set_engine_overruns(counts.engine_overruns);
+    response->set_frontend_xruns(counts.frontend_xruns);
+    return grpc::Status::OK;
+}
+
+grpc::Status TimingControlService::ResetXrunCounts(grpc::ServerContext* /*context*/,
+                                                   const sushi_rpc::GenericVoidValue* /*request*/,
+                                                   sushi_rpc::GenericVoidValue* /*response*/)
+{
+    auto status = _controller->reset_xrun_counts();
+    return to_grpc_status(status);
+}
+
+grpc::Status TimingControlService::GetMetrics(grpc::ServerContext* /*context*/,
+                                              const sushi_rpc::GenericVoidValue* /*request*/,
+                                              sushi_rpc::GenericStringValue* response)
+{
+    response->set_value(_controller->get_metrics());
+    return grpc::Status::OK;
+}
+
 grpc::Status KeyboardControlService::SendNoteOn(grpc::ServerContext* /*context*/,
                                                 const sushi_rpc::NoteOnRequest*request,
                                                 sushi_rpc::GenericVoidValue* /*response*/)
 {
+    sushi::performance::ScopedTraceSource trace_source(sushi::performance::TraceSource::GRPC);
     auto status = _controller->send_note_on(request->track().id(), request->channel(), request->note(), request->velocity());
     return to_grpc_status(status);
 }
@@ -489,6 +556,7 @@ grpc::Status KeyboardControlService::SendNoteOff(grpc::ServerContext* /*context*
                                                  const sushi_rpc::NoteOffRequest* request,
                                                  sushi_rpc::GenericVoidValue* /*response*/)
 {
+    sushi::performance::ScopedTraceSource trace_source(sushi::performance::TraceSource::GRPC);
     auto status = _controller->send_note_off(request->track().id(), request->channel(), request->note(), request->velocity());
     return to_grpc_status(status);
 }
@@ -497,6 +565,7 @@ grpc::Status KeyboardControlService::SendNoteAftertouch(grpc::ServerContext* /*c
                                                         const sushi_rpc::NoteAftertouchRequest* request,
                                                         sushi_rpc::GenericVoidValue* /*response*/)
 {
+    sushi::performance::ScopedTraceSource trace_source(sushi::performance::TraceSource::GRPC);
     auto status = _controller->send_note_aftertouch(request->track().id(), request->channel(), request->note(), request->value());
     return to_grpc_status(status);
 }
@@ -505,6 +574,7 @@ grpc::Status KeyboardControlService::SendAftertouch(grpc::ServerContext* /*conte
                                                     const sushi_rpc::NoteModulationRequest* request,
                                                     sushi_rpc::GenericVoidValue* /*response*/)
 {
+    sushi::performance::ScopedTraceSource trace_source(sushi::performance::TraceSource::GRPC);
     auto status = _controller->send_aftertouch(request->track().id(), request->channel(), request->value());
     return to_grpc_status(status);
 }
@@ -513,6 +583,7 @@ grpc::Status KeyboardControlService::SendPitchBend(grpc::ServerContext* /*contex
                                                    const sushi_rpc::NoteModulationRequest* request,
                                                    sushi_rpc::GenericVoidValue* /*response*/)
 {
+    sushi::performance::ScopedTraceSource trace_source(sushi::performance::TraceSource::GRPC);
     auto status = _controller->send_pitch_bend(request->track().id(), request->channel(), request->value());
     return to_grpc_status(status);
 }
@@ -521,6 +592,7 @@ grpc::Status KeyboardControlService::SendModulation(grpc::ServerContext* /*conte
                                                     const sushi_rpc::NoteModulationRequest* request,
                                                     sushi_rpc::GenericVoidValue* /*response*/)
 {
+    sushi::performance::ScopedTraceSource trace_source(sushi::performance::TraceSource::GRPC);
     auto status = _controller->send_modulation(request->track().id(), request->channel(), request->value());
     return to_grpc_status(status);
 }
@@ -786,6 +858,7 @@ grpc::Status ParameterControlService::SetParameterValue(grpc::ServerContext* /*c
                                                         const sushi_rpc::ParameterValue* request,
                                                         sushi_rpc::GenericVoidValue* /*response*/)
 {
+    sushi::performance::ScopedTraceSource trace_source(sushi::performance::TraceSource::GRPC);
     auto status = _controller->set_parameter_value(request->parameter().processor_id(),
                                                    request->parameter().parameter_id(),
                                                    request->value());
@@ -1533,6 +1606,7 @@ NotificationControlService::NotificationControlService(sushi::ext::SushiControl*
     _controller->subscribe_to_notifications(sushi::ext::NotificationType::TRACK_UPDATE, this);
     _controller->subscribe_to_notifications(sushi::ext::NotificationType::PROCESSOR_UPDATE, this);
     _controller->subscribe_to_notifications(sushi::ext::NotificationType::PARAMETER_CHANGE, this);
+    _controller->subscribe_to_notifications(sushi::ext::NotificationType::XRUN, this);
 }
 
 void NotificationControlService::notification(const sushi::ext::ControlNotification* notification)
@@ -1564,6 +1638,11 @@ void NotificationControlService::notification(const sushi::ext::ControlNotificat
             _forward_parameter_notification_to_subscribers(notification);
             break;
         }
+        case sushi::ext::NotificationType::XRUN:
+        {
+            _forward_xrun_notification_to_subscribers(notification);
+            break;
+        }
         default:
             break;
     }
@@ -1621,10 +1700,7 @@ void NotificationControlService::_forward_cpu_timing_notification_to_subscribers
 {
     auto typed_notification = static_cast<const sushi::ext::CpuTimingNotification*>(notification);
     auto notification_content = std::make_shared<CpuTimings>();
-    auto timings = typed_notification->cpu_timings();
-    notification_content->set_average(timings.avg);
-    notification_content->set_min(timings.min);
-    notification_content->set_max(timings.max);
+    to_grpc(*notification_content, typed_notification->cpu_timings());
 
     std::scoped_lock lock(_timing_subscriber_lock);
     for (auto& subscriber : _timing_subscribers)
@@ -1633,6 +1709,35 @@ void NotificationControlService::_forward_cpu_timing_notification_to_subscribers
     }
 }
 
+void NotificationControlService::_forward_xrun_notification_to_subscribers(const sushi::ext::ControlNotification* notification)
+{
+    auto typed_notification = static_cast<const sushi::ext::XrunNotification*>(notification);
+    auto notification_content = std::make_shared<XrunUpdate>();
+    switch (typed_notification->source())
+    {
+        case sushi::ext::XrunSource::ENGINE_OVERRUN:
+            notification_content->set_source(XrunUpdate_Source_ENGINE_OVERRUN);
+            break;
+        case sushi::ext::XrunSource::AUDIO_FRONTEND:
+            notification_content->set_source(XrunUpdate_Source_AUDIO_FRONTEND);
+            break;
+    }
+    notification_content->set_chunk_load(typed_notification->chunk_load());
+    for (const auto& node : typed_notification->slowest_nodes())
+    {
+        auto grpc_node = notification_content->add_slowest_nodes();
+        grpc_node->set_id(node.id);
+        grpc_node->set_load(node.load);
+    }
+    notification_content->set_timestamp_us(typed_notification->timestamp().count());
+
+    std::scoped_lock lock(_xrun_subscriber_lock);
+    for (auto& subscriber : _xrun_subscribers)
+    {
+        subscriber->push(notification_content);
+    }
+}
+
 void NotificationControlService::_forward_track_notification_to_subscribers(const sushi::ext::ControlNotification* notification)
 {
     auto typed_notification = static_cast<const sushi::ext::TrackNotification*>(notification);
@@ -1745,6 +1850,20 @@ void NotificationControlService::unsubscribe(SubscribeToCpuTimingUpdatesCallData
                                           subscriber));
 }
 
+void NotificationControlService::subscribe(SubscribeToXrunsCallData* subscriber)
+{
+    std::scoped_lock lock(_xrun_subscriber_lock);
+    _xrun_subscribers.push_back(subscriber);
+}
+
+void NotificationControlService::unsubscribe(SubscribeToXrunsCallData* subscriber)
+{
+    std::scoped_lock lock(_xrun_subscriber_lock);
+    _xrun_subscribers.erase(std::remove(_xrun_subscribers.begin(),
+                                        _xrun_subscribers.end(),
+                                        subscriber));
+}
+
 void NotificationControlService::subscribe(SubscribeToTrackChangesCallData* subscriber)
 {
     std::scoped_lock lock(_track_subscriber_lock);
@@ -1810,6 +1929,15 @@ void NotificationControlService::delete_all_subscribers()
         _timing_subscribers.clear();
     }
 
+    {
+        std::scoped_lock lock(_xrun_subscriber_lock);
+        for (auto& subscriber : _xrun_subscribers)
+        {
+            delete subscriber;
+        }
+        _xrun_subscribers.clear();
+    }
+
     {
         std::scoped_lock lock(_track_subscriber_lock);
         for (auto& subscriber : _track_subscribers)
@@ -35,6 +35,7 @@ namespace sushi_rpc {
 
 class SubscribeToTransportChangesCallData;
 class SubscribeToCpuTimingUpdatesCallData;
+class SubscribeToXrunsCallData;
 class SubscribeToTrackChangesCallData;
 class SubscribeToProcessorChangesCallData;
 class SubscribeToParameterUpdatesCallData;
@@ -85,6 +86,12 @@ public:
     grpc::Status ResetAllTimings(grpc::ServerContext* context, const sushi_rpc::GenericVoidValue* request, sushi_rpc::GenericVoidValue* response) override;
     grpc::Status ResetTrackTimings(grpc::ServerContext* context, const sushi_rpc::TrackIdentifier* request, sushi_rpc::GenericVoidValue* response) override;
     grpc::Status ResetProcessorTimings(grpc::ServerContext* context, const sushi_rpc::ProcessorIdentifier* request, sushi_rpc::GenericVoidValue* response) override;
+    grpc::Status GetTracingEnabled(grpc::ServerContext* context, const sushi_rpc::GenericVoidValue* request, sushi_rpc::GenericBoolValue* response) override;
+    grpc::Status SetTracingEnabled(grpc::ServerContext* context, const sushi_rpc::GenericBoolValue* request, sushi_rpc::GenericVoidValue* response) override;
+    grpc::Status WriteTraceToFile(grpc::ServerContext* context, const sushi_rpc::GenericStringValue* request, sushi_rpc::GenericVoidValue* response) override;
+    grpc::Status GetXrunCounts(grpc::ServerContext* context, const sushi_rpc::GenericVoidValue* request, sushi_rpc::XrunCounts* response) override;
+    grpc::Status ResetXrunCounts(grpc::ServerContext* context, const sushi_rpc::GenericVoidValue* request, sushi_rpc::GenericVoidValue* response) override;
+    grpc::Status GetMetrics(grpc::ServerContext* context, const sushi_rpc::GenericVoidValue* request, sushi_rpc::GenericStringValue* response) override;
 
 private:
     sushi::ext::TimingController* _controller;
@@ -270,13 +277,14 @@ private:
     sushi::ext::OscController* _controller;
 };
 
-using AsyncService = sushi_rpc::NotificationController::WithAsyncMethod_SubscribeToParameterUpdates<
+using AsyncService = sushi_rpc::NotificationController::WithAsyncMethod_SubscribeToXruns<
+                     sushi_rpc::NotificationController::WithAsyncMethod_SubscribeToParameterUpdates<
                      sushi_rpc::NotificationController::WithAsyncMethod_SubscribeToProcessorChanges<
                      sushi_rpc::NotificationController::WithAsyncMethod_SubscribeToTrackChanges<
                      sushi_rpc::NotificationController::WithAsyncMethod_SubscribeToEngineCpuTimingUpdates<
                      sushi_rpc::NotificationController::WithAsyncMethod_SubscribeToTransportChanges<
                      sushi_rpc::NotificationController::Service
-                     >>>>>;
+                     >>>>>>;
 
 class NotificationControlService : public AsyncService,
                                    private sushi::ext::ControlListener
@@ -293,6 +301,9 @@ public:
     void subscribe(SubscribeToCpuTimingUpdatesCallData* subscriber);
     void unsubscribe(SubscribeToCpuTimingUpdatesCallData* subscriber);
 
+    void subscribe(SubscribeToXrunsCallData* subscriber);
+    void unsubscribe(SubscribeToXrunsCallData* subscriber);
+
     void subscribe(SubscribeToTrackChangesCallData* subscriber);
     void unsubscribe(SubscribeToTrackChangesCallData* subscriber);
 
@@ -307,6 +318,7 @@ public:
 private:
     void _forward_transport_notification_to_subscribers(const sushi::ext::ControlNotification* notification);
     void _forward_cpu_timing_notification_to_subscribers(const sushi::ext::ControlNotification* notification);
+    void _forward_xrun_notification_to_subscribers(const sushi::ext::ControlNotification* notification);
     void _forward_track_notification_to_subscribers(const sushi::ext::ControlNotification* notification);
     void _forward_processor_notification_to_subscribers(const sushi::ext::ControlNotification* notification);
     void _forward_parameter_notification_to_subscribers(const sushi::ext::ControlNotification* notification);
@@ -317,6 +329,9 @@ private:
     std::vector<SubscribeToCpuTimingUpdatesCallData*> _timing_subscribers;
     std::mutex _timing_subscriber_lock;
 
+    std::vector<SubscribeToXrunsCallData*> _xrun_subscribers;
+    std::mutex _xrun_subscriber_lock;
+
     std::vector<SubscribeToTrackChangesCallData*> _track_subscribers;
     std::mutex _track_subscriber_lock;
 
@@ -51,6 +51,7 @@ void GrpcServer::AsyncRpcLoop()
 {
     new SubscribeToTransportChangesCallData(_notification_control_service.get(), _async_rpc_queue.get());
     new SubscribeToCpuTimingUpdatesCallData(_notification_control_service.get(), _async_rpc_queue.get());
+    new SubscribeToXrunsCallData(_notification_control_service.get(), _async_rpc_queue.get());
     new SubscribeToTrackChangesCallData(_notification_control_service.get(), _async_rpc_queue.get());
     new SubscribeToProcessorChangesCallData(_notification_control_service.get(), _async_rpc_queue.get());
     new SubscribeToParameterUpdatesCallData(_notification_control_service.get(), _async_rpc_queue.get());
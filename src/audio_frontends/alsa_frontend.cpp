@@ -0,0 +1,636 @@
+/*
+ * Copyright 2017-2021 Modern Ancient Instruments Networked AB, dba Elk
+ *
+ * SUSHI is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU Affero General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * SUSHI is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along with
+ * SUSHI.  If not, see http://www.gnu.org/licenses/
+ */
+
+/**
+ * @brief Realtime audio frontend talking directly to an Alsa pcm device
+ * @copyright 2017-2021 Modern Ancient Instruments Networked AB, dba Elk, Stockholm
+ */
+
+#ifdef SUSHI_BUILD_WITH_ALSA
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+
+#include <pthread.h>
+
+#include "logging.h"
+#include "alsa_frontend.h"
+#include "audio_frontend_internals.h"
+
+namespace sushi {
+namespace audio_frontend {
+
+SUSHI_GET_LOGGER_WITH_MODULE_NAME("alsa audio");
+
+constexpr int ALSA_FRONTEND_RT_PRIORITY = 75;
+/* Time to wait for the device before checking if the audio thread should stop */
+constexpr int ALSA_WAIT_TIMEOUT_MS = 100;
+/* Supported sample formats, in order of preference */
+constexpr snd_pcm_format_t ALSA_SAMPLE_FORMATS[] = {SND_PCM_FORMAT_FLOAT_LE, SND_PCM_FORMAT_S32_LE, SND_PCM_FORMAT_S16_LE};
+
+/*
+ * Sample access through an mmap area works for both interleaved and non-interleaved
+ * buffers, as the area describes the position of the first sample and the distance
+ * between samples in bits.
+ */
+template <typename T>
+inline T* area_samples(const snd_pcm_channel_area_t& area, snd_pcm_uframes_t offset)
+{
+    return reinterpret_cast<T*>(static_cast<char*>(area.addr) + (area.first + offset * area.step) / 8);
+}
+
+template <typename T>
+inline void read_samples(const snd_pcm_channel_area_t& area, snd_pcm_uframes_t offset,
+                         snd_pcm_uframes_t frames, float scale, float* dest)
+{
+    const T* src = area_samples<T>(area, offset);
+    int step = area.step / (8 * sizeof(T));
+    for (snd_pcm_uframes_t i = 0; i < frames; ++i)
+    {
+        dest[i] = static_cast<float>(src[i * step]) * scale;
+    }
+}
+
+template <typename T>
+inline void write_samples(const snd_pcm_channel_area_t& area, snd_pcm_uframes_t offset,
+                          snd_pcm_uframes_t frames, double scale, const float* src)
+{
+    T* dest = area_samples<T>(area, offset);
+    int step = area.step / (8 * sizeof(T));
+    for (snd_pcm_uframes_t i = 0; i < frames; ++i)
+    {
+        dest[i * step] = static_cast<T>(std::clamp(src[i], -1.0f, 1.0f) * scale);
+    }
+}
+
+void read_area(const snd_pcm_channel_area_t& area, snd_pcm_uframes_t offset, snd_pcm_uframes_t frames,
+               snd_pcm_format_t format, float* dest)
+{
+    switch (format)
+    {
+        case SND_PCM_FORMAT_S32_LE:
+            read_samples<int32_t>(area, offset, frames, 1.0f / 2147483648.0f, dest);
+            break;
+
+        case SND_PCM_FORMAT_S16_LE:
+            read_samples<int16_t>(area, offset, frames, 1.0f / 32768.0f, dest);
+            break;
+
+        default:
+            read_samples<float>(area, offset, frames, 1.0f, dest);
+    }
+}
+
+void write_area(const snd_pcm_channel_area_t& area, snd_pcm_uframes_t offset, snd_pcm_uframes_t frames,
+                snd_pcm_format_t format, const float* src)
+{
+    switch (format)
+    {
+        case SND_PCM_FORMAT_S32_LE:
+            write_samples<int32_t>(area, offset, frames, 2147483647.0, src);
+            break;
+
+        case SND_PCM_FORMAT_S16_LE:
+            write_samples<int16_t>(area, offset, frames, 32767.0, src);
+            break;
+
+        default:
+        {
+            float* dest = area_samples<float>(area, offset);
+            int step = area.step / (8 * sizeof(float));
+            for (snd_pcm_uframes_t i = 0; i < frames; ++i)
+            {
+                dest[i * step] = src[i];
+            }
+        }
+    }
+}
+
+AudioFrontendStatus AlsaFrontend::init(BaseAudioFrontendConfiguration* config)
+{
+    auto ret_code = BaseAudioFrontend::init(config);
+    if (ret_code != AudioFrontendStatus::OK)
+    {
+        return ret_code;
+    }
+    auto alsa_config = static_cast<AlsaFrontendConfiguration*>(_config);
+    if (alsa_config->period_size <= 0 || alsa_config->periods < 2)
+    {
+        SUSHI_LOG_ERROR("Invalid period size {} or number of periods {}", alsa_config->period_size, alsa_config->periods);
+        return AudioFrontendStatus::AUDIO_HW_ERROR;
+    }
+
+    int ret = snd_pcm_open(&_playback, alsa_config->device.c_str(), SND_PCM_STREAM_PLAYBACK, 0);
+    if (ret < 0)
+    {
+        SUSHI_LOG_ERROR("Failed to open playback on Alsa device {}: {}", alsa_config->device, snd_strerror(ret));
+        _playback = nullptr;
+        return AudioFrontendStatus::AUDIO_HW_ERROR;
+    }
+    ret = snd_pcm_open(&_capture, alsa_config->device.c_str(), SND_PCM_STREAM_CAPTURE, 0);
+    if (ret < 0)
+    {
+        SUSHI_LOG_WARNING("No capture on Alsa device {}, running with outputs only: {}", alsa_config->device, snd_strerror(ret));
+        _capture = nullptr;
+    }
+
+    auto status = _configure_device(std::lround(_engine->sample_rate()), alsa_config->period_size, alsa_config->periods);
+    if (status != AudioFrontendStatus::OK)
+    {
+        cleanup();
+        return status;
+    }
+    if (_capture && snd_pcm_link(_capture, _playback) < 0)
+    {
+        SUSHI_LOG_WARNING("Failed to link capture and playback, they will be started separately");
+    }
+
+    _engine->set_audio_input_channels(_capture_channels);
+    _engine->set_audio_output_channels(_playback_channels);
+    /* Cv is not exchanged, so the engine is set up without cv ports */
+    if (alsa_config->cv_inputs > 0 || alsa_config->cv_outputs > 0)
+    {
+        SUSHI_LOG_WARNING("The Alsa frontend has no cv, ignoring {} cv inputs and {} cv outputs",
+                          alsa_config->cv_inputs, alsa_config->cv_outputs);
+    }
+    _engine->set_cv_input_channels(0);
+    _engine->set_cv_output_channels(0);
+    SUSHI_LOG_INFO("Opened Alsa device {} with {} inputs and {} outputs, {} periods of {} samples",
+                   alsa_config->device, _capture_channels, _playback_channels, _periods, _period_size);
+    return AudioFrontendStatus::OK;
+}
+
+void AlsaFrontend::cleanup()
+{
+    _running = false;
+    if (_worker.joinable())
+    {
+        _worker.join();
+    }
+    _engine->enable_realtime(false);
+    if (_capture)
+    {
+        snd_pcm_drop(_capture);
+        snd_pcm_close(_capture);
+        _capture = nullptr;
+    }
+    if (_playback)
+    {
+        snd_pcm_drop(_playback);
+        snd_pcm_close(_playback);
+        _playback = nullptr;
+    }
+}
+
+void AlsaFrontend::run()
+{
+    /* The configuration file may have changed the sample rate after init */
+    unsigned int sample_rate = std::lround(_engine->sample_rate());
+    if (sample_rate != _sample_rate)
+    {
+        auto status = _configure_device(sample_rate, _period_size, _periods);
+        if (status != AudioFrontendStatus::OK)
+        {
+            SUSHI_LOG_ERROR("Failed to reconfigure Alsa device for sample rate {}", sample_rate);
+            return;
+        }
+    }
+    int ret = _start_streams();
+    if (ret < 0)
+    {
+        SUSHI_LOG_ERROR("Failed to start Alsa streams: {}", snd_strerror(ret));
+        return;
+    }
+    _engine->enable_realtime(true);
+    _running = true;
+    _worker = std::thread(&AlsaFrontend::_audio_thread, this);
+}
+
+AudioFrontendStatus AlsaFrontend::_configure_device(unsigned int sample_rate, snd_pcm_uframes_t period_size, unsigned int periods)
+{
+    auto status = _configure_stream(_playback, &sample_rate, &_playback_format, &_playback_device_channels, &period_size, &periods);
+    if (status != AudioFrontendStatus::OK)
+    {
+        SUSHI_LOG_ERROR("Failed to configure Alsa playback");
+        return status;
+    }
+    _playback_channels = std::min(_playback_device_channels, MAX_FRONTEND_CHANNELS);
+    if (_capture)
+    {
+        /* Capture must run with exactly the same timing as playback */
+        unsigned int capture_rate = sample_rate;
+        snd_pcm_uframes_t capture_period = period_size;
+        unsigned int capture_periods = periods;
+        int capture_device_channels = 0;
+        status = _configure_stream(_capture, &capture_rate, &_capture_format, &capture_device_channels, &capture_period, &capture_periods);
+        if (status != AudioFrontendStatus::OK || capture_rate != sample_rate || capture_period != period_size)
+        {
+            SUSHI_LOG_ERROR("Failed to configure Alsa capture with the same period and sample rate as playback");
+            return AudioFrontendStatus::AUDIO_HW_ERROR;
+        }
+        /* Capture channels beyond what the engine supports are not read */
+        _capture_channels = std::min(capture_device_channels, MAX_FRONTEND_CHANNELS);
+    }
+
+    _sample_rate = sample_rate;
+    _period_size = period_size;
+    _periods = periods;
+    if (std::lround(_engine->sample_rate()) != static_cast<long>(sample_rate))
+    {
+        SUSHI_LOG_WARNING("Sample rate mismatch between engine ({}) and Alsa device ({})", _engine->sample_rate(), sample_rate);
+        _engine->set_sample_rate(sample_rate);
+    }
+
+    _in_data.assign(_capture_channels * period_size, 0.0f);
+    _out_data.assign(_playback_channels * period_size, 0.0f);
+    _in_pointers.clear();
+    _out_pointers.clear();
+    for (int c = 0; c < _capture_channels; ++c)
+    {
+        _in_pointers.push_back(_in_data.data() + c * period_size);
+    }
+    for (int c = 0; c < _playback_channels; ++c)
+    {
+        _out_pointers.push_back(_out_data.data() + c * period_size);
+    }
+    _in_channels.resize(_capture_channels);
+    _out_channels.resize(_playback_channels);
+
+    /* Output is delayed by the whole playback buffer, which is filled with silence at start */
+    int latency = period_size * periods;
+    if (period_size % AUDIO_CHUNK_SIZE != 0)
+    {
+        _reblocker.configure(_capture_channels, _playback_channels, period_size);
+        latency += _reblocker.latency();
+        SUSHI_LOG_INFO("Period of {} samples is not a multiple of {}, re-blocking with {} samples of added latency",
+                       period_size, AUDIO_CHUNK_SIZE, _reblocker.latency());
+    }
+    _engine->set_output_latency(std::chrono::microseconds((latency * 1'000'000) / sample_rate));
+    return AudioFrontendStatus::OK;
+}
+
+AudioFrontendStatus AlsaFrontend::_configure_stream(snd_pcm_t* pcm, unsigned int* sample_rate, snd_pcm_format_t* format,
+                                                    int* channels, snd_pcm_uframes_t* period_size, unsigned int* periods)
+{
+    snd_pcm_hw_params_t* hw_params;
+    snd_pcm_hw_params_alloca(&hw_params);
+    int ret = snd_pcm_hw_params_any(pcm, hw_params);
+    if (ret < 0)
+    {
+        SUSHI_LOG_ERROR("No hw configuration available: {}", snd_strerror(ret));
+        return AudioFrontendStatus::AUDIO_HW_ERROR;
+    }
+    /* Non-interleaved access is the layout of the engine's buffers, but all
+     * access types are handled the same way through the mmap areas */
+    if (snd_pcm_hw_params_set_access(pcm, hw_params, SND_PCM_ACCESS_MMAP_NONINTERLEAVED) < 0 &&
+        snd_pcm_hw_params_set_access(pcm, hw_params, SND_PCM_ACCESS_MMAP_INTERLEAVED) < 0)
+    {
+        SUSHI_LOG_ERROR("Device doesn't support mmap access");
+        return AudioFrontendStatus::AUDIO_HW_ERROR;
+    }
+    auto supported_format = std::find_if(std::begin(ALSA_SAMPLE_FORMATS), std::end(ALSA_SAMPLE_FORMATS), [&](auto f)
+    {
+        return snd_pcm_hw_params_set_format(pcm, hw_params, f) == 0;
+    });
+    if (supported_format == std::end(ALSA_SAMPLE_FORMATS))
+    {
+        SUSHI_LOG_ERROR("Device doesn't support any of the float, 32 bit or 16 bit sample formats");
+        return AudioFrontendStatus::AUDIO_HW_ERROR;
+    }
+    *format = *supported_format;
+
+    unsigned int max_channels = 0;
+    snd_pcm_hw_params_get_channels_max(hw_params, &max_channels);
+    unsigned int channel_count = std::min(max_channels, static_cast<unsigned int>(MAX_FRONTEND_CHANNELS));
+    ret = snd_pcm_hw_params_set_channels_near(pcm, hw_params, &channel_count);
+    if (ret < 0)
+    {
+        SUSHI_LOG_ERROR("Failed to set number of channels: {}", snd_strerror(ret));
+        return AudioFrontendStatus::INVALID_N_CHANNELS;
+    }
+    *channels = static_cast<int>(channel_count);
+
+    ret = snd_pcm_hw_params_set_rate_near(pcm, hw_params, sample_rate, nullptr);
+    if (ret < 0)
+    {
+        SUSHI_LOG_ERROR("Failed to set sample rate: {}", snd_strerror(ret));
+        return AudioFrontendStatus::AUDIO_HW_ERROR;
+    }
+    ret = snd_pcm_hw_params_set_period_size_near(pcm, hw_params, period_size, nullptr);
+    if (ret < 0)
+    {
+        SUSHI_LOG_ERROR("Failed to set period size: {}", snd_strerror(ret));
+        return AudioFrontendStatus::AUDIO_HW_ERROR;
+    }
+    ret = snd_pcm_hw_params_set_periods_near(pcm, hw_params, periods, nullptr);
+    if (ret < 0)
+    {
+        SUSHI_LOG_ERROR("Failed to set number of periods: {}", snd_strerror(ret));
+        return AudioFrontendStatus::AUDIO_HW_ERROR;
+    }
+    ret = snd_pcm_hw_params(pcm, hw_params);
+    if (ret < 0)
+    {
+        SUSHI_LOG_ERROR("Failed to apply hw configuration: {}", snd_strerror(ret));
+        return AudioFrontendStatus::AUDIO_HW_ERROR;
+    }
+
+    /* Streams are started explicitly once the playback buffer is filled */
+    snd_pcm_sw_params_t* sw_params;
+    snd_pcm_sw_params_alloca(&sw_params);
+    snd_pcm_sw_params_current(pcm, sw_params);
+    snd_pcm_uframes_t boundary = 0;
+    snd_pcm_sw_params_get_boundary(sw_params, &boundary);
+    snd_pcm_sw_params_set_avail_min(pcm, sw_params, *period_size);
+    snd_pcm_sw_params_set_start_threshold(pcm, sw_params, boundary);
+    ret = snd_pcm_sw_params(pcm, sw_params);
+    if (ret < 0)
+    {
+        SUSHI_LOG_ERROR("Failed to apply sw configuration: {}", snd_strerror(ret));
+        return AudioFrontendStatus::AUDIO_HW_ERROR;
+    }
+    return AudioFrontendStatus::OK;
+}
+
+int AlsaFrontend::_start_streams()
+{
+    int ret = snd_pcm_prepare(_playback);
+    if (ret < 0)
+    {
+        return ret;
+    }
+    if (_capture && (ret = snd_pcm_prepare(_capture)) < 0)
+    {
+        return ret;
+    }
+    snd_pcm_uframes_t silence = _period_size * _periods;
+    while (silence > 0)
+    {
+        const snd_pcm_channel_area_t* areas;
+        snd_pcm_uframes_t offset;
+        snd_pcm_uframes_t frames = silence;
+        ret = snd_pcm_mmap_begin(_playback, &areas, &offset, &frames);
+        if (ret < 0)
+        {
+            return ret;
+        }
+        snd_pcm_areas_silence(areas, offset, _playback_device_channels, frames, _playback_format);
+        auto committed = snd_pcm_mmap_commit(_playback, offset, frames);
+        if (committed < 0)
+        {
+            return committed;
+        }
+        silence -= committed;
+    }
+    ret = snd_pcm_start(_playback);
+    if (ret < 0)
+    {
+        return ret;
+    }
+    /* Linked streams start together */
+    if (_capture && snd_pcm_state(_capture) != SND_PCM_STATE_RUNNING)
+    {
+        ret = snd_pcm_start(_capture);
+    }
+    return ret;
+}
+
+int AlsaFrontend::_recover(int error)
+{
+    auto xrun_monitor = _engine->xrun_monitor();
+    if (xrun_monitor)
+    {
+        xrun_monitor->report_frontend_xrun();
+    }
+    if (error == -ESTRPIPE)
+    {
+        /* The device was suspended, wait until it is resumed */
+        while ((error = snd_pcm_resume(_playback)) == -EAGAIN && _running)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(ALSA_WAIT_TIMEOUT_MS));
+        }
+    }
+    else if (error != -EPIPE)
+    {
+        return error;
+    }
+    snd_pcm_drop(_playback);
+    if (_capture)
+    {
+        snd_pcm_drop(_capture);
+    }
+    return _start_streams();
+}
+
+void AlsaFrontend::_audio_thread()
+{
+    sched_param param{ALSA_FRONTEND_RT_PRIORITY};
+    int res = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+    if (res != 0)
+    {
+        SUSHI_LOG_WARNING("Failed to set realtime priority of Alsa audio thread: {}", strerror(res));
+    }
+    set_flush_denormals_to_zero();
+
+    while (_running)
+    {
+        int ret = _process_period();
+        if (ret < 0)
+        {
+            ret = _recover(ret);
+            if (ret < 0)
+            {
+                SUSHI_LOG_ERROR("Failed to recover Alsa streams: {}", snd_strerror(ret));
+                break;
+            }
+        }
+    }
+}
+
+int AlsaFrontend::_process_period()
+{
+    if (_capture)
+    {
+        int ret = _wait_for_period(_capture);
+        if (ret <= 0)
+        {
+            return ret;
+        }
+        ret = _read_capture();
+        if (ret < 0)
+        {
+            return ret;
+        }
+    }
+    else
+    {
+        int ret = _wait_for_period(_playback);
+        if (ret <= 0)
+        {
+            return ret;
+        }
+    }
+
+    Time timestamp = get_current_time();
+    if (_period_size % AUDIO_CHUNK_SIZE == 0)
+    {
+        for (snd_pcm_uframes_t frame = 0; frame < _period_size; frame += AUDIO_CHUNK_SIZE)
+        {
+            for (int c = 0; c < _capture_channels; ++c)
+            {
+                _in_channels[c] = ChunkSampleBuffer::create_from_raw_pointer(_in_data.data() + c * _period_size + frame, 0, 1);
+            }
+            for (int c = 0; c < _playback_channels; ++c)
+            {
+                _out_channels[c] = ChunkSampleBuffer::create_from_raw_pointer(_out_data.data() + c * _period_size + frame, 0, 1);
+            }
+            Time delta_time = std::chrono::microseconds((frame * 1'000'000) / _sample_rate);
+            _engine->process_chunk(&_in_channels, &_out_channels, &_in_controls, &_out_controls,
+                                   timestamp + delta_time, _samplecount + frame);
+        }
+    }
+    else
+    {
+        _reblocker.process(_in_pointers.data(), _out_pointers.data(), [&](engine::ChunkChannelBuffers* in_channels,
+                                                                          engine::ChunkChannelBuffers* out_channels,
+                                                                          int offset)
+        {
+            Time delta_time = std::chrono::microseconds((offset * int64_t(1'000'000)) / _sample_rate);
+            _engine->process_chunk(in_channels, out_channels, &_in_controls, &_out_controls,
+                                   timestamp + delta_time, _samplecount + offset);
+        });
+    }
+    _samplecount += _period_size;
+
+    if (_capture)
+    {
+        int ret = _wait_for_period(_playback);
+        if (ret <= 0)
+        {
+            return ret;
+        }
+    }
+    return _write_playback();
+}
+
+int AlsaFrontend::_wait_for_period(snd_pcm_t* pcm)
+{
+    while (_running)
+    {
+        auto avail = snd_pcm_avail_update(pcm);
+        if (avail < 0)
+        {
+            return avail;
+        }
+        if (static_cast<snd_pcm_uframes_t>(avail) >= _period_size)
+        {
+            return 1;
+        }
+        int ret = snd_pcm_wait(pcm, ALSA_WAIT_TIMEOUT_MS);
+        if (ret < 0)
+        {
+            return ret;
+        }
+    }
+    return 0;
+}
+
+int AlsaFrontend::_read_capture()
+{
+    snd_pcm_uframes_t done = 0;
+    while (done < _period_size)
+    {
+        const snd_pcm_channel_area_t* areas;
+        snd_pcm_uframes_t offset;
+        snd_pcm_uframes_t frames = _period_size - done;
+        int ret = snd_pcm_mmap_begin(_capture, &areas, &offset, &frames);
+        if (ret < 0)
+        {
+            return ret;
+        }
+        for (int c = 0; c < _capture_channels; ++c)
+        {
+            read_area(areas[c], offset, frames, _capture_format, _in_data.data() + c * _period_size + done);
+        }
+        auto committed = snd_pcm_mmap_commit(_capture, offset, frames);
+        if (committed < 0)
+        {
+            return committed;
+        }
+        if (static_cast<snd_pcm_uframes_t>(committed) != frames)
+        {
+            return -EPIPE;
+        }
+        done += frames;
+    }
+    return 0;
+}
+
+int AlsaFrontend::_write_playback()
+{
+    snd_pcm_uframes_t done = 0;
+    while (done < _period_size)
+    {
+        const snd_pcm_channel_area_t* areas;
+        snd_pcm_uframes_t offset;
+        snd_pcm_uframes_t frames = _period_size - done;
+        int ret = snd_pcm_mmap_begin(_playback, &areas, &offset, &frames);
+        if (ret < 0)
+        {
+            return ret;
+        }
+        for (int c = 0; c < _playback_channels; ++c)
+        {
+            write_area(areas[c], offset, frames, _playback_format, _out_data.data() + c * _period_size + done);
+        }
+        if (_playback_device_channels > _playback_channels)
+        {
+            snd_pcm_areas_silence(areas + _playback_channels, offset, _playback_device_channels - _playback_channels,
+                                  frames, _playback_format);
+        }
+        auto committed = snd_pcm_mmap_commit(_playback, offset, frames);
+        if (committed < 0)
+        {
+            return committed;
+        }
+        if (static_cast<snd_pcm_uframes_t>(committed) != frames)
+        {
+            return -EPIPE;
+        }
+        done += frames;
+    }
+    return 0;
+}
+
+}; // end namespace audio_frontend
+}; // end namespace sushi
+#endif
+#ifndef SUSHI_BUILD_WITH_ALSA
+#include "audio_frontends/alsa_frontend.h"
+#include "logging.h"
+namespace sushi {
+namespace audio_frontend {
+SUSHI_GET_LOGGER;
+AlsaFrontend::AlsaFrontend(engine::BaseEngine* engine) : BaseAudioFrontend(engine)
+{}
+AudioFrontendStatus AlsaFrontend::init(BaseAudioFrontendConfiguration*)
+{
+    /* The log print needs to be in a cpp file for initialisation order reasons */
+    SUSHI_LOG_ERROR("Sushi was not built with Alsa support!");
+    return AudioFrontendStatus::AUDIO_HW_ERROR;
+}}}
+#endif
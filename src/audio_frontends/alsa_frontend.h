@@ -0,0 +1,183 @@
+/*
+ * Copyright 2017-2021 Modern Ancient Instruments Networked AB, dba Elk
+ *
+ * SUSHI is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU Affero General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * SUSHI is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along with
+ * SUSHI.  If not, see http://www.gnu.org/licenses/
+ */
+
+/**
+ * @brief Realtime audio frontend talking directly to an Alsa pcm device
+ * @copyright 2017-2021 Modern Ancient Instruments Networked AB, dba Elk, Stockholm
+ */
+
+#ifndef SUSHI_ALSA_FRONTEND_H
+#define SUSHI_ALSA_FRONTEND_H
+
+#include <string>
+
+#ifdef SUSHI_BUILD_WITH_ALSA
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <alsa/asoundlib.h>
+
+#include "base_audio_frontend.h"
+#include "reblocking_adapter.h"
+
+namespace sushi {
+namespace audio_frontend {
+
+struct AlsaFrontendConfiguration : public BaseAudioFrontendConfiguration
+{
+    AlsaFrontendConfiguration(const std::string& device,
+                              int period_size,
+                              int periods,
+                              int cv_inputs,
+                              int cv_outputs) :
+            BaseAudioFrontendConfiguration(cv_inputs, cv_outputs),
+            device(device),
+            period_size(period_size),
+            periods(periods)
+    {}
+
+    virtual ~AlsaFrontendConfiguration() = default;
+
+    /* Alsa pcm name, i.e. "hw:0" or "null" */
+    std::string device;
+    /* Frames per period, the device may pick the closest size it supports */
+    int period_size;
+    /* Periods in the device buffer */
+    int periods;
+};
+
+/**
+ * @brief Frontend that drives the engine from an Alsa pcm device without a sound
+ *        server in between. Capture and playback are opened on the same device, linked
+ *        so that they start together, and transferred with snd_pcm_mmap_begin() and
+ *        snd_pcm_mmap_commit() from a SCHED_FIFO thread. Periods that are not a multiple
+ *        of AUDIO_CHUNK_SIZE are re-blocked. Xruns are reported to the xrun monitor and
+ *        recovered from by restarting the streams.
+ *
+ *        If the device has no capture stream the frontend runs with outputs only.
+ *        Gate and cv are not exchanged.
+ */
+class AlsaFrontend : public BaseAudioFrontend
+{
+public:
+    AlsaFrontend(engine::BaseEngine* engine) : BaseAudioFrontend(engine) {}
+
+    virtual ~AlsaFrontend()
+    {
+        cleanup();
+    }
+
+    /**
+     * @brief Open and configure the Alsa device.
+     * @param config Configuration struct
+     * @return OK on successful initialization, error otherwise.
+     */
+    AudioFrontendStatus init(BaseAudioFrontendConfiguration* config) override;
+
+    /**
+     * @brief Stop the audio thread and close the device
+     */
+    void cleanup() override;
+
+    /**
+     * @brief Start the audio thread, returns immediately.
+     */
+    void run() override;
+
+private:
+    /* Set the hw and sw parameters of both streams and allocate buffers to match */
+    AudioFrontendStatus _configure_device(unsigned int sample_rate, snd_pcm_uframes_t period_size, unsigned int periods);
+
+    /* Set the parameters of one stream. channels is set to the number of channels
+     * of the device, which can be more than MAX_FRONTEND_CHANNELS */
+    AudioFrontendStatus _configure_stream(snd_pcm_t* pcm, unsigned int* sample_rate, snd_pcm_format_t* format,
+                                          int* channels, snd_pcm_uframes_t* period_size, unsigned int* periods);
+
+    /* Prepare both streams, fill the playback buffer with silence and start */
+    int _start_streams();
+
+    /* Restart after an xrun or a suspend */
+    int _recover(int error);
+
+    void _audio_thread();
+
+    int _process_period();
+
+    /* Wait until a full period can be transferred to or from a stream */
+    int _wait_for_period(snd_pcm_t* pcm);
+
+    /* Transfer one period between the device and the float buffers */
+    int _read_capture();
+    int _write_playback();
+
+    snd_pcm_t*          _capture{nullptr};
+    snd_pcm_t*          _playback{nullptr};
+    snd_pcm_format_t    _capture_format{SND_PCM_FORMAT_FLOAT_LE};
+    snd_pcm_format_t    _playback_format{SND_PCM_FORMAT_FLOAT_LE};
+    int                 _capture_channels{0};
+    int                 _playback_channels{0};
+    /* Device channels beyond _playback_channels are written with silence */
+    int                 _playback_device_channels{0};
+    unsigned int        _sample_rate{0};
+    snd_pcm_uframes_t   _period_size{0};
+    unsigned int        _periods{0};
+
+    /* One period per channel, non-interleaved */
+    std::vector<float>  _in_data;
+    std::vector<float>  _out_data;
+    std::vector<const float*> _in_pointers;
+    std::vector<float*> _out_pointers;
+
+    engine::ChunkChannelBuffers _in_channels;
+    engine::ChunkChannelBuffers _out_channels;
+    engine::ControlBuffer _in_controls;
+    engine::ControlBuffer _out_controls;
+    ReblockingAdapter   _reblocker;
+
+    int64_t             _samplecount{0};
+    std::atomic_bool    _running{false};
+    std::thread         _worker;
+};
+
+} // end namespace audio_frontend
+} // end namespace sushi
+
+#endif //SUSHI_BUILD_WITH_ALSA
+#ifndef SUSHI_BUILD_WITH_ALSA
+/* If Alsa is disabled in the build config, the alsa frontend is replaced with
+   this dummy frontend whose only purpose is to assert if you try to use it */
+#include "base_audio_frontend.h"
+namespace sushi {
+namespace audio_frontend {
+struct AlsaFrontendConfiguration : public BaseAudioFrontendConfiguration
+{
+    AlsaFrontendConfiguration(const std::string&, int, int, int, int) : BaseAudioFrontendConfiguration(0, 0) {}
+};
+
+class AlsaFrontend : public BaseAudioFrontend
+{
+public:
+    AlsaFrontend(engine::BaseEngine* engine);
+    AudioFrontendStatus init(BaseAudioFrontendConfiguration*) override;
+    void cleanup() override {}
+    void run() override {}
+};
+}; // end namespace audio_frontend
+}; // end namespace sushi
+#endif
+
+#endif //SUSHI_ALSA_FRONTEND_H
@@ -0,0 +1,176 @@
+/*
+ * Copyright 2017-2021 Modern Ancient Instruments Networked AB, dba Elk
+ *
+ * SUSHI is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU Affero General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * SUSHI is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along with
+ * SUSHI.  If not, see http://www.gnu.org/licenses/
+ */
+
+/**
+ * @brief Read-ahead and write-behind threads for streaming audio files
+ * @copyright 2017-2021 Modern Ancient Instruments Networked AB, dba Elk, Stockholm
+ */
+
+#include <algorithm>
+#include <cassert>
+
+#include "logging.h"
+#include "audio_file_streamer.h"
+
+namespace sushi {
+namespace audio_frontend {
+
+SUSHI_GET_LOGGER_WITH_MODULE_NAME("offline audio");
+
+/* Time to wait before polling a queue again when there is nothing to do */
+constexpr auto STREAMER_WAIT_TIME = std::chrono::microseconds(200);
+
+AudioFileStreamer::AudioFileStreamer(const std::vector<AudioFileMapping>& input_files,
+                                     const std::vector<AudioFileMapping>& output_files) : _input_files(input_files),
+                                                                                          _output_files(output_files),
+                                                                                          _blocks(STREAMER_BLOCK_COUNT)
+{
+    for (auto& block : _blocks)
+    {
+        for (const auto& file : _input_files)
+        {
+            block.inputs.emplace_back(block_frames() * file.channels, 0.0f);
+        }
+        for (const auto& file : _output_files)
+        {
+            block.outputs.emplace_back(block_frames() * file.channels, 0.0f);
+        }
+        _free_queue.push(&block);
+    }
+}
+
+AudioFileStreamer::~AudioFileStreamer()
+{
+    _input_done = true;
+    _running = false;
+    if (_reader.joinable())
+    {
+        _reader.join();
+    }
+    if (_writer.joinable())
+    {
+        _writer.join();
+    }
+}
+
+void AudioFileStreamer::start()
+{
+    _running = true;
+    _input_done = false;
+    _reader = std::thread(&AudioFileStreamer::_read_worker, this);
+    _writer = std::thread(&AudioFileStreamer::_write_worker, this);
+}
+
+AudioFileBlock* AudioFileStreamer::next_block()
+{
+    AudioFileBlock* block;
+    while (_read_queue.pop(block) == false)
+    {
+        std::this_thread::sleep_for(STREAMER_WAIT_TIME);
+    }
+    if (block->frames == 0)
+    {
+        /* End of file, hand the block back so the writer can recycle it */
+        _write_queue.push(block);
+        return nullptr;
+    }
+    return block;
+}
+
+void AudioFileStreamer::write_block(AudioFileBlock* block)
+{
+    /* Can not fail as there are never more blocks than the queue can hold */
+    [[maybe_unused]] bool pushed = _write_queue.push(block);
+    assert(pushed);
+}
+
+void AudioFileStreamer::finish()
+{
+    _input_done = true;
+    if (_writer.joinable())
+    {
+        _writer.join();
+    }
+    _running = false;
+    if (_reader.joinable())
+    {
+        _reader.join();
+    }
+}
+
+void AudioFileStreamer::_read_worker()
+{
+    while (_running)
+    {
+        AudioFileBlock* block;
+        if (_free_queue.pop(block) == false)
+        {
+            std::this_thread::sleep_for(STREAMER_WAIT_TIME);
+            continue;
+        }
+        int frames = 0;
+        for (size_t i = 0; i < _input_files.size(); ++i)
+        {
+            auto& input = block->inputs[i];
+            int channels = _input_files[i].channels;
+            auto read = sf_readf_float(_input_files[i].file, input.data(), static_cast<sf_count_t>(block_frames()));
+            int file_frames = static_cast<int>(std::max(read, sf_count_t(0)));
+            if (file_frames < block_frames())
+            {
+                std::fill(input.begin() + file_frames * channels, input.end(), 0.0f);
+            }
+            frames = std::max(frames, file_frames);
+        }
+        block->frames = frames;
+        _read_queue.push(block);
+        if (frames == 0)
+        {
+            break;
+        }
+    }
+}
+
+void AudioFileStreamer::_write_worker()
+{
+    while (true)
+    {
+        AudioFileBlock* block;
+        if (_write_queue.pop(block) == false)
+        {
+            if (_input_done && _write_queue.wasEmpty())
+            {
+                break;
+            }
+            std::this_thread::sleep_for(STREAMER_WAIT_TIME);
+            continue;
+        }
+        if (block->frames > 0)
+        {
+            for (size_t i = 0; i < _output_files.size(); ++i)
+            {
+                auto file = _output_files[i].file;
+                auto written = sf_writef_float(file, block->outputs[i].data(), static_cast<sf_count_t>(block->frames));
+                if (written != block->frames)
+                {
+                    SUSHI_LOG_ERROR("Failed to write to output file: {}", sf_strerror(file));
+                }
+            }
+        }
+        _free_queue.push(block);
+    }
+}
+
+} // end namespace audio_frontend
+} // end namespace sushi
@@ -0,0 +1,140 @@
+/*
+ * Copyright 2017-2021 Modern Ancient Instruments Networked AB, dba Elk
+ *
+ * SUSHI is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU Affero General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * SUSHI is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along with
+ * SUSHI.  If not, see http://www.gnu.org/licenses/
+ */
+
+/**
+ * @brief Read-ahead and write-behind threads for streaming audio files
+ * @copyright 2017-2021 Modern Ancient Instruments Networked AB, dba Elk, Stockholm
+ */
+
+#ifndef SUSHI_AUDIO_FILE_STREAMER_H
+#define SUSHI_AUDIO_FILE_STREAMER_H
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <sndfile.h>
+
+#include "fifo/circularfifo_memory_relaxed_aquire_release.h"
+
+#include "library/constants.h"
+
+namespace sushi {
+namespace audio_frontend {
+
+/* Sizes give around 2.7 seconds of read-ahead and write-behind with
+ * 64 sample chunks at 48 kHz */
+constexpr int STREAMER_BLOCK_CHUNKS = 32;
+constexpr int STREAMER_BLOCK_COUNT = 64;
+
+/**
+ * @brief An open audio file and the first engine channel its channels map to
+ */
+struct AudioFileMapping
+{
+    SNDFILE* file;
+    int channels;
+    int engine_channel;
+};
+
+/**
+ * @brief A block of interleaved audio frames read from the input files, with room
+ *        for the processed output frames. Holds one buffer per file.
+ */
+struct AudioFileBlock
+{
+    std::vector<std::vector<float>> inputs;
+    std::vector<std::vector<float>> outputs;
+    /* Frames read into the block from the longest input file, 0 signals the end of all input files */
+    int frames{0};
+};
+
+/**
+ * @brief Decodes input files in a read-ahead thread and encodes output files in
+ *        a write-behind thread, so that the thread rendering audio does not wait for
+ *        disk or codec. Blocks are passed between the threads through lock free
+ *        queues and are reused, so no memory is allocated while streaming.
+ *
+ *        Blocks are obtained in order with next_block(), filled with output and then
+ *        passed back with write_block(). Blocks hold a multiple of AUDIO_CHUNK_SIZE
+ *        frames. The last block may hold fewer frames than that, the remainder of it
+ *        is set to 0. Input files shorter than the longest one are padded with 0.
+ */
+class AudioFileStreamer
+{
+public:
+    SUSHI_DECLARE_NON_COPYABLE(AudioFileStreamer);
+
+    /**
+     * @param input_files Open files to read from
+     * @param output_files Open files to write to
+     */
+    AudioFileStreamer(const std::vector<AudioFileMapping>& input_files,
+                      const std::vector<AudioFileMapping>& output_files);
+
+    ~AudioFileStreamer();
+
+    /**
+     * @brief Start the reader and writer threads
+     */
+    void start();
+
+    /**
+     * @brief Get the next block of input. Waits if the reader is not yet done with it.
+     * @return A block of input, or nullptr if all input files have been read
+     */
+    AudioFileBlock* next_block();
+
+    /**
+     * @brief Queue a block obtained from next_block() for writing. The block must not
+     *        be accessed after this.
+     * @param block The block, with its output filled in and frames set to the
+     *              number of output frames to write
+     */
+    void write_block(AudioFileBlock* block);
+
+    /**
+     * @brief Wait until all queued blocks are written and stop the threads
+     */
+    void finish();
+
+    static constexpr int block_frames() {return STREAMER_BLOCK_CHUNKS * AUDIO_CHUNK_SIZE;}
+
+private:
+    void _read_worker();
+    void _write_worker();
+
+    using BlockQueue = memory_relaxed_aquire_release::CircularFifo<AudioFileBlock*, STREAMER_BLOCK_COUNT>;
+
+    std::vector<AudioFileMapping> _input_files;
+    std::vector<AudioFileMapping> _output_files;
+
+    std::vector<AudioFileBlock> _blocks;
+    /* Every queue has one producer and one consumer thread:
+     * free: writer -> reader, read: reader -> renderer, write: renderer -> writer */
+    BlockQueue _free_queue;
+    BlockQueue _read_queue;
+    BlockQueue _write_queue;
+
+    std::atomic_bool _running{false};
+    std::atomic_bool _input_done{false};
+    std::thread _reader;
+    std::thread _writer;
+};
+
+} // end namespace audio_frontend
+} // end namespace sushi
+
+#endif //SUSHI_AUDIO_FILE_STREAMER_H
@@ -20,10 +20,15 @@
 #ifndef SUSHI_AUDIO_FRONTEND_INTERNALS_H
 #define SUSHI_AUDIO_FRONTEND_INTERNALS_H
 
+#include <algorithm>
+#include <cstdint>
+
 #ifdef __x86_64__
 #include <xmmintrin.h>
 #endif
 
+#include "library/time.h"
+
 namespace sushi {
 namespace audio_frontend {
 
@@ -73,22 +78,46 @@ inline float map_cv_to_audio(float cv)
 /**
  * @brief Helper function to do ramping of cv outputs that are updated once per
  *        audio chunk.
- * @param output A float array of size AUDIO_CHUNK_SIZE where the smoothed data will
+ * @param output A float array of size samples where the smoothed data will
  *               be copied to.
  * @param current_value The current value of the smoother
  * @param target_value The target value for the smoother
+ * @param samples The length of the ramp, defaults to one audio chunk
  * @return The new current value
  */
-inline float ramp_cv_output(float* output, float current_value, float target_value)
+inline float ramp_cv_output(float* output, float current_value, float target_value, int samples = AUDIO_CHUNK_SIZE)
 {
-    float inc = (target_value - current_value) / (AUDIO_CHUNK_SIZE - 1);
-    for (int i = 0 ; i < AUDIO_CHUNK_SIZE; ++i)
+    float inc = (target_value - current_value) / std::max(samples - 1, 1);
+    for (int i = 0 ; i < samples; ++i)
     {
         output[i] = current_value + inc * i;
     }
     return target_value;
 }
 
+/**
+ * @brief Convert a time to an absolute sample position using integer math only,
+ *        so that positions stay exact regardless of how far into the audio they are.
+ * @param time The time since the start of processing
+ * @param sample_rate The sample rate in Hz
+ * @return The sample position
+ */
+inline int64_t time_to_sample(Time time, int64_t sample_rate)
+{
+    return time.count() * sample_rate / 1'000'000;
+}
+
+/**
+ * @brief Convert an absolute sample position to the time since the start of processing
+ * @param sample The sample position
+ * @param sample_rate The sample rate in Hz
+ * @return The time of the sample, rounded down to whole microseconds
+ */
+inline Time sample_to_time(int64_t sample, int64_t sample_rate)
+{
+    return std::chrono::microseconds(sample * 1'000'000 / sample_rate);
+}
+
 }; // end namespace audio_frontend
 }; // end namespace sushi
 
@@ -19,6 +19,9 @@
  */
 
 #ifdef SUSHI_BUILD_WITH_JACK
+#include <array>
+#include <limits>
+
 #include <jack/midiport.h>
 
 #include "logging.h"
@@ -115,6 +118,19 @@ AudioFrontendStatus JackFrontend::setup_client(const std::string& client_name,
         SUSHI_LOG_ERROR("Failed to set latency callback function, error: {}.", ret);
         return AudioFrontendStatus::AUDIO_HW_ERROR;
     }
+    ret = jack_set_xrun_callback(_client, xrun_callback, this);
+    if (ret != 0)
+    {
+        SUSHI_LOG_ERROR("Failed to set xrun callback function, error: {}.", ret);
+        return AudioFrontendStatus::AUDIO_HW_ERROR;
+    }
+    ret = jack_set_buffer_size_callback(_client, buffer_size_callback, this);
+    if (ret != 0)
+    {
+        SUSHI_LOG_ERROR("Failed to set buffer size callback function, error: {}.", ret);
+        return AudioFrontendStatus::AUDIO_HW_ERROR;
+    }
+    internal_buffer_size_callback(jack_get_buffer_size(_client));
     auto status = setup_sample_rate();
     if (status != AudioFrontendStatus::OK)
     {
@@ -269,9 +285,10 @@ AudioFrontendStatus JackFrontend::connect_ports()
 int JackFrontend::internal_process_callback(jack_nframes_t framecount)
 {
     set_flush_denormals_to_zero();
-    if (framecount < 64 || framecount % 64)
+    bool reblock = framecount % AUDIO_CHUNK_SIZE != 0;
+    if (reblock && framecount != _buffer_size)
     {
-        SUSHI_LOG_CRITICAL("Chunk size not a multiple of AUDIO_CHUNK_SIZE. Skipping.");
+        SUSHI_LOG_CRITICAL("Period size changed to {} without notification. Skipping.", framecount);
         return 0;
     }
     jack_nframes_t 	current_frames{0};
@@ -286,8 +303,13 @@ int JackFrontend::internal_process_callback(jack_nframes_t framecount)
     {
         _start_frame = current_frames;
     }
-    /* Process in chunks of AUDIO_CHUNK_SIZE */
     Time start_time = std::chrono::microseconds(current_usecs);
+    if (reblock)
+    {
+        process_reblocked(framecount, start_time, current_frames - _start_frame);
+        return 0;
+    }
+    /* Process in chunks of AUDIO_CHUNK_SIZE */
     for (jack_nframes_t frame = 0; frame < framecount; frame += AUDIO_CHUNK_SIZE)
     {
         Time delta_time = std::chrono::microseconds((frame * 1'000'000) / _sample_rate);
@@ -311,6 +333,26 @@ int JackFrontend::internal_samplerate_callback(jack_nframes_t sample_rate)
     return 0;
 }
 
+int JackFrontend::internal_buffer_size_callback(jack_nframes_t buffer_size)
+{
+    /* Jack doesn't run the process callback while this is called, so it's safe
+     * to reallocate the adapter. Jack recalculates latencies after a period change,
+     * which brings the new added latency to internal_latency_callback() */
+    _buffer_size = buffer_size;
+    if (buffer_size % AUDIO_CHUNK_SIZE != 0)
+    {
+        _reblocker.configure(MAX_FRONTEND_CHANNELS + _no_cv_input_ports, MAX_FRONTEND_CHANNELS + _no_cv_output_ports, buffer_size);
+        SUSHI_LOG_INFO("Jack period of {} samples is not a multiple of {}, re-blocking with {} samples of added latency",
+                       buffer_size, AUDIO_CHUNK_SIZE, _reblocker.latency());
+    }
+    return 0;
+}
+
+int JackFrontend::added_latency() const
+{
+    return _buffer_size % AUDIO_CHUNK_SIZE != 0 ? _reblocker.latency() : 0;
+}
+
 void JackFrontend::internal_latency_callback(jack_latency_callback_mode_t mode)
 {
     /* Currently all we want to know is the output latency to a physical
@@ -321,42 +363,153 @@ void JackFrontend::internal_latency_callback(jack_latency_callback_mode_t mode)
     {
         int sample_latency = 0;
         jack_latency_range_t range;
+        jack_latency_range_t total_range{std::numeric_limits<jack_nframes_t>::max(), 0};
         for (auto& port : _output_ports)
         {
             jack_port_get_latency_range(port, JackPlaybackLatency, &range);
             sample_latency = std::max(sample_latency, static_cast<int>(range.max));
+            total_range.min = std::min(total_range.min, range.min);
+            total_range.max = std::max(total_range.max, range.max);
+        }
+        /* Audio entering the inputs is played that much later, including re-blocking */
+        sample_latency += added_latency();
+        total_range.min += added_latency();
+        total_range.max += added_latency();
+        for (auto& port : _input_ports)
+        {
+            jack_port_set_latency_range(port, JackPlaybackLatency, &total_range);
         }
         Time latency = std::chrono::microseconds((sample_latency * 1'000'000) / _sample_rate);
         _engine->set_output_latency(latency);
         SUSHI_LOG_INFO("Updated output latency: {} samples, {} ms", sample_latency, latency.count() / 1000.0f);
     }
+    else if (mode == JackCaptureLatency)
+    {
+        jack_latency_range_t range;
+        jack_latency_range_t total_range{std::numeric_limits<jack_nframes_t>::max(), 0};
+        for (auto& port : _input_ports)
+        {
+            jack_port_get_latency_range(port, JackCaptureLatency, &range);
+            total_range.min = std::min(total_range.min, range.min);
+            total_range.max = std::max(total_range.max, range.max);
+        }
+        total_range.min += added_latency();
+        total_range.max += added_latency();
+        for (auto& port : _output_ports)
+        {
+            jack_port_set_latency_range(port, JackCaptureLatency, &total_range);
+        }
+    }
+}
+
+int JackFrontend::internal_xrun_callback()
+{
+    /* Called from Jack's notification thread, the xrun is attributed to the next
+     * chunk processed by the engine */
+    auto xrun_monitor = _engine->xrun_monitor();
+    if (xrun_monitor)
+    {
+        xrun_monitor->report_frontend_xrun();
+    }
+    return 0;
 }
 
 void inline JackFrontend::process_audio(jack_nframes_t start_frame, jack_nframes_t framecount, Time timestamp, int64_t samplecount)
 {
-    /* Copy jack buffer data to internal buffers */
+    /* Port buffers hold one channel each, so every AUDIO_CHUNK_SIZE slice of them can be
+     * wrapped and passed to the engine without copying */
     for (size_t i = 0; i < _input_ports.size(); ++i)
     {
         float* in_data = static_cast<float*>(jack_port_get_buffer(_input_ports[i], framecount)) + start_frame;
-        std::copy(in_data, in_data + AUDIO_CHUNK_SIZE, _in_buffer.channel(i));
+        _in_channels[i] = ChunkSampleBuffer::create_from_raw_pointer(in_data, 0, 1);
+    }
+    for (size_t i = 0; i < _output_ports.size(); ++i)
+    {
+        float* out_data = static_cast<float*>(jack_port_get_buffer(_output_ports[i], framecount)) + start_frame;
+        _out_channels[i] = ChunkSampleBuffer::create_from_raw_pointer(out_data, 0, 1);
     }
     for (int i = 0; i < _no_cv_input_ports; ++i)
     {
         float* in_data = static_cast<float*>(jack_port_get_buffer(_cv_input_ports[i], framecount)) + start_frame;
-        _in_controls.cv_values[i] = map_audio_to_cv(in_data[AUDIO_CHUNK_SIZE - 1]);
+        read_cv_input(in_data, i);
+    }
+    _engine->process_chunk(&_in_channels, &_out_channels, &_in_controls, &_out_controls, timestamp, samplecount);
+    for (int i = 0; i < _no_cv_output_ports; ++i)
+    {
+        float* out_data = static_cast<float*>(jack_port_get_buffer(_cv_output_ports[i], framecount)) + start_frame;
+        write_cv_output(out_data, i);
     }
-    _out_buffer.clear();
-    _engine->process_chunk(&_in_buffer, &_out_buffer, &_in_controls, &_out_controls, timestamp, samplecount);
+}
+
+void JackFrontend::process_reblocked(jack_nframes_t framecount, Time timestamp, int64_t samplecount)
+{
+    /* Cv ports are re-blocked together with the audio ports, after them */
+    std::array<const float*, MAX_FRONTEND_CHANNELS + MAX_ENGINE_CV_IO_PORTS> in_data;
+    std::array<float*, MAX_FRONTEND_CHANNELS + MAX_ENGINE_CV_IO_PORTS> out_data;
     for (size_t i = 0; i < _input_ports.size(); ++i)
     {
-        float* out_data = static_cast<float*>(jack_port_get_buffer(_output_ports[i], framecount)) + start_frame;
-        std::copy(_out_buffer.channel(i), _out_buffer.channel(i) + AUDIO_CHUNK_SIZE, out_data);
+        in_data[i] = static_cast<float*>(jack_port_get_buffer(_input_ports[i], framecount));
+    }
+    for (size_t i = 0; i < _output_ports.size(); ++i)
+    {
+        out_data[i] = static_cast<float*>(jack_port_get_buffer(_output_ports[i], framecount));
+    }
+    for (int i = 0; i < _no_cv_input_ports; ++i)
+    {
+        in_data[MAX_FRONTEND_CHANNELS + i] = static_cast<float*>(jack_port_get_buffer(_cv_input_ports[i], framecount));
     }
-    /* The jack frontend both inputs and outputs cv in audio range [-1, 1] */
     for (int i = 0; i < _no_cv_output_ports; ++i)
     {
-        float* out_data = static_cast<float*>(jack_port_get_buffer(_cv_output_ports[i], framecount)) + start_frame;
-        _cv_output_hist[i] = ramp_cv_output(out_data, _cv_output_hist[i], map_cv_to_audio(_out_controls.cv_values[i]));
+        out_data[MAX_FRONTEND_CHANNELS + i] = static_cast<float*>(jack_port_get_buffer(_cv_output_ports[i], framecount));
+    }
+    _reblocker.process(in_data.data(), out_data.data(), [&](engine::ChunkChannelBuffers* in_channels,
+                                                            engine::ChunkChannelBuffers* out_channels,
+                                                            int offset)
+    {
+        for (int i = 0; i < _no_cv_input_ports; ++i)
+        {
+            read_cv_input((*in_channels)[MAX_FRONTEND_CHANNELS + i].channel(0), i);
+        }
+        /* The engine only gets the audio channels */
+        for (int c = 0; c < MAX_FRONTEND_CHANNELS; ++c)
+        {
+            _in_channels[c] = ChunkSampleBuffer::create_from_raw_pointer((*in_channels)[c].channel(0), 0, 1);
+            _out_channels[c] = ChunkSampleBuffer::create_from_raw_pointer((*out_channels)[c].channel(0), 0, 1);
+        }
+        Time delta_time = std::chrono::microseconds((offset * int64_t(1'000'000)) / _sample_rate);
+        _engine->process_chunk(&_in_channels, &_out_channels, &_in_controls, &_out_controls, timestamp + delta_time, samplecount + offset);
+        for (int i = 0; i < _no_cv_output_ports; ++i)
+        {
+            write_cv_output((*out_channels)[MAX_FRONTEND_CHANNELS + i].channel(0), i);
+        }
+    });
+}
+
+/* The jack frontend both inputs and outputs cv in audio range [-1, 1] */
+void JackFrontend::read_cv_input(const float* in_data, int port)
+{
+    float* cv_data = _in_controls.cv_buffers.channel(port);
+    for (int s = 0; s < AUDIO_CHUNK_SIZE; ++s)
+    {
+        cv_data[s] = map_audio_to_cv(in_data[s]);
+    }
+    _in_controls.cv_values[port] = cv_data[AUDIO_CHUNK_SIZE - 1];
+}
+
+void JackFrontend::write_cv_output(float* out_data, int port)
+{
+    if (_out_controls.audio_rate_cv[port])
+    {
+        const float* cv_data = _out_controls.cv_buffers.channel(port);
+        for (int s = 0; s < AUDIO_CHUNK_SIZE; ++s)
+        {
+            out_data[s] = map_cv_to_audio(cv_data[s]);
+        }
+        _cv_output_hist[port] = out_data[AUDIO_CHUNK_SIZE - 1];
+    }
+    else
+    {
+        _cv_output_hist[port] = ramp_cv_output(out_data, _cv_output_hist[port], map_cv_to_audio(_out_controls.cv_values[port]));
     }
 }
 
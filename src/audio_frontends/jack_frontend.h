@@ -28,6 +28,7 @@
 #include <jack/jack.h>
 
 #include "base_audio_frontend.h"
+#include "reblocking_adapter.h"
 
 namespace sushi {
 namespace audio_frontend {
@@ -85,11 +86,32 @@ public:
         return static_cast<JackFrontend*>(arg)->internal_samplerate_callback(nframes);
     }
 
+    /**
+     * @brief Callback for changes of the period size
+     * @param nframes New number of frames per period
+     * @param arg Pointer to the JackFrontend instance.
+     * @return
+     */
+    static int buffer_size_callback(jack_nframes_t nframes, void *arg)
+    {
+        return static_cast<JackFrontend*>(arg)->internal_buffer_size_callback(nframes);
+    }
+
     static void latency_callback(jack_latency_callback_mode_t mode, void *arg)
     {
         return static_cast<JackFrontend*>(arg)->internal_latency_callback(mode);
     }
 
+    /**
+     * @brief Callback for xruns reported by Jack
+     * @param arg Pointer to the JackFrontend instance.
+     * @return
+     */
+    static int xrun_callback(void *arg)
+    {
+        return static_cast<JackFrontend*>(arg)->internal_xrun_callback();
+    }
+
     /**
      * @brief Initialize the frontend and setup Jack client.
      * @param config Configuration struct
@@ -119,10 +141,22 @@ private:
     /* Internal process callback function */
     int internal_process_callback(jack_nframes_t framecount);
     int internal_samplerate_callback(jack_nframes_t sample_rate);
+    int internal_buffer_size_callback(jack_nframes_t buffer_size);
     void internal_latency_callback(jack_latency_callback_mode_t mode);
+    int internal_xrun_callback();
 
     void process_audio(jack_nframes_t start_frame, jack_nframes_t framecount, Time timestamp, int64_t samplecount);
 
+    /* For periods that are not a multiple of AUDIO_CHUNK_SIZE */
+    void process_reblocked(jack_nframes_t framecount, Time timestamp, int64_t samplecount);
+
+    /* Convert one chunk of a cv port to and from the engine's control buffers */
+    void read_cv_input(const float* in_data, int port);
+    void write_cv_output(float* out_data, int port);
+
+    /* Samples of latency added by sushi on top of the jack period */
+    int added_latency() const;
+
     std::array<jack_port_t*, MAX_FRONTEND_CHANNELS> _input_ports;
     std::array<jack_port_t*, MAX_FRONTEND_CHANNELS> _output_ports;
     std::array<jack_port_t*, MAX_ENGINE_CV_IO_PORTS> _cv_input_ports;
@@ -133,13 +167,17 @@ private:
 
     jack_client_t* _client{nullptr};
     jack_nframes_t _sample_rate;
+    jack_nframes_t _buffer_size{0};
     jack_nframes_t _start_frame{0};
     bool _autoconnect_ports{false};
 
-    SampleBuffer<AUDIO_CHUNK_SIZE> _in_buffer{MAX_FRONTEND_CHANNELS};
-    SampleBuffer<AUDIO_CHUNK_SIZE> _out_buffer{MAX_FRONTEND_CHANNELS};
+    /* Non-owning wrappers of the jack port buffers, the engine processes them in place */
+    engine::ChunkChannelBuffers    _in_channels{MAX_FRONTEND_CHANNELS};
+    engine::ChunkChannelBuffers    _out_channels{MAX_FRONTEND_CHANNELS};
     engine::ControlBuffer          _in_controls;
     engine::ControlBuffer          _out_controls;
+
+    ReblockingAdapter              _reblocker;
 };
 
 }; // end namespace jack_frontend
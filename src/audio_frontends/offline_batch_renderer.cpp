@@ -0,0 +1,381 @@
+/*
+ * Copyright 2017-2021 Modern Ancient Instruments Networked AB, dba Elk
+ *
+ * SUSHI is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU Affero General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * SUSHI is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along with
+ * SUSHI.  If not, see http://www.gnu.org/licenses/
+ */
+
+/**
+ * @brief Offline rendering of many files in parallel with independent engine instances
+ * @copyright 2017-2021 Modern Ancient Instruments Networked AB, dba Elk, Stockholm
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <set>
+
+#include <glob.h>
+#include <sndfile.h>
+
+#include "logging.h"
+#include "offline_batch_renderer.h"
+#include "offline_frontend.h"
+
+namespace sushi {
+namespace audio_frontend {
+
+SUSHI_GET_LOGGER_WITH_MODULE_NAME("offline batch");
+
+std::vector<std::string> list_input_files(const std::string& source)
+{
+    std::vector<std::string> files;
+    if (source.find_first_of("*?[") != std::string::npos)
+    {
+        glob_t glob_result;
+        memset(&glob_result, 0, sizeof(glob_result));
+        if (glob(source.c_str(), 0, nullptr, &glob_result) == 0)
+        {
+            for (size_t i = 0; i < glob_result.gl_pathc; ++i)
+            {
+                files.emplace_back(glob_result.gl_pathv[i]);
+            }
+        }
+        globfree(&glob_result);
+        return files;
+    }
+
+    std::ifstream file_list(source);
+    if (!file_list.good())
+    {
+        SUSHI_LOG_ERROR("Unable to open file list {}", source);
+        return files;
+    }
+    std::string line;
+    while (std::getline(file_list, line))
+    {
+        line.erase(line.find_last_not_of(" \t\r") + 1);
+        if (line.empty() == false && line.front() != '#')
+        {
+            files.push_back(line);
+        }
+    }
+    return files;
+}
+
+std::pair<BatchRendererStatus, std::vector<BatchJob>> create_batch_jobs(const std::string& source,
+                                                                        const std::string& output_dir)
+{
+    std::vector<BatchJob> jobs;
+    std::set<std::string> output_files;
+    for (const auto& input_file : list_input_files(source))
+    {
+        std::string output_file;
+        if (output_dir.empty())
+        {
+            output_file = input_file + "_proc.wav";
+        }
+        else
+        {
+            auto name_start = input_file.find_last_of('/');
+            auto name = name_start == std::string::npos ? input_file : input_file.substr(name_start + 1);
+            output_file = output_dir.back() == '/' ? output_dir + name : output_dir + "/" + name;
+        }
+        if (output_files.insert(output_file).second == false)
+        {
+            SUSHI_LOG_ERROR("More than one input file would be rendered to {}", output_file);
+            return {BatchRendererStatus::DUPLICATE_OUTPUT_FILE, {}};
+        }
+        jobs.push_back({{input_file}, output_file});
+    }
+    if (jobs.empty())
+    {
+        return {BatchRendererStatus::NO_INPUT_FILES, {}};
+    }
+    return {BatchRendererStatus::OK, std::move(jobs)};
+}
+
+OfflineBatchRenderer::OfflineBatchRenderer(const std::string& config_filename,
+                                           float sample_rate,
+                                           int workers,
+                                           bool output_stems) : _config_filename(config_filename),
+                                                                _sample_rate(sample_rate),
+                                                                _worker_count(std::max(workers, 1)),
+                                                                _output_stems(output_stems)
+{}
+
+OfflineBatchRenderer::~OfflineBatchRenderer()
+{
+    for (auto& worker : _workers)
+    {
+        if (worker.joinable())
+        {
+            worker.join();
+        }
+    }
+    if (_config_engine.engine)
+    {
+        _config_engine.engine->event_dispatcher()->stop();
+    }
+}
+
+BatchRendererStatus OfflineBatchRenderer::init(std::vector<BatchJob> jobs)
+{
+    _jobs = std::move(jobs);
+    _worker_count = std::min(_worker_count, static_cast<int>(std::max(_jobs.size(), size_t(1))));
+
+    /* The configuration is only read and parsed once, other engines copy it */
+    _config_engine = _create_engine();
+    auto [status, audio_config] = _config_engine.configurator->load_audio_config();
+    if (status != jsonconfig::JsonConfigReturnStatus::OK)
+    {
+        SUSHI_LOG_ERROR("Failed to read configuration {}", _config_filename);
+        return BatchRendererStatus::INVALID_CONFIGURATION;
+    }
+    _audio_config = audio_config;
+    _cv_inputs = audio_config.cv_inputs.value_or(0);
+    _cv_outputs = audio_config.cv_outputs.value_or(0);
+
+    /* All engines need the same channel count, so the output
+     * files of all jobs have the same layout */
+    int file_channels = 0;
+    if (_jobs.empty() == false)
+    {
+        for (const auto& filename : _jobs.front().input_filenames)
+        {
+            SF_INFO info;
+            memset(&info, 0, sizeof(info));
+            SNDFILE* file = sf_open(filename.c_str(), SFM_READ, &info);
+            if (file == nullptr)
+            {
+                SUSHI_LOG_ERROR("Unable to open input file {}", filename);
+                return BatchRendererStatus::INVALID_INPUT_FILE;
+            }
+            file_channels += info.channels;
+            sf_close(file);
+        }
+    }
+    _audio_inputs = audio_config.audio_inputs.value_or(std::max(OFFLINE_FRONTEND_CHANNELS, file_channels));
+    _audio_outputs = audio_config.audio_outputs.value_or(_audio_inputs);
+
+    /* Set up one engine here so configuration errors are found before rendering */
+    auto setup_status = _setup_engine(_config_engine);
+    if (setup_status != BatchRendererStatus::OK)
+    {
+        return setup_status;
+    }
+    SUSHI_LOG_INFO("Rendering {} files with {} workers, {} inputs and {} outputs",
+                   _jobs.size(), _worker_count, _audio_inputs, _audio_outputs);
+    return BatchRendererStatus::OK;
+}
+
+int OfflineBatchRenderer::run()
+{
+    _next_job = 0;
+    _failed_jobs = 0;
+    for (int i = 0; i < _worker_count; ++i)
+    {
+        _workers.emplace_back(&OfflineBatchRenderer::_worker_loop, this);
+    }
+    for (auto& worker : _workers)
+    {
+        worker.join();
+    }
+    _workers.clear();
+    return _failed_jobs;
+}
+
+OfflineBatchRenderer::EngineInstance OfflineBatchRenderer::_create_engine()
+{
+    EngineInstance instance;
+    instance.engine = std::make_unique<engine::AudioEngine>(_sample_rate);
+    instance.midi_dispatcher = std::make_unique<midi_dispatcher::MidiDispatcher>(instance.engine->event_dispatcher(),
+                                                                                 instance.engine->metrics());
+    instance.configurator = std::make_unique<jsonconfig::JsonConfigurator>(instance.engine.get(),
+                                                                           instance.midi_dispatcher.get(),
+                                                                           instance.engine->processor_container(),
+                                                                           _config_filename);
+    return instance;
+}
+
+BatchRendererStatus OfflineBatchRenderer::_setup_engine(EngineInstance& instance)
+{
+    auto& engine = instance.engine;
+    engine->set_audio_input_channels(_audio_inputs);
+    engine->set_audio_output_channels(_audio_outputs);
+    if (engine->set_cv_input_channels(_cv_inputs) != engine::EngineReturnStatus::OK ||
+        engine->set_cv_output_channels(_cv_outputs) != engine::EngineReturnStatus::OK)
+    {
+        SUSHI_LOG_ERROR("Setting {} cv inputs and {} cv outputs failed", _cv_inputs, _cv_outputs);
+        return BatchRendererStatus::INVALID_CONFIGURATION;
+    }
+
+    instance.midi_dispatcher->set_midi_inputs(_audio_config.midi_inputs.value_or(1));
+    instance.midi_dispatcher->set_midi_outputs(_audio_config.midi_outputs.value_or(1));
+    instance.midi_frontend = std::make_unique<midi_frontend::NullMidiFrontend>(instance.midi_dispatcher.get());
+    instance.midi_dispatcher->set_frontend(instance.midi_frontend.get());
+
+    auto& configurator = instance.configurator;
+    auto status = configurator->load_host_config();
+    if (status == jsonconfig::JsonConfigReturnStatus::OK)
+    {
+        status = configurator->load_tracks();
+    }
+    if (status == jsonconfig::JsonConfigReturnStatus::OK)
+    {
+        status = configurator->load_midi();
+        if (status == jsonconfig::JsonConfigReturnStatus::NO_MIDI_DEFINITIONS)
+        {
+            status = jsonconfig::JsonConfigReturnStatus::OK;
+        }
+    }
+    if (status == jsonconfig::JsonConfigReturnStatus::OK)
+    {
+        status = configurator->load_cv_gate();
+        if (status == jsonconfig::JsonConfigReturnStatus::NO_CV_GATE_DEFINITIONS)
+        {
+            status = jsonconfig::JsonConfigReturnStatus::OK;
+        }
+    }
+    if (status != jsonconfig::JsonConfigReturnStatus::OK)
+    {
+        SUSHI_LOG_ERROR("Failed to load configuration {}", _config_filename);
+        return BatchRendererStatus::INVALID_CONFIGURATION;
+    }
+    engine->event_dispatcher()->run();
+    return BatchRendererStatus::OK;
+}
+
+void OfflineBatchRenderer::_store_engine_state(EngineInstance& instance)
+{
+    instance.parameters.clear();
+    instance.bypass_states.clear();
+    for (const auto& processor : instance.engine->processor_container()->all_processors())
+    {
+        instance.bypass_states.emplace_back(processor->id(), processor->bypassed());
+        for (const auto& parameter : processor->all_parameters())
+        {
+            auto type = parameter->type();
+            if (type != ParameterType::FLOAT && type != ParameterType::INT && type != ParameterType::BOOL)
+            {
+                continue;
+            }
+            auto [status, value] = processor->parameter_value(parameter->id());
+            if (status == ProcessorReturnCode::OK)
+            {
+                instance.parameters.push_back({processor->id(), parameter->id(), value});
+            }
+        }
+    }
+}
+
+void OfflineBatchRenderer::_reset_engine(EngineInstance& instance)
+{
+    auto& engine = instance.engine;
+    /* Reconfiguring all processors with the same sample rate clears filter tails,
+     * voices and other audio state without reloading any plugins */
+    engine->set_sample_rate(engine->sample_rate());
+
+    auto processors = engine->processor_container();
+    for (const auto& [id, bypassed] : instance.bypass_states)
+    {
+        auto processor = processors->mutable_processor(id);
+        if (processor)
+        {
+            processor->set_bypassed(bypassed);
+        }
+    }
+    /* The engine is not running between jobs, so events can be passed directly */
+    for (const auto& parameter : instance.parameters)
+    {
+        auto processor = processors->mutable_processor(parameter.processor);
+        if (processor)
+        {
+            processor->process_event(RtEvent::make_parameter_change_event(parameter.processor, 0,
+                                                                          parameter.parameter, parameter.value));
+        }
+    }
+}
+
+void OfflineBatchRenderer::_worker_loop()
+{
+    auto instance = _create_engine();
+    instance.configurator->copy_configuration(*_config_engine.configurator);
+    bool engine_ready = _setup_engine(instance) == BatchRendererStatus::OK;
+    SUSHI_LOG_ERROR_IF(engine_ready == false, "Failed to set up a worker engine");
+    if (engine_ready)
+    {
+        _store_engine_state(instance);
+    }
+
+    bool first_job = true;
+    while (true)
+    {
+        size_t job = _next_job.fetch_add(1);
+        if (job >= _jobs.size())
+        {
+            break;
+        }
+        if (engine_ready == false)
+        {
+            SUSHI_LOG_ERROR("Failed to render {}", _jobs[job].output_filename);
+            _failed_jobs++;
+            continue;
+        }
+        if (first_job == false)
+        {
+            _reset_engine(instance);
+        }
+        first_job = false;
+        if (_render_job(instance, _jobs[job]) == false)
+        {
+            _failed_jobs++;
+        }
+    }
+    instance.engine->event_dispatcher()->stop();
+}
+
+bool OfflineBatchRenderer::_render_job(EngineInstance& instance, const BatchJob& job)
+{
+    OfflineFrontendConfiguration config(job.input_filenames,
+                                        job.output_filename,
+                                        false,
+                                        _cv_inputs,
+                                        _cv_outputs,
+                                        _audio_inputs,
+                                        _audio_outputs,
+                                        _output_stems);
+    bool rendered = false;
+    {
+        OfflineFrontend frontend(instance.engine.get());
+        if (frontend.init(&config) == AudioFrontendStatus::OK)
+        {
+            auto [status, events] = instance.configurator->load_event_list();
+            if (status == jsonconfig::JsonConfigReturnStatus::OK)
+            {
+                frontend.add_sequencer_events(events);
+            }
+            frontend.run();
+            frontend.cleanup();
+            rendered = true;
+        }
+    }
+    if (rendered == false)
+    {
+        SUSHI_LOG_ERROR("Failed to render {}", job.output_filename);
+        return false;
+    }
+    SUSHI_LOG_INFO("Rendered {}", job.output_filename);
+    return true;
+}
+
+} // end namespace audio_frontend
+} // end namespace sushi
@@ -0,0 +1,164 @@
+/*
+ * Copyright 2017-2021 Modern Ancient Instruments Networked AB, dba Elk
+ *
+ * SUSHI is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU Affero General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * SUSHI is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along with
+ * SUSHI.  If not, see http://www.gnu.org/licenses/
+ */
+
+/**
+ * @brief Offline rendering of many files in parallel with independent engine instances
+ * @copyright 2017-2021 Modern Ancient Instruments Networked AB, dba Elk, Stockholm
+ */
+
+#ifndef SUSHI_OFFLINE_BATCH_RENDERER_H
+#define SUSHI_OFFLINE_BATCH_RENDERER_H
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "engine/audio_engine.h"
+#include "engine/midi_dispatcher.h"
+#include "engine/json_configurator.h"
+#include "control_frontends/base_midi_frontend.h"
+
+namespace sushi {
+namespace audio_frontend {
+
+/**
+ * @brief Input files to render, mapped to consecutive engine inputs, and the
+ *        output file to render them to
+ */
+struct BatchJob
+{
+    std::vector<std::string> input_filenames;
+    std::string output_filename;
+};
+
+enum class BatchRendererStatus
+{
+    OK,
+    NO_INPUT_FILES,
+    DUPLICATE_OUTPUT_FILE,
+    INVALID_CONFIGURATION,
+    INVALID_INPUT_FILE
+};
+
+/**
+ * @brief Create a job per input file from either a glob pattern or a text file
+ *        listing one input file per line. Empty lines and lines starting with
+ *        '#' in the list are ignored.
+ * @param source A glob pattern or the path of a file list
+ * @param output_dir Directory to write output files to, with the same name as the
+ *        input file. If empty, "_proc.wav" is appended to the input file name.
+ * @return BatchRendererStatus::OK and a list of jobs, NO_INPUT_FILES if no files were
+ *         found or DUPLICATE_OUTPUT_FILE if two jobs would write to the same output
+ *         file, i.e. input files with the same name rendered to one output_dir.
+ */
+std::pair<BatchRendererStatus, std::vector<BatchJob>> create_batch_jobs(const std::string& source,
+                                                                        const std::string& output_dir);
+
+/**
+ * @brief Renders a list of jobs through the same configuration as fast as possible.
+ *        Worker threads take jobs from a shared queue until all jobs are done. Every
+ *        worker sets up one engine from the configuration parsed once in init(), so
+ *        plugins are only loaded once per worker. Between jobs the engine is reset:
+ *        all processors are reconfigured, which clears their audio state, and their
+ *        parameter values and bypass states are restored to the configured ones.
+ *
+ *        All engines have the same number of channels, taken from the configuration
+ *        or from the input files of the first job.
+ */
+class OfflineBatchRenderer
+{
+public:
+    SUSHI_DECLARE_NON_COPYABLE(OfflineBatchRenderer);
+
+    /**
+     * @param config_filename The json configuration to render with
+     * @param sample_rate Initial engine sample rate, until set from the configuration
+     * @param workers The number of worker threads rendering jobs in parallel
+     * @param output_stems Write one file per stereo output bus instead of a single output file
+     */
+    OfflineBatchRenderer(const std::string& config_filename, float sample_rate, int workers, bool output_stems);
+
+    ~OfflineBatchRenderer();
+
+    /**
+     * @brief Read the configuration and check that an engine can be set up from it
+     * @param jobs The jobs to render
+     * @return BatchRendererStatus::OK if successful, an error code otherwise
+     */
+    BatchRendererStatus init(std::vector<BatchJob> jobs);
+
+    /**
+     * @brief Render all jobs. Blocks until done.
+     * @return The number of jobs that failed
+     */
+    int run();
+
+private:
+    struct ParameterState
+    {
+        ObjectId processor;
+        ObjectId parameter;
+        float value;
+    };
+
+    struct EngineInstance
+    {
+        std::unique_ptr<engine::AudioEngine> engine;
+        std::unique_ptr<midi_dispatcher::MidiDispatcher> midi_dispatcher;
+        std::unique_ptr<midi_frontend::NullMidiFrontend> midi_frontend;
+        std::unique_ptr<jsonconfig::JsonConfigurator> configurator;
+        /* The configured state, restored between jobs */
+        std::vector<ParameterState> parameters;
+        std::vector<std::pair<ObjectId, bool>> bypass_states;
+    };
+
+    EngineInstance _create_engine();
+
+    BatchRendererStatus _setup_engine(EngineInstance& instance);
+
+    void _store_engine_state(EngineInstance& instance);
+
+    void _reset_engine(EngineInstance& instance);
+
+    void _worker_loop();
+
+    bool _render_job(EngineInstance& instance, const BatchJob& job);
+
+    std::string _config_filename;
+    float _sample_rate;
+    int _worker_count;
+    bool _output_stems;
+
+    jsonconfig::AudioConfig _audio_config;
+    int _audio_inputs{0};
+    int _audio_outputs{0};
+    int _cv_inputs{0};
+    int _cv_outputs{0};
+
+    /* Reads and validates the configuration, which all other engines copy */
+    EngineInstance _config_engine;
+    std::vector<std::thread> _workers;
+    std::vector<BatchJob> _jobs;
+    std::atomic<size_t> _next_job{0};
+    std::atomic<int> _failed_jobs{0};
+};
+
+} // end namespace audio_frontend
+} // end namespace sushi
+
+#endif //SUSHI_OFFLINE_BATCH_RENDERER_H
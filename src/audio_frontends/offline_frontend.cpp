@@ -18,6 +18,8 @@
 * @copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk, Stockholm
 */
 
+#include <algorithm>
+#include <cassert>
 #include <cmath>
 #include <cstring>
 #include <random>
@@ -33,6 +35,9 @@ SUSHI_GET_LOGGER_WITH_MODULE_NAME("offline audio");
 
 constexpr float INPUT_NOISE_LEVEL = powf(10, (-24.0f/20.0f)); // -24 dB input noise
 constexpr int   NOISE_SEED = 5; // Using a constant seed makes potential errors reproducible
+/* Benchmarks run faster than realtime, so timings are collected far more often than
+ * the timer does by itself to keep its queues from filling up */
+constexpr int   BENCHMARK_COLLECT_INTERVAL = 32; // In chunks
 
 template<class random_device, class random_dist>
 void fill_buffer_with_noise(ChunkSampleBuffer& buffer, random_device& dev, random_dist& dist)
@@ -50,9 +55,14 @@ void fill_buffer_with_noise(ChunkSampleBuffer& buffer, random_device& dev, rando
 template<class random_device, class random_dist>
 void fill_cv_buffer_with_noise(engine::ControlBuffer& buffer, random_device& dev, random_dist& dist)
 {
-    for (auto& cv : buffer.cv_values)
+    for (int c = 0; c < buffer.cv_buffers.channel_count(); ++c)
     {
-        cv = map_audio_to_cv(dist(dev));
+        float* cv = buffer.cv_buffers.channel(c);
+        for (int i = 0; i < AUDIO_CHUNK_SIZE; ++i)
+        {
+            cv[i] = map_audio_to_cv(dist(dev));
+        }
+        buffer.cv_values[c] = cv[AUDIO_CHUNK_SIZE - 1];
     }
 }
 
@@ -69,32 +79,48 @@ AudioFrontendStatus OfflineFrontend::init(BaseAudioFrontendConfiguration* config
 
     if (_dummy_mode == false)
     {
-        // Open audio file and check channels / sample rate
-        memset(&_soundfile_info, 0, sizeof(_soundfile_info));
-        if (!(_input_file = sf_open(off_config->input_filename.c_str(), SFM_READ, &_soundfile_info)))
+        auto file_status = _open_input_files(off_config->input_filenames);
+        if (file_status != AudioFrontendStatus::OK)
         {
             cleanup();
-            SUSHI_LOG_ERROR("Unable to open input file {}", off_config->input_filename);
-            return AudioFrontendStatus::INVALID_INPUT_FILE;
+            return file_status;
         }
-        _mono = _soundfile_info.channels == 1;
-        auto sample_rate_file = _soundfile_info.samplerate;
-        if (sample_rate_file != _engine->sample_rate())
+        int file_channels = 0;
+        for (const auto& file : _input_files)
         {
-            SUSHI_LOG_WARNING("Sample rate mismatch between file ({}) and engine ({})",
-                              sample_rate_file,
-                              _engine->sample_rate());
+            file_channels += file.channels;
+        }
+        /* Unless configured, the engine gets at least a stereo pair and
+         * the output is written with as many channels as the input */
+        int inputs = std::max(OFFLINE_FRONTEND_CHANNELS, file_channels);
+        int outputs = inputs;
+        int output_file_channels = file_channels;
+        if (off_config->audio_inputs > 0)
+        {
+            inputs = off_config->audio_inputs;
+        }
+        if (off_config->audio_outputs > 0)
+        {
+            outputs = off_config->audio_outputs;
+            output_file_channels = off_config->audio_outputs;
+        }
+        if (file_channels > inputs)
+        {
+            SUSHI_LOG_WARNING("Input files have {} channels, only the first {} are used", file_channels, inputs);
         }
 
-        // Open output file with same format as input file
-        if (!(_output_file = sf_open(off_config->output_filename.c_str(), SFM_WRITE, &_soundfile_info)))
+        file_status = _open_output_files(off_config, output_file_channels);
+        if (file_status != AudioFrontendStatus::OK)
         {
             cleanup();
-            SUSHI_LOG_ERROR("Unable to open output file {}", off_config->output_filename);
-            return AudioFrontendStatus::INVALID_OUTPUT_FILE;
+            return file_status;
         }
-        _engine->set_audio_input_channels(OFFLINE_FRONTEND_CHANNELS);
-        _engine->set_audio_output_channels(OFFLINE_FRONTEND_CHANNELS);
+        _buffer = ChunkSampleBuffer(inputs);
+        _output_buffer = ChunkSampleBuffer(outputs);
+        _engine->set_audio_input_channels(inputs);
+        _engine->set_audio_output_channels(outputs);
+        SUSHI_LOG_INFO("Rendering {} input files to {} output files with {} inputs and {} outputs",
+                       _input_files.size(), _output_files.size(), inputs, outputs);
     }
     else
     {
@@ -119,14 +145,102 @@ AudioFrontendStatus OfflineFrontend::init(BaseAudioFrontendConfiguration* config
     return ret_code;
 }
 
+std::string stem_filename(const std::string& output_filename, int bus)
+{
+    auto extension = output_filename.find_last_of('.');
+    auto directory = output_filename.find_last_of('/');
+    if (extension == std::string::npos || (directory != std::string::npos && extension < directory))
+    {
+        extension = output_filename.size();
+    }
+    return output_filename.substr(0, extension) + "_bus_" + std::to_string(bus) + output_filename.substr(extension);
+}
+
+AudioFrontendStatus OfflineFrontend::_open_input_files(const std::vector<std::string>& filenames)
+{
+    if (filenames.empty())
+    {
+        SUSHI_LOG_ERROR("No input file given");
+        return AudioFrontendStatus::INVALID_INPUT_FILE;
+    }
+    int engine_channel = 0;
+    for (const auto& filename : filenames)
+    {
+        SF_INFO info;
+        memset(&info, 0, sizeof(info));
+        SNDFILE* file = sf_open(filename.c_str(), SFM_READ, &info);
+        if (file == nullptr)
+        {
+            SUSHI_LOG_ERROR("Unable to open input file {}", filename);
+            return AudioFrontendStatus::INVALID_INPUT_FILE;
+        }
+        if (info.samplerate != _engine->sample_rate())
+        {
+            SUSHI_LOG_WARNING("Sample rate mismatch between file {} ({}) and engine ({})",
+                              filename,
+                              info.samplerate,
+                              _engine->sample_rate());
+        }
+        if (_input_files.empty())
+        {
+            /* Output files are written in the same format as the first input file */
+            _soundfile_info = info;
+        }
+        _input_files.push_back({file, info.channels, engine_channel});
+        engine_channel += info.channels;
+    }
+    return AudioFrontendStatus::OK;
+}
+
+AudioFrontendStatus OfflineFrontend::_open_output_files(const OfflineFrontendConfiguration* config, int channels)
+{
+    std::vector<std::pair<std::string, AudioFileMapping>> outputs;
+    if (config->output_stems)
+    {
+        for (int c = 0; c < channels; c += 2)
+        {
+            outputs.push_back({stem_filename(config->output_filename, c / 2), {nullptr, std::min(2, channels - c), c}});
+        }
+    }
+    else
+    {
+        outputs.push_back({config->output_filename, {nullptr, channels, 0}});
+    }
+
+    for (auto& [filename, mapping] : outputs)
+    {
+        SF_INFO info = _soundfile_info;
+        info.channels = mapping.channels;
+        if (!(mapping.file = sf_open(filename.c_str(), SFM_WRITE, &info)))
+        {
+            SUSHI_LOG_ERROR("Unable to open output file {} with {} channels: {}", filename, mapping.channels, sf_strerror(nullptr));
+            return AudioFrontendStatus::INVALID_OUTPUT_FILE;
+        }
+        _output_files.push_back(mapping);
+    }
+    return AudioFrontendStatus::OK;
+}
+
 void OfflineFrontend::add_sequencer_events(std::vector<Event*> events)
 {
-    // Sort events by reverse time
-    std::sort(events.begin(), events.end(), [](const Event* lhs, const Event* rhs)
-                                              {
-                                                  return lhs->time() >= rhs->time();
-                                              });
-    _event_queue = std::move(events);
+    /* Events are converted up front, so that playback needs no conversions
+     * or allocations, and placed on sample positions using integer math only */
+    auto sample_rate = std::lround(_engine->sample_rate());
+    _timeline.clear();
+    _timeline.reserve(events.size());
+    _next_timeline_event = 0;
+    for (auto event : events)
+    {
+        if (event->maps_to_rt_event())
+        {
+            _timeline.push_back({time_to_sample(event->time(), sample_rate), event->to_rt_event(0)});
+        }
+        delete event;
+    }
+    std::stable_sort(_timeline.begin(), _timeline.end(), [](const TimelineEvent& lhs, const TimelineEvent& rhs)
+                                                         {
+                                                             return lhs.sample < rhs.sample;
+                                                         });
 }
 
 void OfflineFrontend::cleanup()
@@ -136,22 +250,16 @@ void OfflineFrontend::cleanup()
     {
         _worker.join();
     }
-    if (_input_file)
+    for (auto& file : _input_files)
     {
-        sf_close(_input_file);
-        _input_file = nullptr;
+        sf_close(file.file);
     }
-    if (_output_file)
+    _input_files.clear();
+    for (auto& file : _output_files)
     {
-        sf_close(_output_file);
-        _output_file = nullptr;
+        sf_close(file.file);
     }
-}
-
-int time_to_sample_offset(Time chunk_end_time, Time event_time, float samplerate)
-{
-    Time chunktime = std::chrono::microseconds(static_cast<uint64_t>(1'000'000.f * AUDIO_CHUNK_SIZE / samplerate));
-    return AUDIO_CHUNK_SIZE - static_cast<int>((AUDIO_CHUNK_SIZE * (chunk_end_time - event_time) / chunktime));
+    _output_files.clear();
 }
 
 void OfflineFrontend::run()
@@ -166,29 +274,35 @@ void OfflineFrontend::run()
     }
 }
 
-// Process all events up until end_time
-void OfflineFrontend::_process_events(Time end_time)
+// Send all events in the chunk starting at chunk_start
+void OfflineFrontend::_process_events(int64_t chunk_start)
 {
-    while (!_event_queue.empty() && _event_queue.back()->time() < end_time)
+    int64_t chunk_end = chunk_start + AUDIO_CHUNK_SIZE;
+    while (_next_timeline_event < _timeline.size() && _timeline[_next_timeline_event].sample < chunk_end)
     {
-        auto next_event = _event_queue.back();
-        if (next_event->maps_to_rt_event())
-        {
-            int offset = time_to_sample_offset(end_time, next_event->time(), _engine->sample_rate());
-            auto rt_event = next_event->to_rt_event(offset);
-            _engine->send_rt_event(rt_event);
-        }
-        _event_queue.pop_back();
-        delete next_event;
+        auto& entry = _timeline[_next_timeline_event++];
+        entry.event.set_sample_offset(static_cast<int>(std::max(entry.sample - chunk_start, int64_t(0))));
+        _engine->send_rt_event(entry.event);
     }
 }
 
+template<class random_device, class random_dist>
+void OfflineFrontend::_process_dummy_chunk(int64_t& samplecount, int64_t sample_rate, random_device& dev, random_dist& dist)
+{
+    auto process_time = sample_to_time(samplecount, sample_rate);
+    _process_events(samplecount);
+    samplecount += AUDIO_CHUNK_SIZE;
+
+    fill_buffer_with_noise(_buffer, dev, dist);
+    fill_cv_buffer_with_noise(_control_buffer, dev, dist);
+    _engine->process_chunk(&_buffer, &_buffer, &_control_buffer, &_control_buffer, process_time, samplecount);
+}
+
 void OfflineFrontend::_process_dummy()
 {
     set_flush_denormals_to_zero();
-    int samplecount = 0;
-    double usec_time = 0.0f;
-    Time start_time = std::chrono::microseconds(0);
+    int64_t samplecount = 0;
+    auto sample_rate = std::lround(_engine->sample_rate());
 
     std::ranlux24 rand_gen;
     rand_gen.seed(NOISE_SEED);
@@ -196,70 +310,119 @@ void OfflineFrontend::_process_dummy()
 
     while (_running)
     {
-        auto process_time = start_time + std::chrono::microseconds(static_cast<uint64_t>(usec_time));
-
-        samplecount += AUDIO_CHUNK_SIZE;
-        usec_time += AUDIO_CHUNK_SIZE * 1'000'000.f / _engine->sample_rate();
-
-        Time chunk_end_time = start_time + std::chrono::microseconds(static_cast<uint64_t>(usec_time));
-        _process_events(chunk_end_time);
-
-        fill_buffer_with_noise(_buffer, rand_gen, normal_dist);
-        fill_cv_buffer_with_noise(_control_buffer, rand_gen, normal_dist);
-        _engine->process_chunk(&_buffer, &_buffer, &_control_buffer, &_control_buffer, process_time, samplecount);
+        _process_dummy_chunk(samplecount, sample_rate, rand_gen, normal_dist);
     }
 }
 
-void OfflineFrontend::_run_blocking()
+BenchmarkResult OfflineFrontend::run_benchmark(std::chrono::seconds duration)
 {
+    assert(_dummy_mode);
     set_flush_denormals_to_zero();
-    int readcount;
-    int samplecount = 0;
-    double usec_time = 0.0f;
-    Time start_time = std::chrono::microseconds(0);
-
-    float file_buffer[OFFLINE_FRONTEND_CHANNELS * AUDIO_CHUNK_SIZE];
-    while ( (readcount = static_cast<int>(sf_readf_float(_input_file,
-                                                         file_buffer,
-                                                         static_cast<sf_count_t>(AUDIO_CHUNK_SIZE)))) )
-    {
-        auto process_time = start_time + std::chrono::microseconds(static_cast<uint64_t>(usec_time));
+    int64_t samplecount = 0;
+    auto sample_rate = std::lround(_engine->sample_rate());
 
-        samplecount += readcount;
-        usec_time += readcount * 1'000'000.f / _engine->sample_rate();
+    std::ranlux24 rand_gen;
+    rand_gen.seed(NOISE_SEED);
+    std::normal_distribution<float> normal_dist(0.0f, INPUT_NOISE_LEVEL);
 
-        Time chunk_end_time = start_time + std::chrono::microseconds(static_cast<uint64_t>(usec_time));
-        _process_events(chunk_end_time);
+    BenchmarkResult result;
+    result.sample_rate = _engine->sample_rate();
+    auto chunk_period = std::chrono::duration<double, std::nano>(AUDIO_CHUNK_SIZE * 1'000'000'000.0 / result.sample_rate);
+    int chunks = static_cast<int>(duration.count() * result.sample_rate / AUDIO_CHUNK_SIZE);
 
-        _buffer.clear();
+    auto timer = _engine->performance_timer();
+    uint64_t dropped_before = timer ? timer->dropped_timings() : 0;
 
-        if (_mono)
-        {
-            std::copy(file_buffer, file_buffer + AUDIO_CHUNK_SIZE, _buffer.channel(0));
-        }
-        else
+    /* Chunk timings include generating the noise input */
+    auto benchmark_start = std::chrono::steady_clock::now();
+    for (int i = 0; i < chunks && _running; ++i)
+    {
+        auto chunk_start = std::chrono::steady_clock::now();
+        _process_dummy_chunk(samplecount, sample_rate, rand_gen, normal_dist);
+        auto chunk_time = std::chrono::steady_clock::now() - chunk_start;
+        result.chunk_loads.add(static_cast<float>(chunk_time / chunk_period));
+        result.chunks++;
+        if (timer && (i + 1) % BENCHMARK_COLLECT_INTERVAL == 0)
         {
-            auto buffer = ChunkSampleBuffer::create_non_owning_buffer(_buffer, 0, 2);
-            buffer.from_interleaved(file_buffer);
+            timer->collect_timings();
         }
-        /* Gate and CV are ignored when using file frontend */
-        _engine->process_chunk(&_buffer, &_buffer, &_control_buffer, &_control_buffer, process_time, samplecount);
+    }
+    result.render_time = std::chrono::steady_clock::now() - benchmark_start;
+    if (timer)
+    {
+        result.dropped_timings = timer->dropped_timings() - dropped_before;
+    }
+    result.audio_time = std::chrono::duration_cast<std::chrono::nanoseconds>(chunk_period * result.chunks);
+    return result;
+}
+
+void OfflineFrontend::_run_blocking()
+{
+    set_flush_denormals_to_zero();
+    int64_t samplecount = 0;
+    auto sample_rate = std::lround(_engine->sample_rate());
+    int inputs = _buffer.channel_count();
+
+    /* File decoding and encoding happen in separate threads so that
+     * rendering here is not held up by disk or codec latency */
+    AudioFileStreamer streamer(_input_files, _output_files);
+    streamer.start();
 
-        if (_mono)
+    while (AudioFileBlock* block = streamer.next_block())
+    {
+        int rendered_frames = 0;
+        for (int frame = 0; frame < block->frames && _running; frame += AUDIO_CHUNK_SIZE)
         {
-            std::copy(_buffer.channel(0), _buffer.channel(0) + AUDIO_CHUNK_SIZE, file_buffer );
+            int readcount = std::min(AUDIO_CHUNK_SIZE, block->frames - frame);
+            auto process_time = sample_to_time(samplecount, sample_rate);
+            _process_events(samplecount);
+            samplecount += readcount;
+
+            _buffer.clear();
+            for (size_t i = 0; i < _input_files.size(); ++i)
+            {
+                const auto& file = _input_files[i];
+                const float* file_input = block->inputs[i].data() + frame * file.channels;
+                int channels = std::min(file.channels, inputs - file.engine_channel);
+                if (channels == file.channels)
+                {
+                    auto buffer = ChunkSampleBuffer::create_non_owning_buffer(_buffer, file.engine_channel, channels);
+                    buffer.from_interleaved(file_input);
+                }
+                else
+                {
+                    /* Only some channels of the file are used */
+                    for (int c = 0; c < channels; ++c)
+                    {
+                        float* dest = _buffer.channel(file.engine_channel + c);
+                        for (int n = 0; n < AUDIO_CHUNK_SIZE; ++n)
+                        {
+                            dest[n] = file_input[n * file.channels + c];
+                        }
+                    }
+                }
+            }
+            /* Gate and CV are ignored when using file frontend */
+            _engine->process_chunk(&_buffer, &_output_buffer, &_control_buffer, &_control_buffer, process_time, samplecount);
+
+            for (size_t i = 0; i < _output_files.size(); ++i)
+            {
+                const auto& file = _output_files[i];
+                float* file_output = block->outputs[i].data() + frame * file.channels;
+                auto buffer = ChunkSampleBuffer::create_non_owning_buffer(_output_buffer, file.engine_channel, file.channels);
+                buffer.to_interleaved(file_output);
+            }
+            rendered_frames += readcount;
         }
-        else
+        /* If stopped in the middle of the block, only what was rendered is written */
+        block->frames = rendered_frames;
+        streamer.write_block(block);
+        if (_running == false)
         {
-            auto buffer = ChunkSampleBuffer::create_non_owning_buffer(_buffer, 0, 2);
-            buffer.to_interleaved(file_buffer);
+            break;
         }
-
-        // Write to file
-        // Should we check the number of samples effectively written?
-        // Not done in libsndfile's example
-        sf_writef_float(_output_file, file_buffer, static_cast<sf_count_t>(readcount));
     }
+    streamer.finish();
 }
 
 
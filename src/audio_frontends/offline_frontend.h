@@ -29,7 +29,9 @@
 #include <sndfile.h>
 
 #include "base_audio_frontend.h"
+#include "audio_file_streamer.h"
 #include "library/rt_event.h"
+#include "library/benchmark_report.h"
 
 namespace sushi {
 
@@ -40,30 +42,66 @@ constexpr int DUMMY_FRONTEND_CHANNELS = 10;
 
 struct OfflineFrontendConfiguration : public BaseAudioFrontendConfiguration
 {
+    OfflineFrontendConfiguration(const std::vector<std::string>& input_filenames,
+                                 const std::string output_filename,
+                                 bool dummy_mode,
+                                 int cv_inputs,
+                                 int cv_outputs,
+                                 int audio_inputs = 0,
+                                 int audio_outputs = 0,
+                                 bool output_stems = false) :
+            BaseAudioFrontendConfiguration(cv_inputs, cv_outputs),
+            input_filenames(input_filenames),
+            output_filename(output_filename),
+            dummy_mode(dummy_mode),
+            audio_inputs(audio_inputs),
+            audio_outputs(audio_outputs),
+            output_stems(output_stems)
+    {}
 
     OfflineFrontendConfiguration(const std::string input_filename,
                                  const std::string output_filename,
                                  bool dummy_mode,
                                  int cv_inputs,
                                  int cv_outputs) :
-            BaseAudioFrontendConfiguration(cv_inputs, cv_outputs),
-            input_filename(input_filename),
-            output_filename(output_filename),
-            dummy_mode(dummy_mode)
+            OfflineFrontendConfiguration(std::vector<std::string>{input_filename},
+                                         output_filename,
+                                         dummy_mode,
+                                         cv_inputs,
+                                         cv_outputs)
     {}
 
     virtual ~OfflineFrontendConfiguration() = default;
-    std::string input_filename;
+    /* The channels of all input files are mapped to consecutive engine inputs */
+    std::vector<std::string> input_filenames;
     std::string output_filename;
     bool dummy_mode;
+    /* Engine channel counts, 0 means the number of channels in the input files */
+    int audio_inputs;
+    int audio_outputs;
+    /* Write one file per stereo engine output bus instead of a single multichannel file */
+    bool output_stems;
+};
+
+/**
+ * @brief Get the file name of the stem for an engine output bus, i.e.
+ *        "output.wav" becomes "output_bus_1.wav" for bus 1.
+ */
+std::string stem_filename(const std::string& output_filename, int bus);
+
+/**
+ * @brief A sequencer event converted for playback, placed at an absolute sample position
+ */
+struct TimelineEvent
+{
+    int64_t sample;
+    RtEvent event;
 };
 
 class OfflineFrontend : public BaseAudioFrontend
 {
 public:
     OfflineFrontend(engine::BaseEngine* engine) : BaseAudioFrontend(engine),
-                                                  _input_file(nullptr),
-                                                  _output_file(nullptr),
                                                   _running{true}
     {
         _buffer.clear();
@@ -77,7 +115,8 @@ public:
     AudioFrontendStatus init(BaseAudioFrontendConfiguration* config) override;
 
     /**
-     * @brief Add events that should be run during the processing
+     * @brief Add events that should be run during the processing. Must be called
+     *        after the engine sample rate is set. Takes ownership of the events.
      * @param An std::vector containing the timestamped events.
      */
     void add_sequencer_events(std::vector<Event*> events);
@@ -86,23 +125,41 @@ public:
 
     void run() override;
 
+    /**
+     * @brief Process noise input and any sequencer events as fast as possible and
+     *        measure the time it takes. Blocks until done. Only valid in dummy mode.
+     * @param duration The length of audio to process
+     * @return The processing time statistics of the run
+     */
+    BenchmarkResult run_benchmark(std::chrono::seconds duration);
+
 private:
-    void _process_events(Time end_time);
+    void _process_events(int64_t chunk_start);
     void _process_dummy();
+
+    template<class random_device, class random_dist>
+    void _process_dummy_chunk(int64_t& samplecount, int64_t sample_rate, random_device& dev, random_dist& dist);
+
     void _run_blocking();
 
-    SNDFILE*            _input_file;
-    SNDFILE*            _output_file;
+    AudioFrontendStatus _open_input_files(const std::vector<std::string>& filenames);
+
+    AudioFrontendStatus _open_output_files(const OfflineFrontendConfiguration* config, int channels);
+
+    std::vector<AudioFileMapping> _input_files;
+    std::vector<AudioFileMapping> _output_files;
     SF_INFO             _soundfile_info;
-    bool                _mono;
     bool                _dummy_mode;
     std::atomic_bool    _running;
     std::thread         _worker;
 
     SampleBuffer<AUDIO_CHUNK_SIZE> _buffer{DUMMY_FRONTEND_CHANNELS};
+    /* Only used in file mode, as the engine may have fewer outputs than inputs */
+    SampleBuffer<AUDIO_CHUNK_SIZE> _output_buffer{DUMMY_FRONTEND_CHANNELS};
     engine::ControlBuffer _control_buffer;
 
-    std::vector<Event*> _event_queue;
+    std::vector<TimelineEvent> _timeline;
+    size_t _next_timeline_event{0};
 };
 
 }; // end namespace audio_frontend
@@ -0,0 +1,329 @@
+/*
+ * Copyright 2017-2021 Modern Ancient Instruments Networked AB, dba Elk
+ *
+ * SUSHI is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU Affero General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * SUSHI is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along with
+ * SUSHI.  If not, see http://www.gnu.org/licenses/
+ */
+
+/**
+ * @brief Streaming frontend for raw interleaved PCM from and to pipes
+ * @copyright 2017-2021 Modern Ancient Instruments Networked AB, dba Elk, Stockholm
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <thread>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+#include "logging.h"
+#include "pipe_frontend.h"
+#include "audio_frontend_internals.h"
+
+namespace sushi {
+namespace audio_frontend {
+
+SUSHI_GET_LOGGER_WITH_MODULE_NAME("pipe audio");
+
+/* How often the input relay checks if it should stop when no data arrives */
+constexpr int RELAY_POLL_TIMEOUT_MS = 50;
+constexpr int RELAY_BUFFER_SIZE = 16384;
+
+std::optional<PipeSampleFormat> pipe_format_from_string(const std::string& name)
+{
+    if (name == "f32le")
+    {
+        return PipeSampleFormat::FLOAT_32;
+    }
+    if (name == "s16le")
+    {
+        return PipeSampleFormat::INT_16;
+    }
+    if (name == "s24le")
+    {
+        return PipeSampleFormat::INT_24;
+    }
+    if (name == "s32le")
+    {
+        return PipeSampleFormat::INT_32;
+    }
+    return std::nullopt;
+}
+
+int to_sndfile_format(PipeSampleFormat format)
+{
+    switch (format)
+    {
+        case PipeSampleFormat::INT_16:   return SF_FORMAT_RAW | SF_FORMAT_PCM_16 | SF_ENDIAN_LITTLE;
+        case PipeSampleFormat::INT_24:   return SF_FORMAT_RAW | SF_FORMAT_PCM_24 | SF_ENDIAN_LITTLE;
+        case PipeSampleFormat::INT_32:   return SF_FORMAT_RAW | SF_FORMAT_PCM_32 | SF_ENDIAN_LITTLE;
+        case PipeSampleFormat::FLOAT_32:
+        default:                         return SF_FORMAT_RAW | SF_FORMAT_FLOAT | SF_ENDIAN_LITTLE;
+    }
+}
+
+AudioFrontendStatus PipeFrontend::init(BaseAudioFrontendConfiguration* config)
+{
+    auto ret_code = BaseAudioFrontend::init(config);
+    if (ret_code != AudioFrontendStatus::OK)
+    {
+        return ret_code;
+    }
+    auto pipe_config = static_cast<PipeFrontendConfiguration*>(_config);
+    _clocked = pipe_config->clocked;
+
+    if (pipe_config->channels < 1)
+    {
+        SUSHI_LOG_ERROR("Invalid number of channels: {}", pipe_config->channels);
+        return AudioFrontendStatus::INVALID_N_CHANNELS;
+    }
+    int channels = pipe_config->channels;
+
+    auto input = _open_stream(pipe_config->input_path, SFM_READ, pipe_config->format, channels);
+    if (input == nullptr)
+    {
+        cleanup();
+        return AudioFrontendStatus::INVALID_INPUT_FILE;
+    }
+    _input = {input, channels, 0};
+
+    auto output = _open_stream(pipe_config->output_path, SFM_WRITE, pipe_config->format, channels);
+    if (output == nullptr)
+    {
+        cleanup();
+        return AudioFrontendStatus::INVALID_OUTPUT_FILE;
+    }
+    /* Integer formats are clipped rather than wrapped around on overload */
+    sf_command(output, SFC_SET_CLIPPING, nullptr, SF_TRUE);
+    _output = {output, channels, 0};
+
+    int engine_channels = std::max(PIPE_FRONTEND_MIN_CHANNELS, channels);
+    _in_buffer = ChunkSampleBuffer(engine_channels);
+    _out_buffer = ChunkSampleBuffer(engine_channels);
+    _engine->set_audio_input_channels(engine_channels);
+    _engine->set_audio_output_channels(engine_channels);
+
+    /* Cv is not exchanged, so the engine is set up without cv ports */
+    if (pipe_config->cv_inputs > 0 || pipe_config->cv_outputs > 0)
+    {
+        SUSHI_LOG_WARNING("The pipe frontend has no cv, ignoring {} cv inputs and {} cv outputs",
+                          pipe_config->cv_inputs, pipe_config->cv_outputs);
+    }
+    _engine->set_cv_input_channels(0);
+    _engine->set_cv_output_channels(0);
+    _engine->set_output_latency(std::chrono::microseconds(0));
+
+    SUSHI_LOG_INFO("Streaming {} channels from {} to {}, {}", channels, pipe_config->input_path,
+                   pipe_config->output_path, _clocked ? "clocked" : "free running");
+    return AudioFrontendStatus::OK;
+}
+
+void PipeFrontend::cleanup()
+{
+    _running = false;
+    if (_worker.joinable())
+    {
+        _worker.join();
+    }
+    if (_relay.joinable())
+    {
+        _relay.join();
+    }
+    if (_relay_fd >= 0)
+    {
+        close(_relay_fd);
+        _relay_fd = -1;
+    }
+    if (_close_input_fd && _input_fd >= 0)
+    {
+        close(_input_fd);
+    }
+    _input_fd = -1;
+    if (_input.file)
+    {
+        sf_close(_input.file);
+        _input.file = nullptr;
+    }
+    if (_output.file)
+    {
+        sf_close(_output.file);
+        _output.file = nullptr;
+    }
+}
+
+void PipeFrontend::run()
+{
+    _running = true;
+    _stream_ended = false;
+    _relay = std::thread(&PipeFrontend::_relay_input, this);
+    _worker = std::thread(&PipeFrontend::_run_blocking, this);
+}
+
+void PipeFrontend::_relay_input()
+{
+    std::vector<char> buffer(RELAY_BUFFER_SIZE);
+    while (_running)
+    {
+        pollfd input = {_input_fd, POLLIN, 0};
+        int ready = poll(&input, 1, RELAY_POLL_TIMEOUT_MS);
+        if (ready <= 0)
+        {
+            if (ready < 0 && errno != EINTR)
+            {
+                SUSHI_LOG_ERROR("Failed to wait for input: {}", strerror(errno));
+                break;
+            }
+            continue;
+        }
+        auto bytes = read(_input_fd, buffer.data(), buffer.size());
+        if (bytes < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (bytes <= 0)
+        {
+            break;
+        }
+        ssize_t written = 0;
+        while (written < bytes && _running)
+        {
+            pollfd relay = {_relay_fd, POLLOUT, 0};
+            if (poll(&relay, 1, RELAY_POLL_TIMEOUT_MS) <= 0)
+            {
+                continue;
+            }
+            auto count = write(_relay_fd, buffer.data() + written, bytes - written);
+            if (count < 0 && errno != EAGAIN && errno != EINTR)
+            {
+                SUSHI_LOG_ERROR("Failed to relay input: {}", strerror(errno));
+                _running = false;
+                break;
+            }
+            written += std::max(count, ssize_t(0));
+        }
+    }
+    /* Closing the write end ends the stream for the reader */
+    close(_relay_fd);
+    _relay_fd = -1;
+}
+
+void PipeFrontend::_run_blocking()
+{
+    set_flush_denormals_to_zero();
+    int64_t samplecount = 0;
+    auto sample_rate = std::lround(_engine->sample_rate());
+
+    AudioFileStreamer streamer({_input}, {_output});
+    streamer.start();
+    auto start_time = std::chrono::steady_clock::now();
+
+    while (AudioFileBlock* block = streamer.next_block())
+    {
+        int rendered_frames = 0;
+        for (int frame = 0; frame < block->frames && _running; frame += AUDIO_CHUNK_SIZE)
+        {
+            auto process_time = sample_to_time(samplecount, sample_rate);
+            if (_clocked)
+            {
+                std::this_thread::sleep_until(start_time + process_time);
+            }
+            int frames = std::min(AUDIO_CHUNK_SIZE, block->frames - frame);
+            samplecount += frames;
+            _process_chunk(block->inputs.front().data() + frame * _input.channels,
+                           block->outputs.front().data() + frame * _output.channels,
+                           process_time, samplecount);
+            rendered_frames += frames;
+        }
+        /* If stopped in the middle of the block, only what was processed is written */
+        block->frames = rendered_frames;
+        streamer.write_block(block);
+        if (_running == false)
+        {
+            break;
+        }
+    }
+    streamer.finish();
+    SUSHI_LOG_INFO("End of input stream after {} samples", samplecount);
+    _stream_ended = true;
+}
+
+SNDFILE* PipeFrontend::_open_stream(const std::string& path, int mode, PipeSampleFormat format, int channels)
+{
+    bool stdio = path == PIPE_STDIO_PATH;
+    int fd;
+    if (stdio)
+    {
+        fd = mode == SFM_READ ? STDIN_FILENO : STDOUT_FILENO;
+    }
+    else
+    {
+        /* Blocks until the other end of a named pipe is opened */
+        fd = mode == SFM_READ ? open(path.c_str(), O_RDONLY) : open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0)
+        {
+            SUSHI_LOG_ERROR("Unable to open {}: {}", path, strerror(errno));
+            return nullptr;
+        }
+    }
+
+    if (mode == SFM_READ)
+    {
+        /* sndfile reads from an internal pipe that the input is relayed to */
+        int relay[2];
+        if (pipe(relay) != 0)
+        {
+            SUSHI_LOG_ERROR("Unable to create input relay: {}", strerror(errno));
+            if (stdio == false)
+            {
+                close(fd);
+            }
+            return nullptr;
+        }
+        fcntl(relay[1], F_SETFL, O_NONBLOCK);
+        _input_fd = fd;
+        _close_input_fd = stdio == false;
+        _relay_fd = relay[1];
+        fd = relay[0];
+        stdio = false;
+    }
+
+    SF_INFO info;
+    memset(&info, 0, sizeof(info));
+    info.samplerate = static_cast<int>(std::lround(_engine->sample_rate()));
+    info.channels = channels;
+    info.format = to_sndfile_format(format);
+    /* Only descriptors opened here are closed by sndfile */
+    SNDFILE* file = sf_open_fd(fd, mode, &info, stdio ? SF_FALSE : SF_TRUE);
+    if (file == nullptr)
+    {
+        SUSHI_LOG_ERROR("Unable to open {} as a raw stream with {} channels: {}", path, channels, sf_strerror(nullptr));
+    }
+    return file;
+}
+
+void PipeFrontend::_process_chunk(const float* input, float* output, Time process_time, int64_t samplecount)
+{
+    auto in_buffer = ChunkSampleBuffer::create_non_owning_buffer(_in_buffer, 0, _input.channels);
+    in_buffer.from_interleaved(input);
+
+    /* Gate and CV are not streamed */
+    _engine->process_chunk(&_in_buffer, &_out_buffer, &_control_buffer, &_control_buffer, process_time, samplecount);
+
+    auto out_buffer = ChunkSampleBuffer::create_non_owning_buffer(_out_buffer, 0, _output.channels);
+    out_buffer.to_interleaved(output);
+}
+
+} // end namespace audio_frontend
+} // end namespace sushi
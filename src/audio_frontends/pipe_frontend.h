@@ -0,0 +1,156 @@
+/*
+ * Copyright 2017-2021 Modern Ancient Instruments Networked AB, dba Elk
+ *
+ * SUSHI is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU Affero General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * SUSHI is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along with
+ * SUSHI.  If not, see http://www.gnu.org/licenses/
+ */
+
+/**
+ * @brief Streaming frontend for raw interleaved PCM from and to pipes
+ * @copyright 2017-2021 Modern Ancient Instruments Networked AB, dba Elk, Stockholm
+ */
+
+#ifndef SUSHI_PIPE_FRONTEND_H
+#define SUSHI_PIPE_FRONTEND_H
+
+#include <atomic>
+#include <optional>
+#include <string>
+#include <thread>
+
+#include <sndfile.h>
+
+#include "base_audio_frontend.h"
+#include "audio_file_streamer.h"
+
+namespace sushi {
+namespace audio_frontend {
+
+/* Path meaning stdin when used for input and stdout when used for output */
+constexpr char PIPE_STDIO_PATH[] = "-";
+/* Mono streams are processed by the engine as the left channel of a stereo pair */
+constexpr int PIPE_FRONTEND_MIN_CHANNELS = 2;
+
+/**
+ * @brief Little endian sample formats of the raw streams, named as in ffmpeg and sox
+ */
+enum class PipeSampleFormat
+{
+    FLOAT_32,
+    INT_16,
+    INT_24,
+    INT_32
+};
+
+/**
+ * @brief Get the sample format from its name, i.e. one of "f32le", "s16le", "s24le" or "s32le"
+ * @param name The name of the format
+ * @return The format, or no value if the name is not recognized
+ */
+std::optional<PipeSampleFormat> pipe_format_from_string(const std::string& name);
+
+struct PipeFrontendConfiguration : public BaseAudioFrontendConfiguration
+{
+    PipeFrontendConfiguration(const std::string& input_path,
+                              const std::string& output_path,
+                              PipeSampleFormat format,
+                              int channels,
+                              bool clocked,
+                              int cv_inputs,
+                              int cv_outputs) :
+            BaseAudioFrontendConfiguration(cv_inputs, cv_outputs),
+            input_path(input_path),
+            output_path(output_path),
+            format(format),
+            channels(channels),
+            clocked(clocked)
+    {}
+
+    virtual ~PipeFrontendConfiguration() = default;
+
+    /* Named pipes or files, or PIPE_STDIO_PATH for stdin and stdout */
+    std::string input_path;
+    std::string output_path;
+    PipeSampleFormat format;
+    /* Number of interleaved channels in both streams */
+    int channels;
+    /* Pace processing to the engine sample rate instead of running as fast as input arrives */
+    bool clocked;
+};
+
+/**
+ * @brief Frontend that reads interleaved raw PCM from a pipe, processes it and writes
+ *        the result as raw PCM in the same format to another pipe, so that Sushi can
+ *        be used in shell pipelines. Reading and writing is done in large blocks in
+ *        separate threads, see AudioFileStreamer.
+ *
+ *        run() processes the streams in a separate thread until the input stream
+ *        ends, see stream_ended(), or until cleanup() is called. The input is relayed
+ *        through an internal pipe, so that reading can be stopped even if no more
+ *        input arrives. Gate and cv are not exchanged.
+ */
+class PipeFrontend : public BaseAudioFrontend
+{
+public:
+    PipeFrontend(engine::BaseEngine* engine) : BaseAudioFrontend(engine) {}
+
+    virtual ~PipeFrontend()
+    {
+        cleanup();
+    }
+
+    AudioFrontendStatus init(BaseAudioFrontendConfiguration* config) override;
+
+    void cleanup() override;
+
+    void run() override;
+
+    /**
+     * @brief Check if processing is done
+     * @return True once the input stream has ended, or processing was stopped,
+     *         and all output has been written
+     */
+    bool stream_ended() const
+    {
+        return _stream_ended;
+    }
+
+private:
+    SNDFILE* _open_stream(const std::string& path, int mode, PipeSampleFormat format, int channels);
+
+    void _relay_input();
+
+    void _run_blocking();
+
+    void _process_chunk(const float* input, float* output, Time process_time, int64_t samplecount);
+
+    AudioFileMapping _input{nullptr, 0, 0};
+    AudioFileMapping _output{nullptr, 0, 0};
+    bool             _clocked{false};
+    std::atomic_bool _running{true};
+    std::atomic_bool _stream_ended{false};
+
+    /* The input stream, and the write end of the pipe it is relayed to */
+    int              _input_fd{-1};
+    bool             _close_input_fd{false};
+    int              _relay_fd{-1};
+    std::thread      _relay;
+    std::thread      _worker;
+
+    ChunkSampleBuffer     _in_buffer{PIPE_FRONTEND_MIN_CHANNELS};
+    ChunkSampleBuffer     _out_buffer{PIPE_FRONTEND_MIN_CHANNELS};
+    engine::ControlBuffer _control_buffer;
+};
+
+} // end namespace audio_frontend
+} // end namespace sushi
+
+#endif //SUSHI_PIPE_FRONTEND_H
@@ -0,0 +1,153 @@
+/*
+ * Copyright 2017-2021 Modern Ancient Instruments Networked AB, dba Elk
+ *
+ * SUSHI is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU Affero General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * SUSHI is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along with
+ * SUSHI.  If not, see http://www.gnu.org/licenses/
+ */
+
+/**
+ * @brief Adapter for running the engine from audio periods of any size
+ * @copyright 2017-2021 Modern Ancient Instruments Networked AB, dba Elk, Stockholm
+ */
+
+#ifndef SUSHI_REBLOCKING_ADAPTER_H
+#define SUSHI_REBLOCKING_ADAPTER_H
+
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
+#include "library/sample_buffer.h"
+#include "engine/base_engine.h"
+
+namespace sushi {
+namespace audio_frontend {
+
+/**
+ * @brief Re-blocks audio periods of any size into chunks of AUDIO_CHUNK_SIZE.
+ *        Input is gathered until a whole chunk is available and processed chunks are
+ *        queued until they are played. The output queue starts with latency() samples
+ *        of silence, which is the least needed to never run out of output when periods
+ *        and chunks don't line up: AUDIO_CHUNK_SIZE - gcd(period_size, AUDIO_CHUNK_SIZE).
+ *
+ *        Chunks are processed in place in the adapter's buffers, so process() copies
+ *        every sample once on the way in and once on the way out, and is rt safe.
+ */
+class ReblockingAdapter
+{
+public:
+    /**
+     * @brief Set up the adapter for a period size. Allocates memory, so must not be
+     *        called while process() could be running.
+     * @param input_channels Number of input channels
+     * @param output_channels Number of output channels
+     * @param period_size Number of samples in every period passed to process()
+     */
+    void configure(int input_channels, int output_channels, int period_size)
+    {
+        _period_size = period_size;
+        _latency = AUDIO_CHUNK_SIZE - std::gcd(period_size, AUDIO_CHUNK_SIZE);
+        /* The output queue never holds more than latency + period samples, rounded up
+         * to whole chunks so that chunks are always written in one piece */
+        _queue_size = (_latency + period_size + AUDIO_CHUNK_SIZE - 1) / AUDIO_CHUNK_SIZE * AUDIO_CHUNK_SIZE;
+
+        _in_data.assign(input_channels * AUDIO_CHUNK_SIZE, 0.0f);
+        _out_data.assign(output_channels * _queue_size, 0.0f);
+        _in_channels.clear();
+        for (int c = 0; c < input_channels; ++c)
+        {
+            _in_channels.push_back(ChunkSampleBuffer::create_from_raw_pointer(_in_data.data() + c * AUDIO_CHUNK_SIZE, 0, 1));
+        }
+        _out_channels.resize(output_channels);
+        _in_fill = 0;
+        /* Start reading the silence at the end of the queue */
+        _write_pos = 0;
+        _read_pos = (_queue_size - _latency) % _queue_size;
+    }
+
+    /**
+     * @return The number of samples the adapter delays the audio
+     */
+    int latency() const
+    {
+        return _latency;
+    }
+
+    int period_size() const
+    {
+        return _period_size;
+    }
+
+    /**
+     * @brief Pass one period of audio through the adapter.
+     * @param inputs One buffer of period_size samples per input channel
+     * @param outputs One buffer of period_size samples per output channel
+     * @param process_chunk Called for every complete chunk with arguments
+     *        (ChunkChannelBuffers* in, ChunkChannelBuffers* out, int offset), where offset
+     *        is the position of the chunk's first sample relative to the start of this
+     *        period. It is negative if the chunk started in an earlier period.
+     */
+    template <typename ProcessFunction>
+    void process(const float* const* inputs, float* const* outputs, ProcessFunction&& process_chunk)
+    {
+        int frame = 0;
+        while (frame < _period_size)
+        {
+            int frames = std::min(_period_size - frame, AUDIO_CHUNK_SIZE - _in_fill);
+            for (size_t c = 0; c < _in_channels.size(); ++c)
+            {
+                std::copy(inputs[c] + frame, inputs[c] + frame + frames, _in_channels[c].channel(0) + _in_fill);
+            }
+            frame += frames;
+            _in_fill += frames;
+            if (_in_fill == AUDIO_CHUNK_SIZE)
+            {
+                for (size_t c = 0; c < _out_channels.size(); ++c)
+                {
+                    _out_channels[c] = ChunkSampleBuffer::create_from_raw_pointer(_out_data.data() + c * _queue_size + _write_pos, 0, 1);
+                }
+                process_chunk(&_in_channels, &_out_channels, frame - AUDIO_CHUNK_SIZE);
+                _write_pos = (_write_pos + AUDIO_CHUNK_SIZE) % _queue_size;
+                _in_fill = 0;
+            }
+        }
+
+        int first_part = std::min(_period_size, _queue_size - _read_pos);
+        for (size_t c = 0; c < _out_channels.size(); ++c)
+        {
+            const float* queue = _out_data.data() + c * _queue_size;
+            std::copy(queue + _read_pos, queue + _read_pos + first_part, outputs[c]);
+            std::copy(queue, queue + _period_size - first_part, outputs[c] + first_part);
+        }
+        _read_pos = (_read_pos + _period_size) % _queue_size;
+    }
+
+private:
+    int _period_size{0};
+    int _latency{0};
+    int _queue_size{0};
+
+    /* Input gathered for the next chunk */
+    std::vector<float> _in_data;
+    engine::ChunkChannelBuffers _in_channels;
+    int _in_fill{0};
+
+    /* Queue of processed output, one ring buffer of _queue_size samples per channel */
+    std::vector<float> _out_data;
+    engine::ChunkChannelBuffers _out_channels;
+    int _write_pos{0};
+    int _read_pos{0};
+};
+
+} // end namespace audio_frontend
+} // end namespace sushi
+
+#endif //SUSHI_REBLOCKING_ADAPTER_H
@@ -0,0 +1,185 @@
+/*
+ * Copyright 2017-2021 Modern Ancient Instruments Networked AB, dba Elk
+ *
+ * SUSHI is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU Affero General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * SUSHI is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along with
+ * SUSHI.  If not, see http://www.gnu.org/licenses/
+ */
+
+/**
+ * @brief Audio frontend driven by another process through shared memory
+ * @copyright 2017-2021 Modern Ancient Instruments Networked AB, dba Elk, Stockholm
+ */
+
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+
+#include "logging.h"
+#include "shm_frontend.h"
+#include "audio_frontend_internals.h"
+
+namespace sushi {
+namespace audio_frontend {
+
+SUSHI_GET_LOGGER_WITH_MODULE_NAME("shm audio");
+
+constexpr int SHM_FRONTEND_RT_PRIORITY = 75;
+
+AudioFrontendStatus ShmFrontend::init(BaseAudioFrontendConfiguration* config)
+{
+    auto ret_code = BaseAudioFrontend::init(config);
+    if (ret_code != AudioFrontendStatus::OK)
+    {
+        return ret_code;
+    }
+    auto shm_config = static_cast<ShmFrontendConfiguration*>(_config);
+    int inputs = shm_config->audio_inputs;
+    int outputs = shm_config->audio_outputs;
+    if (inputs < 0 || outputs < 0 || inputs + outputs == 0)
+    {
+        SUSHI_LOG_ERROR("Invalid number of channels: {} inputs and {} outputs", inputs, outputs);
+        return AudioFrontendStatus::INVALID_N_CHANNELS;
+    }
+
+    _shm_name = shm_config->shm_name;
+    _region_size = ext::shm_audio_region_size(AUDIO_CHUNK_SIZE, inputs, outputs);
+    int fd = shm_open(_shm_name.c_str(), O_CREAT | O_RDWR, 0600);
+    if (fd < 0)
+    {
+        SUSHI_LOG_ERROR("Failed to create shared memory {}: {}", _shm_name, strerror(errno));
+        return AudioFrontendStatus::AUDIO_HW_ERROR;
+    }
+    if (ftruncate(fd, static_cast<off_t>(_region_size)) != 0)
+    {
+        SUSHI_LOG_ERROR("Failed to set size of shared memory {}: {}", _shm_name, strerror(errno));
+        close(fd);
+        shm_unlink(_shm_name.c_str());
+        return AudioFrontendStatus::AUDIO_HW_ERROR;
+    }
+    void* region = mmap(nullptr, _region_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (region == MAP_FAILED)
+    {
+        SUSHI_LOG_ERROR("Failed to map shared memory {}: {}", _shm_name, strerror(errno));
+        shm_unlink(_shm_name.c_str());
+        return AudioFrontendStatus::AUDIO_HW_ERROR;
+    }
+    /* Page faults in the audio thread would break the deterministic latency */
+    if (mlock(region, _region_size) != 0)
+    {
+        SUSHI_LOG_WARNING("Failed to lock shared memory in ram: {}", strerror(errno));
+    }
+
+    memset(region, 0, _region_size);
+    _header = static_cast<ext::ShmAudioHeader*>(region);
+    _header->magic = ext::SHM_AUDIO_MAGIC;
+    _header->version = ext::SHM_AUDIO_VERSION;
+    _header->chunk_size = AUDIO_CHUNK_SIZE;
+    _header->input_channels = inputs;
+    _header->output_channels = outputs;
+    _header->state.store(ext::ShmAudioState::STARTING);
+
+    /* The engine processes directly in the shared buffers */
+    _in_buffer = ChunkSampleBuffer::create_from_raw_pointer(ext::shm_audio_inputs(_header), 0, inputs);
+    _out_buffer = ChunkSampleBuffer::create_from_raw_pointer(ext::shm_audio_outputs(_header), 0, outputs);
+    _engine->set_audio_input_channels(inputs);
+    _engine->set_audio_output_channels(outputs);
+
+    /* Cv is not exchanged, so the engine is set up without cv ports */
+    if (shm_config->cv_inputs > 0 || shm_config->cv_outputs > 0)
+    {
+        SUSHI_LOG_WARNING("The shared memory frontend has no cv, ignoring {} cv inputs and {} cv outputs",
+                          shm_config->cv_inputs, shm_config->cv_outputs);
+    }
+    _engine->set_cv_input_channels(0);
+    _engine->set_cv_output_channels(0);
+    _engine->set_output_latency(std::chrono::microseconds(0));
+
+    SUSHI_LOG_INFO("Created shared memory {} with {} inputs and {} outputs", _shm_name, inputs, outputs);
+    return AudioFrontendStatus::OK;
+}
+
+void ShmFrontend::cleanup()
+{
+    _running = false;
+    if (_worker.joinable())
+    {
+        ext::shm_audio_wake(_header->request_count);
+        _worker.join();
+    }
+    _engine->enable_realtime(false);
+    if (_header)
+    {
+        /* Wake a client waiting for a period that will not be processed */
+        _header->state.store(ext::ShmAudioState::STOPPED);
+        _header->done_count.fetch_add(1, std::memory_order_release);
+        ext::shm_audio_wake(_header->done_count);
+        munmap(_header, _region_size);
+        shm_unlink(_shm_name.c_str());
+        _header = nullptr;
+    }
+}
+
+void ShmFrontend::run()
+{
+    /* The sample rate is only known once the configuration is loaded */
+    _header->sample_rate = _engine->sample_rate();
+    _done_count = _header->request_count.load(std::memory_order_acquire);
+    _header->done_count.store(_done_count, std::memory_order_release);
+    _engine->enable_realtime(true);
+    _running = true;
+    _worker = std::thread(&ShmFrontend::_audio_thread, this);
+    _header->state.store(ext::ShmAudioState::RUNNING, std::memory_order_release);
+}
+
+void ShmFrontend::_audio_thread()
+{
+    sched_param param{SHM_FRONTEND_RT_PRIORITY};
+    int res = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+    if (res != 0)
+    {
+        SUSHI_LOG_WARNING("Failed to set realtime priority of shared memory audio thread: {}", strerror(res));
+    }
+    set_flush_denormals_to_zero();
+
+    while (_running)
+    {
+        uint32_t request_count = ext::shm_audio_wait(_header->request_count, _done_count, SHM_FRONTEND_POLL_TIMEOUT_NS);
+        if (request_count != _done_count)
+        {
+            _process_period(request_count);
+        }
+    }
+}
+
+void ShmFrontend::_process_period(uint32_t request_count)
+{
+    /* The client requested a new period before the previous one was done */
+    auto xrun_monitor = _engine->xrun_monitor();
+    if (xrun_monitor && request_count - _done_count > 1)
+    {
+        xrun_monitor->report_frontend_xrun();
+    }
+
+    _out_buffer.clear();
+    _engine->process_chunk(&_in_buffer, &_out_buffer, &_in_controls, &_out_controls, get_current_time(), _samplecount);
+    _samplecount += AUDIO_CHUNK_SIZE;
+
+    _done_count = request_count;
+    _header->done_count.store(_done_count, std::memory_order_release);
+    ext::shm_audio_wake(_header->done_count);
+}
+
+} // end namespace audio_frontend
+} // end namespace sushi
@@ -0,0 +1,108 @@
+/*
+ * Copyright 2017-2021 Modern Ancient Instruments Networked AB, dba Elk
+ *
+ * SUSHI is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU Affero General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * SUSHI is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along with
+ * SUSHI.  If not, see http://www.gnu.org/licenses/
+ */
+
+/**
+ * @brief Audio frontend driven by another process through shared memory
+ * @copyright 2017-2021 Modern Ancient Instruments Networked AB, dba Elk, Stockholm
+ */
+
+#ifndef SUSHI_SHM_FRONTEND_H
+#define SUSHI_SHM_FRONTEND_H
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+#include "shm_audio_interface.h"
+
+#include "base_audio_frontend.h"
+
+namespace sushi {
+namespace audio_frontend {
+
+/* Time the audio thread waits for a period before checking if it should stop */
+constexpr long SHM_FRONTEND_POLL_TIMEOUT_NS = 100'000'000;
+
+struct ShmFrontendConfiguration : public BaseAudioFrontendConfiguration
+{
+    ShmFrontendConfiguration(const std::string& shm_name,
+                             int audio_inputs,
+                             int audio_outputs,
+                             int cv_inputs,
+                             int cv_outputs) :
+            BaseAudioFrontendConfiguration(cv_inputs, cv_outputs),
+            shm_name(shm_name),
+            audio_inputs(audio_inputs),
+            audio_outputs(audio_outputs)
+    {}
+
+    virtual ~ShmFrontendConfiguration() = default;
+
+    /* Name of the POSIX shared memory object, i.e. "/sushi" */
+    std::string shm_name;
+    int audio_inputs;
+    int audio_outputs;
+};
+
+/**
+ * @brief Frontend where an external process on the same machine drives processing
+ *        one chunk at a time. Audio buffers live in a shared memory region created by
+ *        sushi, laid out as described in shm_audio_interface.h, and the engine reads
+ *        and writes them in place, so no audio is copied. Periods are handed over
+ *        through two futex counters in the same region.
+ *
+ *        The client supplies chunks of AUDIO_CHUNK_SIZE samples and must wait for
+ *        each to be done before requesting the next. Gate and cv are not exchanged.
+ */
+class ShmFrontend : public BaseAudioFrontend
+{
+public:
+    ShmFrontend(engine::BaseEngine* engine) : BaseAudioFrontend(engine) {}
+
+    virtual ~ShmFrontend()
+    {
+        cleanup();
+    }
+
+    AudioFrontendStatus init(BaseAudioFrontendConfiguration* config) override;
+
+    void cleanup() override;
+
+    void run() override;
+
+private:
+    void _audio_thread();
+
+    void _process_period(uint32_t request_count);
+
+    std::string           _shm_name;
+    ext::ShmAudioHeader*  _header{nullptr};
+    size_t                _region_size{0};
+
+    ChunkSampleBuffer     _in_buffer;
+    ChunkSampleBuffer     _out_buffer;
+    engine::ControlBuffer _in_controls;
+    engine::ControlBuffer _out_controls;
+
+    uint32_t              _done_count{0};
+    int64_t               _samplecount{0};
+    std::atomic_bool      _running{false};
+    std::thread           _worker;
+};
+
+} // end namespace audio_frontend
+} // end namespace sushi
+
+#endif //SUSHI_SHM_FRONTEND_H
@@ -119,6 +119,14 @@ void XenomaiRaspaFrontend::_internal_process_callback(float* input, float* outpu
     set_flush_denormals_to_zero();
     int64_t samplecount = raspa_get_samplecount();
 
+    /* A gap in the sample count means that RASPA dropped one or more periods */
+    auto xrun_monitor = _engine->xrun_monitor();
+    if (xrun_monitor && _expected_samplecount >= 0 && samplecount != _expected_samplecount)
+    {
+        xrun_monitor->report_frontend_xrun();
+    }
+    _expected_samplecount = samplecount + AUDIO_CHUNK_SIZE;
+
     // Gate in signals from the Sika board are inverted, hence invert all bits
     _in_controls.gate_values = ~engine::BitSet32(raspa_get_gate_values());
 
@@ -126,7 +134,13 @@ void XenomaiRaspaFrontend::_internal_process_callback(float* input, float* outpu
     ChunkSampleBuffer out_buffer = ChunkSampleBuffer::create_from_raw_pointer(output, 0, _audio_output_channels);
     for (int i = 0; i < _cv_input_channels; ++i)
     {
-        _in_controls.cv_values[i] = map_audio_to_cv(input[(_audio_input_channels + i + 1) * AUDIO_CHUNK_SIZE - 1] * CV_IN_CORR);
+        const float* in_data = input + (_audio_input_channels + i) * AUDIO_CHUNK_SIZE;
+        float* cv_data = _in_controls.cv_buffers.channel(i);
+        for (int s = 0; s < AUDIO_CHUNK_SIZE; ++s)
+        {
+            cv_data[s] = map_audio_to_cv(in_data[s] * CV_IN_CORR);
+        }
+        _in_controls.cv_values[i] = cv_data[AUDIO_CHUNK_SIZE - 1];
     }
     out_buffer.clear();
     _engine->process_chunk(&in_buffer, &out_buffer, &_in_controls, &_out_controls, timestamp, samplecount);
@@ -135,7 +149,19 @@ void XenomaiRaspaFrontend::_internal_process_callback(float* input, float* outpu
     for (int i = 0; i < _cv_output_channels; ++i)
     {
         float* out_data = output + (_audio_output_channels + i) * AUDIO_CHUNK_SIZE;
-        _cv_output_hist[i] = ramp_cv_output(out_data, _cv_output_hist[i], _out_controls.cv_values[i] * CV_OUT_CORR);
+        if (_out_controls.audio_rate_cv[i])
+        {
+            const float* cv_data = _out_controls.cv_buffers.channel(i);
+            for (int s = 0; s < AUDIO_CHUNK_SIZE; ++s)
+            {
+                out_data[s] = cv_data[s] * CV_OUT_CORR;
+            }
+            _cv_output_hist[i] = out_data[AUDIO_CHUNK_SIZE - 1];
+        }
+        else
+        {
+            _cv_output_hist[i] = ramp_cv_output(out_data, _cv_output_hist[i], _out_controls.cv_values[i] * CV_OUT_CORR);
+        }
     }
 }
 
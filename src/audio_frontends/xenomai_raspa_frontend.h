@@ -100,6 +100,7 @@ private:
     engine::ControlBuffer _in_controls;
     engine::ControlBuffer _out_controls;
     std::array<float, MAX_ENGINE_CV_IO_PORTS> _cv_output_hist{0};
+    int64_t _expected_samplecount{-1};
 };
 
 }; // end namespace audio_frontend
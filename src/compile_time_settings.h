@@ -61,6 +61,9 @@ struct CompileTimeSettings
 #ifdef SUSHI_BUILD_WITH_JACK
             "jack",
 #endif
+#ifdef SUSHI_BUILD_WITH_ALSA
+            "alsa",
+#endif
 #ifdef SUSHI_BUILD_WITH_XENOMAI
             "xenomai",
 #endif
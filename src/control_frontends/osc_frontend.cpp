@@ -25,6 +25,7 @@
 
 #include "osc_utils.h"
 #include "osc_frontend.h"
+#include "library/event_tracer.h"
 #include "logging.h"
 
 namespace sushi {
@@ -42,6 +43,20 @@ static void osc_error(int num, const char* msg, const char* path)
     }
 }
 
+/* Matches every incoming message, returning 1 lets liblo continue to the actual handler */
+static int osc_count_message(const char* /*path*/,
+                             const char* /*types*/,
+                             lo_arg** /*argv*/,
+                             int /*argc*/,
+                             lo_message /*data*/,
+                             void* user_data)
+{
+    static_cast<performance::Counter*>(user_data)->increment();
+    /* Events posted while handling the message are traced as osc input */
+    performance::EventTracer::set_thread_source(performance::TraceSource::OSC);
+    return 1;
+}
+
 static int osc_send_parameter_change_event(const char* /*path*/,
                                            const char* /*types*/,
                                            lo_arg** argv,
@@ -348,7 +363,9 @@ OSCFrontend::OSCFrontend(engine::BaseEngine* engine,
                                           _controller(controller),
                                           _graph_controller(controller->audio_graph_controller()),
                                           _param_controller(controller->parameter_controller())
-{}
+{
+    _sent_counter = _engine->metrics().counter("sushi_osc_messages_sent_total", "Osc messages sent");
+}
 
 ControlFrontendStatus OSCFrontend::init()
 {
@@ -365,9 +382,13 @@ ControlFrontendStatus OSCFrontend::init()
     send_port_stream << _send_port;
     _osc_out_address = lo_address_new(nullptr, send_port_stream.str().c_str());
 
+    /* Must be added before any other method to see all messages */
+    lo_server_thread_add_method(_osc_server, nullptr, nullptr, osc_count_message,
+                                _engine->metrics().counter("sushi_osc_messages_received_total", "Osc messages received"));
+
     _setup_engine_control();
     _osc_initialized = true;
-    _event_dispatcher->subscribe_to_parameter_change_notifications(this);
+    _event_dispatcher->subscribe_to_parameter_change_notifications(this, dispatcher::UI_NOTIFICATION_INTERVAL);
     _event_dispatcher->subscribe_to_engine_notifications(this);
 
     return ControlFrontendStatus::OK;
@@ -815,6 +836,7 @@ void OSCFrontend::_handle_param_change_notification(const ParameterChangeNotific
         if (param_node != node->second.end())
         {
             lo_send(_osc_out_address, param_node->second.c_str(), "f", event->float_value());
+            _sent_counter->increment();
             SUSHI_LOG_DEBUG("Sending parameter change from processor: {}, parameter: {}, value: {}", event->processor_id(), event->parameter_id(), event->float_value());
         }
     }
@@ -825,10 +847,12 @@ void OSCFrontend::_handle_clipping_notification(const ClippingNotificationEvent*
     if (event->channel_type() == ClippingNotificationEvent::ClipChannelType::INPUT)
     {
         lo_send(_osc_out_address, "/engine/input_clip_notification", "i", event->channel());
+        _sent_counter->increment();
     }
     else if (event->channel_type() == ClippingNotificationEvent::ClipChannelType::OUTPUT)
     {
         lo_send(_osc_out_address, "/engine/output_clip_notification", "i", event->channel());
+        _sent_counter->increment();
     }
 }
 
@@ -32,6 +32,7 @@
 
 #include "control_interface.h"
 #include "base_control_frontend.h"
+#include "library/metrics.h"
 
 namespace sushi {
 namespace control_frontend {
@@ -217,6 +218,8 @@ private:
     std::vector<std::unique_ptr<OscConnection>> _connections;
 
     std::map<ObjectId, std::map<ObjectId, std::string>> _outgoing_connections;
+
+    performance::Counter* _sent_counter {nullptr};
 };
 
 }; // namespace control_frontend
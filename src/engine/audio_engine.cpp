@@ -18,6 +18,7 @@
  * @copyright 2017-2020 Modern Ancient Instruments Networked AB, dba Elk, Stockholm
  */
 
+#include <algorithm>
 #include <fstream>
 #include <iomanip>
 #include <functional>
@@ -25,6 +26,7 @@
 #include "twine/src/twine_internal.h"
 
 #include "audio_engine.h"
+#include "library/event_tracer.h"
 #include "logging.h"
 
 
@@ -75,28 +77,43 @@ void ClipDetector::set_output_channels(int channels)
 
 void ClipDetector::detect_clipped_samples(const ChunkSampleBuffer& buffer, RtSafeRtEventFifo& queue, bool audio_input)
 {
-    auto& counter = audio_input? _input_clip_count : _output_clip_count;
     for (int i = 0; i < buffer.channel_count(); ++i)
     {
-        if (buffer.count_clipped_samples(i) > 0 && counter[i] >= _interval)
-        {
-            queue.push(RtEvent::make_clip_notification_event(0, i, audio_input? ClipNotificationRtEvent::ClipChannelType::INPUT:
-                                                                   ClipNotificationRtEvent::ClipChannelType::OUTPUT));
-            counter[i] = 0;
-        }
-        else
-        {
-            counter[i] += AUDIO_CHUNK_SIZE;
-        }
+        _detect_clipped_channel(buffer, i, i, queue, audio_input);
+    }
+}
+
+void ClipDetector::detect_clipped_samples(const ChunkChannelBuffers& channels, RtSafeRtEventFifo& queue, bool audio_input)
+{
+    for (int i = 0; i < static_cast<int>(channels.size()); ++i)
+    {
+        _detect_clipped_channel(channels[i], 0, i, queue, audio_input);
+    }
+}
+
+void ClipDetector::_detect_clipped_channel(const ChunkSampleBuffer& buffer, int buffer_channel, int channel,
+                                           RtSafeRtEventFifo& queue, bool audio_input)
+{
+    auto& counter = audio_input? _input_clip_count : _output_clip_count;
+    if (buffer.count_clipped_samples(buffer_channel) > 0 && counter[channel] >= _interval)
+    {
+        queue.push(RtEvent::make_clip_notification_event(0, channel, audio_input? ClipNotificationRtEvent::ClipChannelType::INPUT:
+                                                                     ClipNotificationRtEvent::ClipChannelType::OUTPUT));
+        counter[channel] = 0;
+    }
+    else
+    {
+        counter[channel] += AUDIO_CHUNK_SIZE;
     }
 }
 
 AudioEngine::AudioEngine(float sample_rate,
                          int rt_cpu_cores,
                          dispatcher::BaseEventDispatcher* event_dispatcher) : BaseEngine::BaseEngine(sample_rate),
-                                             _audio_graph(rt_cpu_cores, MAX_TRACKS),
+                                             _audio_graph(rt_cpu_cores, MAX_TRACKS, &_process_timer),
                                              _audio_in_connections(MAX_AUDIO_CONNECTIONS),
                                              _audio_out_connections(MAX_AUDIO_CONNECTIONS),
+                                             _rt_input_queue(sample_rate),
                                              _transport(sample_rate, &_main_out_queue),
                                              _clip_detector(sample_rate)
 {
@@ -109,10 +126,15 @@ AudioEngine::AudioEngine(float sample_rate,
         _event_dispatcher.reset(event_dispatcher);
     }
     _host_control = std::move(HostControl(_event_dispatcher.get(), &_transport));
+    // One lock free timing queue per audio graph worker, indexed by the core tracks are assigned to
+    _process_timer.set_rt_worker_count(rt_cpu_cores);
 
     this->set_sample_rate(sample_rate);
     _cv_in_connections.reserve(MAX_CV_CONNECTIONS);
+    _cv_in_track_connections.reserve(MAX_CV_CONNECTIONS);
+    _cv_out_track_connections.reserve(MAX_CV_CONNECTIONS);
     _gate_in_connections.reserve(MAX_GATE_CONNECTIONS);
+    _setup_metrics();
 }
 
 AudioEngine::~AudioEngine()
@@ -133,7 +155,9 @@ void AudioEngine::set_sample_rate(float sample_rate)
         _processors.mutable_processor(node->id())->configure(sample_rate);
     }
     _transport.set_sample_rate(sample_rate);
+    _rt_input_queue.set_sample_rate(sample_rate);
     _process_timer.set_timing_period(sample_rate, AUDIO_CHUNK_SIZE);
+    _xrun_monitor.set_timing_period(sample_rate, AUDIO_CHUNK_SIZE);
     _clip_detector.set_sample_rate(sample_rate);
     for (auto& limiter : _master_limiters)
     {
@@ -280,6 +304,74 @@ EngineReturnStatus AudioEngine::connect_cv_from_parameter(const std::string& pro
     return EngineReturnStatus::OK;
 }
 
+EngineReturnStatus AudioEngine::connect_cv_to_track(const std::string& track_name,
+                                                    int track_channel,
+                                                    int cv_input_id)
+{
+    if (cv_input_id >= _cv_inputs)
+    {
+        return EngineReturnStatus::INVALID_CHANNEL;
+    }
+    auto track = _processors.track(track_name);
+    if (track == nullptr)
+    {
+        return EngineReturnStatus::INVALID_TRACK;
+    }
+    if (track_channel >= track->input_channels())
+    {
+        return EngineReturnStatus::INVALID_CHANNEL;
+    }
+    if (realtime())
+    {
+        SUSHI_LOG_ERROR("Cv can't be connected to tracks while the engine is running");
+        return EngineReturnStatus::ERROR;
+    }
+    for (const auto& con : _audio_in_connections.connections())
+    {
+        if (con.track == track->id() && con.track_channel == track_channel)
+        {
+            SUSHI_LOG_ERROR("Channel {} of track \"{}\" already has an audio input connection", track_channel, track_name);
+            return EngineReturnStatus::INVALID_CHANNEL;
+        }
+    }
+    AudioConnection con = {.engine_channel = cv_input_id,
+                           .track_channel = track_channel,
+                           .track = track->id()};
+    _cv_in_track_connections.push_back(con);
+    SUSHI_LOG_INFO("Connected cv input {} to channel {} of track \"{}\"", cv_input_id, track_channel, track_name);
+    return EngineReturnStatus::OK;
+}
+
+EngineReturnStatus AudioEngine::connect_cv_from_track(const std::string& track_name,
+                                                      int track_channel,
+                                                      int cv_output_id)
+{
+    if (cv_output_id >= _cv_outputs)
+    {
+        return EngineReturnStatus::INVALID_CHANNEL;
+    }
+    auto track = _processors.track(track_name);
+    if (track == nullptr)
+    {
+        return EngineReturnStatus::INVALID_TRACK;
+    }
+    if (track_channel >= track->output_channels())
+    {
+        return EngineReturnStatus::INVALID_CHANNEL;
+    }
+    if (realtime())
+    {
+        SUSHI_LOG_ERROR("Cv can't be connected from tracks while the engine is running");
+        return EngineReturnStatus::ERROR;
+    }
+    AudioConnection con = {.engine_channel = cv_output_id,
+                           .track_channel = track_channel,
+                           .track = track->id()};
+    _cv_out_track_connections.push_back(con);
+    SUSHI_LOG_INFO("Connected channel {} of track \"{}\" to cv output {}", track_channel, track_name, cv_output_id);
+    return EngineReturnStatus::OK;
+}
+
 EngineReturnStatus AudioEngine::connect_gate_to_processor(const std::string& processor_name,
                                                           int gate_input_id,
                                                           int note_no,
@@ -434,6 +526,17 @@ void AudioEngine::_remove_connections_from_track(ObjectId track_id)
     }
 }
 
+void AudioEngine::_remove_cv_connections_from_track(ObjectId track_id)
+{
+    auto has_track = [track_id](const AudioConnection& con) {return con.track == track_id;};
+    _cv_in_track_connections.erase(std::remove_if(_cv_in_track_connections.begin(),
+                                                  _cv_in_track_connections.end(), has_track),
+                                   _cv_in_track_connections.end());
+    _cv_out_track_connections.erase(std::remove_if(_cv_out_track_connections.begin(),
+                                                   _cv_out_track_connections.end(), has_track),
+                                    _cv_out_track_connections.end());
+}
+
 void AudioEngine::process_chunk(SampleBuffer<AUDIO_CHUNK_SIZE>* in_buffer,
                                 SampleBuffer<AUDIO_CHUNK_SIZE>* out_buffer,
                                 ControlBuffer* in_controls,
@@ -444,19 +547,9 @@ void AudioEngine::process_chunk(SampleBuffer<AUDIO_CHUNK_SIZE>* in_buffer,
     /* Signal that this is a realtime audio processing thread */
     twine::ThreadRtFlag rt_flag;
 
-    auto engine_timestamp = _process_timer.start_timer();
+    auto engine_timestamp = twine::current_rt_time();
 
-    _transport.set_time(timestamp, samplecount);
-
-    _process_internal_rt_events();
-    _send_rt_events_to_processors();
-
-    if (_cv_inputs > 0)
-    {
-        _route_cv_gate_ins(*in_controls);
-    }
-
-    _event_dispatcher->set_time(_transport.current_process_time());
+    _begin_chunk(in_controls, timestamp, samplecount);
     auto state = _state.load();
 
     if (_input_clip_detection_enabled)
@@ -464,13 +557,10 @@ void AudioEngine::process_chunk(SampleBuffer<AUDIO_CHUNK_SIZE>* in_buffer,
         _clip_detector.detect_clipped_samples(*in_buffer, _main_out_queue, true);
     }
     _copy_audio_to_tracks(in_buffer);
+    _copy_cv_to_tracks(*in_controls);
 
-    // Render all tracks
-    _audio_graph.render();
+    _render_chunk(out_controls);
 
-    _retrieve_events_from_tracks(*out_controls);
-
-    _main_out_queue.push(RtEvent::make_synchronisation_event(_transport.current_process_time()));
     _copy_audio_from_tracks(out_buffer);
     _state.store(update_state(state));
 
@@ -488,7 +578,49 @@ void AudioEngine::process_chunk(SampleBuffer<AUDIO_CHUNK_SIZE>* in_buffer,
     {
         _clip_detector.detect_clipped_samples(*out_buffer, _main_out_queue, false);
     }
-    _process_timer.stop_timer(engine_timestamp, ENGINE_TIMING_ID);
+    _end_chunk(engine_timestamp);
+}
+
+void AudioEngine::process_chunk(ChunkChannelBuffers* in_channels,
+                                ChunkChannelBuffers* out_channels,
+                                ControlBuffer* in_controls,
+                                ControlBuffer* out_controls,
+                                Time timestamp,
+                                int64_t samplecount)
+{
+    twine::ThreadRtFlag rt_flag;
+
+    auto engine_timestamp = twine::current_rt_time();
+
+    _begin_chunk(in_controls, timestamp, samplecount);
+    auto state = _state.load();
+
+    if (_input_clip_detection_enabled)
+    {
+        _clip_detector.detect_clipped_samples(*in_channels, _main_out_queue, true);
+    }
+    _copy_audio_to_tracks(*in_channels);
+    _copy_cv_to_tracks(*in_controls);
+
+    _render_chunk(out_controls);
+
+    _copy_audio_from_tracks(*out_channels);
+    _state.store(update_state(state));
+
+    if (_master_limter_enabled)
+    {
+        for (size_t c = 0; c < out_channels->size(); c++)
+        {
+            float* channel = (*out_channels)[c].channel(0);
+            _master_limiters[c].process(channel, channel);
+        }
+    }
+
+    if (_output_clip_detection_enabled)
+    {
+        _clip_detector.detect_clipped_samples(*out_channels, _main_out_queue, false);
+    }
+    _end_chunk(engine_timestamp);
 }
 
 void AudioEngine::set_tempo(float tempo)
@@ -619,6 +751,7 @@ EngineReturnStatus AudioEngine::delete_track(ObjectId track_id)
     }
     else
     {
+        _remove_cv_connections_from_track(track->id());
         _audio_graph.remove(track.get());
         [[maybe_unused]] bool removed = _remove_processor_from_realtime_part(track->id());
         SUSHI_LOG_WARNING_IF(removed == false, "Plugin track {} was not in the audio graph", track_id);
@@ -1036,6 +1169,8 @@ void AudioEngine::_process_internal_rt_events()
                 bool removed = false;
                 if (track)
                 {
+                    // Cv track connections are only read from the rt thread while running
+                    _remove_cv_connections_from_track(track->id());
                     removed = _audio_graph.remove(track);
                 }
                 typed_event->set_handled(removed);
@@ -1069,8 +1204,42 @@ void AudioEngine::_send_rt_events_to_processors()
     RtEvent event;
     while(_main_in_queue.pop(event))
     {
-        _send_rt_event(event);
+        _batch_rt_event(event);
+    }
+    while(_rt_input_queue.pop(event))
+    {
+        _batch_rt_event(event);
+    }
+    _dispatch_batched_rt_events();
+}
+
+void AudioEngine::_batch_rt_event(const RtEvent& event)
+{
+    if (event.processor_id() >= _realtime_processors.size())
+    {
+        return;
+    }
+    if (event.trace_id() != 0)
+    {
+        _event_tracer.mark_delivered(event.trace_id(), _transport.current_process_time());
     }
+    if (_event_batcher.full())
+    {
+        _dispatch_batched_rt_events();
+    }
+    _event_batcher.add(event);
+}
+
+void AudioEngine::_dispatch_batched_rt_events()
+{
+    _event_batcher.dispatch([this](ObjectId processor_id, RtEventSpan events)
+    {
+        auto processor = _realtime_processors[processor_id];
+        if (processor != nullptr)
+        {
+            processor->process_events(events);
+        }
+    });
 }
 
 void AudioEngine::_send_rt_event(const RtEvent& event)
@@ -1134,6 +1303,139 @@ void AudioEngine::_copy_audio_from_tracks(ChunkSampleBuffer* output)
     }
 }
 
+void AudioEngine::_copy_audio_to_tracks(const ChunkChannelBuffers& inputs)
+{
+    for (const auto& c : _audio_in_connections.connections_rt())
+    {
+        auto track_in = static_cast<Track*>(_realtime_processors[c.track])->input_channel(c.track_channel);
+        track_in = inputs[c.engine_channel];
+    }
+}
+
+void AudioEngine::_copy_audio_from_tracks(ChunkChannelBuffers& outputs)
+{
+    for (auto& channel : outputs)
+    {
+        channel.clear();
+    }
+    for (const auto& c : _audio_out_connections.connections_rt())
+    {
+        auto track_out = static_cast<Track*>(_realtime_processors[c.track])->output_channel(c.track_channel);
+        outputs[c.engine_channel].add(track_out);
+    }
+}
+
+void AudioEngine::_copy_cv_to_tracks(ControlBuffer& buffer)
+{
+    for (const auto& c : _cv_in_track_connections)
+    {
+        auto cv_in = ChunkSampleBuffer::create_non_owning_buffer(buffer.cv_buffers, c.engine_channel, 1);
+        auto track_in = static_cast<Track*>(_realtime_processors[c.track])->input_channel(c.track_channel);
+        track_in = cv_in;
+    }
+}
+
+void AudioEngine::_copy_cv_from_tracks(ControlBuffer& buffer)
+{
+    buffer.audio_rate_cv.reset();
+    for (const auto& c : _cv_out_track_connections)
+    {
+        auto track_out = static_cast<Track*>(_realtime_processors[c.track])->output_channel(c.track_channel);
+        auto cv_out = ChunkSampleBuffer::create_non_owning_buffer(buffer.cv_buffers, c.engine_channel, 1);
+        if (buffer.audio_rate_cv[c.engine_channel] == false)
+        {
+            cv_out.clear();
+            buffer.audio_rate_cv[c.engine_channel] = true;
+        }
+        cv_out.add(track_out);
+        // Frontends that only handle cv once per chunk get the last value
+        buffer.cv_values[c.engine_channel] = cv_out.channel(0)[AUDIO_CHUNK_SIZE - 1];
+    }
+}
+
+void AudioEngine::_begin_chunk(ControlBuffer* in_controls, Time timestamp, int64_t samplecount)
+{
+    _transport.set_time(timestamp, samplecount);
+
+    auto rt_events_timestamp = _process_timer.start_timer();
+    _process_internal_rt_events();
+    _process_timer.stop_trace(rt_events_timestamp, RT_EVENTS_TRACE_ID);
+    _send_rt_events_to_processors();
+
+    if (_cv_inputs > 0)
+    {
+        _route_cv_gate_ins(*in_controls);
+    }
+
+    _event_dispatcher->set_time(_transport.current_process_time());
+    _rt_input_queue.set_time(_transport.current_process_time());
+}
+
+void AudioEngine::_render_chunk(ControlBuffer* out_controls)
+{
+    // Render all tracks
+    _audio_graph.render();
+
+    _retrieve_events_from_tracks(*out_controls);
+    _copy_cv_from_tracks(*out_controls);
+
+    _main_out_queue.push(RtEvent::make_synchronisation_event(_transport.current_process_time()));
+}
+
+void AudioEngine::_end_chunk(performance::TimePoint engine_timestamp)
+{
+    _process_timer.stop_timer(engine_timestamp, ENGINE_TIMING_ID);
+
+    auto process_time = twine::current_rt_time() - engine_timestamp;
+    float load = _xrun_monitor.load(process_time);
+    _chunk_counter->increment();
+    _load_gauge->set(load);
+    _load_histogram->observe(load);
+    _report_xruns(process_time);
+}
+
+void AudioEngine::_setup_metrics()
+{
+    auto& metrics = this->metrics();
+    _chunk_counter = metrics.counter("sushi_engine_chunks_total", "Audio chunks processed by the engine");
+    _load_gauge = metrics.gauge("sushi_engine_load", "Processing time of the last chunk as a fraction of the chunk period");
+    _load_histogram = metrics.histogram("sushi_engine_chunk_load",
+                                        "Processing time of chunks as a fraction of the chunk period",
+                                        {0.1, 0.25, 0.5, 0.75, 0.9, 1.0, 1.5, 2.0});
+
+    const std::string help = "Realtime events dropped because the queue was full";
+    _control_queue_in.set_dropped_events_counter(metrics.counter("sushi_rt_events_dropped_total{queue=\"control_in\"}", help));
+    _main_in_queue.set_dropped_events_counter(metrics.counter("sushi_rt_events_dropped_total{queue=\"main_in\"}", help));
+    _main_out_queue.set_dropped_events_counter(metrics.counter("sushi_rt_events_dropped_total{queue=\"main_out\"}", help));
+    _control_queue_out.set_dropped_events_counter(metrics.counter("sushi_rt_events_dropped_total{queue=\"control_out\"}", help));
+}
+
+void AudioEngine::_report_xruns(performance::TimePoint process_time)
+{
+    auto slot = _xrun_monitor.check_chunk(process_time);
+    if (slot == nullptr)
+    {
+        return;
+    }
+    auto& report = slot->report;
+    for (const auto& core : _audio_graph.tracks())
+    {
+        for (auto track : core)
+        {
+            const auto& profile = track->last_render_profile();
+            report.add_node(track->id(), _xrun_monitor.load(profile.render_time));
+            if (profile.slowest_processor_time.count() > 0)
+            {
+                report.add_node(profile.slowest_processor, _xrun_monitor.load(profile.slowest_processor_time));
+            }
+        }
+    }
+    if (_main_out_queue.push(RtEvent::make_xrun_notification_event(0, slot)) == false)
+    {
+        slot->release();
+    }
+}
+
 void AudioEngine::update_timings()
 {
     if (_process_timer.enabled())
@@ -1164,14 +1466,43 @@ void AudioEngine::update_timings()
     }
 }
 
+bool AudioEngine::write_trace_to_file(const std::string& filename)
+{
+    if (!_process_timer.tracing_enabled())
+    {
+        return false;
+    }
+    auto node_names = [this](int id) -> std::string
+    {
+        switch (id)
+        {
+            case ENGINE_TIMING_ID:          return "process_chunk";
+            case RT_EVENTS_TRACE_ID:        return "process_internal_rt_events";
+            case WORKER_WAIT_TRACE_ID:      return "wait_for_workers";
+            case WORKER_RENDER_TRACE_ID:    return "worker_render";
+            default:
+            {
+                auto processor = _processors.processor(id);
+                return processor ? processor->name() : std::to_string(id);
+            }
+        }
+    };
+    return _process_timer.write_trace_to_file(filename, node_names);
+}
+
 void print_single_timings_for_node(std::fstream& f, performance::PerformanceTimer& timer, int id)
 {
     auto timings = timer.timings_for_node(id);
     if (timings.has_value())
     {
+        const auto& percentiles = timings.value().since_reset;
         f << std::setw(16) << timings.value().avg_case * 100.0
           << std::setw(16) << timings.value().min_case * 100.0
-          << std::setw(16) << timings.value().max_case * 100.0 <<"\n";
+          << std::setw(16) << timings.value().max_case * 100.0
+          << std::setw(16) << percentiles.p50 * 100.0
+          << std::setw(16) << percentiles.p90 * 100.0
+          << std::setw(16) << percentiles.p99 * 100.0
+          << std::setw(16) << percentiles.p99_9 * 100.0 <<"\n";
     }
 }
 
@@ -1187,7 +1518,8 @@ void AudioEngine::print_timings_to_file(const std::string& filename)
     file.setf(std::ios::left);
     file << "Performance timings for all processors in percentages of audio buffer (100% = "<< 1000000.0 / _sample_rate * AUDIO_CHUNK_SIZE
          << "us)\n\n" << std::setw(24) << "" << std::setw(16) << "average(%)" << std::setw(16) << "minimum(%)"
-         << std::setw(16) << "maximum(%)" << std::endl;
+         << std::setw(16) << "maximum(%)" << std::setw(16) << "p50(%)" << std::setw(16) << "p90(%)"
+         << std::setw(16) << "p99(%)" << std::setw(16) << "p99.9(%)" << std::endl;
 
     for (const auto& track : _processors.all_tracks())
     {
@@ -38,6 +38,8 @@
 #include "engine/controller/controller.h"
 #include "engine/audio_graph.h"
 #include "engine/connection_storage.h"
+#include "engine/rt_event_batcher.h"
+#include "engine/rt_input_queue.h"
 #include "library/time.h"
 #include "library/sample_buffer.h"
 #include "library/internal_plugin.h"
@@ -45,6 +47,8 @@
 #include "library/rt_event_fifo.h"
 #include "library/types.h"
 #include "library/performance_timer.h"
+#include "library/xrun_monitor.h"
+#include "library/metrics.h"
 #include "library/plugin_registry.h"
 
 namespace sushi {
@@ -71,7 +75,17 @@ public:
      */
     void detect_clipped_samples(const ChunkSampleBuffer& buffer, RtSafeRtEventFifo& queue, bool audio_input);
 
+    /**
+     * @brief Find clipped samples in separate single channel buffers and send notifications
+     * @param channels The audio channels to process
+     * @param queue Endpoint for clipping notifications
+     * @param audio_input Set to true if the audio comes directly from the an audio inout (i.e. before any processing)
+     */
+    void detect_clipped_samples(const ChunkChannelBuffers& channels, RtSafeRtEventFifo& queue, bool audio_input);
+
 private:
+    void _detect_clipped_channel(const ChunkSampleBuffer& buffer, int buffer_channel, int channel,
+                                 RtSafeRtEventFifo& queue, bool audio_input);
 
     unsigned int _interval;
     std::vector<unsigned int> _input_clip_count;
@@ -139,7 +153,8 @@ public:
 
     /**
      * @brief Connect an engine input channel to an input channel of a given track.
-     *        Not safe to call while the engine is running.
+     *        Not safe to call while the engine is running. If the track channel is
+     *        also connected to a cv input, the cv input replaces the audio input.
      * @param input_channel Index of the engine input channel to connect.
      * @param track_channel Index of the input channel of the track to connect to.
      * @param track_id The id of the track to connect to.
@@ -221,6 +236,36 @@ public:
                                                  const std::string& parameter_name,
                                                  int cv_output_id) override;
 
+    /**
+     * @brief Connect a control voltage input to an input channel of a track, so that
+     *        processors on the track get the cv at audio rate, like a sidechain input,
+     *        instead of as one parameter change per chunk.
+     *        Not possible while the engine is running. The track channel can not
+     *        also have an audio input connection. Connections are removed when
+     *        the track is deleted.
+     * @param track_name The unique name of the track.
+     * @param track_channel The input channel of the track to connect to
+     * @param cv_input_id The Cv input port id to use
+     * @return EngineReturnStatus::OK if successful, error status otherwise
+     */
+    EngineReturnStatus connect_cv_to_track(const std::string& track_name,
+                                           int track_channel,
+                                           int cv_input_id) override;
+
+    /**
+     * @brief Connect an output channel of a track to a control voltage output, which
+     *        is then output at audio rate.
+     *        Not possible while the engine is running. Connections are removed
+     *        when the track is deleted.
+     * @param track_name The unique name of the track.
+     * @param track_channel The output channel of the track to connect from
+     * @param cv_output_id The Cv output port id to use
+     * @return EngineReturnStatus::OK if successful, error status otherwise
+     */
+    EngineReturnStatus connect_cv_from_track(const std::string& track_name,
+                                             int track_channel,
+                                             int cv_output_id) override;
+
     /**
      * @brief Connect a gate input to a processor. Gate changes will be sent as note
      *        on or note off messages to the processor on the selected channel and
@@ -300,6 +345,24 @@ public:
                        Time timestamp,
                        int64_t samplecount) override;
 
+    /**
+     * @brief Process one chunk of audio where every channel is a separate buffer. Lets
+     *        frontends process directly in buffers owned by the audio server instead of
+     *        copying them to and from a contiguous SampleBuffer.
+     * @param in_channels One single channel buffer per engine audio input
+     * @param out_channels One single channel buffer per engine audio output
+     * @param in_controls input control voltage and gate data
+     * @param out_controls output control voltage and gate data
+     * @param timestamp Current time in microseconds
+     * @param samplecount Current number of samples processed
+     */
+    void process_chunk(ChunkChannelBuffers* in_channels,
+                       ChunkChannelBuffers* out_channels,
+                       ControlBuffer* in_controls,
+                       ControlBuffer* out_controls,
+                       Time timestamp,
+                       int64_t samplecount) override;
+
     /**
      * @brief Inform the engine of the current system latency
      * @param latency The output latency of the audio system
@@ -446,6 +509,15 @@ public:
         return &_transport;
     }
 
+    /**
+     * @brief Get the queue for sending events directly to the audio thread from a
+     *        single input thread without going through the event dispatcher.
+     */
+    RtInputQueue* rt_input_queue() override
+    {
+        return &_rt_input_queue;
+    }
+
     performance::BasePerformanceTimer* performance_timer() override
     {
         return &_process_timer;
@@ -456,11 +528,29 @@ public:
         return &_processors;
     }
 
+    performance::XrunMonitor* xrun_monitor() override
+    {
+        return &_xrun_monitor;
+    }
+
+    performance::EventTracer* event_tracer() override
+    {
+        return &_event_tracer;
+    }
+
     /**
      * @brief Print the current processor timings (in enabled) in the log
      */
     void update_timings() override;
 
+    /**
+     * @brief Write the recorded processing timeline, if tracing is enabled, to a file
+     *        in Chrome trace event format
+     * @param filename The file to write to
+     * @return true if the trace was written, false otherwise
+     */
+    bool write_trace_to_file(const std::string& filename) override;
+
 private:
     enum class Direction : bool
     {
@@ -503,6 +593,13 @@ private:
      */
     void _remove_connections_from_track(ObjectId track_id);
 
+    /**
+     * @brief Remove all cv connections to and from a track. Must not be called
+     *        concurrently with the rt thread.
+     * @param track_id The id of the track to remove from
+     */
+    void _remove_cv_connections_from_track(ObjectId track_id);
+
     /**
      * @brief Register a newly created track
      * @param track Pointer to the track
@@ -525,6 +622,10 @@ private:
 
     void _send_rt_events_to_processors();
 
+    void _batch_rt_event(const RtEvent& event);
+
+    void _dispatch_batched_rt_events();
+
     void _send_rt_event(const RtEvent& event);
 
     inline void _retrieve_events_from_tracks(ControlBuffer& buffer);
@@ -533,6 +634,30 @@ private:
 
     inline void _copy_audio_from_tracks(ChunkSampleBuffer* output);
 
+    inline void _copy_audio_to_tracks(const ChunkChannelBuffers& inputs);
+
+    inline void _copy_audio_from_tracks(ChunkChannelBuffers& outputs);
+
+    inline void _copy_cv_to_tracks(ControlBuffer& buffer);
+
+    inline void _copy_cv_from_tracks(ControlBuffer& buffer);
+
+    /* The parts of process_chunk() that don't depend on how the audio channels are stored */
+    inline void _begin_chunk(ControlBuffer* in_controls, Time timestamp, int64_t samplecount);
+
+    inline void _render_chunk(ControlBuffer* out_controls);
+
+    inline void _end_chunk(performance::TimePoint engine_timestamp);
+
+    /**
+     * @brief Check the processing time of the chunk against the chunk period and
+     *        send a notification with the slowest tracks and processors if an
+     *        overrun, or an xrun reported by the audio frontend, occurred
+     */
+    void _report_xruns(performance::TimePoint process_time);
+
+    void _setup_metrics();
+
     void print_timings_to_file(const std::string& filename);
 
     void _route_cv_gate_ins(ControlBuffer& buffer);
@@ -544,9 +669,15 @@ private:
     std::vector<Processor*>    _realtime_processors{MAX_RT_PROCESSOR_ID, nullptr};
     AudioGraph                 _audio_graph;
 
+    // Incoming processor events, grouped per target processor every chunk
+    RtEventBatcher<>           _event_batcher{MAX_RT_PROCESSOR_ID};
+
     ConnectionStorage<AudioConnection> _audio_in_connections;
     ConnectionStorage<AudioConnection> _audio_out_connections;
     std::vector<CvConnection>    _cv_in_connections;
+    // Audio rate cv, engine_channel is the cv port
+    std::vector<AudioConnection> _cv_in_track_connections;
+    std::vector<AudioConnection> _cv_out_track_connections;
     std::vector<GateConnection>  _gate_in_connections;
 
     BitSet32 _prev_gate_values{0};
@@ -558,15 +689,23 @@ private:
     RtSafeRtEventFifo _main_in_queue;
     RtSafeRtEventFifo _main_out_queue;
     RtSafeRtEventFifo _control_queue_out;
+    RtInputQueue      _rt_input_queue;
     std::mutex _in_queue_lock;
     receiver::AsynchronousEventReceiver _event_receiver{&_control_queue_out};
     Transport _transport;
 
+    // Declared before the dispatcher as the dispatcher uses it until destroyed
+    performance::EventTracer _event_tracer{_metrics};
     std::unique_ptr<dispatcher::BaseEventDispatcher> _event_dispatcher;
     HostControl _host_control{nullptr, &_transport};
 
     performance::PerformanceTimer _process_timer;
     int  _log_timing_print_counter{0};
+    performance::XrunMonitor _xrun_monitor{_metrics};
+
+    performance::Counter*   _chunk_counter;
+    performance::Gauge*     _load_gauge;
+    performance::Histogram* _load_histogram;
 
     bool _input_clip_detection_enabled{false};
     bool _output_clip_detection_enabled{false};
@@ -22,6 +22,7 @@
 #include "twine/src/twine_internal.h"
 
 #include "audio_graph.h"
+#include "base_engine.h"
 #include "logging.h"
 
 namespace sushi {
@@ -32,26 +33,41 @@ void external_render_callback(void* data)
     /* Signal that this is a realtime audio processing thread */
     twine::ThreadRtFlag rt_flag;
 
-    auto tracks = reinterpret_cast<std::vector<Track*>*>(data);
-    for (auto i : *tracks)
+    auto worker_data = reinterpret_cast<AudioGraph::WorkerData*>(data);
+    performance::TimePoint start_time{0};
+    if (worker_data->timer)
+    {
+        start_time = worker_data->timer->start_timer();
+    }
+    for (auto i : *worker_data->tracks)
     {
         i->render();
     }
+    if (worker_data->timer)
+    {
+        worker_data->timer->stop_trace(start_time, WORKER_RENDER_TRACE_ID, worker_data->worker);
+    }
 }
 
-AudioGraph::AudioGraph(int cpu_cores, int max_no_tracks) : _audio_graph(cpu_cores),
-                                                           _event_outputs(cpu_cores),
-                                                           _cores(cpu_cores),
-                                                           _current_core(0)
+AudioGraph::AudioGraph(int cpu_cores,
+                       int max_no_tracks,
+                       performance::PerformanceTimer* timer) : _audio_graph(cpu_cores),
+                                                               _timer(timer),
+                                                               _event_outputs(cpu_cores),
+                                                               _cores(cpu_cores),
+                                                               _current_core(0)
 {
     assert(cpu_cores > 0);
     if (_cores > 1)
     {
         _worker_pool = twine::WorkerPool::create_worker_pool(_cores);
-        for (auto& i : _audio_graph)
+        // Reserve up front so pointers handed to the workers stay valid
+        _worker_data.reserve(_cores);
+        for (int core = 0; core < _cores; ++core)
         {
-            _worker_pool->add_worker(external_render_callback, &i);
-            i.reserve(max_no_tracks);
+            _worker_data.push_back({&_audio_graph[core], _timer, core});
+            _worker_pool->add_worker(external_render_callback, &_worker_data.back());
+            _audio_graph[core].reserve(max_no_tracks);
         }
     }
     else
@@ -66,6 +82,7 @@ bool AudioGraph::add(Track* track)
     if (slot.size() < slot.capacity())
     {
         track->set_event_output(&_event_outputs[_current_core]);
+        track->set_rt_worker(_current_core);
         slot.push_back(track);
         _current_core = (_current_core + 1) % _cores;
         return true;
@@ -80,6 +97,7 @@ bool AudioGraph::add_to_core(Track* track, int core)
     if (slot.size() < slot.capacity())
     {
         track->set_event_output(&_event_outputs[core]);
+        track->set_rt_worker(core);
         slot.push_back(track);
         return true;
     }
@@ -113,8 +131,13 @@ void AudioGraph::render()
     }
     else
     {
+        auto start_time = _timer ? _timer->start_timer() : performance::TimePoint(0);
         _worker_pool->wakeup_workers();
         _worker_pool->wait_for_workers_idle();
+        if (_timer)
+        {
+            _timer->stop_trace(start_time, WORKER_WAIT_TRACE_ID);
+        }
     }
 }
 
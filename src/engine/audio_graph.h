@@ -31,6 +31,8 @@
 namespace sushi {
 namespace engine {
 
+void external_render_callback(void* data);
+
 class AudioGraph
 {
 public:
@@ -41,8 +43,9 @@ public:
      * @param max_no_tracks The maximum number of tracks to reserve space for. As
      *                      add() and remove() could be called from an rt thread
      *                      they must not (de)allocate memory-
+     * @param timer If not null, used to trace when workers are woken up and render
      */
-    AudioGraph(int cpu_cores, int max_no_tracks);
+    AudioGraph(int cpu_cores, int max_no_tracks, performance::PerformanceTimer* timer = nullptr);
 
     /**
      * @brief Add a track to the graph. The track will be assigned to a cpu
@@ -80,6 +83,16 @@ public:
         return _event_outputs;
     }
 
+    /**
+     * @brief Return the tracks assigned to each cpu core. Must not be called
+     *        concurrently with render()
+     * @return A std::vector with the tracks of every core
+     */
+    const std::vector<std::vector<Track*>>& tracks() const
+    {
+        return _audio_graph;
+    }
+
     /**
      * @brief Render all tracks. If cpu_cores = 1 all processing is done in the
      *        calling thread. With higher number of cores, the calling thread
@@ -88,8 +101,19 @@ public:
     void render();
 
 private:
+    friend void external_render_callback(void* data);
+
+    struct WorkerData
+    {
+        std::vector<Track*>* tracks;
+        performance::PerformanceTimer* timer;
+        int worker;
+    };
+
     std::vector<std::vector<Track*>>   _audio_graph;
+    std::vector<WorkerData>            _worker_data;
     std::unique_ptr<twine::WorkerPool> _worker_pool;
+    performance::PerformanceTimer*     _timer;
     std::vector<RtEventFifo<>>         _event_outputs;
     int _cores;
     int _current_core;
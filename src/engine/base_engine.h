@@ -21,6 +21,7 @@
 #ifndef SUSHI_BASE_ENGINE_H
 #define SUSHI_BASE_ENGINE_H
 
+#include <atomic>
 #include <memory>
 #include <map>
 #include <vector>
@@ -33,6 +34,9 @@
 #include "base_processor_container.h"
 #include "track.h"
 #include "library/base_performance_timer.h"
+#include "library/xrun_monitor.h"
+#include "library/event_tracer.h"
+#include "library/metrics.h"
 #include "library/time.h"
 #include "library/sample_buffer.h"
 #include "library/types.h"
@@ -42,14 +46,25 @@
 namespace sushi {
 namespace engine {
 
+class RtInputQueue;
+
 using BitSet32 = std::bitset<std::numeric_limits<uint32_t>::digits>;
 
+/* Audio where every channel is a separate, single channel buffer, i.e. buffers owned by
+ * an audio server and wrapped with ChunkSampleBuffer::create_from_raw_pointer() */
+using ChunkChannelBuffers = std::vector<ChunkSampleBuffer>;
+
 struct ControlBuffer
 {
-    ControlBuffer() : cv_values{0}, gate_values{0} {}
+    ControlBuffer() : cv_values{0}, gate_values{0}, cv_buffers(MAX_ENGINE_CV_IO_PORTS), audio_rate_cv{0} {}
 
     std::array<float, MAX_ENGINE_CV_IO_PORTS> cv_values;
     BitSet32 gate_values;
+    /* Every sample of the chunk for each cv port, in the same [0, 1] range as cv_values.
+     * Frontends fill these for cv inputs, the engine fills them for cv outputs connected
+     * to tracks and marks those ports in audio_rate_cv */
+    ChunkSampleBuffer cv_buffers;
+    BitSet32 audio_rate_cv;
 };
 
 enum class EngineReturnStatus
@@ -103,14 +118,25 @@ enum class RealtimeState
 };
 
 constexpr int ENGINE_TIMING_ID = -1;
+/* Sections that are only recorded when tracing and not part of timing statistics */
+constexpr int RT_EVENTS_TRACE_ID = -2;
+constexpr int WORKER_WAIT_TRACE_ID = -3;
+constexpr int WORKER_RENDER_TRACE_ID = -4;
 
 class BaseEngine
 {
 public:
-    BaseEngine(float sample_rate) : _sample_rate(sample_rate)
+    BaseEngine(float sample_rate) : _sample_rate(sample_rate),
+                                    _metrics(performance::MetricsRegistry::global(),
+                                             "engine=\"" + std::to_string(_new_engine_index()) + "\"")
     {}
 
-    virtual ~BaseEngine() = default;
+    virtual ~BaseEngine()
+    {
+        /* Engine metrics are only valid while the engine exists, and removing
+         * them keeps the registry from growing when engines are recreated */
+        _metrics.remove_all();
+    }
 
     float sample_rate()
     {
@@ -221,6 +247,20 @@ public:
         return EngineReturnStatus::OK;
     }
 
+    virtual EngineReturnStatus connect_cv_to_track(const std::string& /*track_name*/,
+                                                   int /*track_channel*/,
+                                                   int /*cv_input_id*/)
+    {
+        return EngineReturnStatus::OK;
+    }
+
+    virtual EngineReturnStatus connect_cv_from_track(const std::string& /*track_name*/,
+                                                     int /*track_channel*/,
+                                                     int /*cv_output_id*/)
+    {
+        return EngineReturnStatus::OK;
+    }
+
     virtual EngineReturnStatus connect_gate_to_processor(const std::string& /*processor_name*/,
                                                          int /*gate_input_id*/,
                                                          int /*note_no*/,
@@ -263,6 +303,13 @@ public:
                                Time timestamp,
                                int64_t samplecount) = 0;
 
+    virtual void process_chunk(ChunkChannelBuffers* in_channels,
+                               ChunkChannelBuffers* out_channels,
+                               ControlBuffer *in_controls,
+                               ControlBuffer *out_controls,
+                               Time timestamp,
+                               int64_t samplecount) = 0;
+
     virtual void set_output_latency(Time /*latency*/) = 0;
 
     virtual void set_tempo(float /*tempo*/) = 0;
@@ -327,6 +374,11 @@ public:
         return nullptr;
     }
 
+    virtual RtInputQueue* rt_input_queue()
+    {
+        return nullptr;
+    }
+
     virtual performance::BasePerformanceTimer* performance_timer()
     {
         return nullptr;
@@ -337,6 +389,25 @@ public:
         return nullptr;
     }
 
+    virtual performance::XrunMonitor* xrun_monitor()
+    {
+        return nullptr;
+    }
+
+    virtual performance::EventTracer* event_tracer()
+    {
+        return nullptr;
+    }
+
+    /**
+     * @brief Metrics of this engine and of the dispatchers and frontends attached to it.
+     *        Registered in the global registry with a label unique to the engine.
+     */
+    performance::MetricsScope& metrics()
+    {
+        return _metrics;
+    }
+
     virtual void enable_input_clip_detection(bool /*enabled*/) {}
 
     virtual void enable_output_clip_detection(bool /*enabled*/) {}
@@ -345,12 +416,25 @@ public:
 
     virtual void update_timings() {}
 
+    virtual bool write_trace_to_file(const std::string& /*filename*/)
+    {
+        return false;
+    }
+
 protected:
     float _sample_rate;
     int _audio_inputs{0};
     int _audio_outputs{0};
     int _cv_inputs{0};
     int _cv_outputs{0};
+    performance::MetricsScope _metrics;
+
+private:
+    static int _new_engine_index()
+    {
+        static std::atomic<int> engine_index{0};
+        return engine_index.fetch_add(1);
+    }
 };
 
 } // namespace engine
@@ -22,6 +22,8 @@
 #ifndef SUSHI_BASE_EVENT_DISPATCHER_H
 #define SUSHI_BASE_EVENT_DISPATCHER_H
 
+#include <chrono>
+
 #include "library/event.h"
 #include "library/event_interface.h"
 
@@ -36,6 +38,10 @@ enum class EventDispatcherStatus
     UNKNOWN_POSTER
 };
 
+/* Notification intervals for subscribe_to_parameter_change_notifications() */
+constexpr auto UNLIMITED_NOTIFICATION_RATE = std::chrono::milliseconds(0);
+constexpr auto UI_NOTIFICATION_INTERVAL = std::chrono::milliseconds(33);
+
 /* Abstract base class is solely for test mockups */
 class BaseEventDispatcher : public EventPoster
 {
@@ -49,7 +55,8 @@ public:
 
     virtual EventDispatcherStatus register_poster(EventPoster* /*poster*/) {return EventDispatcherStatus::OK;}
     virtual EventDispatcherStatus subscribe_to_keyboard_events(EventPoster* /*receiver*/) {return EventDispatcherStatus::OK;}
-    virtual EventDispatcherStatus subscribe_to_parameter_change_notifications(EventPoster* /*receiver*/) { return EventDispatcherStatus::OK;}
+    virtual EventDispatcherStatus subscribe_to_parameter_change_notifications(EventPoster* /*receiver*/,
+                                                                              std::chrono::milliseconds /*interval*/ = UNLIMITED_NOTIFICATION_RATE) { return EventDispatcherStatus::OK;}
     virtual EventDispatcherStatus subscribe_to_engine_notifications(EventPoster* /*receiver*/) {return EventDispatcherStatus::OK;}
 
     virtual EventDispatcherStatus deregister_poster(EventPoster* /*poster*/) {return EventDispatcherStatus::OK;}
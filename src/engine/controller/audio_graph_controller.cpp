@@ -363,6 +363,29 @@ ext::ControlStatus AudioGraphController::delete_track(int track_id)
     return ext::ControlStatus::OK;
 }
 
+std::future<ext::ControlStatus> AudioGraphController::delete_processor_from_track_async(int processor_id, int track_id)
+{
+    SUSHI_LOG_DEBUG("delete_processor_from_track_async called with processor id {} and track id {}",
+                    processor_id, track_id);
+    auto result_promise = std::make_shared<std::promise<ext::ControlStatus>>();
+    auto result = result_promise->get_future();
+    auto lambda = [=] () -> int
+    {
+        auto status = _engine->remove_plugin_from_track(processor_id, track_id);
+        if (status == engine::EngineReturnStatus::OK)
+        {
+            status = _engine->delete_plugin(processor_id);
+        }
+        bool ok = status == EngineReturnStatus::OK;
+        result_promise->set_value(ok? ext::ControlStatus::OK : ext::ControlStatus::ERROR);
+        return ok? EventStatus::HANDLED_OK : EventStatus::ERROR;
+    };
+
+    auto event = new LambdaEvent(lambda, IMMEDIATE_PROCESS);
+    _event_dispatcher->post_event(event);
+    return result;
+}
+
 std::vector<int> AudioGraphController::_get_processor_ids(int track_id) const
 {
     std::vector<int> ids;
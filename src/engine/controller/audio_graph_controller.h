@@ -74,6 +74,7 @@ public:
 
     ext::ControlStatus delete_track(int track_id) override;
 
+    std::future<ext::ControlStatus> delete_processor_from_track_async(int processor_id, int track_id) override;
 
 private:
     std::vector<int> _get_processor_ids(int track_id) const;
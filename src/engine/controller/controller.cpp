@@ -61,7 +61,7 @@ Controller::Controller(engine::BaseEngine* engine, midi_dispatcher::MidiDispatch
     _event_dispatcher = engine->event_dispatcher();
     _processors = engine->processor_container();
 
-    _event_dispatcher->subscribe_to_parameter_change_notifications(this);
+    _event_dispatcher->subscribe_to_parameter_change_notifications(this, dispatcher::UI_NOTIFICATION_INTERVAL);
     _event_dispatcher->subscribe_to_engine_notifications(this);
 }
 
@@ -90,6 +90,10 @@ ext::ControlStatus Controller::subscribe_to_notifications(ext::NotificationType
             break;
         case ext::NotificationType::CPU_TIMING_UPDATE:
             _cpu_timing_update_listeners.push_back(listener);
+            break;
+        case ext::NotificationType::XRUN:
+            _xrun_listeners.push_back(listener);
+            break;
         default:
             break;
     }
@@ -156,6 +160,10 @@ void Controller::_handle_engine_notifications(const EngineNotificationEvent* eve
         auto typed_event = static_cast<const EngineTimingNotificationEvent*>(event);
         _notify_timing_listeners(typed_event);
     }
+    else if (event->is_xrun_notification())
+    {
+        _notify_xrun_listeners(static_cast<const XrunNotificationEvent*>(event));
+    }
 }
 
 void Controller::_handle_audio_graph_notifications(const AudioGraphNotificationEvent* event)
@@ -261,6 +269,21 @@ void Controller::_notify_timing_listeners(const EngineTimingNotificationEvent* e
     }
 }
 
+void Controller::_notify_xrun_listeners(const XrunNotificationEvent* event) const
+{
+    const auto& report = event->report();
+    std::vector<ext::XrunNodeLoad> slowest_nodes;
+    for (int i = 0; i < report.node_count; ++i)
+    {
+        slowest_nodes.push_back({static_cast<int>(report.slowest_nodes[i].id), report.slowest_nodes[i].load});
+    }
+    ext::XrunNotification notification(to_external(report.source), report.chunk_load, std::move(slowest_nodes), event->time());
+    for (auto& listener : _xrun_listeners)
+    {
+        listener->notification(&notification);
+    }
+}
+
 
 }// namespace engine
 }// namespace sushi
@@ -93,11 +93,14 @@ private:
 
     void _notify_timing_listeners(const EngineTimingNotificationEvent* event) const;
 
+    void _notify_xrun_listeners(const XrunNotificationEvent* event) const;
+
     std::vector<ext::ControlListener*>      _parameter_change_listeners;
     std::vector<ext::ControlListener*>      _processor_update_listeners;
     std::vector<ext::ControlListener*>      _track_update_listeners;
     std::vector<ext::ControlListener*>      _transport_update_listeners;
     std::vector<ext::ControlListener*>      _cpu_timing_update_listeners;
+    std::vector<ext::ControlListener*>      _xrun_listeners;
 
     engine::BaseEngine*                     _engine;
     const engine::BaseProcessorContainer*   _processors;
@@ -23,6 +23,7 @@
 
 #include "control_interface.h"
 #include "library/base_performance_timer.h"
+#include "library/xrun_monitor.h"
 
 namespace sushi {
 namespace engine {
@@ -75,11 +76,38 @@ inline sushi::SyncMode to_internal(const ext::SyncMode mode)
     }
 }
 
+inline ext::CpuTimingPercentiles to_external(const sushi::performance::LatencyPercentiles& percentiles)
+{
+    return {.p50 = percentiles.p50,
+            .p90 = percentiles.p90,
+            .p99 = percentiles.p99,
+            .p99_9 = percentiles.p99_9,
+            .max = percentiles.max};
+}
+
 inline ext::CpuTimings to_external(const sushi::performance::ProcessTimings& timings)
 {
     return {.avg = timings.avg_case,
             .min = timings.min_case,
-            .max = timings.max_case};
+            .max = timings.max_case,
+            .recent = to_external(timings.recent),
+            .since_reset = to_external(timings.since_reset)};
+}
+
+inline ext::XrunSource to_external(const sushi::performance::XrunSource source)
+{
+    switch (source)
+    {
+        case performance::XrunSource::ENGINE_OVERRUN: return ext::XrunSource::ENGINE_OVERRUN;
+        case performance::XrunSource::AUDIO_FRONTEND: return ext::XrunSource::AUDIO_FRONTEND;
+        default:                                      return ext::XrunSource::ENGINE_OVERRUN;
+    }
+}
+
+inline ext::XrunCounts to_external(const sushi::performance::XrunCounts& counts)
+{
+    return {.engine_overruns = counts.engine_overruns,
+            .frontend_xruns = counts.frontend_xruns};
 }
 
 inline ext::TimeSignature to_external(sushi::TimeSignature internal)
@@ -19,6 +19,8 @@
  */
 
 #include "timing_controller.h"
+#include "library/metrics.h"
+#include "controller_common.h"
 #include "logging.h"
 
 SUSHI_GET_LOGGER_WITH_MODULE_NAME("controller");
@@ -31,11 +33,6 @@ TimingController::TimingController(sushi::engine::BaseEngine* engine) : _engine(
                                                                         _performance_timer(engine->performance_timer())
 {}
 
-inline ext::CpuTimings to_external(sushi::performance::ProcessTimings& internal)
-{
-    return {internal.avg_case, internal.min_case, internal.max_case};
-}
-
 bool TimingController::get_timing_statistics_enabled() const
 {
     SUSHI_LOG_DEBUG("get_timing_statistics_enabled called");
@@ -87,6 +84,57 @@ ext::ControlStatus TimingController::reset_processor_timings(int processor_id)
     return reset_track_timings(processor_id);
 }
 
+bool TimingController::get_tracing_enabled() const
+{
+    SUSHI_LOG_DEBUG("get_tracing_enabled called");
+    return _performance_timer->tracing_enabled();
+}
+
+void TimingController::set_tracing_enabled(bool enabled)
+{
+    SUSHI_LOG_DEBUG("set_tracing_enabled called with {}", enabled);
+    _performance_timer->enable_tracing(enabled);
+}
+
+ext::ControlStatus TimingController::write_trace_to_file(const std::string& filename)
+{
+    SUSHI_LOG_DEBUG("write_trace_to_file called with {}", filename);
+    if (!_performance_timer->tracing_enabled())
+    {
+        return ext::ControlStatus::UNSUPPORTED_OPERATION;
+    }
+    return _engine->write_trace_to_file(filename)? ext::ControlStatus::OK : ext::ControlStatus::ERROR;
+}
+
+std::pair<ext::ControlStatus, ext::XrunCounts> TimingController::get_xrun_counts() const
+{
+    SUSHI_LOG_DEBUG("get_xrun_counts called");
+    auto monitor = _engine->xrun_monitor();
+    if (monitor == nullptr)
+    {
+        return {ext::ControlStatus::UNSUPPORTED_OPERATION, ext::XrunCounts()};
+    }
+    return {ext::ControlStatus::OK, to_external(monitor->counts())};
+}
+
+ext::ControlStatus TimingController::reset_xrun_counts()
+{
+    SUSHI_LOG_DEBUG("reset_xrun_counts called");
+    auto monitor = _engine->xrun_monitor();
+    if (monitor == nullptr)
+    {
+        return ext::ControlStatus::UNSUPPORTED_OPERATION;
+    }
+    monitor->reset_counts();
+    return ext::ControlStatus::OK;
+}
+
+std::string TimingController::get_metrics() const
+{
+    SUSHI_LOG_DEBUG("get_metrics called");
+    return performance::MetricsRegistry::global().prometheus_text();
+}
+
 std::pair<ext::ControlStatus, ext::CpuTimings> TimingController::_get_timings(int node) const
 {
     if (_performance_timer->enabled())
@@ -96,9 +144,9 @@ std::pair<ext::ControlStatus, ext::CpuTimings> TimingController::_get_timings(in
         {
             return {ext::ControlStatus::OK, to_external(timings.value())};
         }
-        return {ext::ControlStatus::NOT_FOUND, {0,0,0}};
+        return {ext::ControlStatus::NOT_FOUND, ext::CpuTimings()};
     }
-    return {ext::ControlStatus::UNSUPPORTED_OPERATION, {0,0,0}};
+    return {ext::ControlStatus::UNSUPPORTED_OPERATION, ext::CpuTimings()};
 }
 
 } // namespace controller_impl
@@ -52,6 +52,18 @@ public:
 
     ext::ControlStatus reset_processor_timings(int processor_id) override;
 
+    bool get_tracing_enabled() const override;
+
+    void set_tracing_enabled(bool enabled) override;
+
+    ext::ControlStatus write_trace_to_file(const std::string& filename) override;
+
+    std::pair<ext::ControlStatus, ext::XrunCounts> get_xrun_counts() const override;
+
+    ext::ControlStatus reset_xrun_counts() override;
+
+    std::string get_metrics() const override;
+
 private:
     std::pair<ext::ControlStatus, ext::CpuTimings> _get_timings(int node) const;
 
@@ -20,6 +20,7 @@
 
 #include "event_dispatcher.h"
 #include "engine/base_engine.h"
+#include "library/event_tracer.h"
 #include "logging.h"
 
 namespace sushi {
@@ -33,6 +34,7 @@ EventDispatcher::EventDispatcher(engine::BaseEngine* engine,
                                  RtSafeRtEventFifo* in_rt_queue,
                                  RtSafeRtEventFifo* out_rt_queue) : _running{false},
                                                                     _engine{engine},
+                                                                    _event_tracer{engine->event_tracer()},
                                                                     _in_rt_queue{in_rt_queue},
                                                                     _out_rt_queue{out_rt_queue},
                                                                     _worker{engine, this},
@@ -41,10 +43,21 @@ EventDispatcher::EventDispatcher(engine::BaseEngine* engine,
     std::fill(_posters.begin(), _posters.end(), nullptr);
     register_poster(this);
     register_poster(&_worker);
+
+    auto& metrics = engine->metrics();
+    _event_counter = metrics.counter("sushi_dispatcher_events_total", "Events handled by the event dispatcher");
+    _rt_event_counter = metrics.counter("sushi_dispatcher_rt_events_total", "Realtime events received from the engine");
+    _queue_depth = metrics.gauge("sushi_dispatcher_queue_depth", "Events waiting to be handled by the event dispatcher");
+    _cycle_time = metrics.histogram("sushi_dispatcher_cycle_seconds", "Time spent handling events per dispatcher cycle",
+                                    {0.0001, 0.0005, 0.001, 0.005, 0.01, 0.05, 0.1});
 }
 
 void EventDispatcher::post_event(Event* event)
 {
+    if (_event_tracer && event->maps_to_rt_event() && _event_tracer->enabled())
+    {
+        event->set_trace_id(_event_tracer->begin_trace());
+    }
     _in_queue.push(event);
 }
 
@@ -90,15 +103,21 @@ EventDispatcherStatus EventDispatcher::subscribe_to_keyboard_events(EventPoster*
     return EventDispatcherStatus::OK;
 }
 
-EventDispatcherStatus EventDispatcher::subscribe_to_parameter_change_notifications(EventPoster* receiver)
+EventDispatcherStatus EventDispatcher::subscribe_to_parameter_change_notifications(EventPoster* receiver,
+                                                                                   std::chrono::milliseconds interval)
 {
     std::lock_guard<std::mutex> lock(_parameter_listener_lock);
 
-    for (auto r : _parameter_change_listeners)
+    for (const auto& r : _parameter_change_listeners)
     {
-        if (r == receiver) return EventDispatcherStatus::ALREADY_SUBSCRIBED;
+        if (r.listener == receiver) return EventDispatcherStatus::ALREADY_SUBSCRIBED;
     }
-    _parameter_change_listeners.push_back(receiver);
+    std::unique_ptr<ParameterNotificationAggregator> aggregator;
+    if (interval > UNLIMITED_NOTIFICATION_RATE)
+    {
+        aggregator = std::make_unique<ParameterNotificationAggregator>();
+    }
+    _parameter_change_listeners.push_back({receiver, interval, std::chrono::system_clock::now(), std::move(aggregator)});
     return EventDispatcherStatus::OK;
 }
 
@@ -126,7 +145,13 @@ int EventDispatcher::process(Event* event)
         auto [send_now, sample_offset] = _event_timer.sample_offset_from_realtime(event->time());
         if (send_now)
         {
-            if (_out_rt_queue->push(event->to_rt_event(sample_offset)))
+            auto rt_event = event->to_rt_event(sample_offset);
+            rt_event.set_trace_id(event->trace_id());
+            if (_event_tracer)
+            {
+                _event_tracer->mark_dispatched(event->trace_id(), get_current_time());
+            }
+            if (_out_rt_queue->push(rt_event))
             {
                 return EventStatus::HANDLED_OK;
             }
@@ -152,10 +177,12 @@ void EventDispatcher::_event_loop()
     do
     {
         auto start_time = std::chrono::system_clock::now();
+        _queue_depth->set(static_cast<double>(_in_queue.size() + _waiting_list.size()));
 
         /* Handle incoming Events */
         while (Event* event = _next_event())
         {
+            _event_counter->increment();
             assert(event->receiver() < static_cast<int>(_posters.size()));
             EventPoster* receiver = _posters[event->receiver()];
             int status = EventStatus::UNRECOGNIZED_RECEIVER;
@@ -180,7 +207,14 @@ void EventDispatcher::_event_loop()
             RtEvent rt_event;
             _in_rt_queue->pop(rt_event);
             _process_rt_event(rt_event);
+            _rt_event_counter->increment();
         }
+        _flush_parameter_notifications(start_time);
+        if (_event_tracer)
+        {
+            _event_tracer->collect();
+        }
+        _cycle_time->observe(std::chrono::duration<double>(std::chrono::system_clock::now() - start_time).count());
         std::this_thread::sleep_until(start_time + THREAD_PERIODICITY);
     }
     while (_running);
@@ -254,14 +288,63 @@ void EventDispatcher::_publish_parameter_events(Event* event)
 {
     std::lock_guard<std::mutex> lock(_parameter_listener_lock);
 
+    auto typed_event = static_cast<ParameterChangeNotificationEvent*>(event);
     for (auto& listener : _parameter_change_listeners)
     {
-        listener->process(event);
+        if (listener.aggregator)
+        {
+            listener.aggregator->add(typed_event);
+        }
+        else
+        {
+            listener.listener->process(event);
+        }
+    }
+}
+
+void EventDispatcher::_flush_parameter_notifications(std::chrono::system_clock::time_point now)
+{
+    std::lock_guard<std::mutex> lock(_parameter_listener_lock);
+
+    for (auto& listener : _parameter_change_listeners)
+    {
+        if (listener.aggregator && now >= listener.last_flush + listener.interval)
+        {
+            listener.last_flush = now;
+            listener.aggregator->flush([&](Event* event) {listener.listener->process(event);});
+        }
+    }
+}
+
+void EventDispatcher::_remove_parameter_notifications(ObjectId processor_id)
+{
+    std::lock_guard<std::mutex> lock(_parameter_listener_lock);
+
+    for (auto& listener : _parameter_change_listeners)
+    {
+        if (listener.aggregator)
+        {
+            listener.aggregator->remove_processor(processor_id);
+        }
     }
 }
 
 void EventDispatcher::_publish_engine_notification_events(sushi::Event* event)
 {
+    auto typed_event = static_cast<EngineNotificationEvent*>(event);
+    if (typed_event->is_audio_graph_notification())
+    {
+        auto graph_event = static_cast<AudioGraphNotificationEvent*>(typed_event);
+        if (graph_event->action() == AudioGraphNotificationEvent::Action::PROCESSOR_DELETED)
+        {
+            _remove_parameter_notifications(graph_event->processor());
+        }
+        else if (graph_event->action() == AudioGraphNotificationEvent::Action::TRACK_DELETED)
+        {
+            _remove_parameter_notifications(graph_event->track());
+        }
+    }
+
     std::lock_guard<std::mutex> lock(_engine_listener_lock);
 
     for (auto& listener : _engine_notification_listeners)
@@ -301,7 +384,7 @@ EventDispatcherStatus EventDispatcher::unsubscribe_from_parameter_change_notific
 
     for (auto i = _parameter_change_listeners.begin(); i != _parameter_change_listeners.end(); ++i)
     {
-        if (*i == receiver)
+        if (i->listener == receiver)
         {
             _parameter_change_listeners.erase(i);
             return EventDispatcherStatus::OK;
@@ -325,6 +408,16 @@ EventDispatcherStatus EventDispatcher::unsubscribe_from_engine_notifications(Eve
     return EventDispatcherStatus::UNKNOWN_POSTER;
 }
 
+Worker::Worker(engine::BaseEngine* engine, BaseEventDispatcher* dispatcher) : _engine(engine),
+                                                                              _dispatcher(dispatcher),
+                                                                              _running(false)
+{
+    auto& metrics = engine->metrics();
+    _event_counter = metrics.counter("sushi_worker_events_total", "Events executed by the worker");
+    _queue_depth = metrics.gauge("sushi_worker_queue_depth", "Events waiting to be executed by the worker");
+    _busy_threads = metrics.gauge("sushi_worker_busy_threads", "Worker threads currently executing an event");
+}
+
 void Worker::run()
 {
     _running = true;
@@ -352,31 +445,10 @@ void Worker::_worker()
     do
     {
         auto start_time = std::chrono::system_clock::now();
+        _queue_depth->set(static_cast<double>(_queue.size()));
         while (!_queue.empty())
         {
-            int status = EventStatus::UNRECOGNIZED_EVENT;
-            Event* event = _queue.pop();
-
-            if (event->is_engine_event())
-            {
-                auto typed_event = static_cast<EngineEvent*>(event);
-                status = typed_event->execute(_engine);
-            }
-            if (event->is_async_work_event())
-            {
-                auto typed_event = static_cast<AsynchronousWorkEvent*>(event);
-                Event* response_event = typed_event->execute();
-                if (response_event != nullptr)
-                {
-                    _dispatcher->post_event(response_event);
-                }
-            }
-
-            if (event->completion_cb() != nullptr)
-            {
-                event->completion_cb()(event->callback_arg(), event, status);
-            }
-            delete (event);
+            _execute(_queue.pop());
         }
         if (start_time > timing_update_counter + TIMING_UPDATE_INTERVAL)
         {
@@ -389,6 +461,34 @@ void Worker::_worker()
     while (_running);
 }
 
+void Worker::_execute(Event* event)
+{
+    _event_counter->increment();
+    _busy_threads->add(1);
+    int status = EventStatus::UNRECOGNIZED_EVENT;
+    if (event->is_engine_event())
+    {
+        auto typed_event = static_cast<EngineEvent*>(event);
+        status = typed_event->execute(_engine);
+    }
+    if (event->is_async_work_event())
+    {
+        auto typed_event = static_cast<AsynchronousWorkEvent*>(event);
+        Event* response_event = typed_event->execute();
+        if (response_event != nullptr)
+        {
+            _dispatcher->post_event(response_event);
+        }
+    }
+
+    if (event->completion_cb() != nullptr)
+    {
+        event->completion_cb()(event->callback_arg(), event, status);
+    }
+    delete (event);
+    _busy_threads->add(-1);
+}
+
 
 } // end namespace dispatcher
 } // end namespace sushi
\ No newline at end of file
@@ -22,15 +22,18 @@
 #define SUSHI_EVENT_DISPATCHER_H
 
 #include <deque>
+#include <memory>
 #include <vector>
 #include <thread>
 
 #include "engine/base_event_dispatcher.h"
 #include "engine/base_engine.h"
 #include "engine/event_timer.h"
+#include "engine/parameter_notification_aggregator.h"
 #include "library/synchronised_fifo.h"
 #include "library/rt_event_fifo.h"
 #include "library/event_interface.h"
+#include "library/metrics.h"
 
 namespace sushi {
 namespace engine {class BaseEngine;}
@@ -49,9 +52,7 @@ constexpr auto WORKER_THREAD_PERIODICITY = std::chrono::milliseconds(1);
 class Worker : public EventPoster
 {
 public:
-    Worker(engine::BaseEngine* engine, BaseEventDispatcher* dispatcher) : _engine(engine),
-                                                                          _dispatcher(dispatcher),
-                                                                          _running(false) {}
+    Worker(engine::BaseEngine* engine, BaseEventDispatcher* dispatcher);
 
     virtual ~Worker() = default;
 
@@ -66,10 +67,15 @@ private:
     BaseEventDispatcher*        _dispatcher;
 
     void                        _worker();
+    void                        _execute(Event* event);
     std::thread                 _worker_thread;
     std::atomic<bool>           _running;
 
     SynchronizedQueue<Event*>   _queue;
+
+    performance::Counter*       _event_counter;
+    performance::Gauge*         _queue_depth;
+    performance::Gauge*         _busy_threads;
 };
 
 class EventDispatcher : public BaseEventDispatcher
@@ -86,7 +92,16 @@ public:
 
     EventDispatcherStatus register_poster(EventPoster* poster) override;
     EventDispatcherStatus subscribe_to_keyboard_events(EventPoster* receiver) override;
-    EventDispatcherStatus subscribe_to_parameter_change_notifications(EventPoster* receiver) override;
+    /**
+     * @brief Subscribe to parameter change notifications
+     * @param receiver The listener to receive notifications
+     * @param interval If non-zero, notifications are aggregated and the listener receives
+     *        at most one notification per changed parameter and interval, carrying the
+     *        latest value. If zero, every notification is forwarded immediately.
+     * @return EventDispatcherStatus::OK or ALREADY_SUBSCRIBED
+     */
+    EventDispatcherStatus subscribe_to_parameter_change_notifications(EventPoster* receiver,
+                                                                      std::chrono::milliseconds interval = UNLIMITED_NOTIFICATION_RATE) override;
     EventDispatcherStatus subscribe_to_engine_notifications(EventPoster* receiver) override;
     EventDispatcherStatus deregister_poster(EventPoster* poster) override;
     EventDispatcherStatus unsubscribe_from_keyboard_events(EventPoster* receiver) override;
@@ -109,11 +124,22 @@ private:
     void _publish_keyboard_events(Event* event);
     void _publish_parameter_events(Event* event);
     void _publish_engine_notification_events(Event* event);
+    void _flush_parameter_notifications(std::chrono::system_clock::time_point now);
+    void _remove_parameter_notifications(ObjectId processor_id);
+
+    struct ParameterListener
+    {
+        EventPoster*                                    listener;
+        std::chrono::milliseconds                       interval;
+        std::chrono::system_clock::time_point           last_flush;
+        std::unique_ptr<ParameterNotificationAggregator> aggregator;
+    };
 
     std::atomic<bool>           _running;
     std::thread                 _event_thread;
 
     engine::BaseEngine*         _engine;
+    performance::EventTracer*   _event_tracer;
 
     SynchronizedQueue<Event*>   _in_queue;
     RtSafeRtEventFifo*          _in_rt_queue;
@@ -125,12 +151,17 @@ private:
 
     std::array<EventPoster*, EventPosterId::MAX_POSTERS> _posters;
     std::vector<EventPoster*> _keyboard_event_listeners;
-    std::vector<EventPoster*> _parameter_change_listeners;
+    std::vector<ParameterListener> _parameter_change_listeners;
     std::vector<EventPoster*> _engine_notification_listeners;
 
     std::mutex _keyboard_listener_lock;
     std::mutex _parameter_listener_lock;
     std::mutex _engine_listener_lock;
+
+    performance::Counter*       _event_counter;
+    performance::Counter*       _rt_event_counter;
+    performance::Gauge*         _queue_depth;
+    performance::Histogram*     _cycle_time;
 };
 
 } // end namespace dispatcher
@@ -48,6 +48,14 @@ std::pair<JsonConfigReturnStatus, AudioConfig> JsonConfigurator::load_audio_conf
         return {status, audio_config};
     }
 
+    if (host_config.HasMember("audio_inputs"))
+    {
+        audio_config.audio_inputs = host_config["audio_inputs"].GetInt();
+    }
+    if (host_config.HasMember("audio_outputs"))
+    {
+        audio_config.audio_outputs = host_config["audio_outputs"].GetInt();
+    }
     if (host_config.HasMember("cv_inputs"))
     {
         audio_config.cv_inputs = host_config["cv_inputs"].GetInt();
@@ -415,6 +423,20 @@ JsonConfigReturnStatus JsonConfigurator::load_cv_gate()
     {
         for (const auto& cv_in : cv_config["cv_inputs"].GetArray())
         {
+            if (cv_in.HasMember("track"))
+            {
+                auto res = _engine->connect_cv_to_track(cv_in["track"].GetString(),
+                                                        cv_in["channel"].GetInt(),
+                                                        cv_in["cv"].GetInt());
+                if (res != EngineReturnStatus::OK)
+                {
+                    SUSHI_LOG_ERROR("Failed to connect cv input {} to channel {} of track {}",
+                                    cv_in["cv"].GetInt(),
+                                    cv_in["channel"].GetInt(),
+                                    cv_in["track"].GetString());
+                }
+                continue;
+            }
             auto res = _engine->connect_cv_to_parameter(cv_in["processor"].GetString(),
                                                         cv_in["parameter"].GetString(),
                                                         cv_in["cv"].GetInt());
@@ -431,6 +453,20 @@ JsonConfigReturnStatus JsonConfigurator::load_cv_gate()
     {
         for (const auto& cv_out : cv_config["cv_outputs"].GetArray())
         {
+            if (cv_out.HasMember("track"))
+            {
+                auto res = _engine->connect_cv_from_track(cv_out["track"].GetString(),
+                                                          cv_out["channel"].GetInt(),
+                                                          cv_out["cv"].GetInt());
+                if (res != EngineReturnStatus::OK)
+                {
+                    SUSHI_LOG_ERROR("Failed to connect channel {} of track {} to cv output {}",
+                                    cv_out["channel"].GetInt(),
+                                    cv_out["track"].GetString(),
+                                    cv_out["cv"].GetInt());
+                }
+                continue;
+            }
             auto res = _engine->connect_cv_from_parameter(cv_out["processor"].GetString(),
                                                           cv_out["parameter"].GetString(),
                                                           cv_out["cv"].GetInt());
@@ -542,6 +578,12 @@ void JsonConfigurator::set_osc_frontend(control_frontend::OSCFrontend* osc_front
     _osc_frontend = osc_frontend;
 }
 
+void JsonConfigurator::copy_configuration(const JsonConfigurator& other)
+{
+    _document_path = other._document_path;
+    _json_data.CopyFrom(other._json_data, _json_data.GetAllocator());
+}
+
 std::pair<JsonConfigReturnStatus, const rapidjson::Value&> JsonConfigurator::_parse_section(JsonSection section)
 {
     if (_json_data.IsObject() == false)
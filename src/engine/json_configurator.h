@@ -66,6 +66,8 @@ enum class JsonSection
 
 struct AudioConfig
 {
+    std::optional<int> audio_inputs;
+    std::optional<int> audio_outputs;
     std::optional<int> cv_inputs;
     std::optional<int> cv_outputs;
     std::optional<int> midi_inputs;
@@ -145,6 +147,14 @@ public:
 
     void set_osc_frontend(control_frontend::OSCFrontend* osc_frontend);
 
+    /**
+     * @brief Use the configuration already read by another configurator instead of
+     *        reading and parsing the config file again. Used for configuring several
+     *        engines with the same configuration.
+     * @param other A configurator that has successfully loaded its configuration
+     */
+    void copy_configuration(const JsonConfigurator& other);
+
 private:
     /**
      * @brief Helper function to retrieve a particular section of the json configuration
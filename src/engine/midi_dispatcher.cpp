@@ -23,6 +23,8 @@
 #include "base_event_dispatcher.h"
 #include "engine/midi_dispatcher.h"
 #include "base_engine.h"
+#include "engine/rt_input_queue.h"
+#include "library/event_tracer.h"
 #include "library/midi_encoder.h"
 #include "logging.h"
 
@@ -94,31 +96,38 @@ inline Event* make_wrapped_midi_event(const InputConnection& c,
     return new KeyboardEvent(KeyboardEvent::Subtype::WRAPPED_MIDI, c.target, midi_data, timestamp);
 }
 
-inline Event* make_param_change_event(InputConnection& c,
-                                      const midi::ControlChangeMessage& msg,
-                                      Time timestamp)
+inline float param_change_value(const InputConnection& c, const midi::ControlChangeMessage& msg)
+{
+    return static_cast<float>(msg.value) / midi::MAX_VALUE * (c.max_range - c.min_range) + c.min_range;
+}
+
+/**
+ * @brief Apply a relative controller change to a virtual absolute controller value
+ */
+inline uint8_t relative_cc_value(uint8_t abs_value, uint8_t cc_value)
 {
-    uint8_t abs_value = msg.value;
     // Maybe TODO: currently this is based on a virtual controller absolute value which is
     // initialized at 64. An alternative would be to read the parameter value from the plugin
     // and compute a change from that. We should investigate what other DAWs are doing.
-    if (c.relative)
+    if (cc_value < 64u)
     {
-        abs_value = c.virtual_abs_value;
-        if (msg.value < 64u)
-        {
-            auto clipped_increment = std::min<uint8_t>(msg.value, 127u - abs_value);
-            abs_value += clipped_increment;
-        }
-        else
-        {
-            // Two-complement encoding for negative relative changes
-            auto clipped_decrease = std::min<uint8_t>(128u - msg.value, abs_value);
-            abs_value -= clipped_decrease;
-        }
-        c.virtual_abs_value = abs_value;
+        auto clipped_increment = std::min<uint8_t>(cc_value, 127u - abs_value);
+        abs_value += clipped_increment;
     }
-    float value = static_cast<float>(abs_value) / midi::MAX_VALUE * (c.max_range - c.min_range) + c.min_range;
+    else
+    {
+        // Two-complement encoding for negative relative changes
+        auto clipped_decrease = std::min<uint8_t>(128u - cc_value, abs_value);
+        abs_value -= clipped_decrease;
+    }
+    return abs_value;
+}
+
+inline Event* make_param_change_event(const InputConnection& c,
+                                      const midi::ControlChangeMessage& msg,
+                                      Time timestamp)
+{
+    float value = param_change_value(c, msg);
     return new ParameterChangeEvent(ParameterChangeEvent::Subtype::FLOAT_PARAMETER_CHANGE, c.target, c.parameter, value, timestamp);
 }
 
@@ -129,12 +138,89 @@ inline Event* make_program_change_event(const InputConnection& c,
     return new ProgramChangeEvent(c.target, msg.program, timestamp);
 }
 
-MidiDispatcher::MidiDispatcher(dispatcher::BaseEventDispatcher* event_dispatcher) : _frontend(nullptr),
-                                                                                    _event_dispatcher(event_dispatcher)
+/* Overloads for the direct realtime input path, creating RtEvents with a sample offset */
+inline RtEvent make_note_on_event(const InputConnection& c,
+                                  const midi::NoteOnMessage& msg,
+                                  int sample_offset)
+{
+    if (msg.velocity == 0)
+    {
+        return RtEvent::make_note_off_event(c.target, sample_offset, msg.channel, msg.note, 0.5f);
+    }
+
+    float velocity = msg.velocity / static_cast<float>(midi::MAX_VALUE);
+    return RtEvent::make_note_on_event(c.target, sample_offset, msg.channel, msg.note, velocity);
+}
+
+inline RtEvent make_note_off_event(const InputConnection& c,
+                                   const midi::NoteOffMessage& msg,
+                                   int sample_offset)
+{
+    float velocity = msg.velocity / static_cast<float>(midi::MAX_VALUE);
+    return RtEvent::make_note_off_event(c.target, sample_offset, msg.channel, msg.note, velocity);
+}
+
+inline RtEvent make_note_aftertouch_event(const InputConnection& c,
+                                          const midi::PolyKeyPressureMessage& msg,
+                                          int sample_offset)
+{
+    float pressure = msg.pressure / static_cast<float>(midi::MAX_VALUE);
+    return RtEvent::make_note_aftertouch_event(c.target, sample_offset, msg.channel, msg.note, pressure);
+}
+
+inline RtEvent make_aftertouch_event(const InputConnection& c,
+                                     const midi::ChannelPressureMessage& msg,
+                                     int sample_offset)
+{
+    float pressure = msg.pressure / static_cast<float>(midi::MAX_VALUE);
+    return RtEvent::make_aftertouch_event(c.target, sample_offset, msg.channel, pressure);
+}
+
+inline RtEvent make_modulation_event(const InputConnection& c,
+                                     const midi::ControlChangeMessage& msg,
+                                     int sample_offset)
+{
+    float value = msg.value / static_cast<float>(midi::MAX_VALUE);
+    return RtEvent::make_kb_modulation_event(c.target, sample_offset, msg.channel, value);
+}
+
+inline RtEvent make_pitch_bend_event(const InputConnection& c,
+                                     const midi::PitchBendMessage& msg,
+                                     int sample_offset)
+{
+    float value = (msg.value / static_cast<float>(midi::PITCH_BEND_MIDDLE)) - 1.0f;
+    return RtEvent::make_pitch_bend_event(c.target, sample_offset, msg.channel, value);
+}
+
+inline RtEvent make_wrapped_midi_event(const InputConnection& c,
+                                       const uint8_t* data,
+                                       size_t size,
+                                       int sample_offset)
+{
+    MidiDataByte midi_data{0};
+    std::copy(data, data + size, midi_data.data());
+    return RtEvent::make_wrapped_midi_event(c.target, sample_offset, midi_data);
+}
+
+inline RtEvent make_param_change_event(const InputConnection& c,
+                                       const midi::ControlChangeMessage& msg,
+                                       int sample_offset)
+{
+    float value = param_change_value(c, msg);
+    return RtEvent::make_parameter_change_event(c.target, sample_offset, c.parameter, value);
+}
+
+MidiDispatcher::MidiDispatcher(dispatcher::BaseEventDispatcher* event_dispatcher,
+                               performance::MetricsScope& metrics) : _frontend(nullptr),
+                                                                     _event_dispatcher(event_dispatcher)
 {
     _event_dispatcher->register_poster(this);
     _event_dispatcher->subscribe_to_keyboard_events(this);
     _event_dispatcher->subscribe_to_engine_notifications(this);
+
+    _received_counter = metrics.counter("sushi_midi_messages_received_total", "Midi messages received from the midi frontend");
+    _sent_counter = metrics.counter("sushi_midi_messages_sent_total", "Midi messages sent to the midi frontend");
+    _dropped_counter = metrics.counter("sushi_midi_events_dropped_total", "Midi events dropped because the realtime input queue was full");
 }
 
 MidiDispatcher::~MidiDispatcher()
@@ -166,9 +252,11 @@ MidiDispatcherStatus MidiDispatcher::connect_cc_to_parameter(int midi_input,
     connection.relative = use_relative_mode;
     connection.virtual_abs_value = 64;
 
-    std::scoped_lock lock(_cc_routes_lock);
+    std::scoped_lock lock(_routes_in_lock);
 
     _cc_routes[midi_input][cc_no][channel].push_back(connection);
+    _publish_input_routes();
+
     SUSHI_LOG_INFO("Connected parameter ID \"{}\" "
                            "(cc number \"{}\") to processor ID \"{}\"", parameter_id, cc_no, processor_id);
     return MidiDispatcherStatus::OK;
@@ -184,7 +272,7 @@ MidiDispatcherStatus MidiDispatcher::disconnect_cc_from_parameter(int midi_input
         return MidiDispatcherStatus::INVALID_MIDI_INPUT;
     }
 
-    std::scoped_lock lock(_cc_routes_lock);
+    std::scoped_lock lock(_routes_in_lock);
 
     auto connections = _cc_routes.find(midi_input);
     auto& connection_vector = connections->second[cc_no][channel];
@@ -196,6 +284,7 @@ MidiDispatcherStatus MidiDispatcher::disconnect_cc_from_parameter(int midi_input
 
     connection_vector.erase(erase_iterator, connection_vector.end());
 
+    _publish_input_routes();
     SUSHI_LOG_INFO("Disconnected "
                    "(cc number \"{}\") from processor ID \"{}\"", cc_no, processor_id);
     return MidiDispatcherStatus::OK;
@@ -203,7 +292,7 @@ MidiDispatcherStatus MidiDispatcher::disconnect_cc_from_parameter(int midi_input
 
 MidiDispatcherStatus MidiDispatcher::disconnect_all_cc_from_processor(ObjectId processor_id)
 {
-    std::scoped_lock lock(_cc_routes_lock);
+    std::scoped_lock lock(_routes_in_lock);
 
     for(auto input_i = _cc_routes.begin(); input_i != _cc_routes.end(); ++input_i)
     {
@@ -228,6 +317,8 @@ MidiDispatcherStatus MidiDispatcher::disconnect_all_cc_from_processor(ObjectId p
         }
     }
 
+    _publish_input_routes();
+
     return MidiDispatcherStatus::OK;
 }
 
@@ -256,9 +347,11 @@ MidiDispatcherStatus MidiDispatcher::connect_pc_to_processor(int midi_input,
     connection.min_range = 0;
     connection.max_range = 0;
 
-    std::scoped_lock lock(_pc_routes_lock);
+    std::scoped_lock lock(_routes_in_lock);
 
     _pc_routes[midi_input][channel].push_back(connection);
+    _publish_input_routes();
+
     SUSHI_LOG_INFO("Connected program changes from MIDI port \"{}\" to processor id\"{}\"", midi_input, processor_id);
     return MidiDispatcherStatus::OK;
 }
@@ -272,7 +365,7 @@ MidiDispatcherStatus MidiDispatcher::disconnect_pc_from_processor(int midi_input
         return MidiDispatcherStatus::INVALID_MIDI_INPUT;
     }
 
-    std::scoped_lock lock(_pc_routes_lock);
+    std::scoped_lock lock(_routes_in_lock);
 
     auto connections = _pc_routes.find(midi_input);
     auto& connection_vector = connections->second[channel];
@@ -284,13 +377,14 @@ MidiDispatcherStatus MidiDispatcher::disconnect_pc_from_processor(int midi_input
 
     connection_vector.erase(erase_iterator, connection_vector.end());
 
+    _publish_input_routes();
     SUSHI_LOG_INFO("Disconnected program changes from MIDI port \"{}\" to processor ID \"{}\"", midi_input, processor_id);
     return MidiDispatcherStatus::OK;
 }
 
 MidiDispatcherStatus MidiDispatcher::disconnect_all_pc_from_processor(ObjectId processor_id)
 {
-    std::scoped_lock lock(_pc_routes_lock);
+    std::scoped_lock lock(_routes_in_lock);
 
     for(auto inputs_i = _pc_routes.begin(); inputs_i != _pc_routes.end(); ++inputs_i)
     {
@@ -308,6 +402,7 @@ MidiDispatcherStatus MidiDispatcher::disconnect_all_pc_from_processor(ObjectId p
             connection_vector.erase(erase_iterator, connection_vector.end());
         }
     }
+    _publish_input_routes();
     SUSHI_LOG_DEBUG("Disconnected all PC's from processor ID \"{}\"", processor_id);
 
     return MidiDispatcherStatus::OK;
@@ -338,9 +433,11 @@ MidiDispatcherStatus MidiDispatcher::connect_kb_to_track(int midi_input,
     connection.min_range = 0;
     connection.max_range = 0;
 
-    std::scoped_lock lock(_kb_routes_in_lock);
+    std::scoped_lock lock(_routes_in_lock);
 
     _kb_routes_in[midi_input][channel].push_back(connection);
+    _publish_input_routes();
+
     SUSHI_LOG_INFO("Connected MIDI port \"{}\" to track ID \"{}\"", midi_input, track_id);
     return MidiDispatcherStatus::OK;
 }
@@ -355,7 +452,7 @@ MidiDispatcherStatus MidiDispatcher::disconnect_kb_from_track(int midi_input,
         return MidiDispatcherStatus::INVALID_MIDI_INPUT;
     }
 
-    std::scoped_lock lock(_kb_routes_in_lock);
+    std::scoped_lock lock(_routes_in_lock);
 
     auto connections = _kb_routes_in.find(midi_input); // All connections for the midi_input
     auto& connection_vector = connections->second[channel];
@@ -367,6 +464,7 @@ MidiDispatcherStatus MidiDispatcher::disconnect_kb_from_track(int midi_input,
 
     connection_vector.erase(erase_iterator, connection_vector.end());
 
+    _publish_input_routes();
     SUSHI_LOG_INFO("Disconnected MIDI port \"{}\" from track ID \"{}\"", midi_input, track_id);
     return MidiDispatcherStatus::OK;
 }
@@ -375,7 +473,7 @@ std::vector<KbdInputConnection> MidiDispatcher::get_all_kb_input_connections()
 {
     std::vector<KbdInputConnection> returns;
 
-    std::scoped_lock lock_in(_kb_routes_in_lock);
+    std::scoped_lock lock(_routes_in_lock);
 
     // Adding kbd connections:
     for(auto inputs_i = _kb_routes_in.begin(); inputs_i != _kb_routes_in.end(); ++inputs_i)
@@ -395,8 +493,6 @@ std::vector<KbdInputConnection> MidiDispatcher::get_all_kb_input_connections()
         }
     }
 
-    std::scoped_lock lock_raw(_raw_routes_in_lock);
-
     // Adding Raw midi connections:
     for(auto inputs_i = _raw_routes_in.begin(); inputs_i != _raw_routes_in.end(); ++inputs_i)
     {
@@ -433,9 +529,11 @@ MidiDispatcherStatus MidiDispatcher::connect_raw_midi_to_track(int midi_input,
     connection.min_range = 0;
     connection.max_range = 0;
 
-    std::scoped_lock lock(_raw_routes_in_lock);
+    std::scoped_lock lock(_routes_in_lock);
 
     _raw_routes_in[midi_input][channel].push_back(connection);
+    _publish_input_routes();
+
     SUSHI_LOG_INFO("Connected MIDI port \"{}\" to track ID \"{}\"", midi_input, track_id);
     return MidiDispatcherStatus::OK;
 }
@@ -449,7 +547,7 @@ MidiDispatcherStatus MidiDispatcher::disconnect_raw_midi_from_track(int midi_inp
         return MidiDispatcherStatus::INVALID_MIDI_INPUT;
     }
 
-    std::scoped_lock lock(_raw_routes_in_lock);
+    std::scoped_lock lock(_routes_in_lock);
 
     auto connections = _raw_routes_in.find(midi_input); // All connections for the midi_input
     auto& connection_vector = connections->second[channel];
@@ -461,6 +559,7 @@ MidiDispatcherStatus MidiDispatcher::disconnect_raw_midi_from_track(int midi_inp
 
     connection_vector.erase(erase_iterator, connection_vector.end());
 
+    _publish_input_routes();
     SUSHI_LOG_INFO("Disconnected MIDI port \"{}\" from track ID \"{}\"", midi_input, track_id);
     return MidiDispatcherStatus::OK;
 }
@@ -543,30 +642,60 @@ std::vector<KbdOutputConnection> MidiDispatcher::get_all_kb_output_connections()
     return returns;
 }
 
+void MidiDispatcher::_send_event(Event* event)
+{
+    _event_dispatcher->post_event(event);
+}
+
+void MidiDispatcher::_send_event(const RtEvent& event)
+{
+    /* Events on this path bypass the event dispatcher, so the trace starts here */
+    RtEvent traced_event = event;
+    if (_rt_event_tracer)
+    {
+        traced_event.set_trace_id(_rt_event_tracer->begin_trace());
+    }
+    if (_rt_input_queue.load()->push(traced_event) == false)
+    {
+        SUSHI_LOG_WARNING("Realtime midi input queue full, event discarded");
+        _dropped_counter->increment();
+    }
+}
+
 void MidiDispatcher::send_midi(int port, MidiDataByte data, Time timestamp)
 {
+    _received_counter->increment();
+    performance::ScopedTraceSource trace_source(performance::TraceSource::MIDI, timestamp);
+    auto rt_input_queue = _rt_input_queue.load();
+    if (rt_input_queue != nullptr)
+    {
+        _dispatch_midi(port, data, timestamp, rt_input_queue->sample_offset(timestamp));
+    }
+    else
+    {
+        _dispatch_midi(port, data, timestamp, timestamp);
+    }
+}
+
+template <typename EventTime>
+void MidiDispatcher::_dispatch_midi(int port, MidiDataByte data, Time timestamp, EventTime event_time)
+{
+    /* Route lookups are done on an immutable snapshot of the routing tables, without locking */
+    auto routes = _input_routes.read();
+
     const int channel = midi::decode_channel(data);
     const int size = data.size();
+    const std::array<int, 2> channel_slots = {channel_slot(port, midi::MidiChannel::OMNI),
+                                              channel_slot(port, channel)};
     /* Dispatch raw midi messages */
+    for (auto slot : channel_slots)
     {
-        std::scoped_lock lock(_raw_routes_in_lock);
-
-        const auto& cons = _raw_routes_in.find(port);
-        if (cons != _raw_routes_in.end())
+        for (const auto& c : routes->raw_routes.routes(slot))
         {
-            for (auto c : cons->second[midi::MidiChannel::OMNI])
-            {
-                _event_dispatcher->post_event(make_wrapped_midi_event(c, data.data(), size, timestamp));
-            }
-            for (auto c : cons->second[channel])
-            {
-                _event_dispatcher->post_event(make_wrapped_midi_event(c, data.data(), size, timestamp));
-            }
+            _send_event(make_wrapped_midi_event(c, data.data(), size, event_time));
         }
     }
 
-    std::scoped_lock lock(_kb_routes_in_lock);
-
     /* Dispatch decoded midi messages */
     midi::MessageType type = midi::decode_message_type(data);
     switch (type)
@@ -574,33 +703,40 @@ void MidiDispatcher::send_midi(int port, MidiDataByte data, Time timestamp)
         case midi::MessageType::CONTROL_CHANGE:
         {
             midi::ControlChangeMessage decoded_msg = midi::decode_control_change(data);
-
-            std::scoped_lock lock(_cc_routes_lock);
-
-            const auto& cons = _cc_routes.find(port);
-            if (cons != _cc_routes.end())
+            if (decoded_msg.controller > midi::MAX_CONTROLLER_NO)
+            {
+                break;
+            }
+            for (auto slot : {cc_slot(port, decoded_msg.controller, midi::MidiChannel::OMNI),
+                              cc_slot(port, decoded_msg.controller, decoded_msg.channel)})
             {
-                for (auto& c : cons->second[decoded_msg.controller][midi::MidiChannel::OMNI])
+                auto cons = routes->cc_routes.routes(slot);
+                if (cons.empty())
                 {
-                    _event_dispatcher->post_event(make_param_change_event(c, decoded_msg, timestamp));
+                    continue;
                 }
-                for (auto& c : cons->second[decoded_msg.controller][decoded_msg.channel])
+                /* Relative controllers share one virtual absolute value per input, cc and channel */
+                auto& virtual_abs_value = routes->relative_cc_values[slot];
+                auto relative_msg = decoded_msg;
+                relative_msg.value = relative_cc_value(virtual_abs_value.load(), decoded_msg.value);
+                bool has_relative = false;
+                for (const auto& c : cons)
                 {
-                    _event_dispatcher->post_event(make_param_change_event(c, decoded_msg, timestamp));
+                    has_relative |= c.relative;
+                    _send_event(make_param_change_event(c, c.relative ? relative_msg : decoded_msg, event_time));
+                }
+                if (has_relative)
+                {
+                    virtual_abs_value.store(relative_msg.value);
                 }
             }
             if (decoded_msg.controller == midi::MOD_WHEEL_CONTROLLER_NO)
             {
-                const auto& cons = _kb_routes_in.find(port);
-                if (cons != _kb_routes_in.end())
+                for (auto slot : {channel_slots[0], channel_slot(port, decoded_msg.channel)})
                 {
-                    for (auto c : cons->second[midi::MidiChannel::OMNI])
-                    {
-                        _event_dispatcher->post_event(make_modulation_event(c, decoded_msg, timestamp));
-                    }
-                    for (auto c : cons->second[decoded_msg.channel])
+                    for (const auto& c : routes->kb_routes.routes(slot))
                     {
-                        _event_dispatcher->post_event(make_modulation_event(c, decoded_msg, timestamp));
+                        _send_event(make_modulation_event(c, decoded_msg, event_time));
                     }
                 }
             }
@@ -610,16 +746,11 @@ void MidiDispatcher::send_midi(int port, MidiDataByte data, Time timestamp)
         case midi::MessageType::NOTE_ON:
         {
             midi::NoteOnMessage decoded_msg = midi::decode_note_on(data);
-            const auto& cons = _kb_routes_in.find(port);
-            if (cons != _kb_routes_in.end())
+            for (auto slot : {channel_slots[0], channel_slot(port, decoded_msg.channel)})
             {
-                for (auto c : cons->second[midi::MidiChannel::OMNI])
+                for (const auto& c : routes->kb_routes.routes(slot))
                 {
-                    _event_dispatcher->post_event(make_note_on_event(c, decoded_msg, timestamp));
-                }
-                for (auto c : cons->second[decoded_msg.channel])
-                {
-                    _event_dispatcher->post_event(make_note_on_event(c, decoded_msg, timestamp));
+                    _send_event(make_note_on_event(c, decoded_msg, event_time));
                 }
             }
             break;
@@ -628,16 +759,11 @@ void MidiDispatcher::send_midi(int port, MidiDataByte data, Time timestamp)
         case midi::MessageType::NOTE_OFF:
         {
             midi::NoteOffMessage decoded_msg = midi::decode_note_off(data);
-            const auto& cons = _kb_routes_in.find(port);
-            if (cons != _kb_routes_in.end())
+            for (auto slot : {channel_slots[0], channel_slot(port, decoded_msg.channel)})
             {
-                for (auto c : cons->second[midi::MidiChannel::OMNI])
-                {
-                    _event_dispatcher->post_event(make_note_off_event(c, decoded_msg, timestamp));
-                }
-                for (auto c : cons->second[decoded_msg.channel])
+                for (const auto& c : routes->kb_routes.routes(slot))
                 {
-                    _event_dispatcher->post_event(make_note_off_event(c, decoded_msg, timestamp));
+                    _send_event(make_note_off_event(c, decoded_msg, event_time));
                 }
             }
             break;
@@ -646,16 +772,11 @@ void MidiDispatcher::send_midi(int port, MidiDataByte data, Time timestamp)
         case midi::MessageType::PITCH_BEND:
         {
             midi::PitchBendMessage decoded_msg = midi::decode_pitch_bend(data);
-            const auto& cons = _kb_routes_in.find(port);
-            if (cons != _kb_routes_in.end())
+            for (auto slot : {channel_slots[0], channel_slot(port, decoded_msg.channel)})
             {
-                for (auto c : cons->second[midi::MidiChannel::OMNI])
+                for (const auto& c : routes->kb_routes.routes(slot))
                 {
-                    _event_dispatcher->post_event(make_pitch_bend_event(c, decoded_msg, timestamp));
-                }
-                for (auto c : cons->second[decoded_msg.channel])
-                {
-                    _event_dispatcher->post_event(make_pitch_bend_event(c, decoded_msg, timestamp));
+                    _send_event(make_pitch_bend_event(c, decoded_msg, event_time));
                 }
             }
             break;
@@ -664,16 +785,11 @@ void MidiDispatcher::send_midi(int port, MidiDataByte data, Time timestamp)
         case midi::MessageType::POLY_KEY_PRESSURE:
         {
             midi::PolyKeyPressureMessage decoded_msg = midi::decode_poly_key_pressure(data);
-            const auto& cons = _kb_routes_in.find(port);
-            if (cons != _kb_routes_in.end())
+            for (auto slot : {channel_slots[0], channel_slot(port, decoded_msg.channel)})
             {
-                for (auto c : cons->second[midi::MidiChannel::OMNI])
-                {
-                    _event_dispatcher->post_event(make_note_aftertouch_event(c, decoded_msg, timestamp));
-                }
-                for (auto c : cons->second[decoded_msg.channel])
+                for (const auto& c : routes->kb_routes.routes(slot))
                 {
-                    _event_dispatcher->post_event(make_note_aftertouch_event(c, decoded_msg, timestamp));
+                    _send_event(make_note_aftertouch_event(c, decoded_msg, event_time));
                 }
             }
             break;
@@ -682,16 +798,11 @@ void MidiDispatcher::send_midi(int port, MidiDataByte data, Time timestamp)
         case midi::MessageType::CHANNEL_PRESSURE:
         {
             midi::ChannelPressureMessage decoded_msg = midi::decode_channel_pressure(data);
-            const auto& cons = _kb_routes_in.find(port);
-            if (cons != _kb_routes_in.end())
+            for (auto slot : {channel_slots[0], channel_slot(port, decoded_msg.channel)})
             {
-                for (auto c : cons->second[midi::MidiChannel::OMNI])
+                for (const auto& c : routes->kb_routes.routes(slot))
                 {
-                    _event_dispatcher->post_event(make_aftertouch_event(c, decoded_msg, timestamp));
-                }
-                for (auto c : cons->second[decoded_msg.channel])
-                {
-                    _event_dispatcher->post_event( make_aftertouch_event(c, decoded_msg, timestamp));
+                    _send_event(make_aftertouch_event(c, decoded_msg, event_time));
                 }
             }
             break;
@@ -700,16 +811,9 @@ void MidiDispatcher::send_midi(int port, MidiDataByte data, Time timestamp)
         case midi::MessageType::PROGRAM_CHANGE:
         {
             midi::ProgramChangeMessage decoded_msg = midi::decode_program_change(data);
-
-            std::scoped_lock lock(_pc_routes_lock);
-            const auto& cons = _pc_routes.find(port);
-            if (cons != _pc_routes.end())
+            for (auto slot : {channel_slots[0], channel_slot(port, decoded_msg.channel)})
             {
-                for (auto c : cons->second[midi::MidiChannel::OMNI])
-                {
-                    _event_dispatcher->post_event(make_program_change_event(c, decoded_msg, timestamp));
-                }
-                for (auto c : cons->second[decoded_msg.channel])
+                for (const auto& c : routes->pc_routes.routes(slot))
                 {
                     _event_dispatcher->post_event(make_program_change_event(c, decoded_msg, timestamp));
                 }
@@ -722,6 +826,43 @@ void MidiDispatcher::send_midi(int port, MidiDataByte data, Time timestamp)
     }
 }
 
+void MidiDispatcher::set_midi_inputs(int no_inputs)
+{
+    std::scoped_lock lock(_routes_in_lock);
+    _midi_inputs = no_inputs;
+    _relative_cc_values.reset(new std::atomic<uint8_t>[cc_slot(no_inputs, 0, 0)]);
+    for (int i = 0; i < cc_slot(no_inputs, 0, 0); ++i)
+    {
+        _relative_cc_values[i] = 64;
+    }
+    _publish_input_routes();
+}
+
+void MidiDispatcher::_publish_input_routes()
+{
+    const int inputs = _midi_inputs;
+    auto channel_table = [inputs](const auto& route_map)
+    {
+        return RouteTable<InputConnection>(channel_slot(inputs, 0), [&](int slot) -> const std::vector<InputConnection>*
+        {
+            const auto& input = route_map.find(slot / MIDI_CHANNEL_SLOTS);
+            return input != route_map.end() ? &input->second[slot % MIDI_CHANNEL_SLOTS] : nullptr;
+        });
+    };
+
+    auto routes = std::make_unique<MidiInputRoutes>();
+    routes->kb_routes = channel_table(_kb_routes_in);
+    routes->raw_routes = channel_table(_raw_routes_in);
+    routes->pc_routes = channel_table(_pc_routes);
+    routes->cc_routes = RouteTable<InputConnection>(cc_slot(inputs, 0, 0), [&](int slot) -> const std::vector<InputConnection>*
+    {
+        const auto& input = _cc_routes.find(slot / (MIDI_CC_SLOTS * MIDI_CHANNEL_SLOTS));
+        return input != _cc_routes.end() ? &input->second[(slot / MIDI_CHANNEL_SLOTS) % MIDI_CC_SLOTS][slot % MIDI_CHANNEL_SLOTS] : nullptr;
+    });
+    routes->relative_cc_values = _relative_cc_values;
+    _input_routes.publish(std::move(routes));
+}
+
 int MidiDispatcher::process(Event* event)
 {
     if (event->is_keyboard_event())
@@ -760,6 +901,7 @@ int MidiDispatcher::process(Event* event)
                 SUSHI_LOG_DEBUG("Dispatching midi [{:x} {:x} {:x} {:x}], timestamp: {}",
                                 midi_data[0], midi_data[1], midi_data[2], midi_data[3], event->time().count());
                 _frontend->send_midi(c.output, midi_data, event->time());
+                _sent_counter->increment();
             }
         }
         return EventStatus::HANDLED_OK;
@@ -776,7 +918,7 @@ std::vector<CCInputConnection> MidiDispatcher::_get_cc_input_connections(std::op
 {
     std::vector<CCInputConnection> returns;
 
-    std::scoped_lock lock(_cc_routes_lock);
+    std::scoped_lock lock(_routes_in_lock);
 
     for(auto input_i = _cc_routes.begin(); input_i != _cc_routes.end(); ++input_i)
     {
@@ -811,7 +953,7 @@ std::vector<PCInputConnection> MidiDispatcher::_get_pc_input_connections(std::op
 {
     std::vector<PCInputConnection> returns;
 
-    std::scoped_lock lock(_pc_routes_lock);
+    std::scoped_lock lock(_routes_in_lock);
 
     for(auto inputs_i = _pc_routes.begin(); inputs_i != _pc_routes.end(); ++inputs_i)
     {
@@ -26,18 +26,25 @@
 #include <array>
 #include <vector>
 #include <mutex>
+#include <atomic>
+#include <memory>
 
 #include "library/constants.h"
 #include "library/types.h"
 #include "library/midi_decoder.h"
+#include "library/rcu_pointer.h"
 #include "library/event.h"
 #include "library/processor.h"
 #include "control_frontends/base_midi_frontend.h"
+#include "engine/midi_route_table.h"
 #include "library/event_interface.h"
+#include "library/metrics.h"
+#include "library/event_tracer.h"
 
 namespace sushi {
 namespace engine {
 class BaseProcessorContainer;
+class RtInputQueue;
 }
 
 namespace midi_dispatcher {
@@ -55,6 +62,19 @@ struct InputConnection
     uint8_t virtual_abs_value;
 };
 
+/**
+ * @brief Immutable snapshot of all midi input routes. Keyboard, raw midi and program change
+ *        routes are indexed by channel_slot() and control change routes by cc_slot().
+ */
+struct MidiInputRoutes
+{
+    RouteTable<InputConnection> kb_routes;
+    RouteTable<InputConnection> raw_routes;
+    RouteTable<InputConnection> pc_routes;
+    RouteTable<InputConnection> cc_routes;
+    std::shared_ptr<std::atomic<uint8_t>[]> relative_cc_values;
+};
+
 struct OutputConnection
 {
     int channel;
@@ -111,7 +131,7 @@ class MidiDispatcher : public EventPoster, public midi_receiver::MidiReceiver
     SUSHI_DECLARE_NON_COPYABLE(MidiDispatcher);
 
 public:
-    MidiDispatcher(dispatcher::BaseEventDispatcher* event_dispatcher);
+    MidiDispatcher(dispatcher::BaseEventDispatcher* event_dispatcher, performance::MetricsScope& metrics);
 
     virtual ~MidiDispatcher();
 
@@ -120,15 +140,29 @@ public:
         _frontend = frontend;
     }
 
+    /**
+     * @brief Enable the direct realtime input path. Incoming midi is then decoded
+     *        into RtEvents and pushed directly to the audio thread through the given
+     *        queue instead of going through the event dispatcher. Program changes,
+     *        which are not handled in the realtime thread, still use the dispatcher.
+     *        send_midi() must only be called from a single thread when enabled and
+     *        the queue should be set before the midi frontend is started.
+     * @param queue The queue to send events to, or nullptr to disable the realtime path.
+     * @param event_tracer The tracer of the engine owning the queue, events on the
+     *        realtime path are only traced if set.
+     */
+    void set_rt_input_queue(engine::RtInputQueue* queue, performance::EventTracer* event_tracer = nullptr)
+    {
+        _rt_event_tracer = event_tracer;
+        _rt_input_queue = queue;
+    }
+
     /**
      * @brief Sets the number of midi input ports.
      * Not intended to be called dynamically, only once during creation.
      * @param ports number of input ports.
      */
-    void set_midi_inputs(int no_inputs)
-    {
-        _midi_inputs = no_inputs;
-    }
+    void set_midi_inputs(int no_inputs);
 
     /**
      * @brief Returns the number of midi input ports.
@@ -351,6 +385,15 @@ public:
     int poster_id() override {return EventPosterId::MIDI_DISPATCHER;}
 
 private:
+    template <typename EventTime>
+    void _dispatch_midi(int port, MidiDataByte data, Time timestamp, EventTime event_time);
+
+    void _send_event(Event* event);
+    void _send_event(const RtEvent& event);
+
+    /* Rebuild the input route snapshot from the route maps, must be called with _routes_in_lock held */
+    void _publish_input_routes();
+
     bool _handle_audio_graph_notification(const EngineNotificationEvent* typed_event);
 
     std::vector<CCInputConnection> _get_cc_input_connections(std::optional<int> processor_id_filter);
@@ -364,14 +407,22 @@ private:
     int _midi_inputs{0};
     int _midi_outputs{0};
 
-    std::mutex _kb_routes_in_lock;
+    /* Guards the input route maps above, which are only used for editing and querying
+     * routes. Incoming midi is routed using _input_routes, which is read without locking */
+    std::mutex _routes_in_lock;
     std::mutex _kb_routes_out_lock;
-    std::mutex _cc_routes_lock;
-    std::mutex _pc_routes_lock;
-    std::mutex _raw_routes_in_lock;
+
+    RcuPointer<MidiInputRoutes> _input_routes{std::make_unique<MidiInputRoutes>()};
+    std::shared_ptr<std::atomic<uint8_t>[]> _relative_cc_values;
 
     midi_frontend::BaseMidiFrontend* _frontend;
     dispatcher::BaseEventDispatcher* _event_dispatcher;
+    std::atomic<engine::RtInputQueue*> _rt_input_queue{nullptr};
+    performance::EventTracer* _rt_event_tracer{nullptr};
+
+    performance::Counter* _received_counter;
+    performance::Counter* _sent_counter;
+    performance::Counter* _dropped_counter;
 };
 
 } // end namespace midi_dispatcher
@@ -0,0 +1,108 @@
+/*
+ * Copyright 2017-2021 Modern Ancient Instruments Networked AB, dba Elk
+ *
+ * SUSHI is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU Affero General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * SUSHI is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along with
+ * SUSHI.  If not, see http://www.gnu.org/licenses/
+ */
+
+/**
+ * @brief Flat, immutable lookup tables for midi input routing
+ * @copyright 2017-2021 Modern Ancient Instruments Networked AB, dba Elk, Stockholm
+ */
+
+#ifndef SUSHI_MIDI_ROUTE_TABLE_H
+#define SUSHI_MIDI_ROUTE_TABLE_H
+
+#include <vector>
+
+#include "library/midi_decoder.h"
+
+namespace sushi {
+namespace midi_dispatcher {
+
+constexpr int MIDI_CHANNEL_SLOTS = midi::MidiChannel::OMNI + 1;
+constexpr int MIDI_CC_SLOTS = midi::MAX_CONTROLLER_NO + 1;
+
+/**
+ * @brief Connections stored contiguously and indexed by an integer slot number.
+ *        Looking up the connections of a slot is a constant time operation.
+ */
+template <typename Connection>
+class RouteTable
+{
+public:
+    class Range
+    {
+    public:
+        Range(const Connection* begin, const Connection* end) : _begin(begin), _end(end) {}
+        const Connection* begin() const {return _begin;}
+        const Connection* end() const {return _end;}
+        bool empty() const {return _begin == _end;}
+
+    private:
+        const Connection* _begin;
+        const Connection* _end;
+    };
+
+    RouteTable() = default;
+
+    /**
+     * @brief Build a table
+     * @param slot_count The number of slots in the table
+     * @param connections_for_slot Callable with the signature const std::vector<Connection>* (int slot)
+     *        returning the connections for a slot, or nullptr if it has none.
+     */
+    template <typename SlotFunction>
+    RouteTable(int slot_count, SlotFunction&& connections_for_slot) : _offsets(slot_count + 1, 0)
+    {
+        for (int slot = 0; slot < slot_count; ++slot)
+        {
+            _offsets[slot] = static_cast<int>(_connections.size());
+            auto connections = connections_for_slot(slot);
+            if (connections != nullptr)
+            {
+                _connections.insert(_connections.end(), connections->begin(), connections->end());
+            }
+        }
+        _offsets[slot_count] = static_cast<int>(_connections.size());
+    }
+
+    /**
+     * @brief Get the connections of a slot, slots outside of the table have no connections
+     */
+    Range routes(int slot) const
+    {
+        if (slot < 0 || slot + 1 >= static_cast<int>(_offsets.size()))
+        {
+            return Range(nullptr, nullptr);
+        }
+        return Range(_connections.data() + _offsets[slot], _connections.data() + _offsets[slot + 1]);
+    }
+
+private:
+    std::vector<Connection> _connections;
+    std::vector<int>        _offsets;
+};
+
+inline int channel_slot(int input, int channel)
+{
+    return input * MIDI_CHANNEL_SLOTS + channel;
+}
+
+inline int cc_slot(int input, int cc, int channel)
+{
+    return (input * MIDI_CC_SLOTS + cc) * MIDI_CHANNEL_SLOTS + channel;
+}
+
+} // end namespace midi_dispatcher
+} // end namespace sushi
+
+#endif //SUSHI_MIDI_ROUTE_TABLE_H
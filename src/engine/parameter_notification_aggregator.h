@@ -0,0 +1,129 @@
+/*
+ * Copyright 2017-2021 Modern Ancient Instruments Networked AB, dba Elk
+ *
+ * SUSHI is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU Affero General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * SUSHI is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along with
+ * SUSHI.  If not, see http://www.gnu.org/licenses/
+ */
+
+/**
+ * @brief Coalescing of parameter change notifications for rate limited listeners
+ * @copyright 2017-2021 Modern Ancient Instruments Networked AB, dba Elk, Stockholm
+ */
+
+#ifndef SUSHI_PARAMETER_NOTIFICATION_AGGREGATOR_H
+#define SUSHI_PARAMETER_NOTIFICATION_AGGREGATOR_H
+
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "library/event.h"
+
+namespace sushi {
+namespace dispatcher {
+
+/**
+ * @brief Keeps the latest value of every parameter that changed since the last flush.
+ *        Repeated notifications for the same parameter only overwrite the stored value,
+ *        so the cost of a flush depends on the number of changed parameters and not on
+ *        the number of notifications received. Not thread safe, intended to be owned
+ *        and called from the event dispatcher thread only.
+ */
+class ParameterNotificationAggregator
+{
+public:
+    /**
+     * @brief Store the value of a notification, replacing any earlier unflushed value
+     *        for the same processor and parameter.
+     * @param event The notification to aggregate, the aggregator does not take ownership
+     */
+    void add(const ParameterChangeNotificationEvent* event)
+    {
+        auto& entry = _entries[_key(event->processor_id(), event->parameter_id())];
+        if (entry.dirty == false)
+        {
+            entry.dirty = true;
+            entry.processor_id = event->processor_id();
+            entry.parameter_id = event->parameter_id();
+            _dirty_entries.push_back(&entry);
+        }
+        entry.subtype = event->subtype();
+        entry.value = event->float_value();
+        entry.timestamp = event->time();
+    }
+
+    /**
+     * @brief Discard all stored values for a processor, including unflushed ones.
+     *        Called when a processor is deleted so that its entries don't accumulate.
+     * @param processor_id The id of the deleted processor
+     */
+    void remove_processor(ObjectId processor_id)
+    {
+        _dirty_entries.erase(std::remove_if(_dirty_entries.begin(), _dirty_entries.end(),
+                                            [&](const Entry* e) {return e->processor_id == processor_id;}),
+                             _dirty_entries.end());
+        for (auto i = _entries.begin(); i != _entries.end();)
+        {
+            i = i->second.processor_id == processor_id ? _entries.erase(i) : std::next(i);
+        }
+    }
+
+    bool empty() const {return _dirty_entries.empty();}
+
+    /**
+     * @brief Call handler once for every parameter that changed since the last flush,
+     *        in the order the parameters first changed, and clear the dirty set.
+     * @param handler Callable with the signature void(Event* event). The event is only
+     *        valid for the duration of the call.
+     */
+    template <typename Handler>
+    void flush(Handler&& handler)
+    {
+        for (auto entry : _dirty_entries)
+        {
+            ParameterChangeNotificationEvent event(entry->subtype,
+                                                   entry->processor_id,
+                                                   entry->parameter_id,
+                                                   entry->value,
+                                                   entry->timestamp);
+            entry->dirty = false;
+            handler(&event);
+        }
+        _dirty_entries.clear();
+    }
+
+private:
+    struct Entry
+    {
+        ParameterChangeNotificationEvent::Subtype subtype;
+        ObjectId processor_id;
+        ObjectId parameter_id;
+        float    value;
+        Time     timestamp;
+        bool     dirty{false};
+    };
+
+    static uint64_t _key(ObjectId processor_id, ObjectId parameter_id)
+    {
+        return static_cast<uint64_t>(processor_id) << 32u | static_cast<uint64_t>(parameter_id);
+    }
+
+    // Pointers to map elements stay valid across rehashing, entries are only erased
+    // together with their pointer in _dirty_entries
+    std::unordered_map<uint64_t, Entry> _entries;
+    std::vector<Entry*>                 _dirty_entries;
+};
+
+} // end namespace dispatcher
+} // end namespace sushi
+
+#endif //SUSHI_PARAMETER_NOTIFICATION_AGGREGATOR_H
@@ -0,0 +1,140 @@
+/*
+ * Copyright 2017-2021 Modern Ancient Instruments Networked AB, dba Elk
+ *
+ * SUSHI is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU Affero General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * SUSHI is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along with
+ * SUSHI.  If not, see http://www.gnu.org/licenses/
+ */
+
+/**
+ * @brief Realtime safe grouping of RtEvents per target processor so that all events
+ *        for one processor can be delivered in a single batch.
+ * @copyright 2017-2021 Modern Ancient Instruments Networked AB, dba Elk, Stockholm
+ */
+
+#ifndef SUSHI_RT_EVENT_BATCHER_H
+#define SUSHI_RT_EVENT_BATCHER_H
+
+#include <array>
+#include <vector>
+#include <cassert>
+
+#include "library/rt_event.h"
+#include "library/rt_event_fifo.h"
+
+namespace sushi {
+namespace engine {
+
+/**
+ * @brief Collects RtEvents and sorts them by target processor with a counting sort
+ *        pass. Events to the same processor keep their arrival order. All storage
+ *        is allocated on construction, add() and dispatch() never allocate.
+ * @tparam capacity The maximum number of events that can be held before dispatch().
+ */
+template <int capacity = MAX_EVENTS_IN_QUEUE>
+class RtEventBatcher
+{
+public:
+    /**
+     * @brief Create a batcher
+     * @param max_processor_id Events can only be added for processor ids below this value
+     */
+    explicit RtEventBatcher(int max_processor_id) : _slot_lookup(max_processor_id, NO_SLOT) {}
+
+    /**
+     * @brief Add an event to the current batch
+     * @param event The event to add, its processor_id() must be below max_processor_id
+     * @return true if the event was added, false if the batch is full
+     */
+    bool add(const RtEvent& event)
+    {
+        if (_event_count >= capacity)
+        {
+            return false;
+        }
+        auto id = event.processor_id();
+        assert(id < _slot_lookup.size());
+        int slot = _slot_lookup[id];
+        if (slot == NO_SLOT)
+        {
+            slot = _target_count++;
+            _slot_lookup[id] = slot;
+            _targets[slot] = id;
+            _target_event_counts[slot] = 0;
+        }
+        _target_event_counts[slot]++;
+        _event_slots[_event_count] = slot;
+        _events[_event_count++] = event;
+        return true;
+    }
+
+    bool full() const {return _event_count >= capacity;}
+
+    bool empty() const {return _event_count == 0;}
+
+    /**
+     * @brief Deliver all events added since the last call, grouped per target, and clear
+     *        the batch. Targets are visited in the order they were first seen.
+     * @param handler Callable with the signature void(ObjectId target, RtEventSpan events)
+     */
+    template <typename Handler>
+    void dispatch(Handler&& handler)
+    {
+        if (_target_count == 1)
+        {
+            // Single target, events are already in order and no sort pass is needed
+            handler(_targets[0], RtEventSpan(_events.data(), _event_count));
+        }
+        else if (_target_count > 1)
+        {
+            int offset = 0;
+            for (int slot = 0; slot < _target_count; ++slot)
+            {
+                _target_offsets[slot] = offset;
+                offset += _target_event_counts[slot];
+            }
+            for (int i = 0; i < _event_count; ++i)
+            {
+                _sorted_events[_target_offsets[_event_slots[i]]++] = _events[i];
+            }
+            // After the scatter pass each offset points to the end of its target's range
+            for (int slot = 0; slot < _target_count; ++slot)
+            {
+                int count = _target_event_counts[slot];
+                handler(_targets[slot], RtEventSpan(&_sorted_events[_target_offsets[slot] - count], count));
+            }
+        }
+        for (int slot = 0; slot < _target_count; ++slot)
+        {
+            _slot_lookup[_targets[slot]] = NO_SLOT;
+        }
+        _target_count = 0;
+        _event_count = 0;
+    }
+
+private:
+    static constexpr int NO_SLOT = -1;
+
+    std::array<RtEvent, capacity>   _events;
+    std::array<RtEvent, capacity>   _sorted_events;
+    std::array<int, capacity>       _event_slots;
+    std::array<ObjectId, capacity>  _targets;
+    std::array<int, capacity>       _target_event_counts;
+    std::array<int, capacity>       _target_offsets;
+    std::vector<int>                _slot_lookup;
+
+    int _event_count{0};
+    int _target_count{0};
+};
+
+} // namespace engine
+} // namespace sushi
+
+#endif //SUSHI_RT_EVENT_BATCHER_H
@@ -0,0 +1,91 @@
+/*
+ * Copyright 2017-2021 Modern Ancient Instruments Networked AB, dba Elk
+ *
+ * SUSHI is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU Affero General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * SUSHI is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along with
+ * SUSHI.  If not, see http://www.gnu.org/licenses/
+ */
+
+/**
+ * @brief Lock free queue for sending RtEvents directly to the audio thread, bypassing
+ *        the event dispatcher.
+ * @copyright 2017-2021 Modern Ancient Instruments Networked AB, dba Elk, Stockholm
+ */
+
+#ifndef SUSHI_RT_INPUT_QUEUE_H
+#define SUSHI_RT_INPUT_QUEUE_H
+
+#include "engine/event_timer.h"
+#include "library/constants.h"
+#include "library/rt_event_fifo.h"
+
+namespace sushi {
+namespace engine {
+
+/**
+ * @brief Single producer, single consumer queue of RtEvents into the audio thread.
+ *        The producer converts timestamps to sample offsets itself, using the chunk
+ *        time published by the audio thread, so events do not have to pass through
+ *        the event dispatcher thread. Intended for a single input thread, i.e. a
+ *        midi frontend.
+ */
+class RtInputQueue
+{
+public:
+    explicit RtInputQueue(float sample_rate) : _timer(sample_rate) {}
+
+    /**
+     * @brief Convert a timestamp to a sample offset in the next chunk to be processed.
+     *        Timestamps that lie in the past are mapped to the start of the chunk and
+     *        timestamps beyond the next chunk are mapped to the end of it.
+     *        Note that this differs from events sent through the event dispatcher,
+     *        which holds events with future timestamps until the chunk they belong
+     *        to. Events pushed here are always delivered in the next chunk, so this
+     *        queue is only suited to input that is timestamped when it arrives.
+     *        Called from the producer thread.
+     * @param timestamp A real time timestamp
+     * @return A sample offset between 0 and AUDIO_CHUNK_SIZE - 1
+     */
+    int sample_offset(Time timestamp)
+    {
+        auto [send_now, offset] = _timer.sample_offset_from_realtime(timestamp);
+        return send_now ? offset : AUDIO_CHUNK_SIZE - 1;
+    }
+
+    /**
+     * @brief Push an event to the audio thread. Called from the producer thread.
+     * @return false if the queue is full
+     */
+    bool push(const RtEvent& event) {return _queue.push(event);}
+
+    /**
+     * @brief Retrieve the next event. Called from the audio thread.
+     * @return false if the queue is empty
+     */
+    bool pop(RtEvent& event) {return _queue.pop(event);}
+
+    /**
+     * @brief Called from the audio thread when all events for the current chunk
+     *        have been retrieved.
+     * @param timestamp The time when the currently processed chunk is outputted
+     */
+    void set_time(Time timestamp) {_timer.set_incoming_time(timestamp);}
+
+    void set_sample_rate(float sample_rate) {_timer.set_sample_rate(sample_rate);}
+
+private:
+    event_timer::EventTimer _timer;
+    RtSafeRtEventFifo       _queue;
+};
+
+} // end namespace engine
+} // end namespace sushi
+
+#endif //SUSHI_RT_INPUT_QUEUE_H
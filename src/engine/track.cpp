@@ -20,6 +20,8 @@
 
 #include <cassert>
 
+#include "twine/twine.h"
+
 #include "track.h"
 #include "logging.h"
 #include "library/constants.h"
@@ -157,7 +159,7 @@ bool Track::remove(ObjectId processor)
 
 void Track::render()
 {
-    auto track_timestamp = _timer->start_timer();
+    auto track_timestamp = twine::current_rt_time();
 
     process_audio(_input_buffer, _output_buffer);
     for (int bus = 0; bus < _output_busses; ++bus)
@@ -167,7 +169,8 @@ void Track::render()
     }
     _input_buffer.clear();
 
-    _timer->stop_timer_rt_safe(track_timestamp, this->id());
+    _render_profile.render_time = twine::current_rt_time() - track_timestamp;
+    _stop_timer(track_timestamp, this->id());
 }
 
 void Track::process_audio(const ChunkSampleBuffer& /*in*/, ChunkSampleBuffer& out)
@@ -179,10 +182,29 @@ void Track::process_audio(const ChunkSampleBuffer& /*in*/, ChunkSampleBuffer& ou
      * _input_buffer  */
     ChunkSampleBuffer aliased_in = ChunkSampleBuffer::create_non_owning_buffer(_input_buffer);
     ChunkSampleBuffer aliased_out = ChunkSampleBuffer::create_non_owning_buffer(out);
+    _render_profile.slowest_processor_time = performance::TimePoint(0);
+
+    /* Processors are only read from the clock when timings or tracing are enabled.
+     * With a sampling interval, processor n is timed when (chunk + n) is a multiple
+     * of it. Processors that are not timed in this chunk are not read from the clock
+     * and don't take part in the render profile either */
+    bool timed = _timer->enabled() || _timer->tracing_enabled();
+    int sampling_interval = _timer->tracing_enabled() ? 1 : _timer->processor_sampling_interval();
+    int sample_index = static_cast<int>(_rendered_chunks % static_cast<uint32_t>(sampling_interval));
+    _rendered_chunks++;
 
     for (auto &processor : _processors)
     {
-        auto processor_timestamp = _timer->start_timer();
+        bool sampled = timed && sample_index == 0;
+        if (++sample_index == sampling_interval)
+        {
+            sample_index = 0;
+        }
+        performance::TimePoint processor_timestamp{0};
+        if (sampled)
+        {
+            processor_timestamp = twine::current_rt_time();
+        }
         while (!_kb_event_buffer.empty())
         {
             RtEvent event;
@@ -195,7 +217,17 @@ void Track::process_audio(const ChunkSampleBuffer& /*in*/, ChunkSampleBuffer& ou
         ChunkSampleBuffer proc_out = ChunkSampleBuffer::create_non_owning_buffer(aliased_out, 0, processor->output_channels());
         processor->process_audio(proc_in, proc_out);
         std::swap(aliased_in, aliased_out);
-        _timer->stop_timer_rt_safe(processor_timestamp, processor->id());
+
+        if (sampled)
+        {
+            auto processor_time = twine::current_rt_time() - processor_timestamp;
+            if (processor_time > _render_profile.slowest_processor_time)
+            {
+                _render_profile.slowest_processor = processor->id();
+                _render_profile.slowest_processor_time = processor_time;
+            }
+            _stop_timer(processor_timestamp, processor->id());
+        }
     }
 
     int output_channels = _processors.empty() ? _current_output_channels : _processors.back()->output_channels();
@@ -40,6 +40,7 @@ namespace engine {
 /* No real technical limit, just something arbitrarily high enough */
 constexpr int TRACK_MAX_CHANNELS = 10;
 constexpr int TRACK_MAX_BUSSES = TRACK_MAX_CHANNELS / 2;
+constexpr int NO_RT_WORKER = -1;
 
 class Track : public InternalPlugin, public RtEventPipe
 {
@@ -153,6 +154,36 @@ public:
      */
     void render();
 
+    /**
+     * @brief Set the index of the realtime worker thread that renders this track, timings
+     *        are then recorded without locking. Set to NO_RT_WORKER if not rendered by
+     *        a dedicated worker.
+     * @param worker The worker index
+     */
+    void set_rt_worker(int worker)
+    {
+        _rt_worker = worker;
+    }
+
+    /**
+     * @brief Processing times from the last call to render(), so slow nodes can be
+     *        reported on xruns. The render time of the track is always recorded, the
+     *        slowest processor only when timings or tracing are enabled. With a
+     *        processor sampling interval, only the processors timed in the last chunk
+     *        are candidates for the slowest processor.
+     */
+    struct RenderProfile
+    {
+        performance::TimePoint render_time{0};
+        ObjectId slowest_processor{0};
+        performance::TimePoint slowest_processor_time{0};
+    };
+
+    const RenderProfile& last_render_profile() const
+    {
+        return _render_profile;
+    }
+
     /**
      * @brief Static render function for passing to a thread manager
      * @param arg Void* pointing to an instance of a Track.
@@ -186,6 +217,18 @@ public:
 
 private:
     void _common_init();
+
+    void _stop_timer(performance::TimePoint start_time, int node_id)
+    {
+        if (_rt_worker == NO_RT_WORKER)
+        {
+            _timer->stop_timer_rt_safe(start_time, node_id);
+        }
+        else
+        {
+            _timer->stop_timer(start_time, node_id, _rt_worker);
+        }
+    }
     void _update_channel_config();
     void _process_output_events();
     void _apply_pan_and_gain(ChunkSampleBuffer& buffer, int bus);
@@ -204,6 +247,9 @@ private:
     std::array<ValueSmootherFilter<float>, TRACK_MAX_BUSSES> _pan_gain_smoothers_left;
 
     performance::PerformanceTimer* _timer;
+    int _rt_worker{NO_RT_WORKER};
+    uint32_t _rendered_chunks{0};
+    RenderProfile _render_profile;
 
     RtSafeRtEventFifo _kb_event_buffer;
 };
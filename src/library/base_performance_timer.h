@@ -21,11 +21,25 @@
 #ifndef SUSHI_BASE_PERFORMANCE_TIMER_H
 #define SUSHI_BASE_PERFORMANCE_TIMER_H
 
+#include <cstdint>
 #include <optional>
+#include <functional>
+#include <string>
 
 namespace sushi {
 namespace performance {
 
+using TraceNodeNames = std::function<std::string(int id)>;
+
+struct LatencyPercentiles
+{
+    float p50{0};
+    float p90{0};
+    float p99{0};
+    float p99_9{0};
+    float max{0};
+};
+
 struct ProcessTimings
 {
     ProcessTimings() : avg_case{0.0f}, min_case{100.0f}, max_case{0.0f} {}
@@ -33,6 +47,10 @@ struct ProcessTimings
     float avg_case{1};
     float min_case{1};
     float max_case{0};
+    // Percentiles over the last ROLLING_WINDOW_INTERVALS evaluation intervals
+    LatencyPercentiles recent;
+    // Percentiles over all timings since the last reset
+    LatencyPercentiles since_reset;
 };
 
 class BasePerformanceTimer
@@ -59,12 +77,32 @@ public:
      */
     virtual void enable(bool enabled) = 0;
 
+    /**
+     * @brief Time processors only in every nth chunk to reduce the overhead of timings
+     * @param interval Time every processor once every interval chunks, 1 to time
+     *        processors in every chunk.
+     */
+    virtual void set_processor_sampling_interval(int interval) = 0;
+
     /**
      * @brief Query the enabled state
      * @return True if the timer is enabled, false otherwise
      */
     virtual bool enabled() = 0;
 
+    /**
+     * @brief Move timing records from the realtime queues now instead of waiting for
+     *        the next periodic update. Keeps the queues from overflowing when audio is
+     *        processed faster than realtime. Not realtime safe.
+     */
+    virtual void collect_timings() = 0;
+
+    /**
+     * @brief Get the number of timing records that were dropped because a queue was full
+     * @return The number of dropped records since the timer was created
+     */
+    virtual uint64_t dropped_timings() = 0;
+
     /**
      * @brief Get the recorded timings from a specific node
      * @param id An integer id representing a timing node
@@ -83,6 +121,26 @@ public:
      * @brief Reset all recorded timings
      */
     virtual void clear_all_timings() = 0;
+
+    /**
+     * @brief Enable or disable recording of a processing timeline
+     * @param enabled Enable tracing if true, disable if false
+     */
+    virtual void enable_tracing(bool enabled) = 0;
+
+    /**
+     * @brief Query the tracing state
+     * @return True if tracing is enabled, false otherwise
+     */
+    virtual bool tracing_enabled() = 0;
+
+    /**
+     * @brief Write the recorded timeline to a file in Chrome trace event format
+     * @param filename The file to write to
+     * @param node_names Function returning a display name for a node id
+     * @return true if the file was written, false otherwise
+     */
+    virtual bool write_trace_to_file(const std::string& filename, const TraceNodeNames& node_names) = 0;
 };
 
 
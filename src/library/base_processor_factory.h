@@ -32,7 +32,9 @@ public:
     virtual ~BaseProcessorFactory() = default;
 
     /**
-     * @brief Attempts to create a new Processor instance.
+     * @brief Attempts to create a new Processor instance. May be called concurrently
+     *        from several threads, factories that can't create instances in parallel
+     *        must serialize calls internally.
      * @param plugin_info
      * @param host_control
      * @param sample_rate
@@ -0,0 +1,96 @@
+/*
+ * Copyright 2017-2021 Modern Ancient Instruments Networked AB, dba Elk
+ *
+ * SUSHI is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU Affero General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * SUSHI is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along with
+ * SUSHI.  If not, see http://www.gnu.org/licenses/
+ */
+
+/**
+ * @brief Results of a headless benchmark run and their json representation.
+ * @copyright 2017-2021 Modern Ancient Instruments Networked AB, dba Elk, Stockholm
+ */
+
+#include "library/benchmark_report.h"
+
+namespace sushi {
+
+namespace {
+
+rapidjson::Value percentiles_to_json(const performance::LatencyPercentiles& percentiles,
+                                     rapidjson::Document::AllocatorType& allocator)
+{
+    rapidjson::Value obj(rapidjson::kObjectType);
+    obj.AddMember("p50", percentiles.p50, allocator);
+    obj.AddMember("p90", percentiles.p90, allocator);
+    obj.AddMember("p99", percentiles.p99, allocator);
+    obj.AddMember("p99_9", percentiles.p99_9, allocator);
+    obj.AddMember("max", percentiles.max, allocator);
+    return obj;
+}
+
+rapidjson::Value node_to_json(int id,
+                              const std::string& name,
+                              performance::BasePerformanceTimer* timer,
+                              rapidjson::Document::AllocatorType& allocator)
+{
+    rapidjson::Value obj(rapidjson::kObjectType);
+    obj.AddMember("id", id, allocator);
+    obj.AddMember("name", rapidjson::Value(name.c_str(), allocator).Move(), allocator);
+    auto timings = timer->timings_for_node(id);
+    if (timings.has_value())
+    {
+        obj.AddMember("avg", timings->avg_case, allocator);
+        obj.AddMember("min", timings->min_case, allocator);
+        obj.AddMember("max", timings->max_case, allocator);
+        obj.AddMember("percentiles", percentiles_to_json(timings->since_reset, allocator).Move(), allocator);
+    }
+    return obj;
+}
+
+} // anonymous namespace
+
+rapidjson::Document generate_benchmark_document(const BenchmarkResult& result,
+                                                sushi::ext::SushiControl* engine_controller,
+                                                performance::BasePerformanceTimer* timer)
+{
+    rapidjson::Document document;
+    document.SetObject();
+    rapidjson::Document::AllocatorType& allocator = document.GetAllocator();
+
+    document.AddMember("chunks", result.chunks, allocator);
+    document.AddMember("sample_rate", result.sample_rate, allocator);
+    document.AddMember("audio_time_s", std::chrono::duration<double>(result.audio_time).count(), allocator);
+    document.AddMember("render_time_s", std::chrono::duration<double>(result.render_time).count(), allocator);
+    document.AddMember("realtime_factor", result.realtime_factor(), allocator);
+    document.AddMember("dropped_timings", result.dropped_timings, allocator);
+
+    /* All loads are expressed as fractions of the chunk period */
+    document.AddMember("chunk_load", percentiles_to_json(result.chunk_loads.percentiles(), allocator).Move(), allocator);
+
+    rapidjson::Value tracks(rapidjson::kArrayType);
+    auto graph_controller = engine_controller->audio_graph_controller();
+    for (const auto& track : graph_controller->get_all_tracks())
+    {
+        auto track_obj = node_to_json(track.id, track.name, timer, allocator);
+        rapidjson::Value processors(rapidjson::kArrayType);
+        for (const auto& processor : graph_controller->get_track_processors(track.id).second)
+        {
+            processors.PushBack(node_to_json(processor.id, processor.name, timer, allocator).Move(), allocator);
+        }
+        track_obj.AddMember("processors", processors.Move(), allocator);
+        tracks.PushBack(track_obj.Move(), allocator);
+    }
+    document.AddMember("tracks", tracks.Move(), allocator);
+
+    return document;
+}
+
+} // end namespace sushi
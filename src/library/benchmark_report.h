@@ -0,0 +1,67 @@
+/*
+ * Copyright 2017-2021 Modern Ancient Instruments Networked AB, dba Elk
+ *
+ * SUSHI is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU Affero General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * SUSHI is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along with
+ * SUSHI.  If not, see http://www.gnu.org/licenses/
+ */
+
+/**
+ * @brief Results of a headless benchmark run and their json representation.
+ * @copyright 2017-2021 Modern Ancient Instruments Networked AB, dba Elk, Stockholm
+ */
+
+#ifndef SUSHI_BENCHMARK_REPORT_H
+#define SUSHI_BENCHMARK_REPORT_H
+
+#include <chrono>
+
+#include "control_interface.h"
+#include "library/base_performance_timer.h"
+#include "library/latency_histogram.h"
+#include "rapidjson/document.h"
+
+namespace sushi {
+
+struct BenchmarkResult
+{
+    int chunks{0};
+    float sample_rate{0};
+    // Duration of the rendered audio
+    std::chrono::nanoseconds audio_time{0};
+    // Wall clock time spent rendering it
+    std::chrono::nanoseconds render_time{0};
+    // Processing time of every chunk as a fraction of the chunk period
+    performance::LatencyHistogram chunk_loads;
+    // Processor timings lost because the timer's queues were full, if non-zero the
+    // per node timings are incomplete
+    uint64_t dropped_timings{0};
+
+    float realtime_factor() const
+    {
+        return render_time.count() > 0 ? static_cast<float>(audio_time.count()) / render_time.count() : 0.0f;
+    }
+};
+
+/**
+ * @brief Generate a json document of benchmark results, including the cost of every
+ *        track and processor as recorded by the performance timer.
+ * @param result The result of the benchmark run
+ * @param engine_controller Used to look up tracks and processors
+ * @param timer A performance timer that was enabled during the run. Should be disabled
+ *        before calling this so that all timings are accounted for.
+ */
+rapidjson::Document generate_benchmark_document(const BenchmarkResult& result,
+                                                sushi::ext::SushiControl* engine_controller,
+                                                performance::BasePerformanceTimer* timer);
+
+} // end namespace sushi
+
+#endif //SUSHI_BENCHMARK_REPORT_H
@@ -167,6 +167,13 @@ Event* Event::from_rt_event(const RtEvent& rt_event, Time timestamp)
                                                             ClippingNotificationEvent::ClipChannelType::OUTPUT;
             return new ClippingNotificationEvent(typed_ev->channel(), channel_type, timestamp);
         }
+        case RtEventType::XRUN_NOTIFICATION:
+        {
+            auto slot = rt_event.xrun_notification_event()->report_slot();
+            auto event = new XrunNotificationEvent(slot->report, timestamp);
+            slot->release();
+            return event;
+        }
         default:
             return nullptr;
 
@@ -29,6 +29,7 @@
 #include "library/time.h"
 #include "library/types.h"
 #include "base_performance_timer.h"
+#include "xrun_monitor.h"
 
 namespace sushi {
 namespace dispatcher
@@ -78,6 +79,8 @@ public:
     Time        time() const {return _timestamp;}
     int         receiver() const {return _receiver;}
     EventId     id() const {return _id;}
+    /* Non-zero if the latency of the event is traced */
+    uint16_t    trace_id() const {return _trace_id;}
 
     /**
      * @brief Whether the event should be processes asynchronously in a low priority thread or not
@@ -122,6 +125,7 @@ protected:
 
     /* Only the dispatcher can set the receiver and call the completion callback */
     void                    set_receiver(int receiver) {_receiver = receiver;}
+    void                    set_trace_id(uint16_t trace_id) {_trace_id = trace_id;}
     EventCompletionCallback completion_cb() const {return _completion_cb;}
     void*                   callback_arg() const {return _callback_arg;}
 
@@ -131,6 +135,7 @@ private:
     EventCompletionCallback _completion_cb{nullptr};
     void*                   _callback_arg{nullptr};
     EventId                 _id{EventIdGenerator::new_id()};
+    uint16_t                _trace_id{0};
 };
 
 class KeyboardEvent : public Event
@@ -435,6 +440,9 @@ public:
     /* Convertible to TimingNotification */
     virtual bool is_timing_notification() const {return false;}
 
+    /* Convertible to XrunNotification */
+    virtual bool is_xrun_notification() const {return false;}
+
 protected:
     EngineNotificationEvent(Time timestamp) : Event(timestamp) {}
 };
@@ -556,6 +564,20 @@ private:
     performance::ProcessTimings _timings;
 };
 
+class XrunNotificationEvent : public EngineNotificationEvent
+{
+public:
+    XrunNotificationEvent(const performance::XrunReport& report,
+                          Time timestamp) : EngineNotificationEvent(timestamp),
+                                            _report(report) {}
+
+    bool is_xrun_notification() const override {return true;}
+    const performance::XrunReport& report() const {return _report;}
+
+private:
+    performance::XrunReport _report;
+};
+
 class AsynchronousWorkEvent : public Event
 {
 public:
@@ -0,0 +1,205 @@
+/*
+ * Copyright 2017-2021 Modern Ancient Instruments Networked AB, dba Elk
+ *
+ * SUSHI is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU Affero General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * SUSHI is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along with
+ * SUSHI.  If not, see http://www.gnu.org/licenses/
+ */
+
+/**
+ * @brief Tracing of control event latency from arrival to delivery in the audio thread
+ * @copyright 2017-2021 Modern Ancient Instruments Networked AB, dba Elk, Stockholm
+ */
+
+#include "event_tracer.h"
+
+namespace sushi {
+namespace performance {
+
+/* Traces that are not delivered within this time, i.e. the event was dropped or
+ * never reached a processor, are released */
+constexpr auto STALE_TRACE_TIME = std::chrono::seconds(1);
+
+namespace {
+
+struct ThreadSource
+{
+    TraceSource source{TraceSource::NONE};
+    Time arrival{0};
+};
+
+thread_local ThreadSource thread_source;
+
+float to_ms(Time time)
+{
+    return std::chrono::duration<float, std::milli>(time).count();
+}
+
+} // anonymous namespace
+
+EventTracer::EventTracer(MetricsScope& metrics)
+{
+    const std::vector<double> buckets = {0.0005, 0.001, 0.002, 0.005, 0.01, 0.02, 0.05, 0.1};
+    _exported_latencies[static_cast<int>(TraceSource::MIDI)] = metrics.histogram("sushi_midi_event_latency_seconds",
+                                        "Time from arrival of midi input until delivered to a processor", buckets);
+    _exported_latencies[static_cast<int>(TraceSource::OSC)] = metrics.histogram("sushi_osc_event_latency_seconds",
+                                        "Time from arrival of osc input until delivered to a processor", buckets);
+    _exported_latencies[static_cast<int>(TraceSource::GRPC)] = metrics.histogram("sushi_grpc_event_latency_seconds",
+                                        "Time from arrival of grpc input until delivered to a processor", buckets);
+    _dropped_traces = metrics.counter("sushi_event_traces_dropped_total", "Traced events that were never delivered");
+}
+
+void EventTracer::set_thread_source(TraceSource source, Time arrival_time)
+{
+    thread_source.source = source;
+    thread_source.arrival = arrival_time;
+}
+
+uint16_t EventTracer::begin_trace()
+{
+    if (enabled() == false || thread_source.source == TraceSource::NONE)
+    {
+        return 0;
+    }
+    int index = _next_slot.fetch_add(1, std::memory_order_relaxed) % MAX_TRACED_EVENTS;
+    auto& slot = _slots[index];
+    auto state = slot.state.load(std::memory_order_relaxed);
+    if (_state(state) != FREE)
+    {
+        return 0;
+    }
+    /* Generations run from 1, so no trace id is ever 0 */
+    int generation = _trace_id(state) >> TRACE_ID_INDEX_BITS;
+    generation = generation % ((1 << (16 - TRACE_ID_INDEX_BITS)) - 1) + 1;
+    auto trace_id = static_cast<uint16_t>(generation << TRACE_ID_INDEX_BITS | index);
+    if (slot.state.compare_exchange_strong(state, _slot_state(trace_id, CLAIMED), std::memory_order_acquire) == false)
+    {
+        return 0;
+    }
+    if (thread_source.arrival == IMMEDIATE_PROCESS)
+    {
+        thread_source.arrival = get_current_time();
+    }
+    slot.source = thread_source.source;
+    slot.arrival = thread_source.arrival;
+    slot.dispatched = thread_source.arrival;
+    slot.delivered = Time(0);
+    slot.state.store(_slot_state(trace_id, ACTIVE), std::memory_order_release);
+    return trace_id;
+}
+
+void EventTracer::mark_dispatched(uint16_t trace_id, Time time)
+{
+    if (trace_id == 0)
+    {
+        return;
+    }
+    auto& slot = _slots[_index(trace_id)];
+    if (slot.state.load(std::memory_order_acquire) == _slot_state(trace_id, ACTIVE))
+    {
+        slot.dispatched = time;
+    }
+}
+
+void EventTracer::mark_delivered(uint16_t trace_id, Time time)
+{
+    if (trace_id == 0)
+    {
+        return;
+    }
+    auto& slot = _slots[_index(trace_id)];
+    auto expected = _slot_state(trace_id, ACTIVE);
+    if (slot.state.compare_exchange_strong(expected, _slot_state(trace_id, COMPLETING), std::memory_order_acquire) == false)
+    {
+        return;
+    }
+    slot.delivered = time;
+    slot.state.store(_slot_state(trace_id, DELIVERED), std::memory_order_release);
+    /* If the queue is full the slot is released later as stale */
+    _delivered_queue.push(trace_id);
+}
+
+void EventTracer::collect()
+{
+    uint16_t trace_id;
+    while (_delivered_queue.pop(trace_id))
+    {
+        auto& slot = _slots[_index(trace_id)];
+        if (slot.state.load(std::memory_order_acquire) == _slot_state(trace_id, DELIVERED))
+        {
+            _add_latencies(slot);
+            slot.state.store(_slot_state(trace_id, FREE), std::memory_order_release);
+        }
+    }
+
+    auto now = get_current_time();
+    if (now - _last_stale_check > STALE_TRACE_TIME)
+    {
+        _release_stale_traces(now);
+        _last_stale_check = now;
+    }
+}
+
+LatencyPercentiles EventTracer::latency(TraceSource source, TraceSegment segment) const
+{
+    std::scoped_lock<std::mutex> lock(_histogram_lock);
+    return _histograms[static_cast<int>(source)][static_cast<int>(segment)].percentiles();
+}
+
+void EventTracer::clear_latencies()
+{
+    std::scoped_lock<std::mutex> lock(_histogram_lock);
+    for (auto& source : _histograms)
+    {
+        for (auto& histogram : source)
+        {
+            histogram.clear();
+        }
+    }
+}
+
+void EventTracer::_add_latencies(const TraceSlot& slot)
+{
+    /* Events can be scheduled ahead in time, or delivered in a chunk whose timestamp
+     * precedes the arrival, count these as 0 latency */
+    auto dispatch = std::max(slot.dispatched - slot.arrival, Time(0));
+    auto delivery = std::max(slot.delivered - slot.dispatched, Time(0));
+    auto total = std::max(slot.delivered - slot.arrival, Time(0));
+    int source = static_cast<int>(slot.source);
+    {
+        std::scoped_lock<std::mutex> lock(_histogram_lock);
+        auto& histograms = _histograms[source];
+        histograms[static_cast<int>(TraceSegment::DISPATCH)].add(to_ms(dispatch));
+        histograms[static_cast<int>(TraceSegment::DELIVERY)].add(to_ms(delivery));
+        histograms[static_cast<int>(TraceSegment::TOTAL)].add(to_ms(total));
+    }
+    if (_exported_latencies[source])
+    {
+        _exported_latencies[source]->observe(std::chrono::duration<double>(total).count());
+    }
+}
+
+void EventTracer::_release_stale_traces(Time now)
+{
+    for (auto& slot : _slots)
+    {
+        auto state = slot.state.load(std::memory_order_acquire);
+        if ((_state(state) == ACTIVE || _state(state) == DELIVERED) && now - slot.arrival > STALE_TRACE_TIME)
+        {
+            if (slot.state.compare_exchange_strong(state, _slot_state(_trace_id(state), FREE), std::memory_order_acq_rel))
+            {
+                _dropped_traces->increment();
+            }
+        }
+    }
+}
+
+} // namespace performance
+} // namespace sushi
@@ -0,0 +1,211 @@
+/*
+ * Copyright 2017-2021 Modern Ancient Instruments Networked AB, dba Elk
+ *
+ * SUSHI is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU Affero General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * SUSHI is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along with
+ * SUSHI.  If not, see http://www.gnu.org/licenses/
+ */
+
+/**
+ * @brief Tracing of control event latency from arrival to delivery in the audio thread
+ * @copyright 2017-2021 Modern Ancient Instruments Networked AB, dba Elk, Stockholm
+ */
+
+#ifndef SUSHI_EVENT_TRACER_H
+#define SUSHI_EVENT_TRACER_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+#include "fifo/circularfifo_memory_relaxed_aquire_release.h"
+
+#include "constants.h"
+#include "latency_histogram.h"
+#include "metrics.h"
+#include "time.h"
+
+namespace sushi {
+namespace performance {
+
+constexpr int MAX_TRACED_EVENTS = 1024;
+/* Trace ids carry the slot index in the low bits and a generation in the high bits */
+constexpr int TRACE_ID_INDEX_BITS = 10;
+static_assert(MAX_TRACED_EVENTS <= (1 << TRACE_ID_INDEX_BITS));
+
+enum class TraceSource
+{
+    NONE,
+    MIDI,
+    OSC,
+    GRPC,
+    NUMBER_OF_SOURCES
+};
+
+enum class TraceSegment
+{
+    /* From arrival until sent to the realtime queue, including any scheduling delay */
+    DISPATCH,
+    /* From sent to the realtime queue until delivered to a processor */
+    DELIVERY,
+    /* From arrival until delivered to a processor */
+    TOTAL,
+    NUMBER_OF_SEGMENTS
+};
+
+/**
+ * @brief Follows control events from the point where they arrive in Sushi until they are
+ *        delivered to a processor in the audio thread and collects the latencies in
+ *        histograms per event source.
+ *
+ *        Control frontends call set_thread_source() when input arrives. Events posted
+ *        from the same thread after that are traced when they map to an RtEvent. State
+ *        for every traced event is kept in a fixed size side table, and only a 16 bit
+ *        trace id is carried by the Event and RtEvent. The id holds the index into the
+ *        table and a generation that changes every time the slot is reused, so a late
+ *        delivery of an event whose trace was released as stale is ignored. The
+ *        delivery time is the timestamp of the audio chunk the event is delivered in.
+ *        Events are not traced if the table is full.
+ *
+ *        Every engine has its own tracer, as the audio thread of the engine is the
+ *        only thread that may mark events as delivered.
+ *
+ *        Latencies are kept in milliseconds and exported as metrics in seconds.
+ */
+class EventTracer
+{
+public:
+    SUSHI_DECLARE_NON_COPYABLE(EventTracer);
+
+    /**
+     * @param metrics Where to export latency metrics to
+     */
+    explicit EventTracer(MetricsScope& metrics);
+
+    void enable(bool enabled) {_enabled.store(enabled, std::memory_order_relaxed);}
+
+    bool enabled() const {return _enabled.load(std::memory_order_relaxed);}
+
+    /**
+     * @brief Set the source of events posted from the calling thread from now on
+     * @param source The control frontend the input came from
+     * @param arrival_time The time the input arrived. If IMMEDIATE_PROCESS, the time
+     *        the first event is traced is used.
+     */
+    static void set_thread_source(TraceSource source, Time arrival_time = IMMEDIATE_PROCESS);
+
+    /**
+     * @brief Start tracing an event posted from the calling thread. Not realtime safe.
+     * @return A trace id to attach to the event, 0 if the event should not be traced
+     */
+    uint16_t begin_trace();
+
+    /**
+     * @brief Record that a traced event is sent to the realtime queue. Must be called
+     *        from the thread that calls collect().
+     */
+    void mark_dispatched(uint16_t trace_id, Time time);
+
+    /**
+     * @brief Record that a traced event is delivered. Called from the audio thread of
+     *        the engine owning the tracer only.
+     * @param trace_id The trace id carried by the event
+     * @param time The timestamp of the audio chunk being processed
+     */
+    void mark_delivered(uint16_t trace_id, Time time);
+
+    /**
+     * @brief Add the latencies of delivered events to the histograms and release stale
+     *        traces. Not realtime safe, should be called periodically from one thread.
+     */
+    void collect();
+
+    /**
+     * @brief Latency percentiles in milliseconds for events from a source
+     */
+    LatencyPercentiles latency(TraceSource source, TraceSegment segment) const;
+
+    void clear_latencies();
+
+private:
+    enum SlotState : uint32_t
+    {
+        FREE,
+        CLAIMED,
+        ACTIVE,
+        COMPLETING,
+        DELIVERED
+    };
+
+    /* The state of a slot is stored together with the id of the trace using it, so
+     * that state changes made with an old trace id fail once the slot is reused */
+    struct TraceSlot
+    {
+        std::atomic<uint32_t> state{FREE};
+        TraceSource source;
+        Time arrival;
+        Time dispatched;
+        Time delivered;
+    };
+
+    static uint32_t _slot_state(uint16_t trace_id, SlotState state)
+    {
+        return static_cast<uint32_t>(trace_id) << 8 | state;
+    }
+
+    static SlotState _state(uint32_t slot_state) {return static_cast<SlotState>(slot_state & 0xff);}
+
+    static uint16_t _trace_id(uint32_t slot_state) {return static_cast<uint16_t>(slot_state >> 8);}
+
+    static int _index(uint16_t trace_id) {return trace_id & ((1 << TRACE_ID_INDEX_BITS) - 1);}
+
+    void _add_latencies(const TraceSlot& slot);
+
+    void _release_stale_traces(Time now);
+
+    std::atomic_bool _enabled{false};
+    std::atomic<int> _next_slot{0};
+    std::array<TraceSlot, MAX_TRACED_EVENTS> _slots;
+    memory_relaxed_aquire_release::CircularFifo<uint16_t, MAX_TRACED_EVENTS> _delivered_queue;
+    Time _last_stale_check{0};
+
+    static constexpr int SOURCES = static_cast<int>(TraceSource::NUMBER_OF_SOURCES);
+    static constexpr int SEGMENTS = static_cast<int>(TraceSegment::NUMBER_OF_SEGMENTS);
+
+    std::array<std::array<LatencyHistogram, SEGMENTS>, SOURCES> _histograms;
+    std::array<Histogram*, SOURCES> _exported_latencies{};
+    Counter* _dropped_traces;
+    mutable std::mutex _histogram_lock;
+};
+
+/**
+ * @brief Sets the trace source of the calling thread for the duration of a scope
+ */
+class ScopedTraceSource
+{
+public:
+    SUSHI_DECLARE_NON_COPYABLE(ScopedTraceSource);
+
+    explicit ScopedTraceSource(TraceSource source, Time arrival_time = IMMEDIATE_PROCESS)
+    {
+        EventTracer::set_thread_source(source, arrival_time);
+    }
+
+    ~ScopedTraceSource()
+    {
+        EventTracer::set_thread_source(TraceSource::NONE);
+    }
+};
+
+} // namespace performance
+} // namespace sushi
+
+#endif //SUSHI_EVENT_TRACER_H
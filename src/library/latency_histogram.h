@@ -0,0 +1,133 @@
+/*
+ * Copyright 2017-2021 Modern Ancient Instruments Networked AB, dba Elk
+ *
+ * SUSHI is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU Affero General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * SUSHI is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along with
+ * SUSHI.  If not, see http://www.gnu.org/licenses/
+ */
+
+/**
+ * @brief Fixed size, log scale histogram for estimating percentiles of process timings
+ * @copyright 2017-2021 Modern Ancient Instruments Networked AB, dba Elk, Stockholm
+ */
+
+#ifndef SUSHI_LATENCY_HISTOGRAM_H
+#define SUSHI_LATENCY_HISTOGRAM_H
+
+#include <array>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#include "base_performance_timer.h"
+
+namespace sushi {
+namespace performance {
+
+constexpr float HISTOGRAM_MIN_VALUE = 1.0f / 4096.0f;
+constexpr int   HISTOGRAM_BUCKETS_PER_OCTAVE = 8;
+constexpr int   HISTOGRAM_OCTAVES = 16;
+
+/**
+ * @brief Histogram of timings expressed as fractions of the audio buffer period.
+ *        Buckets are spaced logarithmically with HISTOGRAM_BUCKETS_PER_OCTAVE buckets
+ *        per doubling, starting at HISTOGRAM_MIN_VALUE, which gives a relative error
+ *        of percentile estimates of about 9%. Values below the range are counted in
+ *        the first bucket and values above it in the last. The exact max is kept.
+ */
+class LatencyHistogram
+{
+public:
+    static constexpr int BUCKETS = HISTOGRAM_BUCKETS_PER_OCTAVE * HISTOGRAM_OCTAVES + 2;
+
+    void add(float value)
+    {
+        _counts[_bucket_index(value)]++;
+        _count++;
+        _max = std::max(_max, value);
+    }
+
+    void merge(const LatencyHistogram& other)
+    {
+        for (int i = 0; i < BUCKETS; ++i)
+        {
+            _counts[i] += other._counts[i];
+        }
+        _count += other._count;
+        _max = std::max(_max, other._max);
+    }
+
+    void clear()
+    {
+        _counts.fill(0);
+        _count = 0;
+        _max = 0.0f;
+    }
+
+    uint64_t count() const {return _count;}
+
+    float max() const {return _max;}
+
+    /**
+     * @brief Estimate a percentile from the recorded values
+     * @param fraction The percentile to estimate as a fraction, i.e. 0.99 for p99
+     * @return The upper edge of the bucket containing the percentile, limited to the
+     *         largest recorded value, or 0 if the histogram is empty
+     */
+    float percentile(float fraction) const
+    {
+        if (_count == 0)
+        {
+            return 0.0f;
+        }
+        auto target = static_cast<uint64_t>(std::ceil(fraction * _count));
+        target = std::clamp<uint64_t>(target, 1, _count);
+        uint64_t accumulated = 0;
+        for (int i = 0; i < BUCKETS - 1; ++i)
+        {
+            accumulated += _counts[i];
+            if (accumulated >= target)
+            {
+                return std::min(_bucket_upper_edge(i), _max);
+            }
+        }
+        return _max;
+    }
+
+    LatencyPercentiles percentiles() const
+    {
+        return {percentile(0.5f), percentile(0.9f), percentile(0.99f), percentile(0.999f), _max};
+    }
+
+private:
+    static int _bucket_index(float value)
+    {
+        if (value < HISTOGRAM_MIN_VALUE)
+        {
+            return 0;
+        }
+        int index = 1 + static_cast<int>(std::log2(value / HISTOGRAM_MIN_VALUE) * HISTOGRAM_BUCKETS_PER_OCTAVE);
+        return std::min(index, BUCKETS - 1);
+    }
+
+    static float _bucket_upper_edge(int index)
+    {
+        return HISTOGRAM_MIN_VALUE * std::exp2(static_cast<float>(index) / HISTOGRAM_BUCKETS_PER_OCTAVE);
+    }
+
+    std::array<uint64_t, BUCKETS> _counts{};
+    uint64_t _count{0};
+    float _max{0.0f};
+};
+
+} // namespace performance
+} // namespace sushi
+
+#endif //SUSHI_LATENCY_HISTOGRAM_H
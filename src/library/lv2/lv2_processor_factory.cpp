@@ -37,6 +37,7 @@ std::pair<ProcessorReturnCode, std::shared_ptr<Processor>> Lv2ProcessorFactory::
                                                                                              HostControl& host_control,
                                                                                              float sample_rate)
 {
+    std::lock_guard<std::mutex> lock(_world_lock);
     auto world = _world.lock();
     if (!world)
     {
@@ -20,6 +20,8 @@
 #ifndef SUSHI_LV2_PROCESSOR_FACTORY_H
 #define SUSHI_LV2_PROCESSOR_FACTORY_H
 
+#include <mutex>
+
 #include "library/base_processor_factory.h"
 
 namespace sushi {
@@ -38,6 +40,8 @@ public:
 
 private:
     std::weak_ptr<LilvWorldWrapper> _world;
+    // The Lilv world is shared between instances and is not thread safe
+    std::mutex _world_lock;
 };
 
 } // end namespace lv2
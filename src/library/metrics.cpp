@@ -0,0 +1,217 @@
+/*
+ * Copyright 2017-2021 Modern Ancient Instruments Networked AB, dba Elk
+ *
+ * SUSHI is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU Affero General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * SUSHI is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along with
+ * SUSHI.  If not, see http://www.gnu.org/licenses/
+ */
+
+/**
+ * @brief Registry of counters, gauges and histograms for monitoring the host
+ * @copyright 2017-2021 Modern Ancient Instruments Networked AB, dba Elk, Stockholm
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <sstream>
+
+#include "metrics.h"
+
+namespace sushi {
+namespace performance {
+
+constexpr int EXPORT_PRECISION = 12;
+
+Histogram::Histogram(const std::vector<double>& upper_bounds) : _upper_bounds(upper_bounds),
+                                                                _buckets(new std::atomic<uint64_t>[upper_bounds.size() + 1])
+{
+    assert(std::is_sorted(_upper_bounds.begin(), _upper_bounds.end()));
+    for (size_t i = 0; i <= _upper_bounds.size(); ++i)
+    {
+        _buckets[i] = 0;
+    }
+}
+
+uint64_t Histogram::count() const
+{
+    uint64_t count = 0;
+    for (size_t i = 0; i <= _upper_bounds.size(); ++i)
+    {
+        count += bucket_count(i);
+    }
+    return count;
+}
+
+std::string MetricsScope::add_labels(const std::string& name, const std::string& labels)
+{
+    if (labels.empty())
+    {
+        return name;
+    }
+    auto label_start = name.find('{');
+    if (label_start == std::string::npos)
+    {
+        return name + "{" + labels + "}";
+    }
+    return name.substr(0, label_start + 1) + labels + "," + name.substr(label_start + 1);
+}
+
+MetricsRegistry& MetricsRegistry::global()
+{
+    static MetricsRegistry registry;
+    return registry;
+}
+
+Counter* MetricsRegistry::counter(const std::string& name, const std::string& help)
+{
+    std::scoped_lock lock(_lock);
+    auto metric = _find_or_create(name, help, MetricType::COUNTER);
+    if (metric->counter == nullptr)
+    {
+        metric->counter = std::make_unique<Counter>();
+    }
+    return metric->counter.get();
+}
+
+Gauge* MetricsRegistry::gauge(const std::string& name, const std::string& help)
+{
+    std::scoped_lock lock(_lock);
+    auto metric = _find_or_create(name, help, MetricType::GAUGE);
+    if (metric->gauge == nullptr)
+    {
+        metric->gauge = std::make_unique<Gauge>();
+    }
+    return metric->gauge.get();
+}
+
+Histogram* MetricsRegistry::histogram(const std::string& name, const std::string& help, const std::vector<double>& upper_bounds)
+{
+    std::scoped_lock lock(_lock);
+    auto metric = _find_or_create(name, help, MetricType::HISTOGRAM);
+    if (metric->histogram == nullptr)
+    {
+        metric->histogram = std::make_unique<Histogram>(upper_bounds);
+    }
+    return metric->histogram.get();
+}
+
+void MetricsRegistry::remove(const std::string& labels)
+{
+    std::scoped_lock lock(_lock);
+    /* Scope labels always come first in a name, see MetricsScope::add_labels() */
+    auto has_labels = [&](const auto& metric)
+    {
+        auto label_start = metric->name.find('{');
+        if (label_start == std::string::npos || labels.empty() ||
+            metric->name.compare(label_start + 1, labels.size(), labels) != 0)
+        {
+            return false;
+        }
+        char next = metric->name[label_start + 1 + labels.size()];
+        return next == '}' || next == ',';
+    };
+    _metrics.erase(std::remove_if(_metrics.begin(), _metrics.end(), has_labels), _metrics.end());
+}
+
+void MetricsRegistry::write_prometheus(std::ostream& output) const
+{
+    std::scoped_lock lock(_lock);
+    auto precision = output.precision(EXPORT_PRECISION);
+
+    /* All samples of a metric family must be written together, in the order the
+     * families were first registered */
+    std::vector<const std::string*> written_families;
+    for (const auto& metric : _metrics)
+    {
+        const auto& family = metric->family;
+        if (std::find_if(written_families.begin(), written_families.end(),
+                         [&](const auto f) {return *f == family;}) != written_families.end())
+        {
+            continue;
+        }
+        written_families.push_back(&family);
+        output << "# HELP " << family << " " << metric->help << "\n"
+               << "# TYPE " << family << " " << _type_name(metric->type) << "\n";
+
+        for (const auto& sample : _metrics)
+        {
+            if (sample->family != family)
+            {
+                continue;
+            }
+            if (sample->counter)
+            {
+                output << sample->name << " " << sample->counter->value() << "\n";
+            }
+            else if (sample->gauge)
+            {
+                output << sample->name << " " << sample->gauge->value() << "\n";
+            }
+            else if (sample->histogram)
+            {
+                /* The labels of the sample, if any, go before the bucket label */
+                auto labels = sample->name.substr(family.size());
+                auto bucket_labels = labels.empty() ? std::string("{") : labels.substr(0, labels.size() - 1) + ",";
+                const auto& histogram = *sample->histogram;
+                uint64_t cumulative = 0;
+                for (size_t i = 0; i < histogram.upper_bounds().size(); ++i)
+                {
+                    cumulative += histogram.bucket_count(i);
+                    output << family << "_bucket" << bucket_labels << "le=\"" << histogram.upper_bounds()[i] << "\"} " << cumulative << "\n";
+                }
+                cumulative += histogram.bucket_count(histogram.upper_bounds().size());
+                output << family << "_bucket" << bucket_labels << "le=\"+Inf\"} " << cumulative << "\n"
+                       << family << "_sum" << labels << " " << histogram.sum() << "\n"
+                       << family << "_count" << labels << " " << cumulative << "\n";
+            }
+        }
+    }
+    output.precision(precision);
+}
+
+std::string MetricsRegistry::prometheus_text() const
+{
+    std::ostringstream output;
+    write_prometheus(output);
+    return output.str();
+}
+
+const char* MetricsRegistry::_type_name(MetricType type)
+{
+    switch (type)
+    {
+        case MetricType::COUNTER:   return "counter";
+        case MetricType::GAUGE:     return "gauge";
+        case MetricType::HISTOGRAM: return "histogram";
+        default:                    return "untyped";
+    }
+}
+
+MetricsRegistry::Metric* MetricsRegistry::_find_or_create(const std::string& name, const std::string& help, MetricType type)
+{
+    for (auto& metric : _metrics)
+    {
+        if (metric->name == name)
+        {
+            assert(metric->type == type);
+            return metric.get();
+        }
+    }
+    auto metric = std::make_unique<Metric>();
+    metric->name = name;
+    metric->family = name.substr(0, name.find('{'));
+    metric->help = help;
+    metric->type = type;
+    _metrics.push_back(std::move(metric));
+    return _metrics.back().get();
+}
+
+} // namespace performance
+} // namespace sushi
@@ -0,0 +1,267 @@
+/*
+ * Copyright 2017-2021 Modern Ancient Instruments Networked AB, dba Elk
+ *
+ * SUSHI is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU Affero General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * SUSHI is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along with
+ * SUSHI.  If not, see http://www.gnu.org/licenses/
+ */
+
+/**
+ * @brief Registry of counters, gauges and histograms for monitoring the host
+ * @copyright 2017-2021 Modern Ancient Instruments Networked AB, dba Elk, Stockholm
+ */
+
+#ifndef SUSHI_METRICS_H
+#define SUSHI_METRICS_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "constants.h"
+
+namespace sushi {
+namespace performance {
+
+/**
+ * @brief Monotonically increasing count. Lock free and realtime safe.
+ */
+class Counter
+{
+public:
+    void increment(uint64_t value = 1)
+    {
+        _value.fetch_add(value, std::memory_order_relaxed);
+    }
+
+    uint64_t value() const
+    {
+        return _value.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<uint64_t> _value{0};
+};
+
+/**
+ * @brief Value that can go up and down. Lock free and realtime safe.
+ */
+class Gauge
+{
+public:
+    void set(double value)
+    {
+        _value.store(value, std::memory_order_relaxed);
+    }
+
+    void add(double value)
+    {
+        double current = _value.load(std::memory_order_relaxed);
+        while (!_value.compare_exchange_weak(current, current + value, std::memory_order_relaxed)) {}
+    }
+
+    double value() const
+    {
+        return _value.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<double> _value{0};
+};
+
+/**
+ * @brief Distribution of observed values over a fixed set of buckets, with an
+ *        implicit last bucket for values above the largest bound. Observing
+ *        values is lock free and realtime safe.
+ */
+class Histogram
+{
+public:
+    explicit Histogram(const std::vector<double>& upper_bounds);
+
+    void observe(double value)
+    {
+        size_t bucket = 0;
+        while (bucket < _upper_bounds.size() && value > _upper_bounds[bucket])
+        {
+            bucket++;
+        }
+        _buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+        double current = _sum.load(std::memory_order_relaxed);
+        while (!_sum.compare_exchange_weak(current, current + value, std::memory_order_relaxed)) {}
+    }
+
+    const std::vector<double>& upper_bounds() const {return _upper_bounds;}
+
+    /**
+     * @brief Number of values observed in a bucket, not including lower buckets
+     * @param bucket Bucket index, upper_bounds().size() is the bucket above all bounds
+     */
+    uint64_t bucket_count(size_t bucket) const
+    {
+        return _buckets[bucket].load(std::memory_order_relaxed);
+    }
+
+    uint64_t count() const;
+
+    double sum() const {return _sum.load(std::memory_order_relaxed);}
+
+private:
+    std::vector<double> _upper_bounds;
+    std::unique_ptr<std::atomic<uint64_t>[]> _buckets;
+    std::atomic<double> _sum{0};
+};
+
+/**
+ * @brief Owns all metrics and exports them in Prometheus text format. Metric names
+ *        may include Prometheus labels, i.e. "sushi_queue_depth{queue=\"in\"}", and
+ *        metrics with the same name but different labels are exported together.
+ *        Returned pointers stay valid until the metric is removed with remove(), or
+ *        for the lifetime of the registry.
+ */
+class MetricsRegistry
+{
+public:
+    SUSHI_DECLARE_NON_COPYABLE(MetricsRegistry);
+
+    MetricsRegistry() = default;
+
+    /**
+     * @brief The registry shared by all parts of the host. Metrics of an engine are
+     *        told apart by an engine label, see BaseEngine::metrics()
+     */
+    static MetricsRegistry& global();
+
+    /**
+     * @brief Get a counter, creating it if it does not exist. Not realtime safe,
+     *        metrics should be looked up once and the pointer kept.
+     * @param name The name of the counter, including labels if any
+     * @param help A description of the counter
+     */
+    Counter* counter(const std::string& name, const std::string& help);
+
+    /**
+     * @brief Get a gauge, creating it if it does not exist. Not realtime safe.
+     * @param name The name of the gauge, including labels if any
+     * @param help A description of the gauge
+     */
+    Gauge* gauge(const std::string& name, const std::string& help);
+
+    /**
+     * @brief Get a histogram, creating it if it does not exist. Not realtime safe.
+     * @param name The name of the histogram, including labels if any
+     * @param help A description of the histogram
+     * @param upper_bounds The upper bounds of the buckets in increasing order. Not
+     *        used if the histogram already exists.
+     */
+    Histogram* histogram(const std::string& name, const std::string& help, const std::vector<double>& upper_bounds);
+
+    /**
+     * @brief Remove all metrics registered through a MetricsScope with the given labels.
+     *        Pointers to removed metrics must not be used afterwards.
+     * @param labels The labels of the scope, i.e. "engine=\"0\""
+     */
+    void remove(const std::string& labels);
+
+    /**
+     * @brief Write all metrics in Prometheus text exposition format
+     */
+    void write_prometheus(std::ostream& output) const;
+
+    std::string prometheus_text() const;
+
+private:
+    enum class MetricType
+    {
+        COUNTER,
+        GAUGE,
+        HISTOGRAM
+    };
+
+    struct Metric
+    {
+        std::string name;
+        std::string family;
+        std::string help;
+        MetricType  type;
+        std::unique_ptr<Counter>   counter;
+        std::unique_ptr<Gauge>     gauge;
+        std::unique_ptr<Histogram> histogram;
+    };
+
+    Metric* _find_or_create(const std::string& name, const std::string& help, MetricType type);
+
+    static const char* _type_name(MetricType type);
+
+    std::vector<std::unique_ptr<Metric>> _metrics;
+    mutable std::mutex _lock;
+};
+
+/**
+ * @brief Registers metrics in a registry with a fixed set of labels added to every
+ *        name, so that the metrics of several engines in one process are kept apart.
+ */
+class MetricsScope
+{
+public:
+    SUSHI_DECLARE_NON_COPYABLE(MetricsScope);
+
+    /**
+     * @param registry The registry to register metrics in
+     * @param labels Labels to add to every metric, i.e. "engine=\"0\""
+     */
+    MetricsScope(MetricsRegistry& registry, const std::string& labels) : _registry(registry),
+                                                                        _labels(labels) {}
+
+    Counter* counter(const std::string& name, const std::string& help)
+    {
+        return _registry.counter(add_labels(name, _labels), help);
+    }
+
+    Gauge* gauge(const std::string& name, const std::string& help)
+    {
+        return _registry.gauge(add_labels(name, _labels), help);
+    }
+
+    Histogram* histogram(const std::string& name, const std::string& help, const std::vector<double>& upper_bounds)
+    {
+        return _registry.histogram(add_labels(name, _labels), help, upper_bounds);
+    }
+
+    const std::string& labels() const {return _labels;}
+
+    /**
+     * @brief Remove all metrics registered through this scope from the registry
+     */
+    void remove_all()
+    {
+        _registry.remove(_labels);
+    }
+
+    /**
+     * @brief Add labels to a metric name that may already have labels of its own
+     * @param name The name of the metric, i.e. "sushi_queue_depth{queue=\"in\"}"
+     * @param labels Comma separated labels to add first, i.e. "engine=\"0\""
+     */
+    static std::string add_labels(const std::string& name, const std::string& labels);
+
+private:
+    MetricsRegistry& _registry;
+    std::string _labels;
+};
+
+} // namespace performance
+} // namespace sushi
+
+#endif //SUSHI_METRICS_H
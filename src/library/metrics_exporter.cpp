@@ -0,0 +1,185 @@
+/*
+ * Copyright 2017-2021 Modern Ancient Instruments Networked AB, dba Elk
+ *
+ * SUSHI is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU Affero General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * SUSHI is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along with
+ * SUSHI.  If not, see http://www.gnu.org/licenses/
+ */
+
+/**
+ * @brief Periodic export of metrics to a file and a local socket
+ * @copyright 2017-2021 Modern Ancient Instruments Networked AB, dba Elk, Stockholm
+ */
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "metrics_exporter.h"
+#include "logging.h"
+
+SUSHI_GET_LOGGER_WITH_MODULE_NAME("metrics");
+
+namespace sushi {
+namespace performance {
+
+/* Max time to wait for clients to connect, limits how long stop() can take */
+constexpr auto MAX_SOCKET_WAIT = std::chrono::milliseconds(100);
+/* Max time a single send to a client may block before the client is dropped */
+constexpr auto CLIENT_SEND_TIMEOUT = std::chrono::milliseconds(200);
+
+MetricsExporter::~MetricsExporter()
+{
+    stop();
+    if (_socket >= 0)
+    {
+        close(_socket);
+        unlink(_socket_path.c_str());
+    }
+}
+
+void MetricsExporter::set_file(const std::string& filename)
+{
+    _filename = filename;
+}
+
+bool MetricsExporter::set_socket(const std::string& socket_path)
+{
+    sockaddr_un address{};
+    if (socket_path.size() >= sizeof(address.sun_path))
+    {
+        SUSHI_LOG_ERROR("Metrics socket path too long: {}", socket_path);
+        return false;
+    }
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, socket_path.c_str(), sizeof(address.sun_path) - 1);
+
+    _socket = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (_socket < 0)
+    {
+        SUSHI_LOG_ERROR("Failed to create metrics socket: {}", std::strerror(errno));
+        return false;
+    }
+    unlink(socket_path.c_str());
+    if (bind(_socket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 || listen(_socket, 4) < 0)
+    {
+        SUSHI_LOG_ERROR("Failed to bind metrics socket {}: {}", socket_path, std::strerror(errno));
+        close(_socket);
+        _socket = -1;
+        return false;
+    }
+    _socket_path = socket_path;
+    return true;
+}
+
+void MetricsExporter::run()
+{
+    _running = true;
+    _thread = std::thread(&MetricsExporter::_export_loop, this);
+}
+
+void MetricsExporter::stop()
+{
+    _running = false;
+    if (_thread.joinable())
+    {
+        _thread.join();
+        write_file();
+    }
+}
+
+bool MetricsExporter::write_file()
+{
+    if (_filename.empty())
+    {
+        return false;
+    }
+    auto temp_filename = _filename + ".tmp";
+    {
+        std::ofstream file(temp_filename, std::ios::out | std::ios::trunc);
+        if (!file.good())
+        {
+            SUSHI_LOG_ERROR("Failed to open metrics file {}", temp_filename);
+            return false;
+        }
+        _registry.write_prometheus(file);
+    }
+    return std::rename(temp_filename.c_str(), _filename.c_str()) == 0;
+}
+
+void MetricsExporter::_export_loop()
+{
+    auto next_export = std::chrono::steady_clock::now();
+    while (_running)
+    {
+        auto now = std::chrono::steady_clock::now();
+        if (now >= next_export)
+        {
+            write_file();
+            next_export = now + _interval;
+        }
+        auto timeout = std::min(std::chrono::duration_cast<std::chrono::milliseconds>(next_export - now), MAX_SOCKET_WAIT);
+        if (_socket >= 0)
+        {
+            _serve_socket(timeout);
+        }
+        else
+        {
+            std::this_thread::sleep_for(timeout);
+        }
+    }
+}
+
+void MetricsExporter::_serve_socket(std::chrono::milliseconds timeout)
+{
+    pollfd poll_fd{_socket, POLLIN, 0};
+    if (poll(&poll_fd, 1, static_cast<int>(timeout.count())) <= 0)
+    {
+        return;
+    }
+    int client = accept(_socket, nullptr, nullptr);
+    if (client < 0)
+    {
+        return;
+    }
+    /* Sends block until the whole text is written, but with a timeout so that a
+     * client that stops reading can't stall the export loop */
+    timeval send_timeout{0, static_cast<suseconds_t>(std::chrono::microseconds(CLIENT_SEND_TIMEOUT).count())};
+    setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &send_timeout, sizeof(send_timeout));
+
+    auto text = _registry.prometheus_text();
+    size_t sent = 0;
+    while (sent < text.size())
+    {
+        auto ret = send(client, text.data() + sent, text.size() - sent, MSG_NOSIGNAL);
+        if (ret < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (ret <= 0)
+        {
+            SUSHI_LOG_WARNING("Failed to send metrics to client, dropped {} of {} bytes: {}",
+                              text.size() - sent, text.size(), std::strerror(errno));
+            break;
+        }
+        sent += ret;
+    }
+    close(client);
+}
+
+} // namespace performance
+} // namespace sushi
@@ -0,0 +1,95 @@
+/*
+ * Copyright 2017-2021 Modern Ancient Instruments Networked AB, dba Elk
+ *
+ * SUSHI is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU Affero General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * SUSHI is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along with
+ * SUSHI.  If not, see http://www.gnu.org/licenses/
+ */
+
+/**
+ * @brief Periodic export of metrics to a file and a local socket
+ * @copyright 2017-2021 Modern Ancient Instruments Networked AB, dba Elk, Stockholm
+ */
+
+#ifndef SUSHI_METRICS_EXPORTER_H
+#define SUSHI_METRICS_EXPORTER_H
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include "metrics.h"
+
+namespace sushi {
+namespace performance {
+
+constexpr auto METRICS_EXPORT_INTERVAL = std::chrono::milliseconds(1000);
+
+/**
+ * @brief Exports the metrics of a registry in Prometheus text format from a
+ *        background thread. The file is rewritten every export interval by writing
+ *        to a temporary file and renaming it, so readers never see partial content,
+ *        i.e. for the textfile collector of the Prometheus node exporter. Clients
+ *        connecting to the unix domain socket receive the current metrics, after
+ *        which the connection is closed.
+ */
+class MetricsExporter
+{
+public:
+    SUSHI_DECLARE_NON_COPYABLE(MetricsExporter);
+
+    explicit MetricsExporter(const MetricsRegistry& registry,
+                             std::chrono::milliseconds interval = METRICS_EXPORT_INTERVAL) : _registry(registry),
+                                                                                             _interval(interval) {}
+
+    ~MetricsExporter();
+
+    /**
+     * @brief Set a file to export metrics to. Must be called before run().
+     */
+    void set_file(const std::string& filename);
+
+    /**
+     * @brief Create a unix domain socket at the given path for serving metrics. Any
+     *        existing file at the path is removed. Must be called before run().
+     * @return true if the socket was created, false otherwise
+     */
+    bool set_socket(const std::string& socket_path);
+
+    void run();
+
+    void stop();
+
+    /**
+     * @brief Write the current metrics to the export file, if set
+     * @return true if the file was written
+     */
+    bool write_file();
+
+private:
+    void _export_loop();
+
+    void _serve_socket(std::chrono::milliseconds timeout);
+
+    const MetricsRegistry&    _registry;
+    std::chrono::milliseconds _interval;
+    std::string               _filename;
+    std::string               _socket_path;
+    int                       _socket{-1};
+
+    std::thread               _thread;
+    std::atomic_bool          _running{false};
+};
+
+} // namespace performance
+} // namespace sushi
+
+#endif //SUSHI_METRICS_EXPORTER_H
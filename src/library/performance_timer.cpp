@@ -19,6 +19,7 @@
  */
 
 #include <vector>
+#include <fstream>
 
 #include "performance_timer.h"
 #include "logging.h"
@@ -50,6 +51,54 @@ void PerformanceTimer::set_timing_period(float samplerate, int buffer_size)
     _period = static_cast<double>(buffer_size) / samplerate * SEC_TO_NANOSEC;
 }
 
+void PerformanceTimer::set_rt_worker_count(int workers)
+{
+    assert(_enabled == false);
+    _worker_queues.clear();
+    for (int i = 0; i < workers; ++i)
+    {
+        _worker_queues.push_back(std::make_unique<TimingQueue>());
+    }
+    /* Trace thread 0 is the main audio thread. With a single worker, tracks are
+     * processed on the main audio thread and trace into its buffer, otherwise every
+     * worker gets a buffer of its own. Sections timed with stop_timer_rt_safe() can
+     * come from any thread and go into a separate buffer last. */
+    std::vector<std::string> trace_threads{"Audio thread"};
+    _worker_trace_offset = workers > 1 ? 1 : 0;
+    if (workers > 1)
+    {
+        for (int i = 0; i < workers; ++i)
+        {
+            trace_threads.push_back("Audio worker " + std::to_string(i));
+        }
+    }
+    _rt_safe_trace_thread = static_cast<int>(trace_threads.size());
+    trace_threads.emplace_back("Shared timer sections");
+    _trace_recorder.set_threads(trace_threads);
+}
+
+void PerformanceTimer::enable_tracing(bool enabled)
+{
+    _trace_recorder.enable(enabled);
+}
+
+bool PerformanceTimer::tracing_enabled()
+{
+    return _trace_recorder.enabled();
+}
+
+bool PerformanceTimer::write_trace_to_file(const std::string& filename, const TraceNodeNames& node_names)
+{
+    std::ofstream file(filename);
+    if (!file.is_open())
+    {
+        SUSHI_LOG_WARNING("Couldn't open trace file {}", filename);
+        return false;
+    }
+    _trace_recorder.write_chrome_trace(file, node_names);
+    return file.good();
+}
+
 std::optional<ProcessTimings> PerformanceTimer::timings_for_node(int id)
 {
     std::unique_lock<std::mutex> lock(_timing_lock);
@@ -95,24 +144,68 @@ void PerformanceTimer::_worker()
     }
 }
 
-void PerformanceTimer::_update_timings()
+void PerformanceTimer::collect_timings()
 {
-    std::map<int, std::vector<TimingLogPoint>> sorted_data;
+    std::lock_guard<std::mutex> lock(_collect_lock);
     TimingLogPoint log_point;
     while (_entry_queue.pop(log_point))
     {
-        sorted_data[log_point.id].push_back(log_point);
+        _collected[log_point.id].push_back(log_point);
+    }
+    for (auto& queue : _worker_queues)
+    {
+        while (queue->pop(log_point))
+        {
+            _collected[log_point.id].push_back(log_point);
+        }
     }
+}
+
+void PerformanceTimer::_update_timings()
+{
+    collect_timings();
+    std::map<int, std::vector<TimingLogPoint>> sorted_data;
+    {
+        std::lock_guard<std::mutex> lock(_collect_lock);
+        sorted_data.swap(_collected);
+    }
+    std::lock_guard<std::mutex> lock(_timing_lock);
     for (const auto& node : sorted_data)
     {
         int id = node.first;
-        std::lock_guard<std::mutex> lock(_timing_lock);
-        const auto& timings = _timings[id];
+        auto& timings = _timings[id];
         auto new_timings = _calculate_timings(node.second);
-        _timings[id].timings = _merge_timings(timings.timings, new_timings);
+        timings.timings = _merge_timings(timings.timings, new_timings);
+    }
+    // Every node advances its rolling window, also nodes that received no timings in this interval
+    for (auto& [id, node] : _timings)
+    {
+        auto entries = sorted_data.find(id);
+        _update_histograms(node, entries != sorted_data.end() ? entries->second : std::vector<TimingLogPoint>());
     }
 }
 
+void PerformanceTimer::_update_histograms(TimingNode& node, const std::vector<TimingLogPoint>& entries)
+{
+    node.window_index = (node.window_index + 1) % ROLLING_WINDOW_INTERVALS;
+    auto& current = node.window[node.window_index];
+    current.clear();
+    for (const auto& entry : entries)
+    {
+        float process_time = static_cast<float>(entry.delta_time.count()) / _period;
+        current.add(process_time);
+    }
+    node.since_reset.merge(current);
+
+    LatencyHistogram recent;
+    for (const auto& interval : node.window)
+    {
+        recent.merge(interval);
+    }
+    node.timings.recent = recent.percentiles();
+    node.timings.since_reset = node.since_reset.percentiles();
+}
+
 ProcessTimings PerformanceTimer::_calculate_timings(const std::vector<TimingLogPoint>& entries)
 {
     float min_value{100};
@@ -149,7 +242,7 @@ bool PerformanceTimer::clear_timings_for_node(int id)
     const auto& node = _timings.find(id);
     if (node != _timings.end())
     {
-        new (&node->second.timings) (ProcessTimings);
+        _clear_node(node->second);
         return true;
     }
     return false;
@@ -160,7 +253,17 @@ void PerformanceTimer::clear_all_timings()
     std::lock_guard<std::mutex> lock(_timing_lock);
     for (auto& node : _timings)
     {
-        new (&node.second.timings) (ProcessTimings);
+        _clear_node(node.second);
+    }
+}
+
+void PerformanceTimer::_clear_node(TimingNode& node)
+{
+    new (&node.timings) (ProcessTimings);
+    node.since_reset.clear();
+    for (auto& interval : node.window)
+    {
+        interval.clear();
     }
 }
 
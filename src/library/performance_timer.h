@@ -25,13 +25,19 @@
 #include <atomic>
 #include <thread>
 #include <map>
+#include <array>
 #include <mutex>
+#include <algorithm>
 #include <vector>
+#include <memory>
+#include <cassert>
 
 #include "fifo/circularfifo_memory_relaxed_aquire_release.h"
 #include "twine/twine.h"
 
 #include "base_performance_timer.h"
+#include "latency_histogram.h"
+#include "trace_recorder.h"
 #include "constants.h"
 #include "spinlock.h"
 
@@ -40,6 +46,8 @@ namespace performance {
 
 using TimePoint = std::chrono::nanoseconds;
 constexpr int MAX_LOG_ENTRIES = 20000;
+// Timings are evaluated once every second, so this gives a 10 second rolling window
+constexpr int ROLLING_WINDOW_INTERVALS = 10;
 
 
 class PerformanceTimer : public BasePerformanceTimer
@@ -69,7 +77,7 @@ public:
      */
     TimePoint start_timer()
     {
-        if (_enabled)
+        if (_enabled || _trace_recorder.enabled())
         {
             return twine::current_rt_time();
         }
@@ -83,32 +91,124 @@ public:
      */
     void stop_timer(TimePoint start_time, int node_id)
     {
-        if (_enabled)
+        if (_enabled || _trace_recorder.enabled())
         {
-            TimingLogPoint tp{node_id, twine::current_rt_time() - start_time};
-            _entry_queue.push(tp);
-            // if queue is full, drop entries silently.
+            auto stop_time = twine::current_rt_time();
+            if (_enabled)
+            {
+                TimingLogPoint tp{node_id, stop_time - start_time};
+                _push_entry(_entry_queue, tp);
+            }
+            _trace_recorder.record(0, node_id, start_time, stop_time);
+        }
+    }
+
+    /**
+     * @brief Exit point for timing section from a realtime worker thread. Every worker
+     *        records into its own queue so no locking is needed, but each worker index
+     *        must only be used from one thread at a time.
+     * @param start_time A timestamp from a previous call to start_timer()
+     * @param node_id An integer id to identify timings from this node
+     * @param worker The index of the calling worker, must be less than the count
+     *        passed to set_rt_worker_count()
+     */
+    void stop_timer(TimePoint start_time, int node_id, int worker)
+    {
+        if (_enabled || _trace_recorder.enabled())
+        {
+            auto stop_time = twine::current_rt_time();
+            if (_enabled)
+            {
+                assert(worker < static_cast<int>(_worker_queues.size()));
+                TimingLogPoint tp{node_id, stop_time - start_time};
+                _push_entry(*_worker_queues[worker], tp);
+            }
+            _trace_recorder.record(worker + _worker_trace_offset, node_id, start_time, stop_time);
+        }
+    }
+
+    /**
+     * @brief Exit point for a section that is only traced and not included in the
+     *        timing statistics. Called from the main audio thread.
+     * @param start_time A timestamp from a previous call to start_timer()
+     * @param node_id An integer id to identify the section
+     */
+    void stop_trace(TimePoint start_time, int node_id)
+    {
+        if (_trace_recorder.enabled())
+        {
+            _trace_recorder.record(0, node_id, start_time, twine::current_rt_time());
+        }
+    }
+
+    /**
+     * @brief Exit point for a section that is only traced, called from a realtime worker
+     * @param start_time A timestamp from a previous call to start_timer()
+     * @param node_id An integer id to identify the section
+     * @param worker The index of the calling worker
+     */
+    void stop_trace(TimePoint start_time, int node_id, int worker)
+    {
+        if (_trace_recorder.enabled())
+        {
+            _trace_recorder.record(worker + _worker_trace_offset, node_id, start_time, twine::current_rt_time());
         }
     }
 
     /**
      * @brief Exit point for timing section. Safe to call concurrently from
-     *       several threads.
+     *       several threads, but serializes all callers. Prefer the per worker
+     *       version of stop_timer() where possible.
      * @param start_time A timestamp from a previous call to start_timer()
      * @param node_id An integer id to identify timings from this node
      */
     void stop_timer_rt_safe(TimePoint start_time, int node_id)
     {
-        if(_enabled)
+        if (_enabled || _trace_recorder.enabled())
         {
-            TimingLogPoint tp{node_id, twine::current_rt_time() - start_time};
+            auto stop_time = twine::current_rt_time();
             _queue_lock.lock();
-            _entry_queue.push(tp);
+            if (_enabled)
+            {
+                TimingLogPoint tp{node_id, stop_time - start_time};
+                _push_entry(_entry_queue, tp);
+            }
+            _trace_recorder.record(_rt_safe_trace_thread, node_id, start_time, stop_time);
             _queue_lock.unlock();
-            // if queue is full, drop entries silently.
         }
     }
 
+    /**
+     * @brief Allocate lock free timing queues for a number of realtime worker threads.
+     *        Must not be called while timings are being recorded.
+     * @param workers The number of worker threads that will call stop_timer() with a
+     *        worker index
+     */
+    void set_rt_worker_count(int workers);
+
+    /**
+     * @brief Time processors only in every nth chunk to reduce the overhead of timings.
+     *        Tracks and the engine are still timed in every chunk. Tracks offset the
+     *        chunks their processors are timed in so the cost is spread evenly.
+     *        As all timings are relative to the chunk period, the statistics of a
+     *        sampled processor are estimates of the same values and need no scaling.
+     * @param interval Time every processor once every interval chunks, 1 to time
+     *        processors in every chunk.
+     */
+    void set_processor_sampling_interval(int interval) override
+    {
+        _sampling_interval.store(std::max(interval, 1), std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Get the interval set with set_processor_sampling_interval(), safe to call
+     *        from the audio thread.
+     */
+    int processor_sampling_interval() const
+    {
+        return _sampling_interval.load(std::memory_order_relaxed);
+    }
+
     /**
      * @brief Enable or disable timings
      * @param enabled Enable timings if true, disable if false
@@ -121,6 +221,21 @@ public:
      */
     bool enabled() override;
 
+    /**
+     * @brief Move timing records from the realtime queues now instead of waiting for
+     *        the next periodic update. Not realtime safe.
+     */
+    void collect_timings() override;
+
+    /**
+     * @brief Get the number of timing records that were dropped because a queue was full
+     * @return The number of dropped records since the timer was created
+     */
+    uint64_t dropped_timings() override
+    {
+        return _dropped_entries.load(std::memory_order_relaxed);
+    }
+
     /**
      * @brief Get the recorded timings from a specific node
      * @param id An integer id representing a timing node
@@ -140,6 +255,27 @@ public:
      */
     void clear_all_timings() override;
 
+    /**
+     * @brief Enable or disable recording of a processing timeline. Tracing is
+     *        independent of timing statistics.
+     * @param enabled Enable tracing if true, disable if false
+     */
+    void enable_tracing(bool enabled) override;
+
+    /**
+     * @brief Query the tracing state
+     * @return True if tracing is enabled, false otherwise
+     */
+    bool tracing_enabled() override;
+
+    /**
+     * @brief Write the recorded timeline to a file in Chrome trace event format
+     * @param filename The file to write to
+     * @param node_names Function returning a display name for a node id
+     * @return true if the file was written, false otherwise
+     */
+    bool write_trace_to_file(const std::string& filename, const TraceNodeNames& node_names) override;
+
 protected:
 
     struct TimingLogPoint
@@ -152,22 +288,46 @@ protected:
     {
         int id;
         ProcessTimings timings;
+        LatencyHistogram since_reset;
+        std::array<LatencyHistogram, ROLLING_WINDOW_INTERVALS> window;
+        int window_index{0};
     };
 
+    using TimingQueue = memory_relaxed_aquire_release::CircularFifo<TimingLogPoint, MAX_LOG_ENTRIES>;
+
+    void _push_entry(TimingQueue& queue, const TimingLogPoint& entry)
+    {
+        if (queue.push(entry) == false)
+        {
+            _dropped_entries.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
     void _worker();
     void _update_timings();
 
     ProcessTimings _calculate_timings(const std::vector<TimingLogPoint>& entries);
     ProcessTimings _merge_timings(ProcessTimings prev_timings, ProcessTimings new_timings);
+    void _update_histograms(TimingNode& node, const std::vector<TimingLogPoint>& entries);
+    static void _clear_node(TimingNode& node);
 
     std::thread _process_thread;
     float _period;
-    std::atomic_bool _enabled;
+    std::atomic_bool _enabled{false};
+    std::atomic<int> _sampling_interval{1};
 
     std::map<int, TimingNode>  _timings;
     std::mutex _timing_lock;
+    /* Records collected from the queues but not yet included in the timings */
+    std::map<int, std::vector<TimingLogPoint>> _collected;
+    std::mutex _collect_lock;
+    std::atomic<uint64_t> _dropped_entries{0};
     SpinLock _queue_lock;
-    alignas(ASSUMED_CACHE_LINE_SIZE) memory_relaxed_aquire_release::CircularFifo<TimingLogPoint, MAX_LOG_ENTRIES> _entry_queue;
+    alignas(ASSUMED_CACHE_LINE_SIZE) TimingQueue _entry_queue;
+    std::vector<std::unique_ptr<TimingQueue>> _worker_queues;
+    TraceRecorder _trace_recorder;
+    int _worker_trace_offset{0};
+    int _rt_safe_trace_thread{1};
 };
 
 } // namespace performance
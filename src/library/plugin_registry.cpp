@@ -27,40 +27,53 @@ PluginRegistry::new_instance(const sushi::engine::PluginInfo& plugin_info,
                              sushi::HostControl& host_control,
                              float sample_rate)
 {
-    if (_factories.count(plugin_info.type) == 0)
+    auto factory = _factory(plugin_info.type);
+    if (factory == nullptr)
     {
-        switch (plugin_info.type)
+        return {ProcessorReturnCode::PLUGIN_LOAD_ERROR, nullptr};
+    }
+    /* Instantiation is done outside of the registry lock so that internal plugins can be
+     * loaded in parallel. Factories for external plugin formats serialise instantiation
+     * internally where the format or plugin libraries are not thread safe. */
+    return factory->new_instance(plugin_info, host_control, sample_rate);
+}
+
+BaseProcessorFactory* PluginRegistry::_factory(engine::PluginType type)
+{
+    std::lock_guard<std::mutex> lock(_factory_lock);
+    if (_factories.count(type) == 0)
+    {
+        switch (type)
         {
             case engine::PluginType::INTERNAL:
             {
                 std::unique_ptr<BaseProcessorFactory> new_factory = std::make_unique<InternalProcessorFactory>();
-                _factories[plugin_info.type] = std::move(new_factory);
+                _factories[type] = std::move(new_factory);
                 break;
             }
             case engine::PluginType::VST2X:
             {
                 std::unique_ptr<BaseProcessorFactory> new_factory = std::make_unique<vst2::Vst2xProcessorFactory>();
-                _factories[plugin_info.type] = std::move(new_factory);
+                _factories[type] = std::move(new_factory);
                 break;
             }
             case engine::PluginType::VST3X:
             {
                 std::unique_ptr<BaseProcessorFactory> new_factory = std::make_unique<vst3::Vst3xProcessorFactory>();
-                _factories[plugin_info.type] = std::move(new_factory);
+                _factories[type] = std::move(new_factory);
                 break;
             }
             case engine::PluginType::LV2:
             {
                 std::unique_ptr<BaseProcessorFactory> new_factory = std::make_unique<lv2::Lv2ProcessorFactory>();
-                _factories[plugin_info.type] = std::move(new_factory);
+                _factories[type] = std::move(new_factory);
                 break;
             }
             default:
-                return {ProcessorReturnCode::PLUGIN_LOAD_ERROR, nullptr};
+                return nullptr;
         }
     }
-
-    return _factories[plugin_info.type]->new_instance(plugin_info, host_control, sample_rate);
+    return _factories[type].get();
 }
 
-}; // end namespace sushi
\ No newline at end of file
+}; // end namespace sushi
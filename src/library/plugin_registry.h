@@ -23,6 +23,7 @@
 #define SUSHI_PLUGIN_REGISTRY_H
 
 #include <unordered_map>
+#include <mutex>
 
 #include "library/processor.h"
 #include "library/base_processor_factory.h"
@@ -41,12 +42,20 @@ struct Hash
 class PluginRegistry
 {
 public:
+    /**
+     * @brief Create a new plugin instance. Safe to call concurrently from several
+     *        threads. Internal plugins are instantiated in parallel while the VST2,
+     *        VST3 and LV2 factories serialize instantiation of their plugins.
+     */
     std::pair<ProcessorReturnCode, std::shared_ptr<Processor>> new_instance(const engine::PluginInfo& plugin_info,
                                                                             HostControl& host_control,
                                                                             float sample_rate);
 
 private:
+    BaseProcessorFactory* _factory(engine::PluginType type);
+
     std::unordered_map<engine::PluginType, std::unique_ptr<BaseProcessorFactory>, Hash> _factories;
+    std::mutex _factory_lock;
 };
 
 }; // end namespace sushi
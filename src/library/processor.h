@@ -82,6 +82,20 @@ public:
      */
     virtual void process_event(const RtEvent& event) = 0;
 
+    /**
+     * @brief Process a batch of realtime events, all targeted to this processor and
+     *        sorted in arrival order. The default implementation calls process_event()
+     *        for every event. Override to fill plugin native event structures in one pass.
+     * @param events The events to process.
+     */
+    virtual void process_events(RtEventSpan events)
+    {
+        for (const auto& event : events)
+        {
+            process_event(event);
+        }
+    }
+
     /**
      * @brief Process a chunk of audio.
      * @param in_buffer Input SampleBuffer
@@ -0,0 +1,123 @@
+/*
+ * Copyright 2017-2021 Modern Ancient Instruments Networked AB, dba Elk
+ *
+ * SUSHI is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU Affero General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * SUSHI is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along with
+ * SUSHI.  If not, see http://www.gnu.org/licenses/
+ */
+
+/**
+ * @brief Read-copy-update container for data that is read often and seldom modified.
+ *        Readers never lock or wait, writers publish a new copy of the data and wait
+ *        for readers of the previous copy to finish before deleting it.
+ * @copyright 2017-2021 Modern Ancient Instruments Networked AB, dba Elk, Stockholm
+ */
+
+#ifndef SUSHI_RCU_POINTER_H
+#define SUSHI_RCU_POINTER_H
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <thread>
+
+#include "library/constants.h"
+
+namespace sushi {
+
+template <typename T>
+class RcuPointer
+{
+    SUSHI_DECLARE_NON_COPYABLE(RcuPointer);
+public:
+    /**
+     * @brief Keeps the data it was created from alive as long as it exists.
+     *        Should be short lived, as it holds off writers from reclaiming old data.
+     */
+    class ReadGuard
+    {
+        SUSHI_DECLARE_NON_COPYABLE(ReadGuard);
+    public:
+        explicit ReadGuard(const RcuPointer& parent) : _parent(parent)
+        {
+            /* Register with the reader count of the current epoch. If a writer
+             * started a new epoch in between, register with that one instead */
+            while (true)
+            {
+                unsigned int epoch = _parent._epoch.load();
+                _slot = epoch & 1u;
+                _parent._readers[_slot].fetch_add(1);
+                if (_parent._epoch.load() == epoch)
+                {
+                    break;
+                }
+                _parent._readers[_slot].fetch_sub(1);
+            }
+            _data = _parent._data.load();
+        }
+
+        ~ReadGuard()
+        {
+            _parent._readers[_slot].fetch_sub(1);
+        }
+
+        const T* operator->() const {return _data;}
+        const T& operator*() const {return *_data;}
+
+    private:
+        const RcuPointer& _parent;
+        const T*          _data;
+        unsigned int      _slot;
+    };
+
+    explicit RcuPointer(std::unique_ptr<T> data) : _data(data.release()) {}
+
+    ~RcuPointer()
+    {
+        delete _data.load();
+    }
+
+    /**
+     * @brief Access the current data. Doesn't lock, only retries if a writer
+     *        publishes new data at the same time.
+     */
+    ReadGuard read() const
+    {
+        return ReadGuard(*this);
+    }
+
+    /**
+     * @brief Replace the current data and delete the previous copy once no reader
+     *        accesses it. Only readers that started before the call are waited for,
+     *        as readers starting after it are counted in the next epoch, so a steady
+     *        stream of readers doesn't hold off the writer.
+     *        Calls to publish() must be serialised by the caller.
+     * @param data The new data
+     */
+    void publish(std::unique_ptr<T> data)
+    {
+        auto old_data = _data.exchange(data.release());
+        unsigned int old_slot = _epoch.fetch_add(1) & 1u;
+        while (_readers[old_slot].load() > 0)
+        {
+            std::this_thread::yield();
+        }
+        delete old_data;
+    }
+
+private:
+    std::atomic<T*>                      _data;
+    mutable std::atomic<unsigned int>    _epoch{0};
+    mutable std::array<std::atomic<int>, 2> _readers{};
+};
+
+} // end namespace sushi
+
+#endif //SUSHI_RCU_POINTER_H
@@ -23,6 +23,7 @@
 
 #include <string>
 #include <cassert>
+#include <cstdint>
 #include <optional>
 
 #include "id_generator.h"
@@ -32,6 +33,8 @@
 
 namespace sushi {
 
+namespace performance {struct XrunReportSlot;}
+
 /* Currently limiting the size of an event to 32 bytes and forcing it to align
  * to 32 byte boundaries. We could possibly extend this to 64 bytes if neccesary,
  * but likely not further */
@@ -40,9 +43,10 @@ namespace sushi {
 #endif
 
 /**
- * List of realtime message types
+ * List of realtime message types. Stored as 16 bits to leave room for a trace id
+ * in BaseRtEvent without growing the events.
  */
-enum class RtEventType
+enum class RtEventType : uint16_t
 {
     /* Processor commands */
     NOTE_ON,
@@ -90,6 +94,7 @@ enum class RtEventType
     SYNC,
     /* Engine notification events */
     CLIP_NOTIFICATION,
+    XRUN_NOTIFICATION,
 };
 
 class BaseRtEvent
@@ -114,11 +119,23 @@ public:
      */
     int sample_offset() const {return _sample_offset;}
 
+    /**
+     * @brief Id of the latency trace following this event, 0 if the event is not traced.
+     * @return
+     */
+    uint16_t trace_id() const {return _trace_id;}
+
+    void set_trace_id(uint16_t trace_id) {_trace_id = trace_id;}
+
+    void set_sample_offset(int offset) {_sample_offset = offset;}
+
 protected:
     BaseRtEvent(RtEventType type, ObjectId target, int offset) : _type(type),
+                                                                 _trace_id(0),
                                                                  _processor_id(target),
                                                                  _sample_offset(offset) {}
     RtEventType _type;
+    uint16_t _trace_id;
     ObjectId _processor_id;
     int _sample_offset;
 };
@@ -574,6 +591,23 @@ private:
     ClipChannelType _channel_type;
 };
 
+/* RtEvent for notifying the engine of an xrun or missed processing deadline. The
+ * report slot it points to belongs to the engine's XrunMonitor and must be released
+ * by the receiver once the report is copied */
+class XrunNotificationRtEvent : public BaseRtEvent
+{
+public:
+    XrunNotificationRtEvent(int offset, performance::XrunReportSlot* report_slot) : BaseRtEvent(RtEventType::XRUN_NOTIFICATION,
+                                                                                                0,
+                                                                                                offset),
+                                                                                    _report_slot(report_slot) {}
+
+    performance::XrunReportSlot* report_slot() const {return _report_slot;}
+
+private:
+    performance::XrunReportSlot* _report_slot;
+};
+
 /**
  * @brief Container class for rt events. Functionally this takes the role of a
  *        baseclass for events, from which you can access the derived event
@@ -591,6 +625,12 @@ public:
 
     int sample_offset() const {return _base_event.sample_offset();}
 
+    uint16_t trace_id() const {return _base_event.trace_id();}
+
+    void set_trace_id(uint16_t trace_id) {_base_event.set_trace_id(trace_id);}
+
+    void set_sample_offset(int offset) {_base_event.set_sample_offset(offset);}
+
     /* Access functions protected by asserts */
     const KeyboardRtEvent* keyboard_event() const
     {
@@ -788,6 +828,12 @@ public:
         return &_clip_notification_event;
     }
 
+    const XrunNotificationRtEvent* xrun_notification_event() const
+    {
+        assert(_xrun_notification_event.type() == RtEventType::XRUN_NOTIFICATION);
+        return &_xrun_notification_event;
+    }
+
 
     /* Factory functions for constructing events */
     static RtEvent make_note_on_event(ObjectId target, int offset, int channel, int note, float velocity)
@@ -1056,6 +1102,12 @@ public:
         return typed_event;
     }
 
+    static RtEvent make_xrun_notification_event(int offset, performance::XrunReportSlot* report_slot)
+    {
+        XrunNotificationRtEvent typed_event(offset, report_slot);
+        return typed_event;
+    }
+
 
 private:
     /* Private constructors that are invoked automatically when using the make_xxx_event functions */
@@ -1083,6 +1135,7 @@ private:
     RtEvent(const PlayingModeRtEvent& e)                : _playing_mode_event(e) {}
     RtEvent(const SyncModeRtEvent& e)                   : _sync_mode_event(e) {}
     RtEvent(const ClipNotificationRtEvent& e)           : _clip_notification_event(e) {}
+    RtEvent(const XrunNotificationRtEvent& e)           : _xrun_notification_event(e) {}
     /* Data storage */
     union
     {
@@ -1111,6 +1164,7 @@ private:
         PlayingModeRtEvent            _playing_mode_event;
         SyncModeRtEvent               _sync_mode_event;
         ClipNotificationRtEvent       _clip_notification_event;
+        XrunNotificationRtEvent       _xrun_notification_event;
     };
 };
 
@@ -1134,6 +1188,34 @@ static inline bool is_keyboard_event(const RtEvent event)
     return false;
 }
 
+/**
+ * @brief Non-owning view of a contiguous range of RtEvents. Used for passing several
+ *        events to the same processor in one call.
+ */
+class RtEventSpan
+{
+public:
+    RtEventSpan(const RtEvent* data, int size) : _data(data), _size(size) {}
+
+    const RtEvent* begin() const {return _data;}
+
+    const RtEvent* end() const {return _data + _size;}
+
+    const RtEvent& operator[](int i) const
+    {
+        assert(i < _size);
+        return _data[i];
+    }
+
+    int size() const {return _size;}
+
+    bool empty() const {return _size == 0;}
+
+private:
+    const RtEvent* _data;
+    int _size;
+};
+
 } // namespace sushi
 
 #endif //SUSHI_RT_EVENTS_H
@@ -25,6 +25,7 @@
 #include "library/simple_fifo.h"
 #include "library/rt_event.h"
 #include "library/rt_event_pipe.h"
+#include "library/metrics.h"
 
 namespace sushi {
 
@@ -37,7 +38,15 @@ class RtSafeRtEventFifo : public RtEventPipe
 {
 public:
 
-    inline bool push(const RtEvent& event) {return _fifo.push(event);}
+    inline bool push(const RtEvent& event)
+    {
+        bool pushed = _fifo.push(event);
+        if (pushed == false && _dropped_events)
+        {
+            _dropped_events->increment();
+        }
+        return pushed;
+    }
 
     inline bool pop(RtEvent& event)
     {
@@ -48,8 +57,14 @@ public:
 
     void send_event(const RtEvent &event) override {push(event);}
 
+    /**
+     * @brief Set a counter to increment when an event is dropped because the queue is full
+     */
+    void set_dropped_events_counter(performance::Counter* counter) {_dropped_events = counter;}
+
 private:
     memory_relaxed_aquire_release::CircularFifo<RtEvent, MAX_EVENTS_IN_QUEUE> _fifo;
+    performance::Counter* _dropped_events{nullptr};
 };
 
 /**
@@ -239,37 +239,37 @@ public:
 
     /**
      * @brief Copy interleaved audio data from interleaved_buf to this buffer.
+     *        interleaved_buf must hold size frames of channel_count() channels.
      */
     void from_interleaved(const float* interleaved_buf)
     {
+        /* Fixed channel counts let the compiler vectorise the shuffles */
         switch (_channel_count)
         {
-            case 2:  // Most common case, others are mostly included for future compatibility
-            {
-                float* l_in = _buffer;
-                float* r_in = _buffer + size;
-                for (int n = 0; n < size; ++n)
-                {
-                    *l_in++ = *interleaved_buf++;
-                    *r_in++ = *interleaved_buf++;
-                }
-                break;
-            }
             case 1:
-            {
                 std::copy(interleaved_buf, interleaved_buf + size, _buffer);
                 break;
-            }
+            case 2:  // Most common case
+                _deinterleave<2>(interleaved_buf, _buffer);
+                break;
+            case 4:
+                _deinterleave<4>(interleaved_buf, _buffer);
+                break;
+            case 6:
+                _deinterleave<6>(interleaved_buf, _buffer);
+                break;
+            case 8:
+                _deinterleave<8>(interleaved_buf, _buffer);
+                break;
             default:
-            {
-                for (int n = 0; n < size; ++n)
+                for (int c = 0; c < _channel_count; ++c)
                 {
-                    for (int c = 0; c < _channel_count; ++c)
+                    float* dest = _buffer + c * size;
+                    for (int n = 0; n < size; ++n)
                     {
-                        _buffer[n + c * _channel_count] = *interleaved_buf++;
+                        dest[n] = interleaved_buf[n * _channel_count + c];
                     }
                 }
-            }
         }
     }
 
@@ -280,32 +280,30 @@ public:
     {
         switch (_channel_count)
         {
-            case 2:  // Most common case, others are mostly included for future compatibility
-            {
-                float* l_out = _buffer;
-                float* r_out = _buffer + size;
-                for (int n = 0; n < size; ++n)
-                {
-                    *interleaved_buf++ = *l_out++;
-                    *interleaved_buf++ = *r_out++;
-                }
-                break;
-            }
             case 1:
-            {
                 std::copy(_buffer, _buffer + size, interleaved_buf);
                 break;
-            }
+            case 2:  // Most common case
+                _interleave<2>(_buffer, interleaved_buf);
+                break;
+            case 4:
+                _interleave<4>(_buffer, interleaved_buf);
+                break;
+            case 6:
+                _interleave<6>(_buffer, interleaved_buf);
+                break;
+            case 8:
+                _interleave<8>(_buffer, interleaved_buf);
+                break;
             default:
-            {
-                for (int n = 0; n < size; ++n)
+                for (int c = 0; c < _channel_count; ++c)
                 {
-                    for (int c = 0; c < _channel_count; ++c)
+                    const float* source = _buffer + c * size;
+                    for (int n = 0; n < size; ++n)
                     {
-                        *interleaved_buf++ = _buffer[n + c * size];
+                        interleaved_buf[n * _channel_count + c] = source[n];
                     }
                 }
-            }
         }
     }
 
@@ -591,6 +589,30 @@ public:
     }
 
 private:
+    template <int channels>
+    static void _deinterleave(const float* __restrict interleaved_buf, float* __restrict buffer)
+    {
+        for (int n = 0; n < size; ++n)
+        {
+            for (int c = 0; c < channels; ++c)
+            {
+                buffer[c * size + n] = interleaved_buf[n * channels + c];
+            }
+        }
+    }
+
+    template <int channels>
+    static void _interleave(const float* __restrict buffer, float* __restrict interleaved_buf)
+    {
+        for (int n = 0; n < size; ++n)
+        {
+            for (int c = 0; c < channels; ++c)
+            {
+                interleaved_buf[n * channels + c] = buffer[c * size + n];
+            }
+        }
+    }
+
     int _channel_count;
     bool _own_buffer;
     float* _buffer;
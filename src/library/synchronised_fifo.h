@@ -63,6 +63,12 @@ public:
     {
         return _queue.empty();
     }
+
+    size_t size()
+    {
+        std::lock_guard<std::mutex> lock(_queue_mutex);
+        return _queue.size();
+    }
 private:
     std::deque<T>           _queue;
     std::mutex              _queue_mutex;
@@ -0,0 +1,155 @@
+/*
+ * Copyright 2017-2021 Modern Ancient Instruments Networked AB, dba Elk
+ *
+ * SUSHI is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU Affero General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * SUSHI is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along with
+ * SUSHI.  If not, see http://www.gnu.org/licenses/
+ */
+
+/**
+ * @brief Realtime safe recording of processing sections for timeline visualisation
+ * @copyright 2017-2021 Modern Ancient Instruments Networked AB, dba Elk, Stockholm
+ */
+
+#include <cassert>
+#include <thread>
+
+#include "trace_recorder.h"
+
+namespace sushi {
+namespace performance {
+
+constexpr double NANOSEC_TO_MICROSEC = 0.001;
+constexpr int TIMESTAMP_DECIMALS = 3;
+
+std::string escape_json(const std::string& text)
+{
+    std::string escaped;
+    escaped.reserve(text.size());
+    for (char c : text)
+    {
+        if (c == '"' || c == '\\')
+        {
+            escaped.push_back('\\');
+            escaped.push_back(c);
+        }
+        else if (static_cast<unsigned char>(c) >= 0x20)
+        {
+            escaped.push_back(c);
+        }
+    }
+    return escaped;
+}
+
+void TraceRecorder::set_threads(const std::vector<std::string>& names)
+{
+    assert(_enabled == false);
+    _thread_names = names;
+    _threads.clear();
+}
+
+void TraceRecorder::enable(bool enabled)
+{
+    if (enabled && _threads.empty())
+    {
+        for (unsigned int i = 0; i < _thread_names.size(); ++i)
+        {
+            _threads.push_back(std::make_unique<ThreadBuffer>());
+        }
+    }
+    _enabled.store(enabled, std::memory_order_release);
+}
+
+void TraceRecorder::write_chrome_trace(std::ostream& output, const TraceNodeNames& node_names)
+{
+    bool was_enabled = _pause();
+
+    // Timestamps are written relative to the first recorded section to keep them readable
+    auto time_origin = std::chrono::nanoseconds::max();
+    for (const auto& thread : _threads)
+    {
+        uint64_t count = std::min<uint64_t>(thread->write_index, TRACE_BUFFER_SIZE);
+        for (uint64_t i = 0; i < count; ++i)
+        {
+            time_origin = std::min(time_origin, thread->sections[i].start);
+        }
+    }
+
+    /* Microseconds with nanosecond resolution, the default precision of 6 digits
+     * would round timestamps to whole microseconds after 1 second */
+    auto flags = output.flags();
+    auto precision = output.precision(TIMESTAMP_DECIMALS);
+    output << std::fixed;
+
+    output << "{\"traceEvents\":[\n";
+    bool first = true;
+    for (int t = 0; t < static_cast<int>(_threads.size()); ++t)
+    {
+        if (!first)
+        {
+            output << ",\n";
+        }
+        first = false;
+        output << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << t
+               << ",\"args\":{\"name\":\"" << escape_json(_thread_names[t]) << "\"}}";
+
+        const auto& thread = *_threads[t];
+        uint64_t end = thread.write_index;
+        uint64_t begin = end > TRACE_BUFFER_SIZE ? end - TRACE_BUFFER_SIZE : 0;
+        for (uint64_t i = begin; i < end; ++i)
+        {
+            const auto& section = thread.sections[i % TRACE_BUFFER_SIZE];
+            output << ",\n{\"name\":\"" << escape_json(node_names(section.id))
+                   << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << t
+                   << ",\"ts\":" << (section.start - time_origin).count() * NANOSEC_TO_MICROSEC
+                   << ",\"dur\":" << (section.end - section.start).count() * NANOSEC_TO_MICROSEC << "}";
+        }
+    }
+    output << "\n]}\n";
+    output.flags(flags);
+    output.precision(precision);
+
+    if (was_enabled)
+    {
+        _enabled = true;
+    }
+}
+
+void TraceRecorder::clear()
+{
+    bool was_enabled = _pause();
+    for (auto& thread : _threads)
+    {
+        thread->write_index = 0;
+    }
+    if (was_enabled)
+    {
+        _enabled = true;
+    }
+}
+
+bool TraceRecorder::_pause()
+{
+    bool was_enabled = _enabled.exchange(false, std::memory_order_seq_cst);
+    if (was_enabled)
+    {
+        for (const auto& thread : _threads)
+        {
+            while (thread->writing.load(std::memory_order_seq_cst))
+            {
+                std::this_thread::yield();
+            }
+        }
+    }
+    return was_enabled;
+}
+
+} // namespace performance
+} // namespace sushi
@@ -0,0 +1,140 @@
+/*
+ * Copyright 2017-2021 Modern Ancient Instruments Networked AB, dba Elk
+ *
+ * SUSHI is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU Affero General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * SUSHI is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along with
+ * SUSHI.  If not, see http://www.gnu.org/licenses/
+ */
+
+/**
+ * @brief Realtime safe recording of processing sections for timeline visualisation
+ * @copyright 2017-2021 Modern Ancient Instruments Networked AB, dba Elk, Stockholm
+ */
+
+#ifndef SUSHI_TRACE_RECORDER_H
+#define SUSHI_TRACE_RECORDER_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "base_performance_timer.h"
+#include "constants.h"
+
+namespace sushi {
+namespace performance {
+
+/* Number of sections kept per thread, older sections are overwritten */
+constexpr int TRACE_BUFFER_SIZE = 32768;
+
+/**
+ * @brief Records the start and end time of processing sections into one preallocated
+ *        ring buffer per thread and writes them as Chrome trace event JSON, which can be
+ *        opened in chrome://tracing or ui.perfetto.dev.
+ */
+class TraceRecorder
+{
+public:
+    SUSHI_DECLARE_NON_COPYABLE(TraceRecorder);
+
+    TraceRecorder() = default;
+
+    /**
+     * @brief Set the threads that will record sections. Must not be called while
+     *        recording is enabled.
+     * @param names The display name of every thread, indexed by the thread index
+     *        passed to record()
+     */
+    void set_threads(const std::vector<std::string>& names);
+
+    /**
+     * @brief Enable or disable recording. Buffers are allocated on the first call to
+     *        enable(true) so no memory is used unless tracing is used.
+     */
+    void enable(bool enabled);
+
+    bool enabled() const
+    {
+        return _enabled.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Record a processing section. Realtime safe, but each thread index must
+     *        only be used from one thread at a time.
+     * @param thread The index of the calling thread
+     * @param id An id identifying the section, i.e. a processor id
+     * @param start Start time of the section
+     * @param end End time of the section
+     */
+    void record(int thread, int id, std::chrono::nanoseconds start, std::chrono::nanoseconds end)
+    {
+        if (enabled() && thread < static_cast<int>(_threads.size()))
+        {
+            auto& buffer = *_threads[thread];
+            /* Flag the buffer as busy before checking _enabled again, readers clear
+             * _enabled before checking the flag so either the section is dropped here
+             * or the reader waits until it is written */
+            buffer.writing.store(true, std::memory_order_seq_cst);
+            if (_enabled.load(std::memory_order_seq_cst))
+            {
+                auto index = buffer.write_index.load(std::memory_order_relaxed);
+                buffer.sections[index % TRACE_BUFFER_SIZE] = {id, start, end};
+                buffer.write_index.store(index + 1, std::memory_order_release);
+            }
+            buffer.writing.store(false, std::memory_order_release);
+        }
+    }
+
+    /**
+     * @brief Write all recorded sections as Chrome trace event JSON. Recording is paused
+     *        while the buffers are read.
+     * @param output The stream to write to
+     * @param node_names Function returning a display name for a section id
+     */
+    void write_chrome_trace(std::ostream& output, const TraceNodeNames& node_names);
+
+    /**
+     * @brief Clear all recorded sections
+     */
+    void clear();
+
+private:
+    /* Disable recording and wait until no thread is writing a section,
+     * returns whether recording was enabled */
+    bool _pause();
+
+    struct Section
+    {
+        int id;
+        std::chrono::nanoseconds start;
+        std::chrono::nanoseconds end;
+    };
+
+    struct ThreadBuffer
+    {
+        std::array<Section, TRACE_BUFFER_SIZE> sections;
+        std::atomic<uint64_t> write_index{0};
+        std::atomic_bool writing{false};
+    };
+
+    std::vector<std::unique_ptr<ThreadBuffer>> _threads;
+    std::vector<std::string> _thread_names{"Audio thread"};
+    std::atomic_bool _enabled{false};
+};
+
+} // namespace performance
+} // namespace sushi
+
+#endif //SUSHI_TRACE_RECORDER_H
@@ -36,6 +36,7 @@ std::pair<ProcessorReturnCode, std::shared_ptr<Processor>> Vst2xProcessorFactory
                                                                                                HostControl& host_control,
                                                                                                float sample_rate)
 {
+    std::lock_guard<std::mutex> lock(_instantiation_lock);
     auto processor = std::make_shared<Vst2xWrapper>(host_control, plugin_info.path);
     auto processor_status = processor->init(sample_rate);
     return {processor_status, processor};
@@ -21,6 +21,8 @@
 #ifndef SUSHI_VST2X_PROCESSOR_FACTORY_H
 #define SUSHI_VST2X_PROCESSOR_FACTORY_H
 
+#include <mutex>
+
 #include "library/base_processor_factory.h"
 
 namespace sushi {
@@ -32,6 +34,9 @@ public:
     std::pair<ProcessorReturnCode, std::shared_ptr<Processor>> new_instance(const sushi::engine::PluginInfo& plugin_info,
                                                                             HostControl& host_control,
                                                                             float sample_rate) override;
+private:
+    // Plugin libraries are not guaranteed to be safe to load and initialise concurrently
+    std::mutex _instantiation_lock;
 };
 
 } // end namespace vst2
@@ -42,6 +42,7 @@ std::pair<ProcessorReturnCode, std::shared_ptr<Processor>> Vst3xProcessorFactory
                                                                                                HostControl& host_control,
                                                                                                float sample_rate)
 {
+    std::lock_guard<std::mutex> lock(_instantiation_lock);
     auto processor = std::make_shared<Vst3xWrapper>(host_control,
                                                     plugin_info.path,
                                                     plugin_info.uid,
@@ -21,6 +21,7 @@
 #define SUSHI_VST3X_PROCESSOR_FACTORY_H
 
 #include <memory>
+#include <mutex>
 
 #include "library/base_processor_factory.h"
 
@@ -39,6 +40,8 @@ public:
                                                                             HostControl& host_control,
                                                                             float sample_rate) override;
 private:
+    // Guards _host_app, which is shared by all instances and not thread safe
+    std::mutex _instantiation_lock;
     std::unique_ptr<SushiHostApplication> _host_app;
 };
 
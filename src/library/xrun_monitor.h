@@ -0,0 +1,237 @@
+/*
+ * Copyright 2017-2021 Modern Ancient Instruments Networked AB, dba Elk
+ *
+ * SUSHI is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU Affero General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * SUSHI is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along with
+ * SUSHI.  If not, see http://www.gnu.org/licenses/
+ */
+
+/**
+ * @brief Detection and reporting of xruns and missed processing deadlines
+ * @copyright 2017-2021 Modern Ancient Instruments Networked AB, dba Elk, Stockholm
+ */
+
+#ifndef SUSHI_XRUN_MONITOR_H
+#define SUSHI_XRUN_MONITOR_H
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "constants.h"
+#include "id_generator.h"
+#include "metrics.h"
+
+namespace sushi {
+namespace performance {
+
+/* Number of slowest tracks and processors included in an xrun report */
+constexpr int XRUN_SNAPSHOT_NODES = 4;
+/* Number of reports that can be in flight to the non-rt side at the same time */
+constexpr int XRUN_REPORT_SLOTS = 16;
+
+enum class XrunSource
+{
+    ENGINE_OVERRUN,
+    AUDIO_FRONTEND
+};
+
+struct XrunNodeLoad
+{
+    ObjectId id;
+    float load;
+};
+
+/**
+ * @brief Snapshot of a chunk in which an xrun occurred. Loads are expressed as
+ *        fractions of the chunk period.
+ */
+struct XrunReport
+{
+    XrunSource source{XrunSource::ENGINE_OVERRUN};
+    float chunk_load{0};
+    int node_count{0};
+    std::array<XrunNodeLoad, XRUN_SNAPSHOT_NODES> slowest_nodes{};
+
+    /**
+     * @brief Add a track or processor to the snapshot if it is among the
+     *        XRUN_SNAPSHOT_NODES slowest added so far. Nodes are kept sorted
+     *        with the slowest first.
+     */
+    void add_node(ObjectId id, float load)
+    {
+        int pos = node_count;
+        while (pos > 0 && slowest_nodes[pos - 1].load < load)
+        {
+            if (pos < XRUN_SNAPSHOT_NODES)
+            {
+                slowest_nodes[pos] = slowest_nodes[pos - 1];
+            }
+            pos--;
+        }
+        if (pos < XRUN_SNAPSHOT_NODES)
+        {
+            slowest_nodes[pos] = {id, load};
+            node_count = std::min(node_count + 1, XRUN_SNAPSHOT_NODES);
+        }
+    }
+};
+
+/**
+ * @brief An XrunReport handed from the audio thread to the non-rt side by pointer.
+ *        The slot is owned by the non-rt side until it calls release() after it
+ *        has copied the report, and the monitor won't reuse it before that.
+ */
+struct XrunReportSlot
+{
+    XrunReport report;
+    std::atomic_bool in_use{false};
+
+    void release()
+    {
+        in_use.store(false, std::memory_order_release);
+    }
+};
+
+struct XrunCounts
+{
+    int engine_overruns{0};
+    int frontend_xruns{0};
+};
+
+/**
+ * @brief Keeps count of xruns and hands out reports for the audio thread to fill in.
+ *        The engine checks the processing time of every chunk against the chunk
+ *        period, audio frontends report xruns detected by the audio driver, and
+ *        these are attributed to the next chunk processed by the engine.
+ */
+class XrunMonitor
+{
+public:
+    SUSHI_DECLARE_NON_COPYABLE(XrunMonitor);
+
+    /**
+     * @param metrics Where to register the xrun counters
+     */
+    explicit XrunMonitor(MetricsScope& metrics)
+    {
+        _engine_overrun_counter = metrics.counter("sushi_engine_overruns_total",
+                                                  "Chunks where processing took longer than the chunk period");
+        _frontend_xrun_counter = metrics.counter("sushi_frontend_xruns_total",
+                                                 "Xruns reported by the audio frontend");
+    }
+
+    /**
+     * @brief Set the chunk period that processing times are compared against
+     * @param samplerate The samplerate in Hz
+     * @param buffer_size The audio buffer size in samples
+     */
+    void set_timing_period(float samplerate, int buffer_size)
+    {
+        _period = std::chrono::nanoseconds(static_cast<int64_t>(1'000'000'000.0 * buffer_size / samplerate));
+    }
+
+    /**
+     * @brief Called by audio frontends when the audio driver reports an xrun.
+     *        Safe to call from any thread.
+     */
+    void report_frontend_xrun()
+    {
+        _frontend_xruns.fetch_add(1, std::memory_order_relaxed);
+        _frontend_xrun_counter->increment();
+        _frontend_xrun_pending.store(true, std::memory_order_release);
+    }
+
+    /**
+     * @brief Called from the audio thread after every chunk with the time it took to
+     *        process it.
+     * @param process_time The processing time of the chunk
+     * @return A slot with a report to fill in with the slowest nodes of the chunk and
+     *         pass on to the non-rt side if an xrun should be reported, nullptr
+     *         otherwise. Also nullptr if all slots are still in use, the xrun is still
+     *         counted but no report is made. The receiver must release the slot.
+     */
+    XrunReportSlot* check_chunk(std::chrono::nanoseconds process_time)
+    {
+        float chunk_load = load(process_time);
+        XrunSource source;
+        if (chunk_load > 1.0f)
+        {
+            _engine_overruns.fetch_add(1, std::memory_order_relaxed);
+            _engine_overrun_counter->increment();
+            source = XrunSource::ENGINE_OVERRUN;
+        }
+        else if (_frontend_xrun_pending.exchange(false, std::memory_order_acq_rel))
+        {
+            source = XrunSource::AUDIO_FRONTEND;
+        }
+        else
+        {
+            return nullptr;
+        }
+        for (int i = 0; i < XRUN_REPORT_SLOTS; ++i)
+        {
+            auto& slot = _reports[_next_report];
+            _next_report = (_next_report + 1) % XRUN_REPORT_SLOTS;
+            if (slot.in_use.load(std::memory_order_acquire) == false)
+            {
+                slot.in_use.store(true, std::memory_order_relaxed);
+                slot.report = XrunReport();
+                slot.report.source = source;
+                slot.report.chunk_load = chunk_load;
+                return &slot;
+            }
+        }
+        return nullptr;
+    }
+
+    /**
+     * @brief Convert a processing time to a fraction of the chunk period
+     */
+    float load(std::chrono::nanoseconds process_time) const
+    {
+        if (_period.count() == 0)
+        {
+            return 0.0f;
+        }
+        return static_cast<float>(process_time.count()) / static_cast<float>(_period.count());
+    }
+
+    XrunCounts counts() const
+    {
+        return {_engine_overruns.load(std::memory_order_relaxed), _frontend_xruns.load(std::memory_order_relaxed)};
+    }
+
+    void reset_counts()
+    {
+        _engine_overruns.store(0, std::memory_order_relaxed);
+        _frontend_xruns.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    std::array<XrunReportSlot, XRUN_REPORT_SLOTS> _reports;
+    int _next_report{0};
+    std::chrono::nanoseconds _period{0};
+
+    std::atomic<int> _engine_overruns{0};
+    std::atomic<int> _frontend_xruns{0};
+    std::atomic_bool _frontend_xrun_pending{false};
+
+    /* Exported counters are never reset, unlike the counts above */
+    Counter* _engine_overrun_counter;
+    Counter* _frontend_xrun_counter;
+};
+
+} // namespace performance
+} // namespace sushi
+
+#endif //SUSHI_XRUN_MONITOR_H
@@ -21,19 +21,28 @@
 #include <vector>
 #include <iostream>
 #include <csignal>
+#include <stdexcept>
 #include <condition_variable>
+#include <thread>
 
 #include "twine/src/twine_internal.h"
 
 #include "logging.h"
 #include "engine/audio_engine.h"
 #include "audio_frontends/offline_frontend.h"
+#include "audio_frontends/offline_batch_renderer.h"
+#include "audio_frontends/pipe_frontend.h"
+#include "audio_frontends/shm_frontend.h"
 #include "audio_frontends/jack_frontend.h"
+#include "audio_frontends/alsa_frontend.h"
 #include "audio_frontends/xenomai_raspa_frontend.h"
 #include "engine/json_configurator.h"
 #include "control_frontends/osc_frontend.h"
 #include "control_frontends/alsa_midi_frontend.h"
 #include "library/parameter_dump.h"
+#include "library/benchmark_report.h"
+#include "library/metrics_exporter.h"
+#include "library/event_tracer.h"
 #include "compile_time_settings.h"
 
 #ifdef SUSHI_BUILD_WITH_RPC_INTERFACE
@@ -44,11 +53,17 @@ enum class FrontendType
 {
     OFFLINE,
     DUMMY,
+    PIPE,
+    SHM,
     JACK,
+    ALSA,
     XENOMAI_RASPA,
     NONE
 };
 
+/* How often to check if the input of the pipe frontend has ended */
+constexpr auto PIPE_END_POLL_INTERVAL = std::chrono::milliseconds(100);
+
 bool                    exit_flag = false;
 bool                    exit_condition() {return exit_flag;}
 std::condition_variable exit_notifier;
@@ -71,6 +86,25 @@ void error_exit(const std::string& message)
     std::exit(1);
 }
 
+int positive_integer_or_exit(const std::string& option_name, const char* argument)
+{
+    int value = 0;
+    size_t parsed_chars = 0;
+    try
+    {
+        value = std::stoi(argument, &parsed_chars);
+    }
+    catch (const std::logic_error&)
+    {
+        parsed_chars = 0;
+    }
+    if (parsed_chars == 0 || argument[parsed_chars] != '\0' || value <= 0)
+    {
+        error_exit("Option '" + option_name + "' requires a positive integer, got: " + std::string(argument));
+    }
+    return value;
+}
+
 void print_version_and_build_info()
 {
     std::cout << "\nVersion "   << CompileTimeSettings::sushi_version << std::endl;
@@ -131,14 +165,27 @@ int main(int argc, char* argv[])
         return 0;
     }
 
-    std::string input_filename;
+    std::vector<std::string> input_filenames;
     std::string output_filename;
+    bool output_stems = false;
+    std::string batch_source;
+    std::string batch_output_dir;
+    int  batch_jobs = static_cast<int>(std::thread::hardware_concurrency());
+    std::string pipe_input = sushi::audio_frontend::PIPE_STDIO_PATH;
+    std::string pipe_output = sushi::audio_frontend::PIPE_STDIO_PATH;
+    auto pipe_format = sushi::audio_frontend::PipeSampleFormat::FLOAT_32;
+    int  pipe_channels = 2;
+    bool pipe_clocked = false;
+    std::string shm_name;
 
     std::string log_level = std::string(CompileTimeSettings::log_level_default);
     std::string log_filename = std::string(CompileTimeSettings::log_filename_default);
     std::string config_filename = std::string(CompileTimeSettings::json_filename_default);
     std::string jack_client_name = std::string(CompileTimeSettings::jack_client_name_default);
     std::string jack_server_name = std::string("");
+    std::string alsa_device = std::string("default");
+    int  alsa_period = AUDIO_CHUNK_SIZE;
+    int  alsa_periods = 2;
     int osc_server_port = CompileTimeSettings::osc_server_port;
     int osc_send_port = CompileTimeSettings::osc_send_port;
     std::string grpc_listening_address = CompileTimeSettings::grpc_listening_port;
@@ -147,8 +194,15 @@ int main(int argc, char* argv[])
     bool debug_mode_switches = false;
     int  rt_cpu_cores = 1;
     bool enable_timings = false;
+    int  timing_sampling_interval = 1;
+    std::string trace_filename;
+    bool enable_event_latency_tracing = false;
+    std::string metrics_filename;
+    std::string metrics_socket_path;
+    bool enable_rt_midi_input = false;
     bool enable_flush_interval = false;
     bool enable_parameter_dump = false;
+    int  benchmark_seconds = 0;
     std::chrono::seconds log_flush_interval = std::chrono::seconds(0);
 
     for (int i = 0; i<cl_parser.optionsCount(); i++)
@@ -195,17 +249,74 @@ int main(int argc, char* argv[])
             break;
 
         case OPT_IDX_INPUT_FILE:
-            input_filename.assign(opt.arg);
+            input_filenames.emplace_back(opt.arg);
             break;
 
         case OPT_IDX_OUTPUT_FILE:
             output_filename.assign(opt.arg);
             break;
 
+        case OPT_IDX_OUTPUT_STEMS:
+            output_stems = true;
+            break;
+
+        case OPT_IDX_BATCH:
+            batch_source.assign(opt.arg);
+            break;
+
+        case OPT_IDX_BATCH_JOBS:
+            batch_jobs = atoi(opt.arg);
+            break;
+
+        case OPT_IDX_OUTPUT_DIR:
+            batch_output_dir.assign(opt.arg);
+            break;
+
+        case OPT_IDX_USE_PIPE:
+            frontend_type = FrontendType::PIPE;
+            break;
+
+        case OPT_IDX_PIPE_INPUT:
+            pipe_input.assign(opt.arg);
+            break;
+
+        case OPT_IDX_PIPE_OUTPUT:
+            pipe_output.assign(opt.arg);
+            break;
+
+        case OPT_IDX_PIPE_FORMAT:
+            {
+                auto format = sushi::audio_frontend::pipe_format_from_string(opt.arg);
+                if (format.has_value() == false)
+                {
+                    error_exit("Invalid pipe format: " + std::string(opt.arg));
+                }
+                pipe_format = format.value();
+            }
+            break;
+
+        case OPT_IDX_PIPE_CHANNELS:
+            pipe_channels = atoi(opt.arg);
+            break;
+
+        case OPT_IDX_PIPE_CLOCKED:
+            pipe_clocked = true;
+            break;
+
+        case OPT_IDX_USE_SHM:
+            frontend_type = FrontendType::SHM;
+            shm_name.assign(opt.arg);
+            break;
+
         case OPT_IDX_USE_DUMMY:
             frontend_type = FrontendType::DUMMY;
             break;
 
+        case OPT_IDX_BENCHMARK:
+            frontend_type = FrontendType::DUMMY;
+            benchmark_seconds = positive_integer_or_exit("benchmark", opt.arg);
+            break;
+
         case OPT_IDX_USE_JACK:
             frontend_type = FrontendType::JACK;
             break;
@@ -222,6 +333,22 @@ int main(int argc, char* argv[])
             jack_server_name.assign(opt.arg);
             break;
 
+        case OPT_IDX_USE_ALSA:
+            frontend_type = FrontendType::ALSA;
+            if (opt.arg)
+            {
+                alsa_device.assign(opt.arg);
+            }
+            break;
+
+        case OPT_IDX_ALSA_PERIOD:
+            alsa_period = atoi(opt.arg);
+            break;
+
+        case OPT_IDX_ALSA_PERIODS:
+            alsa_periods = atoi(opt.arg);
+            break;
+
         case OPT_IDX_USE_XENOMAI_RASPA:
             frontend_type = FrontendType::XENOMAI_RASPA;
             break;
@@ -238,6 +365,30 @@ int main(int argc, char* argv[])
             enable_timings = true;
             break;
 
+        case OPT_IDX_TIMINGS_SAMPLING:
+            timing_sampling_interval = atoi(opt.arg);
+            break;
+
+        case OPT_IDX_TRACE_FILE:
+            trace_filename.assign(opt.arg);
+            break;
+
+        case OPT_IDX_TRACE_EVENT_LATENCY:
+            enable_event_latency_tracing = true;
+            break;
+
+        case OPT_IDX_METRICS_FILE:
+            metrics_filename.assign(opt.arg);
+            break;
+
+        case OPT_IDX_METRICS_SOCKET:
+            metrics_socket_path.assign(opt.arg);
+            break;
+
+        case OPT_IDX_RT_MIDI_INPUT:
+            enable_rt_midi_input = true;
+            break;
+
         case OPT_IDX_OSC_RECEIVE_PORT:
             osc_server_port = atoi(opt.arg);
             break;
@@ -256,18 +407,22 @@ int main(int argc, char* argv[])
         }
     }
 
-    if (enable_parameter_dump == false)
+    if (enable_parameter_dump == false && benchmark_seconds == 0)
     {
-        print_sushi_headline();
+        // stdout may be carrying audio
+        if (frontend_type != FrontendType::PIPE || pipe_output != sushi::audio_frontend::PIPE_STDIO_PATH)
+        {
+            print_sushi_headline();
+        }
     }
     else
     {
         frontend_type = FrontendType::DUMMY;
     }
 
-    if (output_filename.empty() && !input_filename.empty())
+    if (output_filename.empty() && !input_filenames.empty())
     {
-        output_filename = input_filename + "_proc.wav";
+        output_filename = input_filenames.front() + "_proc.wav";
     }
 
     ////////////////////////////////////////////////////////////////////////////////
@@ -281,6 +436,38 @@ int main(int argc, char* argv[])
 
     SUSHI_GET_LOGGER_WITH_MODULE_NAME("main");
 
+    ////////////////////////////////////////////////////////////////////////////////
+    // Batch rendering, uses its own engine instances //
+    ////////////////////////////////////////////////////////////////////////////////
+
+    if (!batch_source.empty())
+    {
+        auto [jobs_status, jobs] = sushi::audio_frontend::create_batch_jobs(batch_source, batch_output_dir);
+        if (jobs_status == sushi::audio_frontend::BatchRendererStatus::NO_INPUT_FILES)
+        {
+            error_exit("No input files found for batch rendering in " + batch_source);
+        }
+        if (jobs_status != sushi::audio_frontend::BatchRendererStatus::OK)
+        {
+            error_exit("Input files with the same name can't be rendered to the same output directory, check logs for details.");
+        }
+        sushi::audio_frontend::OfflineBatchRenderer batch_renderer(config_filename,
+                                                                   CompileTimeSettings::sample_rate_default,
+                                                                   batch_jobs,
+                                                                   output_stems);
+        if (batch_renderer.init(std::move(jobs)) != sushi::audio_frontend::BatchRendererStatus::OK)
+        {
+            error_exit("Error setting up batch rendering, check logs for details.");
+        }
+        int failed_jobs = batch_renderer.run();
+        if (failed_jobs > 0)
+        {
+            error_exit(std::to_string(failed_jobs) + " files failed to render, check logs for details.");
+        }
+        SUSHI_LOG_INFO("Batch rendering done");
+        return 0;
+    }
+
     ////////////////////////////////////////////////////////////////////////////////
     // Main body //
     ////////////////////////////////////////////////////////////////////////////////
@@ -291,7 +478,7 @@ int main(int argc, char* argv[])
     }
     auto engine = std::make_unique<sushi::engine::AudioEngine>(CompileTimeSettings::sample_rate_default, rt_cpu_cores);
     auto event_dispatcher = engine->event_dispatcher();
-    auto midi_dispatcher = std::make_unique<sushi::midi_dispatcher::MidiDispatcher>(engine->event_dispatcher());
+    auto midi_dispatcher = std::make_unique<sushi::midi_dispatcher::MidiDispatcher>(engine->event_dispatcher(), engine->metrics());
     auto configurator = std::make_unique<sushi::jsonconfig::JsonConfigurator>(engine.get(),
                                                                               midi_dispatcher.get(),
                                                                               engine->processor_container(),
@@ -337,6 +524,18 @@ int main(int argc, char* argv[])
             break;
         }
 
+        case FrontendType::ALSA:
+        {
+            SUSHI_LOG_INFO("Setting up Alsa audio frontend");
+            frontend_config = std::make_unique<sushi::audio_frontend::AlsaFrontendConfiguration>(alsa_device,
+                                                                                                 alsa_period,
+                                                                                                 alsa_periods,
+                                                                                                 cv_inputs,
+                                                                                                 cv_outputs);
+            audio_frontend = std::make_unique<sushi::audio_frontend::AlsaFrontend>(engine.get());
+            break;
+        }
+
         case FrontendType::XENOMAI_RASPA:
         {
             SUSHI_LOG_INFO("Setting up Xenomai RASPA frontend");
@@ -347,6 +546,32 @@ int main(int argc, char* argv[])
             break;
         }
 
+        case FrontendType::PIPE:
+        {
+            SUSHI_LOG_INFO("Setting up pipe audio frontend");
+            frontend_config = std::make_unique<sushi::audio_frontend::PipeFrontendConfiguration>(pipe_input,
+                                                                                                 pipe_output,
+                                                                                                 pipe_format,
+                                                                                                 pipe_channels,
+                                                                                                 pipe_clocked,
+                                                                                                 cv_inputs,
+                                                                                                 cv_outputs);
+            audio_frontend = std::make_unique<sushi::audio_frontend::PipeFrontend>(engine.get());
+            break;
+        }
+
+        case FrontendType::SHM:
+        {
+            SUSHI_LOG_INFO("Setting up shared memory audio frontend");
+            frontend_config = std::make_unique<sushi::audio_frontend::ShmFrontendConfiguration>(shm_name,
+                                                                                                audio_config.audio_inputs.value_or(sushi::audio_frontend::MAX_FRONTEND_CHANNELS),
+                                                                                                audio_config.audio_outputs.value_or(sushi::audio_frontend::MAX_FRONTEND_CHANNELS),
+                                                                                                cv_inputs,
+                                                                                                cv_outputs);
+            audio_frontend = std::make_unique<sushi::audio_frontend::ShmFrontend>(engine.get());
+            break;
+        }
+
         case FrontendType::DUMMY:
         case FrontendType::OFFLINE:
         {
@@ -360,11 +585,14 @@ int main(int argc, char* argv[])
             {
                 SUSHI_LOG_INFO("Setting up offline audio frontend");
             }
-            frontend_config = std::make_unique<sushi::audio_frontend::OfflineFrontendConfiguration>(input_filename,
+            frontend_config = std::make_unique<sushi::audio_frontend::OfflineFrontendConfiguration>(input_filenames,
                                                                                                     output_filename,
                                                                                                     dummy,
                                                                                                     cv_inputs,
-                                                                                                    cv_outputs);
+                                                                                                    cv_outputs,
+                                                                                                    audio_config.audio_inputs.value_or(0),
+                                                                                                    audio_config.audio_outputs.value_or(0),
+                                                                                                    output_stems);
             audio_frontend = std::make_unique<sushi::audio_frontend::OfflineFrontend>(engine.get());
             break;
         }
@@ -436,7 +664,7 @@ int main(int argc, char* argv[])
         error_exit("");
     }
 
-    if (frontend_type == FrontendType::JACK || frontend_type == FrontendType::XENOMAI_RASPA)
+    if (frontend_type == FrontendType::JACK || frontend_type == FrontendType::ALSA || frontend_type == FrontendType::XENOMAI_RASPA)
     {
         midi_frontend = std::make_unique<sushi::midi_frontend::AlsaMidiFrontend>(midi_inputs, midi_outputs, midi_dispatcher.get());
         osc_frontend = std::make_unique<sushi::control_frontend::OSCFrontend>(engine.get(),
@@ -471,6 +699,10 @@ int main(int argc, char* argv[])
         error_exit("Failed to setup Midi frontend");
     }
     midi_dispatcher->set_frontend(midi_frontend.get());
+    if (enable_rt_midi_input)
+    {
+        midi_dispatcher->set_rt_input_queue(engine->rt_input_queue(), engine->event_tracer());
+    }
 
 #ifdef SUSHI_BUILD_WITH_RPC_INTERFACE
     auto rpc_server = std::make_unique<sushi_rpc::GrpcServer>(grpc_listening_address, controller.get());
@@ -480,16 +712,39 @@ int main(int argc, char* argv[])
     // Start everything! //
     ////////////////////////////////////////////////////////////////////////////////
 
+    engine->performance_timer()->set_processor_sampling_interval(timing_sampling_interval);
     if (enable_timings)
     {
         engine->performance_timer()->enable(true);
     }
+    if (!trace_filename.empty())
+    {
+        engine->performance_timer()->enable_tracing(true);
+    }
+    engine->event_tracer()->enable(enable_event_latency_tracing);
 
-    audio_frontend->run();
+    sushi::performance::MetricsExporter metrics_exporter(sushi::performance::MetricsRegistry::global());
+    if (!metrics_filename.empty())
+    {
+        metrics_exporter.set_file(metrics_filename);
+    }
+    if (!metrics_socket_path.empty() && !metrics_exporter.set_socket(metrics_socket_path))
+    {
+        SUSHI_LOG_WARNING("Failed to create metrics socket at {}", metrics_socket_path);
+    }
+    if (!metrics_filename.empty() || !metrics_socket_path.empty())
+    {
+        metrics_exporter.run();
+    }
+
+    if (benchmark_seconds == 0)
+    {
+        audio_frontend->run();
+    }
     event_dispatcher->run();
     midi_frontend->run();
 
-    if (frontend_type == FrontendType::JACK || frontend_type == FrontendType::XENOMAI_RASPA)
+    if (frontend_type == FrontendType::JACK || frontend_type == FrontendType::ALSA || frontend_type == FrontendType::XENOMAI_RASPA)
     {
         osc_frontend->run();
     }
@@ -499,7 +754,28 @@ int main(int argc, char* argv[])
     rpc_server->start();
 #endif
 
-    if (frontend_type != FrontendType::OFFLINE)
+    if (benchmark_seconds > 0)
+    {
+        SUSHI_LOG_INFO("Running benchmark for {} seconds of audio", benchmark_seconds);
+        engine->performance_timer()->enable(true);
+        auto offline_frontend = static_cast<sushi::audio_frontend::OfflineFrontend*>(audio_frontend.get());
+        auto result = offline_frontend->run_benchmark(std::chrono::seconds(benchmark_seconds));
+        SUSHI_LOG_WARNING_IF(result.dropped_timings > 0, "{} timings were dropped, processor timings are incomplete",
+                             result.dropped_timings);
+        // Disabling the timer processes all timings still in its queues
+        engine->performance_timer()->enable(false);
+        std::cout << sushi::generate_benchmark_document(result, controller.get(), engine->performance_timer()) << std::endl;
+    }
+    else if (frontend_type == FrontendType::PIPE)
+    {
+        // Run until the input stream ends or Sushi is stopped
+        auto pipe_frontend = static_cast<sushi::audio_frontend::PipeFrontend*>(audio_frontend.get());
+        std::mutex m;
+        std::unique_lock<std::mutex> lock(m);
+        while (exit_notifier.wait_for(lock, PIPE_END_POLL_INTERVAL, exit_condition) == false &&
+               pipe_frontend->stream_ended() == false) {}
+    }
+    else if (frontend_type != FrontendType::OFFLINE)
     {
         std::mutex m;
         std::unique_lock<std::mutex> lock(m);
@@ -512,8 +788,31 @@ int main(int argc, char* argv[])
 
     audio_frontend->cleanup();
     event_dispatcher->stop();
+    metrics_exporter.stop();
+
+    if (!trace_filename.empty() && !engine->write_trace_to_file(trace_filename))
+    {
+        SUSHI_LOG_WARNING("Failed to write trace to {}", trace_filename);
+    }
+
+    if (enable_event_latency_tracing)
+    {
+        using sushi::performance::TraceSource;
+        using sushi::performance::TraceSegment;
+        auto& tracer = *engine->event_tracer();
+        tracer.collect();
+        for (auto [source, name] : {std::pair{TraceSource::MIDI, "Midi"},
+                                    std::pair{TraceSource::OSC, "Osc"},
+                                    std::pair{TraceSource::GRPC, "gRPC"}})
+        {
+            auto total = tracer.latency(source, TraceSegment::TOTAL);
+            auto delivery = tracer.latency(source, TraceSegment::DELIVERY);
+            SUSHI_LOG_INFO("{} event latency (ms): p50 {}, p99 {}, max {}. Of which in realtime queue: p50 {}, p99 {}, max {}",
+                           name, total.p50, total.p99, total.max, delivery.p50, delivery.p99, delivery.max);
+        }
+    }
 
-    if (frontend_type == FrontendType::JACK || frontend_type == FrontendType::XENOMAI_RASPA)
+    if (frontend_type == FrontendType::JACK || frontend_type == FrontendType::ALSA || frontend_type == FrontendType::XENOMAI_RASPA)
     {
         osc_frontend->stop();
         midi_frontend->stop();
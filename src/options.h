@@ -110,15 +110,36 @@ enum OptionIndex
     OPT_IDX_USE_OFFLINE,
     OPT_IDX_INPUT_FILE,
     OPT_IDX_OUTPUT_FILE,
+    OPT_IDX_OUTPUT_STEMS,
+    OPT_IDX_BATCH,
+    OPT_IDX_BATCH_JOBS,
+    OPT_IDX_OUTPUT_DIR,
+    OPT_IDX_USE_PIPE,
+    OPT_IDX_PIPE_INPUT,
+    OPT_IDX_PIPE_OUTPUT,
+    OPT_IDX_PIPE_FORMAT,
+    OPT_IDX_PIPE_CHANNELS,
+    OPT_IDX_PIPE_CLOCKED,
+    OPT_IDX_USE_SHM,
     OPT_IDX_USE_DUMMY,
+    OPT_IDX_BENCHMARK,
     OPT_IDX_USE_JACK,
     OPT_IDX_CONNECT_PORTS,
     OPT_IDX_JACK_CLIENT,
     OPT_IDX_JACK_SERVER,
+    OPT_IDX_USE_ALSA,
+    OPT_IDX_ALSA_PERIOD,
+    OPT_IDX_ALSA_PERIODS,
     OPT_IDX_USE_XENOMAI_RASPA,
     OPT_IDX_XENOMAI_DEBUG_MODE_SW,
     OPT_IDX_MULTICORE_PROCESSING,
     OPT_IDX_TIMINGS_STATISTICS,
+    OPT_IDX_TIMINGS_SAMPLING,
+    OPT_IDX_TRACE_FILE,
+    OPT_IDX_TRACE_EVENT_LATENCY,
+    OPT_IDX_METRICS_FILE,
+    OPT_IDX_METRICS_SOCKET,
+    OPT_IDX_RT_MIDI_INPUT,
     OPT_IDX_OSC_RECEIVE_PORT,
     OPT_IDX_OSC_SEND_PORT,
     OPT_IDX_GRPC_LISTEN_ADDRESS
@@ -213,7 +234,7 @@ const optionparser::Descriptor usage[] =
         "i",
         "input",
         SushiArg::NonEmpty,
-        "\t\t-i <filename>, --input=<filename> \tSpecify input file, required for --offline option."
+        "\t\t-i <filename>, --input=<filename> \tSpecify input file, required for --offline option. Can be given several times, the channels of all files are mapped to consecutive engine inputs."
     },
     {
         OPT_IDX_OUTPUT_FILE,
@@ -223,6 +244,94 @@ const optionparser::Descriptor usage[] =
         SushiArg::NonEmpty,
         "\t\t-O <filename>, --output=<filename> \tSpecify output file [default= (input_file).proc.wav]."
     },
+    {
+        OPT_IDX_OUTPUT_STEMS,
+        OPT_TYPE_DISABLED,
+        "",
+        "output-stems",
+        SushiArg::Optional,
+        "\t\t--output-stems \tWrite one stereo file per engine output bus instead of a single multichannel output file. Files are named (output_file)_bus_<n>."
+    },
+    {
+        OPT_IDX_BATCH,
+        OPT_TYPE_UNUSED,
+        "",
+        "batch",
+        SushiArg::NonEmpty,
+        "\t\t--batch=<list or pattern> \tRender many files offline in parallel. Takes a file with one input file per line, or a quoted glob pattern."
+    },
+    {
+        OPT_IDX_BATCH_JOBS,
+        OPT_TYPE_UNUSED,
+        "",
+        "batch-jobs",
+        SushiArg::Numeric,
+        "\t\t--batch-jobs=<n> \tNumber of files to render in parallel with --batch, each with its own engine [default=number of cores]."
+    },
+    {
+        OPT_IDX_OUTPUT_DIR,
+        OPT_TYPE_UNUSED,
+        "",
+        "output-dir",
+        SushiArg::NonEmpty,
+        "\t\t--output-dir=<dir> \tWrite files rendered with --batch to <dir> with the input file names, which must then be unique [default= (input_file)_proc.wav]."
+    },
+    {
+        OPT_IDX_USE_PIPE,
+        OPT_TYPE_DISABLED,
+        "",
+        "pipe",
+        SushiArg::Optional,
+        "\t\t--pipe \tUse pipe audio frontend, streaming raw interleaved PCM from stdin to stdout."
+    },
+    {
+        OPT_IDX_PIPE_INPUT,
+        OPT_TYPE_UNUSED,
+        "",
+        "pipe-input",
+        SushiArg::NonEmpty,
+        "\t\t--pipe-input=<path> \tRead raw PCM from a named pipe or file, '-' for stdin [default=-]."
+    },
+    {
+        OPT_IDX_PIPE_OUTPUT,
+        OPT_TYPE_UNUSED,
+        "",
+        "pipe-output",
+        SushiArg::NonEmpty,
+        "\t\t--pipe-output=<path> \tWrite raw PCM to a named pipe or file, '-' for stdout [default=-]."
+    },
+    {
+        OPT_IDX_PIPE_FORMAT,
+        OPT_TYPE_UNUSED,
+        "",
+        "pipe-format",
+        SushiArg::NonEmpty,
+        "\t\t--pipe-format=<format> \tSample format of the pipe streams, one of f32le, s16le, s24le or s32le [default=f32le]."
+    },
+    {
+        OPT_IDX_PIPE_CHANNELS,
+        OPT_TYPE_UNUSED,
+        "",
+        "pipe-channels",
+        SushiArg::Numeric,
+        "\t\t--pipe-channels=<n> \tNumber of interleaved channels in the pipe streams [default=2]."
+    },
+    {
+        OPT_IDX_PIPE_CLOCKED,
+        OPT_TYPE_DISABLED,
+        "",
+        "pipe-clocked",
+        SushiArg::Optional,
+        "\t\t--pipe-clocked \tPace pipe processing to the sample rate instead of processing as fast as input arrives."
+    },
+    {
+        OPT_IDX_USE_SHM,
+        OPT_TYPE_UNUSED,
+        "",
+        "shm",
+        SushiArg::NonEmpty,
+        "\t\t--shm=<name> \tUse shared memory audio frontend, driven by another process through the POSIX shared memory object <name>, i.e. /sushi."
+    },
     {
         OPT_IDX_USE_DUMMY,
         OPT_TYPE_DISABLED,
@@ -231,6 +340,14 @@ const optionparser::Descriptor usage[] =
         SushiArg::Optional,
         "\t\t-d --dummy \tUse dummy audio frontend. Useful for debugging."
     },
+    {
+        OPT_IDX_BENCHMARK,
+        OPT_TYPE_UNUSED,
+        "",
+        "benchmark",
+        SushiArg::Numeric,
+        "\t\t--benchmark=<seconds> \tRender <seconds> of noise input through the loaded configuration as fast as possible, then print the realtime factor and processing times to stdout in JSON format."
+    },
     {
         OPT_IDX_USE_JACK,
         OPT_TYPE_DISABLED,
@@ -263,6 +380,30 @@ const optionparser::Descriptor usage[] =
         SushiArg::NonEmpty,
         "\t\t--server-name=<jack server name> \tSpecify name of Jack server to connect to [determined by jack if empty]."
     },
+    {
+        OPT_IDX_USE_ALSA,
+        OPT_TYPE_UNUSED,
+        "",
+        "alsa",
+        SushiArg::Optional,
+        "\t\t--alsa[=<device>] \tUse Alsa realtime audio frontend on pcm <device>, i.e. hw:0 [default=default]."
+    },
+    {
+        OPT_IDX_ALSA_PERIOD,
+        OPT_TYPE_UNUSED,
+        "",
+        "alsa-period",
+        SushiArg::Numeric,
+        "\t\t--alsa-period=<frames> \tSize of Alsa periods, sizes that are not a multiple of the internal buffer size add latency [default=internal buffer size]."
+    },
+    {
+        OPT_IDX_ALSA_PERIODS,
+        OPT_TYPE_UNUSED,
+        "",
+        "alsa-periods",
+        SushiArg::Numeric,
+        "\t\t--alsa-periods=<n> \tNumber of periods in the Alsa device buffer [default=2]."
+    },
     {
         OPT_IDX_USE_XENOMAI_RASPA,
         OPT_TYPE_DISABLED,
@@ -295,6 +436,54 @@ const optionparser::Descriptor usage[] =
         SushiArg::Optional,
         "\t\t--timing-statistics \tEnable performance timings on all audio processors."
     },
+    {
+        OPT_IDX_TIMINGS_SAMPLING,
+        OPT_TYPE_UNUSED,
+        "",
+        "timing-sampling",
+        SushiArg::Numeric,
+        "\t\t--timing-sampling=<n> \tWith timing statistics enabled, time each audio processor only once every <n> chunks to reduce the overhead. Tracks and engine are timed in every chunk [default n=1]."
+    },
+    {
+        OPT_IDX_TRACE_FILE,
+        OPT_TYPE_UNUSED,
+        "",
+        "trace-file",
+        SushiArg::NonEmpty,
+        "\t\t--trace-file=<filename> \tRecord a timeline of the audio processing and write it to <filename> in Chrome trace format on exit."
+    },
+    {
+        OPT_IDX_TRACE_EVENT_LATENCY,
+        OPT_TYPE_DISABLED,
+        "",
+        "trace-event-latency",
+        SushiArg::Optional,
+        "\t\t--trace-event-latency \tMeasure the latency of midi, osc and grpc events from arrival until delivered to a processor and log a summary on exit."
+    },
+    {
+        OPT_IDX_METRICS_FILE,
+        OPT_TYPE_UNUSED,
+        "",
+        "metrics-file",
+        SushiArg::NonEmpty,
+        "\t\t--metrics-file=<filename> \tPeriodically write metrics to <filename> in Prometheus text format."
+    },
+    {
+        OPT_IDX_METRICS_SOCKET,
+        OPT_TYPE_UNUSED,
+        "",
+        "metrics-socket",
+        SushiArg::NonEmpty,
+        "\t\t--metrics-socket=<path> \tServe metrics in Prometheus text format on a unix domain socket created at <path>."
+    },
+    {
+        OPT_IDX_RT_MIDI_INPUT,
+        OPT_TYPE_DISABLED,
+        "",
+        "rt-midi-input",
+        SushiArg::Optional,
+        "\t\t--rt-midi-input \tSend incoming midi directly to the audio thread, bypassing the event dispatcher, for lower latency."
+    },
     {
         OPT_IDX_OSC_RECEIVE_PORT,
         OPT_TYPE_UNUSED,
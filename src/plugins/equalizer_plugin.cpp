@@ -69,7 +69,10 @@ ProcessorReturnCode EqualizerPlugin::init(float sample_rate)
 void EqualizerPlugin::configure(float sample_rate)
 {
     _sample_rate = sample_rate;
-    return;
+    for (auto& f : _filters)
+    {
+        f.reset();
+    }
 }
 
 void EqualizerPlugin::set_input_channels(int channels)
@@ -0,0 +1,97 @@
+#include <array>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+
+#include "dsp_library/biquad_filter.h"
+#include "dsp_library/master_limiter.h"
+#include "dsp_library/value_smoother.h"
+
+using namespace sushi;
+using namespace dsp;
+
+constexpr float SAMPLE_RATE = 48000;
+
+static void chunk_size_args(benchmark::internal::Benchmark* benchmark)
+{
+    for (int chunk_size : {16, 32, 64, 128, 256})
+    {
+        benchmark->Arg(chunk_size);
+    }
+}
+
+static std::vector<float> make_test_signal(int samples)
+{
+    std::vector<float> signal(samples);
+    for (int i = 0; i < samples; ++i)
+    {
+        signal[i] = (i % 2 == 0 ? 0.8f : -0.8f) * static_cast<float>(i) / samples;
+    }
+    return signal;
+}
+
+static void BM_BiquadFilter(benchmark::State& state)
+{
+    int samples = state.range(0);
+    biquad::Coefficients coefficients;
+    biquad::calc_biquad_peak(coefficients, SAMPLE_RATE, 1000.0f, 1.0f, 2.0f);
+    biquad::BiquadFilter filter(coefficients);
+    filter.set_smoothing(samples);
+    auto input = make_test_signal(samples);
+    std::vector<float> output(samples);
+    for (auto _ : state)
+    {
+        filter.process(input.data(), output.data(), samples);
+        benchmark::DoNotOptimize(output.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * samples);
+}
+BENCHMARK(BM_BiquadFilter)->Apply(chunk_size_args);
+
+template<int size>
+static void BM_MasterLimiter(benchmark::State& state)
+{
+    MasterLimiter<size> limiter;
+    limiter.init(SAMPLE_RATE);
+    /* Scaled above 0 dB so that the limiter is engaged */
+    auto input = make_test_signal(size);
+    for (auto& sample : input)
+    {
+        sample *= 2.0f;
+    }
+    std::array<float, size> output;
+    for (auto _ : state)
+    {
+        limiter.process(input.data(), output.data());
+        benchmark::DoNotOptimize(output.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * size);
+}
+BENCHMARK_TEMPLATE(BM_MasterLimiter, 16);
+BENCHMARK_TEMPLATE(BM_MasterLimiter, 32);
+BENCHMARK_TEMPLATE(BM_MasterLimiter, 64);
+BENCHMARK_TEMPLATE(BM_MasterLimiter, 128);
+BENCHMARK_TEMPLATE(BM_MasterLimiter, 256);
+
+template<class Smoother>
+static void BM_ValueSmoother(benchmark::State& state)
+{
+    int samples = state.range(0);
+    Smoother smoother(std::chrono::milliseconds(10), SAMPLE_RATE);
+    float target = 1.0f;
+    for (auto _ : state)
+    {
+        /* Alternate targets so that the smoother never becomes stationary */
+        target = 1.0f - target;
+        smoother.set(target);
+        for (int i = 0; i < samples; ++i)
+        {
+            benchmark::DoNotOptimize(smoother.next_value());
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * samples);
+}
+BENCHMARK_TEMPLATE(BM_ValueSmoother, ValueSmootherRamp<float>)->Apply(chunk_size_args);
+BENCHMARK_TEMPLATE(BM_ValueSmoother, ValueSmootherFilter<float>)->Apply(chunk_size_args);
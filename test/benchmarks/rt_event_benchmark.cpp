@@ -0,0 +1,122 @@
+#include <memory>
+
+#include "benchmark/benchmark.h"
+
+#include "library/rt_event.h"
+#include "library/rt_event_fifo.h"
+#ifdef SUSHI_BUILD_WITH_VST2
+#include "library/vst2x/vst2x_midi_event_fifo.h"
+#endif
+
+using namespace sushi;
+
+/* Number of events passed per iteration, from a single event to a full queue. The
+ * queues hold one event less than their size. */
+static void batch_size_args(benchmark::internal::Benchmark* benchmark)
+{
+    for (int events : {1, 16, 128, MAX_EVENTS_IN_QUEUE - 1})
+    {
+        benchmark->Arg(events);
+    }
+}
+
+static void BM_RtEventMakeNoteOn(benchmark::State& state)
+{
+    int note = 0;
+    for (auto _ : state)
+    {
+        auto event = RtEvent::make_note_on_event(1, 0, 0, note++ & 0x7f, 1.0f);
+        benchmark::DoNotOptimize(event);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_RtEventMakeNoteOn);
+
+static void BM_RtEventMakeParameterChange(benchmark::State& state)
+{
+    float value = 0.0f;
+    for (auto _ : state)
+    {
+        auto event = RtEvent::make_parameter_change_event(1, 0, 2, value);
+        value += 0.001f;
+        benchmark::DoNotOptimize(event);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_RtEventMakeParameterChange);
+
+static void BM_RtEventCopy(benchmark::State& state)
+{
+    auto source = RtEvent::make_note_on_event(1, 0, 0, 60, 1.0f);
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(source);
+        RtEvent copy = source;
+        benchmark::DoNotOptimize(copy);
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * sizeof(RtEvent));
+}
+BENCHMARK(BM_RtEventCopy);
+
+static void BM_RtSafeRtEventFifoPushPop(benchmark::State& state)
+{
+    int events = state.range(0);
+    /* Too large for the stack */
+    auto fifo = std::make_unique<RtSafeRtEventFifo>();
+    auto event = RtEvent::make_note_on_event(1, 0, 0, 60, 1.0f);
+    RtEvent received;
+    for (auto _ : state)
+    {
+        for (int i = 0; i < events; ++i)
+        {
+            fifo->push(event);
+        }
+        while (fifo->pop(received))
+        {
+            benchmark::DoNotOptimize(received);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * events);
+}
+BENCHMARK(BM_RtSafeRtEventFifoPushPop)->Apply(batch_size_args);
+
+template<int capacity>
+static void BM_RtEventFifoPushPop(benchmark::State& state)
+{
+    int events = state.range(0);
+    RtEventFifo<capacity> fifo;
+    auto event = RtEvent::make_note_on_event(1, 0, 0, 60, 1.0f);
+    RtEvent received;
+    for (auto _ : state)
+    {
+        for (int i = 0; i < events; ++i)
+        {
+            fifo.push(event);
+        }
+        while (fifo.pop(received))
+        {
+            benchmark::DoNotOptimize(received);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * events);
+}
+BENCHMARK_TEMPLATE(BM_RtEventFifoPushPop, MAX_EVENTS_IN_QUEUE)->Apply(batch_size_args);
+
+#ifdef SUSHI_BUILD_WITH_VST2
+static void BM_Vst2xMidiEventFifoPushFlush(benchmark::State& state)
+{
+    int events = state.range(0);
+    vst2::Vst2xMidiEventFIFO<MAX_EVENTS_IN_QUEUE> fifo;
+    for (auto _ : state)
+    {
+        for (int i = 0; i < events; ++i)
+        {
+            fifo.push(RtEvent::make_note_on_event(1, i % AUDIO_CHUNK_SIZE, 0, 60, 1.0f));
+        }
+        benchmark::DoNotOptimize(fifo.flush());
+    }
+    state.SetItemsProcessed(state.iterations() * events);
+}
+BENCHMARK(BM_Vst2xMidiEventFifoPushFlush)->Apply(batch_size_args);
+#endif
@@ -0,0 +1,170 @@
+#include <vector>
+
+#include "benchmark/benchmark.h"
+
+#include "library/sample_buffer.h"
+
+using namespace sushi;
+
+/* Chunk size is a template parameter of SampleBuffer, channel count the benchmark argument */
+#define SAMPLE_BUFFER_BENCHMARK_WITH_ARGS(function, args) BENCHMARK_TEMPLATE(function, 16)->Apply(args); \
+                                                          BENCHMARK_TEMPLATE(function, 32)->Apply(args); \
+                                                          BENCHMARK_TEMPLATE(function, 64)->Apply(args); \
+                                                          BENCHMARK_TEMPLATE(function, 128)->Apply(args); \
+                                                          BENCHMARK_TEMPLATE(function, 256)->Apply(args)
+
+#define SAMPLE_BUFFER_BENCHMARK(function) SAMPLE_BUFFER_BENCHMARK_WITH_ARGS(function, channel_args)
+
+static void channel_args(benchmark::internal::Benchmark* benchmark)
+{
+    for (int channels : {1, 2, 8, 32})
+    {
+        benchmark->Arg(channels);
+    }
+}
+
+/* 3 channels exercise the generic (de)interleaving path */
+static void interleaved_channel_args(benchmark::internal::Benchmark* benchmark)
+{
+    for (int channels : {1, 2, 3, 8})
+    {
+        benchmark->Arg(channels);
+    }
+}
+
+template<int size>
+void fill_buffer(SampleBuffer<size>& buffer)
+{
+    for (int c = 0; c < buffer.channel_count(); ++c)
+    {
+        for (int i = 0; i < size; ++i)
+        {
+            buffer.channel(c)[i] = 0.5f * static_cast<float>(i) / size;
+        }
+    }
+}
+
+template<int size>
+void set_sample_counters(benchmark::State& state)
+{
+    state.SetItemsProcessed(state.iterations() * size * state.range(0));
+}
+
+template<int size>
+static void BM_SampleBufferClear(benchmark::State& state)
+{
+    SampleBuffer<size> buffer(state.range(0));
+    for (auto _ : state)
+    {
+        buffer.clear();
+        benchmark::DoNotOptimize(buffer.channel(0));
+        benchmark::ClobberMemory();
+    }
+    set_sample_counters<size>(state);
+}
+SAMPLE_BUFFER_BENCHMARK(BM_SampleBufferClear);
+
+template<int size>
+static void BM_SampleBufferApplyGain(benchmark::State& state)
+{
+    SampleBuffer<size> buffer(state.range(0));
+    fill_buffer(buffer);
+    for (auto _ : state)
+    {
+        buffer.apply_gain(0.99f);
+        benchmark::ClobberMemory();
+    }
+    set_sample_counters<size>(state);
+}
+SAMPLE_BUFFER_BENCHMARK(BM_SampleBufferApplyGain);
+
+template<int size>
+static void BM_SampleBufferAdd(benchmark::State& state)
+{
+    SampleBuffer<size> buffer(state.range(0));
+    SampleBuffer<size> source(state.range(0));
+    fill_buffer(source);
+    for (auto _ : state)
+    {
+        buffer.add(source);
+        benchmark::ClobberMemory();
+    }
+    set_sample_counters<size>(state);
+}
+SAMPLE_BUFFER_BENCHMARK(BM_SampleBufferAdd);
+
+template<int size>
+static void BM_SampleBufferAddWithGain(benchmark::State& state)
+{
+    SampleBuffer<size> buffer(state.range(0));
+    SampleBuffer<size> source(state.range(0));
+    fill_buffer(source);
+    for (auto _ : state)
+    {
+        buffer.add_with_gain(source, 0.5f);
+        benchmark::ClobberMemory();
+    }
+    set_sample_counters<size>(state);
+}
+SAMPLE_BUFFER_BENCHMARK(BM_SampleBufferAddWithGain);
+
+template<int size>
+static void BM_SampleBufferAddWithRamp(benchmark::State& state)
+{
+    SampleBuffer<size> buffer(state.range(0));
+    SampleBuffer<size> source(state.range(0));
+    fill_buffer(source);
+    for (auto _ : state)
+    {
+        buffer.add_with_ramp(source, 0.25f, 0.75f);
+        benchmark::ClobberMemory();
+    }
+    set_sample_counters<size>(state);
+}
+SAMPLE_BUFFER_BENCHMARK(BM_SampleBufferAddWithRamp);
+
+template<int size>
+static void BM_SampleBufferRamp(benchmark::State& state)
+{
+    SampleBuffer<size> buffer(state.range(0));
+    fill_buffer(buffer);
+    for (auto _ : state)
+    {
+        buffer.ramp(0.99f, 1.0f);
+        benchmark::ClobberMemory();
+    }
+    set_sample_counters<size>(state);
+}
+SAMPLE_BUFFER_BENCHMARK(BM_SampleBufferRamp);
+
+template<int size>
+static void BM_SampleBufferInterleave(benchmark::State& state)
+{
+    SampleBuffer<size> buffer(state.range(0));
+    std::vector<float> interleaved(size * state.range(0), 0.5f);
+    for (auto _ : state)
+    {
+        buffer.from_interleaved(interleaved.data());
+        buffer.to_interleaved(interleaved.data());
+        benchmark::ClobberMemory();
+    }
+    set_sample_counters<size>(state);
+}
+SAMPLE_BUFFER_BENCHMARK_WITH_ARGS(BM_SampleBufferInterleave, interleaved_channel_args);
+
+template<int size>
+static void BM_SampleBufferPeakAndRms(benchmark::State& state)
+{
+    SampleBuffer<size> buffer(state.range(0));
+    fill_buffer(buffer);
+    for (auto _ : state)
+    {
+        for (int c = 0; c < buffer.channel_count(); ++c)
+        {
+            benchmark::DoNotOptimize(buffer.calc_peak_value(c));
+            benchmark::DoNotOptimize(buffer.calc_rms_value(c));
+        }
+    }
+    set_sample_counters<size>(state);
+}
+SAMPLE_BUFFER_BENCHMARK(BM_SampleBufferPeakAndRms);
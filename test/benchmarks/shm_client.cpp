@@ -0,0 +1,144 @@
+/*
+ * Reference client for the shared memory audio frontend, started with sushi --shm=<name>.
+ * Feeds a sine to all inputs, one chunk at a time, and measures the round trip
+ * latency of every period, i.e. the time from handing a chunk over to sushi until
+ * the processed output is available.
+ *
+ * Usage: sushi_shm_client [-r] <name> [periods]
+ *   -r       Pace periods to the sample rate, as an audio interface would.
+ *            Otherwise periods are requested as fast as sushi processes them.
+ *   periods  Number of periods to run [default=100000]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+
+#include "shm_audio_interface.h"
+
+using namespace sushi::ext;
+
+constexpr long WAIT_TIMEOUT_NS = 100'000'000;
+constexpr float TEST_FREQUENCY = 440.0f;
+
+int main(int argc, char* argv[])
+{
+    bool realtime = false;
+    std::vector<std::string> args;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::string(argv[i]) == "-r")
+        {
+            realtime = true;
+        }
+        else
+        {
+            args.emplace_back(argv[i]);
+        }
+    }
+    if (args.empty())
+    {
+        std::cerr << "Usage: sushi_shm_client [-r] <name> [periods]" << std::endl;
+        return 1;
+    }
+    std::string name = args[0];
+    int periods = args.size() > 1 ? std::stoi(args[1]) : 100000;
+
+    int fd = shm_open(name.c_str(), O_RDWR, 0);
+    if (fd < 0)
+    {
+        std::cerr << "Failed to open shared memory " << name << ": " << strerror(errno) << std::endl;
+        return 1;
+    }
+    /* Map the header first to find the size of the whole region */
+    auto header = static_cast<ShmAudioHeader*>(mmap(nullptr, sizeof(ShmAudioHeader), PROT_READ, MAP_SHARED, fd, 0));
+    if (header == MAP_FAILED || header->magic != SHM_AUDIO_MAGIC || header->version != SHM_AUDIO_VERSION)
+    {
+        std::cerr << name << " is not a sushi audio region of version " << SHM_AUDIO_VERSION << std::endl;
+        return 1;
+    }
+    size_t size = shm_audio_region_size(header->chunk_size, header->input_channels, header->output_channels);
+    munmap(header, sizeof(ShmAudioHeader));
+    header = static_cast<ShmAudioHeader*>(mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0));
+    close(fd);
+    if (header == MAP_FAILED)
+    {
+        std::cerr << "Failed to map shared memory: " << strerror(errno) << std::endl;
+        return 1;
+    }
+    mlock(header, size);
+
+    while (header->state.load(std::memory_order_acquire) == ShmAudioState::STARTING)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    int chunk_size = header->chunk_size;
+    int inputs = header->input_channels;
+    float sample_rate = header->sample_rate;
+    std::cout << "Connected to " << name << ": " << inputs << " inputs, " << header->output_channels
+              << " outputs, " << chunk_size << " samples at " << sample_rate << " Hz" << std::endl;
+
+    auto period_time = std::chrono::duration<double, std::micro>(chunk_size * 1'000'000.0 / sample_rate);
+    std::vector<double> latencies;
+    latencies.reserve(periods);
+    float phase = 0.0f;
+    float phase_inc = 2.0f * static_cast<float>(M_PI) * TEST_FREQUENCY / sample_rate;
+    uint32_t count = header->request_count.load(std::memory_order_acquire);
+    auto next_period = std::chrono::steady_clock::now();
+
+    for (int p = 0; p < periods; ++p)
+    {
+        if (realtime)
+        {
+            next_period += std::chrono::duration_cast<std::chrono::steady_clock::duration>(period_time);
+            std::this_thread::sleep_until(next_period);
+        }
+        float* input = shm_audio_inputs(header);
+        for (int n = 0; n < chunk_size; ++n)
+        {
+            float sample = 0.5f * std::sin(phase);
+            phase = std::fmod(phase + phase_inc, 2.0f * static_cast<float>(M_PI));
+            for (int c = 0; c < inputs; ++c)
+            {
+                input[c * chunk_size + n] = sample;
+            }
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        header->request_count.store(++count, std::memory_order_release);
+        shm_audio_wake(header->request_count);
+        while (header->done_count.load(std::memory_order_acquire) != count)
+        {
+            shm_audio_wait(header->done_count, count - 1, WAIT_TIMEOUT_NS);
+            if (header->state.load(std::memory_order_acquire) == ShmAudioState::STOPPED)
+            {
+                std::cerr << "Sushi stopped" << std::endl;
+                return 1;
+            }
+        }
+        latencies.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+    }
+
+    if (latencies.empty())
+    {
+        return 0;
+    }
+    std::sort(latencies.begin(), latencies.end());
+    auto percentile = [&](double p) {return latencies[static_cast<size_t>(p * (latencies.size() - 1))];};
+    std::cout << "Round trip latency of " << latencies.size() << " periods (us): min " << latencies.front()
+              << ", p50 " << percentile(0.5) << ", p99 " << percentile(0.99) << ", p99.9 " << percentile(0.999)
+              << ", max " << latencies.back() << std::endl;
+    std::cout << "Period time (us): " << period_time.count() << ", worst case load: "
+              << 100.0 * latencies.back() / period_time.count() << " %" << std::endl;
+    munmap(header, size);
+    return 0;
+}
@@ -0,0 +1,86 @@
+#include <memory>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+
+#include "engine/track.h"
+#include "engine/transport.h"
+#include "library/rt_event_fifo.h"
+#include "plugins/gain_plugin.h"
+
+using namespace sushi;
+
+constexpr float SAMPLE_RATE = 48000;
+constexpr int TRACK_CHANNELS = 2;
+
+enum TimingMode
+{
+    TIMING_DISABLED = 0,
+    TIMING_ENABLED = 1,
+    TRACING_ENABLED = 2
+};
+
+class TrackFixture
+{
+public:
+    TrackFixture(int processors)
+    {
+        _timer.set_timing_period(SAMPLE_RATE, AUDIO_CHUNK_SIZE);
+        _timer.set_rt_worker_count(1);
+        _track.init(SAMPLE_RATE);
+        for (int i = 0; i < processors; ++i)
+        {
+            auto& plugin = _plugins.emplace_back(std::make_unique<gain_plugin::GainPlugin>(_host_control));
+            plugin->init(SAMPLE_RATE);
+            _track.add(plugin.get());
+        }
+    }
+
+    RtEventFifo<10> _event_output;
+    engine::Transport _transport{SAMPLE_RATE, &_event_output};
+    HostControl _host_control{nullptr, &_transport};
+    performance::PerformanceTimer _timer;
+    engine::Track _track{_host_control, TRACK_CHANNELS, &_timer};
+    std::vector<std::unique_ptr<gain_plugin::GainPlugin>> _plugins;
+};
+
+/* The processors of a track without the track, as a reference for the overhead of
+ * Track::render() */
+static void BM_ProcessorChain(benchmark::State& state)
+{
+    TrackFixture fixture(state.range(0));
+    ChunkSampleBuffer buffer_1(TRACK_CHANNELS);
+    ChunkSampleBuffer buffer_2(TRACK_CHANNELS);
+    for (auto _ : state)
+    {
+        for (auto& plugin : fixture._plugins)
+        {
+            plugin->process_audio(buffer_1, buffer_2);
+            std::swap(buffer_1, buffer_2);
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * AUDIO_CHUNK_SIZE);
+}
+BENCHMARK(BM_ProcessorChain)->Arg(1)->Arg(8);
+
+/* Render a track with timings and tracing disabled, enabled or with tracing only.
+ * With both disabled, processors are not read from the clock and the difference
+ * to BM_ProcessorChain is the gain and pan of the track and its own timing, which
+ * should stay well below 1% of the chunk period. */
+static void BM_TrackRender(benchmark::State& state)
+{
+    TrackFixture fixture(state.range(0));
+    auto mode = static_cast<TimingMode>(state.range(1));
+    fixture._timer.enable(mode == TIMING_ENABLED);
+    fixture._timer.enable_tracing(mode == TRACING_ENABLED);
+    for (auto _ : state)
+    {
+        fixture._track.render();
+        benchmark::ClobberMemory();
+    }
+    fixture._timer.enable(false);
+    fixture._timer.enable_tracing(false);
+    state.SetItemsProcessed(state.iterations() * AUDIO_CHUNK_SIZE);
+}
+BENCHMARK(BM_TrackRender)->ArgsProduct({{1, 8}, {TIMING_DISABLED, TIMING_ENABLED, TRACING_ENABLED}});
@@ -0,0 +1,135 @@
+#!/usr/bin/env python3
+"""
+Run a Sushi configuration in headless benchmark mode and compare the throughput
+and p99 chunk load against a stored baseline.
+
+External plugins (vst2x, vst3x and lv2) in the configuration are replaced by an
+internal stand-in with the same name, and midi, cv and event mappings that refer
+to them are removed, so that every configuration can be run with internal plugins
+only and results are comparable between machines with different plugins installed.
+
+Exit codes: 0 on pass, 1 on a performance regression or error, 77 if there is no
+baseline for the configuration (reported as skipped by CTest).
+"""
+
+import argparse
+import json
+import os
+import statistics
+import subprocess
+import sys
+
+SKIP_RETURN_CODE = 77
+STAND_IN_PLUGIN_UID = "sushi.testing.equalizer"
+PROCESSOR_REFERENCE_KEYS = ("processor", "plugin_name", "plugin")
+
+
+def substitute_external_plugins(config):
+    substituted = set()
+    for track in config.get("tracks", []):
+        for plugin in track.get("plugins", []):
+            if plugin.get("type") != "internal":
+                for key in ("path", "uri", "uid"):
+                    plugin.pop(key, None)
+                plugin["type"] = "internal"
+                plugin["uid"] = STAND_IN_PLUGIN_UID
+                substituted.add(plugin["name"])
+
+    def refers_to_substituted(entry):
+        if isinstance(entry, dict):
+            return any(entry.get(key) in substituted for key in PROCESSOR_REFERENCE_KEYS) or \
+                   any(refers_to_substituted(value) for value in entry.values())
+        return False
+
+    def strip_references(node):
+        if isinstance(node, dict):
+            for value in node.values():
+                strip_references(value)
+        elif isinstance(node, list):
+            node[:] = [entry for entry in node if not refers_to_substituted(entry)]
+            for entry in node:
+                strip_references(entry)
+
+    for section in ("midi", "cv_control", "events", "osc"):
+        if section in config:
+            strip_references(config[section])
+    return substituted
+
+
+def run_benchmark(sushi, config_file, seconds, log_file):
+    command = [sushi, "-c", config_file, "--benchmark={}".format(seconds), "-L", log_file]
+    output = subprocess.run(command, stdout=subprocess.PIPE, check=True, universal_newlines=True).stdout
+    # The report is the only json document on stdout
+    result, _ = json.JSONDecoder().raw_decode(output[output.index("{"):])
+    return result
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--sushi", required=True, help="Path to the sushi executable")
+    parser.add_argument("--config", required=True, help="Sushi json configuration to run")
+    parser.add_argument("--baselines", required=True, help="Json file with baseline results for all configurations")
+    parser.add_argument("--work-dir", default=".", help="Directory for generated configurations and logs")
+    parser.add_argument("--seconds", type=int, default=20, help="Seconds of audio to render per run")
+    parser.add_argument("--runs", type=int, default=3, help="Number of runs, the median result is used")
+    parser.add_argument("--tolerance", type=float, default=0.2,
+                        help="Allowed relative change from the baseline before failing")
+    parser.add_argument("--update", action="store_true", help="Store the results as the new baseline")
+    args = parser.parse_args()
+
+    name = os.path.splitext(os.path.basename(args.config))[0]
+    with open(args.config) as f:
+        config = json.load(f)
+    substituted = substitute_external_plugins(config)
+    if substituted:
+        print("Replaced external plugins with {}: {}".format(STAND_IN_PLUGIN_UID, ", ".join(sorted(substituted))))
+
+    os.makedirs(args.work_dir, exist_ok=True)
+    config_file = os.path.join(args.work_dir, name + ".json")
+    with open(config_file, "w") as f:
+        json.dump(config, f, indent=4)
+
+    log_file = os.path.join(args.work_dir, name + ".log")
+    try:
+        results = [run_benchmark(args.sushi, config_file, args.seconds, log_file) for _ in range(args.runs)]
+    except (subprocess.CalledProcessError, ValueError) as e:
+        print("Failed to run benchmark: {}, see {}".format(e, log_file))
+        return 1
+
+    measured = {"realtime_factor": statistics.median(r["realtime_factor"] for r in results),
+                "chunk_load_p99": statistics.median(r["chunk_load"]["p99"] for r in results)}
+    print("{}: realtime factor {:.1f}, p99 chunk load {:.4f}".format(name, measured["realtime_factor"],
+                                                                      measured["chunk_load_p99"]))
+
+    baselines = {}
+    if os.path.exists(args.baselines):
+        with open(args.baselines) as f:
+            baselines = json.load(f)
+
+    if args.update:
+        baselines[name] = measured
+        with open(args.baselines, "w") as f:
+            json.dump(baselines, f, indent=4, sort_keys=True)
+            f.write("\n")
+        print("Updated baseline in {}".format(args.baselines))
+        return 0
+
+    baseline = baselines.get(name)
+    if baseline is None:
+        print("No baseline for {} in {}".format(name, args.baselines))
+        return SKIP_RETURN_CODE
+
+    passed = True
+    if measured["realtime_factor"] < baseline["realtime_factor"] * (1.0 - args.tolerance):
+        print("Throughput regression: realtime factor {:.1f}, baseline {:.1f}".format(measured["realtime_factor"],
+                                                                                    baseline["realtime_factor"]))
+        passed = False
+    if measured["chunk_load_p99"] > baseline["chunk_load_p99"] * (1.0 + args.tolerance):
+        print("Chunk time regression: p99 chunk load {:.4f}, baseline {:.4f}".format(measured["chunk_load_p99"],
+                                                                                   baseline["chunk_load_p99"]))
+        passed = False
+    return 0 if passed else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,106 @@
+#include "gtest/gtest.h"
+
+#include "test_utils/engine_mockup.h"
+
+#define private public
+#include "audio_frontends/alsa_frontend.cpp"
+
+using namespace sushi;
+using namespace sushi::audio_frontend;
+
+constexpr float SAMPLE_RATE = 48000;
+constexpr int CV_CHANNELS = 0;
+constexpr int TEST_PERIODS = 3;
+/* The null pcm accepts any configuration and is always available */
+constexpr char TEST_DEVICE[] = "null";
+constexpr auto PROCESSING_TIMEOUT = std::chrono::seconds(1);
+
+/* The null pcm is always ready for another period, so without pacing the
+ * realtime audio thread would spin at full speed for as long as it runs */
+class PacedEngineMockup : public EngineMockup
+{
+public:
+    PacedEngineMockup(float sample_rate) : EngineMockup(sample_rate) {}
+
+    void process_chunk(engine::ChunkChannelBuffers* in_channels,
+                       engine::ChunkChannelBuffers* out_channels,
+                       ControlBuffer* in_controls, ControlBuffer* out_controls,
+                       Time timestamp, int64_t samplecount) override
+    {
+        EngineMockup::process_chunk(in_channels, out_channels, in_controls, out_controls, timestamp, samplecount);
+        std::this_thread::sleep_for(std::chrono::microseconds(AUDIO_CHUNK_SIZE * 1'000'000 / static_cast<int>(SAMPLE_RATE)));
+    }
+};
+
+class TestAlsaFrontend : public ::testing::Test
+{
+protected:
+    TestAlsaFrontend()
+    {
+    }
+
+    void SetUp()
+    {
+        _module_under_test = new AlsaFrontend(&_engine);
+    }
+
+    void TearDown()
+    {
+        delete _module_under_test;
+    }
+
+    void wait_for_processing()
+    {
+        auto deadline = std::chrono::steady_clock::now() + PROCESSING_TIMEOUT;
+        while (_engine.process_called == false && std::chrono::steady_clock::now() < deadline)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    }
+
+    PacedEngineMockup _engine{SAMPLE_RATE};
+    AlsaFrontend* _module_under_test;
+};
+
+TEST_F(TestAlsaFrontend, TestInvalidConfiguration)
+{
+    AlsaFrontendConfiguration config(TEST_DEVICE, AUDIO_CHUNK_SIZE, 1, CV_CHANNELS, CV_CHANNELS);
+    EXPECT_EQ(AudioFrontendStatus::AUDIO_HW_ERROR, _module_under_test->init(&config));
+
+    AlsaFrontendConfiguration no_device("sushi_no_such_device", AUDIO_CHUNK_SIZE, TEST_PERIODS, CV_CHANNELS, CV_CHANNELS);
+    EXPECT_EQ(AudioFrontendStatus::AUDIO_HW_ERROR, _module_under_test->init(&no_device));
+}
+
+TEST_F(TestAlsaFrontend, TestProcessing)
+{
+    AlsaFrontendConfiguration config(TEST_DEVICE, AUDIO_CHUNK_SIZE, TEST_PERIODS, CV_CHANNELS, CV_CHANNELS);
+    ASSERT_EQ(AudioFrontendStatus::OK, _module_under_test->init(&config));
+    ASSERT_NE(nullptr, _module_under_test->_playback);
+    EXPECT_GT(_module_under_test->_playback_channels, 0);
+    EXPECT_LE(_module_under_test->_playback_channels, MAX_FRONTEND_CHANNELS);
+    EXPECT_LE(_module_under_test->_playback_channels, _module_under_test->_playback_device_channels);
+    EXPECT_EQ(static_cast<unsigned int>(SAMPLE_RATE), _module_under_test->_sample_rate);
+    EXPECT_EQ(_module_under_test->_playback_channels, static_cast<int>(_module_under_test->_out_channels.size()));
+
+    _module_under_test->run();
+    wait_for_processing();
+    EXPECT_TRUE(_engine.process_called);
+    _module_under_test->cleanup();
+    EXPECT_EQ(nullptr, _module_under_test->_playback);
+    EXPECT_EQ(0, _module_under_test->_samplecount % static_cast<int64_t>(_module_under_test->_period_size));
+}
+
+TEST_F(TestAlsaFrontend, TestReblockedProcessing)
+{
+    constexpr int PERIOD_SIZE = AUDIO_CHUNK_SIZE + AUDIO_CHUNK_SIZE / 2;
+    AlsaFrontendConfiguration config(TEST_DEVICE, PERIOD_SIZE, TEST_PERIODS, CV_CHANNELS, CV_CHANNELS);
+    ASSERT_EQ(AudioFrontendStatus::OK, _module_under_test->init(&config));
+    ASSERT_EQ(static_cast<snd_pcm_uframes_t>(PERIOD_SIZE), _module_under_test->_period_size);
+    EXPECT_EQ(PERIOD_SIZE, _module_under_test->_reblocker.period_size());
+    EXPECT_EQ(AUDIO_CHUNK_SIZE / 2, _module_under_test->_reblocker.latency());
+
+    _module_under_test->run();
+    wait_for_processing();
+    _module_under_test->cleanup();
+    EXPECT_TRUE(_engine.process_called);
+}
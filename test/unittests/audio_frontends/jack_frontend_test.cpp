@@ -51,6 +51,71 @@ TEST_F(TestJackFrontend, TestOperation)
     jack_activate(_module_under_test->_client);
 
     ASSERT_TRUE(_engine.process_called);
+
+    /* The engine was given the port buffers themselves, offset to the last chunk of the period */
+    ASSERT_EQ(MAX_FRONTEND_CHANNELS, static_cast<int>(_module_under_test->_in_channels.size()));
+    EXPECT_EQ(buffer + JACK_NFRAMES - AUDIO_CHUNK_SIZE, _module_under_test->_in_channels[0].channel(0));
+    EXPECT_EQ(buffer + JACK_NFRAMES - AUDIO_CHUNK_SIZE, _module_under_test->_out_channels[0].channel(0));
+}
+
+TEST_F(TestJackFrontend, TestXrunCallback)
+{
+    JackFrontendConfiguration config("Jack Client", "Jack Server", false, CV_CHANNELS, CV_CHANNELS);
+    ASSERT_EQ(AudioFrontendStatus::OK, _module_under_test->init(&config));
+
+    auto client = _module_under_test->_client;
+    ASSERT_NE(nullptr, client->xrun_callback_function);
+    EXPECT_EQ(0, client->xrun_callback_function(client->xrun_instance));
+    EXPECT_EQ(1, _engine.xrun_monitor()->counts().frontend_xruns);
+}
+
+TEST_F(TestJackFrontend, TestReblocking)
+{
+    JackFrontendConfiguration config("Jack Client", "Jack Server", false, CV_CHANNELS, CV_CHANNELS);
+    ASSERT_EQ(AudioFrontendStatus::OK, _module_under_test->init(&config));
+    EXPECT_EQ(0, _module_under_test->added_latency());
+
+    /* A period that is not a multiple of the chunk size is processed through the adapter */
+    constexpr int PERIOD = AUDIO_CHUNK_SIZE / 4 * 3;
+    _module_under_test->internal_buffer_size_callback(PERIOD);
+    EXPECT_EQ(AUDIO_CHUNK_SIZE - std::gcd(PERIOD, AUDIO_CHUNK_SIZE), _module_under_test->added_latency());
+    _module_under_test->internal_process_callback(PERIOD);
+    EXPECT_FALSE(_engine.process_called);
+    _module_under_test->internal_process_callback(PERIOD);
+    EXPECT_TRUE(_engine.process_called);
+
+    /* A period change jack didn't notify about is skipped */
+    _engine.process_called = false;
+    _module_under_test->internal_process_callback(PERIOD + 1);
+    _module_under_test->internal_process_callback(PERIOD + 1);
+    EXPECT_FALSE(_engine.process_called);
 }
 
+TEST_F(TestJackFrontend, TestReblockedCv)
+{
+    JackFrontendConfiguration config("Jack Client", "Jack Server", false, 1, 1);
+    ASSERT_EQ(AudioFrontendStatus::OK, _module_under_test->init(&config));
 
+    constexpr int PERIOD = AUDIO_CHUNK_SIZE / 4 * 3;
+    _module_under_test->internal_buffer_size_callback(PERIOD);
+    /* All mocked ports share one buffer, it is filled with a ramp before every period */
+    for (int i = 0; i < 2; ++i)
+    {
+        for (int n = 0; n < JACK_NFRAMES; ++n)
+        {
+            buffer[n] = static_cast<float>(n) / JACK_NFRAMES;
+        }
+        _module_under_test->internal_process_callback(PERIOD);
+    }
+    ASSERT_TRUE(_engine.process_called);
+
+    /* Cv input is re-blocked with the audio, so the first chunk holds the first period
+     * followed by the start of the second one */
+    const float* cv_data = _module_under_test->_in_controls.cv_buffers.channel(0);
+    for (int i = 0; i < AUDIO_CHUNK_SIZE; ++i)
+    {
+        int frame = i < PERIOD ? i : i - PERIOD;
+        ASSERT_FLOAT_EQ(map_audio_to_cv(static_cast<float>(frame) / JACK_NFRAMES), cv_data[i]);
+    }
+    EXPECT_FLOAT_EQ(cv_data[AUDIO_CHUNK_SIZE - 1], _module_under_test->_in_controls.cv_values[0]);
+}
@@ -0,0 +1,141 @@
+#include <fstream>
+
+#include "gtest/gtest.h"
+
+#include "test_utils/test_utils.h"
+
+#define private public
+#include "audio_frontends/offline_batch_renderer.cpp"
+
+using namespace sushi;
+using namespace sushi::audio_frontend;
+
+TEST(TestOfflineBatchRenderer, TestJobsFromFileList)
+{
+    std::string list_file("./test_batch_list.txt");
+    std::ofstream list(list_file);
+    list << "# Files to render\n"
+         << "/data/in/first.wav\n"
+         << "\n"
+         << "second.wav  \n";
+    list.close();
+
+    auto [status, jobs] = create_batch_jobs(list_file, "");
+    ASSERT_EQ(BatchRendererStatus::OK, status);
+    ASSERT_EQ(2u, jobs.size());
+    ASSERT_EQ(1u, jobs[0].input_filenames.size());
+    EXPECT_EQ("/data/in/first.wav", jobs[0].input_filenames[0]);
+    EXPECT_EQ("/data/in/first.wav_proc.wav", jobs[0].output_filename);
+    EXPECT_EQ("second.wav", jobs[1].input_filenames[0]);
+
+    std::tie(status, jobs) = create_batch_jobs(list_file, "/data/out");
+    ASSERT_EQ(BatchRendererStatus::OK, status);
+    ASSERT_EQ(2u, jobs.size());
+    EXPECT_EQ("/data/out/first.wav", jobs[0].output_filename);
+    EXPECT_EQ("/data/out/second.wav", jobs[1].output_filename);
+
+    EXPECT_EQ(BatchRendererStatus::NO_INPUT_FILES, create_batch_jobs("not_a_file_list.txt", "").first);
+}
+
+TEST(TestOfflineBatchRenderer, TestDuplicateOutputFiles)
+{
+    std::string list_file("./test_batch_list.txt");
+    std::ofstream list(list_file);
+    list << "/data/in/a/take.wav\n"
+         << "/data/in/b/take.wav\n";
+    list.close();
+
+    /* Different input files are fine as long as they are not written to the same directory */
+    EXPECT_EQ(BatchRendererStatus::OK, create_batch_jobs(list_file, "").first);
+    auto [status, jobs] = create_batch_jobs(list_file, "/data/out");
+    EXPECT_EQ(BatchRendererStatus::DUPLICATE_OUTPUT_FILE, status);
+    EXPECT_TRUE(jobs.empty());
+}
+
+TEST(TestOfflineBatchRenderer, TestJobsFromGlob)
+{
+    std::string pattern = test_utils::get_data_dir_path();
+    pattern.append("test_sndfile_*.wav");
+    auto [status, jobs] = create_batch_jobs(pattern, "");
+    ASSERT_EQ(BatchRendererStatus::OK, status);
+    ASSERT_EQ(1u, jobs.size());
+    EXPECT_EQ(test_utils::get_data_dir_path() + "test_sndfile_05.wav", jobs[0].input_filenames[0]);
+}
+
+TEST(TestOfflineBatchRenderer, TestRendering)
+{
+    constexpr int JOBS = 5;
+    std::string input_file = test_utils::get_data_dir_path();
+    input_file.append("test_sndfile_05.wav");
+    std::string config_file = test_utils::get_data_dir_path();
+    config_file.append("config.json");
+
+    std::vector<BatchJob> jobs;
+    for (int i = 0; i < JOBS; ++i)
+    {
+        jobs.push_back({{input_file}, "./test_batch_out_" + std::to_string(i) + ".wav"});
+    }
+
+    OfflineBatchRenderer module_under_test(config_file, 48000, 2, false);
+    ASSERT_EQ(BatchRendererStatus::OK, module_under_test.init(jobs));
+    EXPECT_EQ(2, module_under_test._worker_count);
+    /* Channel counts come from the configuration */
+    EXPECT_EQ(8, module_under_test._config_engine.engine->audio_input_channels());
+    EXPECT_EQ(8, module_under_test._config_engine.engine->audio_output_channels());
+
+    /* Worker engines remove their metrics when done */
+    auto metrics_count = performance::MetricsRegistry::global()._metrics.size();
+    EXPECT_EQ(0, module_under_test.run());
+    EXPECT_EQ(metrics_count, performance::MetricsRegistry::global()._metrics.size());
+
+    SF_INFO input_info;
+    memset(&input_info, 0, sizeof(input_info));
+    SNDFILE* file = sf_open(input_file.c_str(), SFM_READ, &input_info);
+    ASSERT_NE(nullptr, file);
+    sf_close(file);
+    for (const auto& job : jobs)
+    {
+        SF_INFO info;
+        memset(&info, 0, sizeof(info));
+        file = sf_open(job.output_filename.c_str(), SFM_READ, &info);
+        ASSERT_NE(nullptr, file) << job.output_filename;
+        EXPECT_EQ(8, info.channels);
+        EXPECT_EQ(input_info.frames, info.frames);
+        sf_close(file);
+    }
+}
+
+TEST(TestOfflineBatchRenderer, TestNoStateBetweenJobs)
+{
+    std::string input_file = test_utils::get_data_dir_path();
+    input_file.append("test_sndfile_05.wav");
+    std::string config_file = test_utils::get_data_dir_path();
+    config_file.append("config.json");
+
+    /* With a single worker both jobs are rendered one after the other */
+    std::vector<BatchJob> jobs = {{{input_file}, "./test_batch_twice_0.wav"},
+                                  {{input_file}, "./test_batch_twice_1.wav"}};
+    OfflineBatchRenderer module_under_test(config_file, 48000, 1, false);
+    ASSERT_EQ(BatchRendererStatus::OK, module_under_test.init(jobs));
+    EXPECT_EQ(0, module_under_test.run());
+
+    std::vector<std::vector<float>> outputs;
+    for (const auto& job : jobs)
+    {
+        SF_INFO info;
+        memset(&info, 0, sizeof(info));
+        SNDFILE* file = sf_open(job.output_filename.c_str(), SFM_READ, &info);
+        ASSERT_NE(nullptr, file) << job.output_filename;
+        auto& output = outputs.emplace_back(info.frames * info.channels);
+        ASSERT_EQ(info.frames, sf_readf_float(file, output.data(), info.frames));
+        sf_close(file);
+    }
+    ASSERT_FALSE(outputs[0].empty());
+    EXPECT_EQ(outputs[0], outputs[1]);
+}
+
+TEST(TestOfflineBatchRenderer, TestInvalidConfiguration)
+{
+    OfflineBatchRenderer module_under_test("not_a_config.json", 48000, 2, false);
+    EXPECT_EQ(BatchRendererStatus::INVALID_CONFIGURATION, module_under_test.init({{{"in.wav"}, "out.wav"}}));
+}
@@ -7,6 +7,7 @@
 
 #define private public
 #include "audio_frontends/offline_frontend.cpp"
+#include "audio_frontends/audio_file_streamer.cpp"
 
 using ::testing::internal::posix::GetEnv;
 
@@ -18,6 +19,25 @@ constexpr float SAMPLE_RATE = 44000;
 constexpr int CV_CHANNELS = 0;
 constexpr int AUDIO_CHANNELS = 2;
 
+/* Write a float wav file where each channel holds a constant value of 0.25 * (channel + 1) */
+void write_test_file(const std::string& filename, int channels, int frames)
+{
+    SF_INFO info;
+    memset(&info, 0, sizeof(info));
+    info.samplerate = SAMPLE_RATE;
+    info.channels = channels;
+    info.format = SF_FORMAT_WAV | SF_FORMAT_FLOAT;
+    SNDFILE* file = sf_open(filename.c_str(), SFM_WRITE, &info);
+    ASSERT_NE(nullptr, file);
+    std::vector<float> data(frames * channels);
+    for (int i = 0; i < frames * channels; ++i)
+    {
+        data[i] = 0.25f * (i % channels + 1);
+    }
+    sf_writef_float(file, data.data(), frames);
+    sf_close(file);
+}
+
 class TestOfflineFrontend : public ::testing::Test
 {
 protected:
@@ -38,7 +58,7 @@ protected:
     }
 
     EngineMockup _engine{SAMPLE_RATE};
-    MidiDispatcher _midi_dispatcher{_engine.event_dispatcher()};
+    MidiDispatcher _midi_dispatcher{_engine.event_dispatcher(), _engine.metrics()};
     OfflineFrontend* _module_under_test;
 };
 
@@ -113,6 +133,137 @@ TEST_F(TestOfflineFrontend, TestMonoMode)
     _module_under_test->run();
 }
 
+TEST_F(TestOfflineFrontend, TestMultipleFilesToStems)
+{
+    constexpr int FRAMES = AUDIO_CHUNK_SIZE * 5;
+    constexpr int MONO_FRAMES = AUDIO_CHUNK_SIZE * 2 + 3;
+    write_test_file("./test_multi_in_0.wav", 2, FRAMES);
+    write_test_file("./test_multi_in_1.wav", 1, MONO_FRAMES);
+
+    OfflineFrontendConfiguration config({"./test_multi_in_0.wav", "./test_multi_in_1.wav"}, "./test_multi_out.wav",
+                                        false, CV_CHANNELS, CV_CHANNELS, 0, 0, true);
+    auto ret_code = _module_under_test->init(&config);
+    ASSERT_EQ(AudioFrontendStatus::OK, ret_code);
+    EXPECT_EQ(3, _engine.audio_input_channels());
+    EXPECT_EQ(3, _engine.audio_output_channels());
+    ASSERT_EQ(2u, _module_under_test->_output_files.size());
+
+    _module_under_test->run();
+    _module_under_test->cleanup();
+
+    /* The stereo file passes through to the first bus, the shorter
+     * mono file to the first channel of the second bus */
+    SF_INFO info;
+    memset(&info, 0, sizeof(info));
+    SNDFILE* file = sf_open("./test_multi_out_bus_0.wav", SFM_READ, &info);
+    ASSERT_NE(nullptr, file);
+    ASSERT_EQ(2, info.channels);
+    std::vector<float> output(FRAMES * 2);
+    ASSERT_EQ(FRAMES, sf_readf_float(file, output.data(), FRAMES));
+    sf_close(file);
+    for (int n = 0; n < FRAMES; ++n)
+    {
+        ASSERT_FLOAT_EQ(0.25f, output[n * 2]);
+        ASSERT_FLOAT_EQ(0.5f, output[n * 2 + 1]);
+    }
+
+    file = sf_open("./test_multi_out_bus_1.wav", SFM_READ, &info);
+    ASSERT_NE(nullptr, file);
+    ASSERT_EQ(1, info.channels);
+    ASSERT_EQ(FRAMES, sf_readf_float(file, output.data(), FRAMES));
+    sf_close(file);
+    for (int n = 0; n < FRAMES; ++n)
+    {
+        ASSERT_FLOAT_EQ(n < MONO_FRAMES ? 0.25f : 0.0f, output[n]);
+    }
+}
+
+/* Stops the frontend from inside the audio callback after a number of chunks */
+class StoppingEngineMockup : public EngineMockup
+{
+public:
+    StoppingEngineMockup(float sample_rate, int stop_after) : EngineMockup(sample_rate), _stop_after(stop_after) {}
+
+    void process_chunk(SampleBuffer<AUDIO_CHUNK_SIZE>* in_buffer,
+                       SampleBuffer<AUDIO_CHUNK_SIZE>* out_buffer,
+                       ControlBuffer* in_controls, ControlBuffer* out_controls,
+                       Time timestamp, int64_t samplecount) override
+    {
+        EngineMockup::process_chunk(in_buffer, out_buffer, in_controls, out_controls, timestamp, samplecount);
+        if (++_chunks == _stop_after)
+        {
+            frontend->_running = false;
+        }
+    }
+
+    OfflineFrontend* frontend{nullptr};
+
+private:
+    int _stop_after;
+    int _chunks{0};
+};
+
+TEST(TestOfflineFrontendStop, TestStopWritesOnlyRenderedFrames)
+{
+    constexpr int STOP_AFTER_CHUNKS = 3;
+    write_test_file("./test_stop_in.wav", 2, AudioFileStreamer::block_frames() * 2);
+
+    StoppingEngineMockup engine(SAMPLE_RATE, STOP_AFTER_CHUNKS);
+    OfflineFrontend module_under_test(&engine);
+    engine.frontend = &module_under_test;
+    engine.set_audio_input_channels(AUDIO_CHANNELS);
+    engine.set_audio_output_channels(AUDIO_CHANNELS);
+    OfflineFrontendConfiguration config("./test_stop_in.wav", "./test_stop_out.wav", false, CV_CHANNELS, CV_CHANNELS);
+    ASSERT_EQ(AudioFrontendStatus::OK, module_under_test.init(&config));
+
+    module_under_test.run();
+    module_under_test.cleanup();
+
+    SF_INFO info;
+    memset(&info, 0, sizeof(info));
+    SNDFILE* file = sf_open("./test_stop_out.wav", SFM_READ, &info);
+    ASSERT_NE(nullptr, file);
+    std::vector<float> output(AudioFileStreamer::block_frames() * 2 * AUDIO_CHANNELS);
+    EXPECT_EQ(STOP_AFTER_CHUNKS * AUDIO_CHUNK_SIZE, sf_readf_float(file, output.data(), AudioFileStreamer::block_frames() * 2));
+    sf_close(file);
+}
+
+TEST_F(TestOfflineFrontend, TestConfiguredChannels)
+{
+    write_test_file("./test_multi_in_0.wav", 2, AUDIO_CHUNK_SIZE);
+    OfflineFrontendConfiguration config({"./test_multi_in_0.wav"}, "./test_multi_out.wav",
+                                        false, CV_CHANNELS, CV_CHANNELS, 8, 8, false);
+    auto ret_code = _module_under_test->init(&config);
+    ASSERT_EQ(AudioFrontendStatus::OK, ret_code);
+    EXPECT_EQ(8, _engine.audio_input_channels());
+    EXPECT_EQ(8, _engine.audio_output_channels());
+    ASSERT_EQ(1u, _module_under_test->_output_files.size());
+    EXPECT_EQ(8, _module_under_test->_output_files[0].channels);
+}
+
+TEST(TestOfflineFrontendInternals, TestStemFilename)
+{
+    EXPECT_EQ("out_bus_0.wav", stem_filename("out.wav", 0));
+    EXPECT_EQ("/tmp/render.d/out_bus_3", stem_filename("/tmp/render.d/out", 3));
+    EXPECT_EQ("./out_bus_1.flac", stem_filename("./out.flac", 1));
+}
+
+TEST_F(TestOfflineFrontend, TestBenchmark)
+{
+    OfflineFrontendConfiguration config("", "", true, CV_CHANNELS, CV_CHANNELS);
+    auto ret_code = _module_under_test->init(&config);
+    ASSERT_EQ(AudioFrontendStatus::OK, ret_code);
+
+    auto result = _module_under_test->run_benchmark(std::chrono::seconds(1));
+    int expected_chunks = static_cast<int>(SAMPLE_RATE / AUDIO_CHUNK_SIZE);
+    EXPECT_EQ(expected_chunks, result.chunks);
+    EXPECT_EQ(static_cast<uint64_t>(expected_chunks), result.chunk_loads.count());
+    EXPECT_FLOAT_EQ(SAMPLE_RATE, result.sample_rate);
+    EXPECT_NEAR(1.0, std::chrono::duration<double>(result.audio_time).count(), 0.01);
+    EXPECT_GT(result.realtime_factor(), 0.0f);
+    EXPECT_EQ(0u, result.dropped_timings);
+}
+
 TEST_F(TestOfflineFrontend, TestAddSequencerEvents)
 {
     char const* test_data_dir = GetEnv("SUSHI_TEST_DATA_DIR");
@@ -133,16 +284,47 @@ TEST_F(TestOfflineFrontend, TestAddSequencerEvents)
     ASSERT_EQ(jsonconfig::JsonConfigReturnStatus::OK, status);
     _module_under_test->add_sequencer_events(events);
 
-    auto event_q = _module_under_test->_event_queue;
-    ASSERT_EQ(4u, event_q.size());
+    auto& timeline = _module_under_test->_timeline;
+    ASSERT_EQ(4u, timeline.size());
 
-    // Check that queue is sorted by time
-    auto jt = --event_q.end();
-    for(auto it = event_q.begin(); it != jt; ++it)
+    // Check that the timeline is sorted by time
+    for (size_t i = 1; i < timeline.size(); ++i)
     {
-        ASSERT_GE((*it)->time(), (*(it + 1))->time());
+        ASSERT_LE(timeline[i - 1].sample, timeline[i].sample);
     }
+}
+
+TEST_F(TestOfflineFrontend, TestEventTimeline)
+{
+    /* 3 hours and 11 samples in, which is exactly representable in microseconds */
+    constexpr int64_t EVENT_SAMPLE = static_cast<int64_t>(SAMPLE_RATE) * 3 * 3600 + 11;
+    Time event_time = std::chrono::seconds(3 * 3600) + std::chrono::microseconds(250);
+    std::vector<Event*> events;
+    events.push_back(new ParameterChangeEvent(ParameterChangeEvent::Subtype::FLOAT_PARAMETER_CHANGE,
+                                              1, 2, 0.5f, event_time));
+    events.push_back(new ParameterChangeEvent(ParameterChangeEvent::Subtype::FLOAT_PARAMETER_CHANGE,
+                                              1, 2, 0.25f, Time(0)));
+    _module_under_test->add_sequencer_events(events);
+
+    auto& timeline = _module_under_test->_timeline;
+    ASSERT_EQ(2u, timeline.size());
+    EXPECT_EQ(0, timeline[0].sample);
+    EXPECT_EQ(EVENT_SAMPLE, timeline[1].sample);
 
+    _module_under_test->_process_events(0);
+    EXPECT_EQ(1u, _module_under_test->_next_timeline_event);
+    EXPECT_EQ(0, timeline[0].event.sample_offset());
+
+    /* The chunk before the event's should not send it */
+    _module_under_test->_process_events(EVENT_SAMPLE - 5 - AUDIO_CHUNK_SIZE);
+    EXPECT_EQ(1u, _module_under_test->_next_timeline_event);
+
+    _module_under_test->_process_events(EVENT_SAMPLE - 5);
+    EXPECT_EQ(2u, _module_under_test->_next_timeline_event);
+    EXPECT_EQ(5, timeline[1].event.sample_offset());
+    EXPECT_FLOAT_EQ(0.5f, timeline[1].event.parameter_change_event()->value());
+
+    EXPECT_EQ(Time(std::chrono::seconds(3 * 3600) + std::chrono::microseconds(250)), sample_to_time(EVENT_SAMPLE, SAMPLE_RATE));
 }
 
 TEST_F(TestOfflineFrontend, TestNoiseGeneration)
@@ -177,4 +359,61 @@ TEST(TestAudioFrontendInternals, TestRampCvOutput)
         EXPECT_GT(prev, i);
         prev = i;
     }
-}
\ No newline at end of file
+}
+TEST(TestAudioFileStreamer, TestStreaming)
+{
+    constexpr int CHANNELS = 2;
+    /* Not a multiple of the block size to test a partial last block */
+    const int frames = AudioFileStreamer::block_frames() * 3 + AUDIO_CHUNK_SIZE + 5;
+    std::string input_file_name("./test_streamer_in.wav");
+    std::string output_file_name("./test_streamer_out.wav");
+
+    SF_INFO info;
+    memset(&info, 0, sizeof(info));
+    info.samplerate = SAMPLE_RATE;
+    info.channels = CHANNELS;
+    info.format = SF_FORMAT_WAV | SF_FORMAT_FLOAT;
+    SNDFILE* file = sf_open(input_file_name.c_str(), SFM_WRITE, &info);
+    ASSERT_NE(nullptr, file);
+    std::vector<float> data(frames * CHANNELS);
+    for (int i = 0; i < frames * CHANNELS; ++i)
+    {
+        data[i] = static_cast<float>(i % 1000) / 1000.0f;
+    }
+    sf_writef_float(file, data.data(), frames);
+    sf_close(file);
+
+    SNDFILE* input_file = sf_open(input_file_name.c_str(), SFM_READ, &info);
+    SNDFILE* output_file = sf_open(output_file_name.c_str(), SFM_WRITE, &info);
+    ASSERT_NE(nullptr, input_file);
+    ASSERT_NE(nullptr, output_file);
+    {
+        AudioFileStreamer module_under_test({{input_file, CHANNELS, 0}}, {{output_file, CHANNELS, 0}});
+        module_under_test.start();
+        int blocks = 0;
+        while (auto block = module_under_test.next_block())
+        {
+            /* Output a scaled copy of the input */
+            for (int i = 0; i < block->frames * CHANNELS; ++i)
+            {
+                block->outputs[0][i] = 0.5f * block->inputs[0][i];
+            }
+            module_under_test.write_block(block);
+            blocks++;
+        }
+        module_under_test.finish();
+        EXPECT_EQ(4, blocks);
+    }
+    sf_close(input_file);
+    sf_close(output_file);
+
+    file = sf_open(output_file_name.c_str(), SFM_READ, &info);
+    ASSERT_NE(nullptr, file);
+    std::vector<float> output(frames * CHANNELS + 1);
+    ASSERT_EQ(frames, sf_readf_float(file, output.data(), frames + 1));
+    sf_close(file);
+    for (int i = 0; i < frames * CHANNELS; ++i)
+    {
+        ASSERT_FLOAT_EQ(0.5f * data[i], output[i]);
+    }
+}
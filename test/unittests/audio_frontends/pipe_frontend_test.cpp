@@ -0,0 +1,182 @@
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+#include <sys/stat.h>
+
+#include "gtest/gtest.h"
+
+#include "test_utils/engine_mockup.h"
+
+#define private public
+#include "audio_frontends/pipe_frontend.cpp"
+
+using namespace sushi;
+using namespace sushi::audio_frontend;
+
+constexpr float SAMPLE_RATE = 48000;
+constexpr int CV_CHANNELS = 0;
+
+/* Write raw interleaved samples to a file, as they would arrive through a pipe */
+template <typename T>
+void write_raw_file(const std::string& filename, const std::vector<T>& data)
+{
+    FILE* file = fopen(filename.c_str(), "wb");
+    ASSERT_NE(nullptr, file);
+    fwrite(data.data(), sizeof(T), data.size(), file);
+    fclose(file);
+}
+
+template <typename T>
+std::vector<T> read_raw_file(const std::string& filename)
+{
+    std::vector<T> data;
+    FILE* file = fopen(filename.c_str(), "rb");
+    if (file == nullptr)
+    {
+        return data;
+    }
+    T sample;
+    while (fread(&sample, sizeof(T), 1, file) == 1)
+    {
+        data.push_back(sample);
+    }
+    fclose(file);
+    return data;
+}
+
+bool wait_for_stream_end(const PipeFrontend& frontend)
+{
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (frontend.stream_ended() == false)
+    {
+        if (std::chrono::steady_clock::now() > deadline)
+        {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+class TestPipeFrontend : public ::testing::Test
+{
+protected:
+    TestPipeFrontend()
+    {
+    }
+
+    void SetUp()
+    {
+        _module_under_test = new PipeFrontend(&_engine);
+    }
+
+    void TearDown()
+    {
+        delete _module_under_test;
+    }
+
+    EngineMockup _engine{SAMPLE_RATE};
+    PipeFrontend* _module_under_test;
+};
+
+TEST(TestPipeFrontendInternals, TestFormatFromString)
+{
+    EXPECT_EQ(PipeSampleFormat::FLOAT_32, pipe_format_from_string("f32le").value());
+    EXPECT_EQ(PipeSampleFormat::INT_16, pipe_format_from_string("s16le").value());
+    EXPECT_EQ(PipeSampleFormat::INT_24, pipe_format_from_string("s24le").value());
+    EXPECT_EQ(PipeSampleFormat::INT_32, pipe_format_from_string("s32le").value());
+    EXPECT_FALSE(pipe_format_from_string("u8").has_value());
+}
+
+TEST_F(TestPipeFrontend, TestInvalidConfiguration)
+{
+    PipeFrontendConfiguration config("./not_a_pipe", "./test_pipe_out.raw", PipeSampleFormat::FLOAT_32, 2, false, CV_CHANNELS, CV_CHANNELS);
+    EXPECT_EQ(AudioFrontendStatus::INVALID_INPUT_FILE, _module_under_test->init(&config));
+
+    write_raw_file<float>("./test_pipe_in.raw", {0.0f, 0.0f});
+    PipeFrontendConfiguration no_channels("./test_pipe_in.raw", "./test_pipe_out.raw", PipeSampleFormat::FLOAT_32, 0, false, CV_CHANNELS, CV_CHANNELS);
+    EXPECT_EQ(AudioFrontendStatus::INVALID_N_CHANNELS, _module_under_test->init(&no_channels));
+}
+
+TEST_F(TestPipeFrontend, TestFloatStreaming)
+{
+    /* Not a multiple of the chunk size, and mapped to more engine channels than in the stream */
+    constexpr int FRAMES = AUDIO_CHUNK_SIZE * 3 + 5;
+    constexpr int CHANNELS = 3;
+    std::vector<float> input(FRAMES * CHANNELS);
+    for (size_t i = 0; i < input.size(); ++i)
+    {
+        input[i] = 0.001f * i - 0.5f;
+    }
+    write_raw_file("./test_pipe_in.raw", input);
+
+    PipeFrontendConfiguration config("./test_pipe_in.raw", "./test_pipe_out.raw", PipeSampleFormat::FLOAT_32, CHANNELS, false, CV_CHANNELS, CV_CHANNELS);
+    ASSERT_EQ(AudioFrontendStatus::OK, _module_under_test->init(&config));
+    EXPECT_EQ(CHANNELS, _engine.audio_input_channels());
+    _module_under_test->run();
+    ASSERT_TRUE(wait_for_stream_end(*_module_under_test));
+    _module_under_test->cleanup();
+
+    /* Output is the unprocessed input from the bypass engine */
+    auto output = read_raw_file<float>("./test_pipe_out.raw");
+    ASSERT_EQ(input.size(), output.size());
+    for (size_t i = 0; i < input.size(); ++i)
+    {
+        ASSERT_FLOAT_EQ(input[i], output[i]);
+    }
+}
+
+TEST_F(TestPipeFrontend, TestMonoInt16Streaming)
+{
+    constexpr int FRAMES = AUDIO_CHUNK_SIZE * 2;
+    std::vector<int16_t> input(FRAMES);
+    for (size_t i = 0; i < input.size(); ++i)
+    {
+        input[i] = static_cast<int16_t>(i * 50 - 3000);
+    }
+    write_raw_file("./test_pipe_in.raw", input);
+
+    PipeFrontendConfiguration config("./test_pipe_in.raw", "./test_pipe_out.raw", PipeSampleFormat::INT_16, 1, true, CV_CHANNELS, CV_CHANNELS);
+    ASSERT_EQ(AudioFrontendStatus::OK, _module_under_test->init(&config));
+    /* Mono streams are processed as the left channel of a stereo engine */
+    EXPECT_EQ(PIPE_FRONTEND_MIN_CHANNELS, _engine.audio_input_channels());
+    _module_under_test->run();
+    ASSERT_TRUE(wait_for_stream_end(*_module_under_test));
+    _module_under_test->cleanup();
+
+    auto output = read_raw_file<int16_t>("./test_pipe_out.raw");
+    ASSERT_EQ(input.size(), output.size());
+    for (size_t i = 0; i < input.size(); ++i)
+    {
+        ASSERT_EQ(input[i], output[i]);
+    }
+}
+
+TEST_F(TestPipeFrontend, TestStopWithoutEndOfStream)
+{
+    /* The writing end of the fifo is kept open, so the stream never ends by itself */
+    std::string fifo_name = "./test_pipe_fifo";
+    unlink(fifo_name.c_str());
+    ASSERT_EQ(0, mkfifo(fifo_name.c_str(), 0600));
+    int fifo = open(fifo_name.c_str(), O_RDWR);
+    ASSERT_GE(fifo, 0);
+    std::vector<float> input(AUDIO_CHUNK_SIZE * 2, 0.25f);
+    ASSERT_EQ(static_cast<ssize_t>(input.size() * sizeof(float)), write(fifo, input.data(), input.size() * sizeof(float)));
+
+    PipeFrontendConfiguration config(fifo_name, "./test_pipe_out.raw", PipeSampleFormat::FLOAT_32, 2, false, CV_CHANNELS, CV_CHANNELS);
+    ASSERT_EQ(AudioFrontendStatus::OK, _module_under_test->init(&config));
+    _module_under_test->run();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_FALSE(_module_under_test->stream_ended());
+
+    auto start = std::chrono::steady_clock::now();
+    _module_under_test->cleanup();
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(1));
+    EXPECT_TRUE(_module_under_test->stream_ended());
+
+    /* Input that arrived before stopping may or may not be processed, but never more than that */
+    EXPECT_LE(read_raw_file<float>("./test_pipe_out.raw").size(), input.size());
+    close(fifo);
+    unlink(fifo_name.c_str());
+}
@@ -0,0 +1,90 @@
+#include <numeric>
+
+#include "gtest/gtest.h"
+
+#include "audio_frontends/reblocking_adapter.h"
+
+using namespace sushi;
+using namespace sushi::audio_frontend;
+
+constexpr int INPUT_CHANNELS = 2;
+constexpr int OUTPUT_CHANNELS = 2;
+
+class TestReblockingAdapter : public ::testing::Test
+{
+protected:
+    TestReblockingAdapter() {}
+
+    /* Run a ramp through the adapter, passing audio straight through and recording the chunk offsets */
+    void run_periods(int period_size, int periods)
+    {
+        _chunk_starts.clear();
+        _output = std::vector<std::vector<float>>(OUTPUT_CHANNELS);
+        std::vector<std::vector<float>> in_data(INPUT_CHANNELS, std::vector<float>(period_size));
+        std::vector<std::vector<float>> out_data(OUTPUT_CHANNELS, std::vector<float>(period_size));
+        std::vector<const float*> inputs;
+        std::vector<float*> outputs;
+        for (int c = 0; c < INPUT_CHANNELS; ++c)
+        {
+            inputs.push_back(in_data[c].data());
+            outputs.push_back(out_data[c].data());
+        }
+        int sample = 0;
+        for (int p = 0; p < periods; ++p)
+        {
+            for (int c = 0; c < INPUT_CHANNELS; ++c)
+            {
+                std::iota(in_data[c].begin(), in_data[c].end(), static_cast<float>(sample + 1 + c * 100000));
+            }
+            _module_under_test.process(inputs.data(), outputs.data(), [&](engine::ChunkChannelBuffers* in,
+                                                                          engine::ChunkChannelBuffers* out,
+                                                                          int offset)
+            {
+                _chunk_starts.push_back(sample + offset);
+                for (int c = 0; c < OUTPUT_CHANNELS; ++c)
+                {
+                    (*out)[c] = (*in)[c];
+                }
+            });
+            for (int c = 0; c < OUTPUT_CHANNELS; ++c)
+            {
+                _output[c].insert(_output[c].end(), out_data[c].begin(), out_data[c].end());
+            }
+            sample += period_size;
+        }
+    }
+
+    ReblockingAdapter _module_under_test;
+    std::vector<int> _chunk_starts;
+    std::vector<std::vector<float>> _output{OUTPUT_CHANNELS};
+};
+
+TEST_F(TestReblockingAdapter, TestDelay)
+{
+    for (int period_size : {AUDIO_CHUNK_SIZE / 4, AUDIO_CHUNK_SIZE / 4 * 3, AUDIO_CHUNK_SIZE - 1,
+                            AUDIO_CHUNK_SIZE, AUDIO_CHUNK_SIZE + 36, 3 * AUDIO_CHUNK_SIZE + 1})
+    {
+        _module_under_test.configure(INPUT_CHANNELS, OUTPUT_CHANNELS, period_size);
+        int latency = _module_under_test.latency();
+        EXPECT_EQ(AUDIO_CHUNK_SIZE - std::gcd(period_size, AUDIO_CHUNK_SIZE), latency);
+
+        run_periods(period_size, 4 * AUDIO_CHUNK_SIZE);
+
+        /* The output is the input delayed by exactly the reported latency */
+        for (int c = 0; c < OUTPUT_CHANNELS; ++c)
+        {
+            for (int i = 0; i < static_cast<int>(_output[c].size()); ++i)
+            {
+                float expected = i < latency ? 0.0f : static_cast<float>(i - latency + 1 + c * 100000);
+                ASSERT_FLOAT_EQ(expected, _output[c][i]) << "period " << period_size << ", sample " << i;
+            }
+        }
+
+        /* Chunks are processed back to back */
+        ASSERT_EQ(4 * period_size, static_cast<int>(_chunk_starts.size()));
+        for (int i = 0; i < static_cast<int>(_chunk_starts.size()); ++i)
+        {
+            ASSERT_EQ(i * AUDIO_CHUNK_SIZE, _chunk_starts[i]);
+        }
+    }
+}
@@ -0,0 +1,85 @@
+#include "gtest/gtest.h"
+
+#include "test_utils/engine_mockup.h"
+
+#define private public
+#include "audio_frontends/shm_frontend.cpp"
+
+using namespace sushi;
+using namespace sushi::audio_frontend;
+
+constexpr float SAMPLE_RATE = 48000;
+constexpr int CV_CHANNELS = 0;
+constexpr int AUDIO_CHANNELS = 2;
+constexpr long TEST_TIMEOUT_NS = 1'000'000'000;
+constexpr char TEST_SHM_NAME[] = "/sushi_shm_frontend_test";
+
+class TestShmFrontend : public ::testing::Test
+{
+protected:
+    TestShmFrontend()
+    {
+    }
+
+    void SetUp()
+    {
+        _module_under_test = new ShmFrontend(&_engine);
+    }
+
+    void TearDown()
+    {
+        delete _module_under_test;
+    }
+
+    EngineMockup _engine{SAMPLE_RATE};
+    ShmFrontend* _module_under_test;
+};
+
+TEST_F(TestShmFrontend, TestInvalidChannels)
+{
+    ShmFrontendConfiguration config(TEST_SHM_NAME, 0, 0, CV_CHANNELS, CV_CHANNELS);
+    EXPECT_EQ(AudioFrontendStatus::INVALID_N_CHANNELS, _module_under_test->init(&config));
+}
+
+TEST_F(TestShmFrontend, TestProcessing)
+{
+    ShmFrontendConfiguration config(TEST_SHM_NAME, AUDIO_CHANNELS, AUDIO_CHANNELS, CV_CHANNELS, CV_CHANNELS);
+    ASSERT_EQ(AudioFrontendStatus::OK, _module_under_test->init(&config));
+    auto header = _module_under_test->_header;
+    ASSERT_NE(nullptr, header);
+    EXPECT_EQ(ext::SHM_AUDIO_MAGIC, header->magic);
+    EXPECT_EQ(AUDIO_CHUNK_SIZE, static_cast<int>(header->chunk_size));
+    EXPECT_EQ(AUDIO_CHANNELS, static_cast<int>(header->input_channels));
+    EXPECT_EQ(ext::ShmAudioState::STARTING, header->state.load());
+
+    _module_under_test->run();
+    EXPECT_EQ(ext::ShmAudioState::RUNNING, header->state.load());
+    EXPECT_FLOAT_EQ(SAMPLE_RATE, header->sample_rate);
+
+    /* Act as the client and run a few periods through the bypass engine */
+    for (uint32_t period = 1; period <= 3; ++period)
+    {
+        float* input = ext::shm_audio_inputs(header);
+        for (int i = 0; i < AUDIO_CHANNELS * AUDIO_CHUNK_SIZE; ++i)
+        {
+            input[i] = 0.001f * (i + period);
+        }
+        header->request_count.store(period);
+        ext::shm_audio_wake(header->request_count);
+        while (header->done_count.load() != period)
+        {
+            ext::shm_audio_wait(header->done_count, period - 1, TEST_TIMEOUT_NS);
+        }
+        float* output = ext::shm_audio_outputs(header);
+        for (int i = 0; i < AUDIO_CHANNELS * AUDIO_CHUNK_SIZE; ++i)
+        {
+            ASSERT_FLOAT_EQ(0.001f * (i + period), output[i]);
+        }
+    }
+    EXPECT_EQ(3 * AUDIO_CHUNK_SIZE, _module_under_test->_samplecount);
+
+    /* The region is removed on cleanup */
+    _module_under_test->cleanup();
+    EXPECT_EQ(nullptr, _module_under_test->_header);
+    EXPECT_LT(shm_open(TEST_SHM_NAME, O_RDWR, 0), 0);
+}
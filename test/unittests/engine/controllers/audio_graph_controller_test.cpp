@@ -163,3 +163,30 @@ TEST_F(AudioGraphControllerTest, TestCreatingAndRemovingProcessors)
     processors = _audio_engine->processor_container()->processors_on_track(track_2_id);
     EXPECT_EQ(0u, processors.size());
 }
+
+TEST_F(AudioGraphControllerTest, TestAsyncRemovingProcessor)
+{
+    auto status = _module_under_test->create_processor_on_track("Proc 1",
+                                                                "sushi.testing.gain",
+                                                                "",
+                                                                ext::PluginType::INTERNAL,
+                                                                _track_id,
+                                                                std::nullopt);
+    ASSERT_EQ(ext::ControlStatus::OK, status);
+    ASSERT_EQ(EventStatus::HANDLED_OK, _event_dispatcher_mockup->execute_engine_event(_audio_engine.get()));
+
+    auto processors = _audio_engine->processor_container()->processors_on_track(_track_id);
+    ASSERT_EQ(1u, processors.size());
+    int proc_id = processors[0]->id();
+
+    auto delete_future = _module_under_test->delete_processor_from_track_async(proc_id, _track_id);
+    EXPECT_NE(std::future_status::ready, delete_future.wait_for(std::chrono::seconds(0)));
+    _event_dispatcher_mockup->execute_engine_event(_audio_engine.get());
+    EXPECT_EQ(ext::ControlStatus::OK, delete_future.get());
+    EXPECT_EQ(0u, _audio_engine->processor_container()->processors_on_track(_track_id).size());
+
+    // Deleting it again should fail
+    delete_future = _module_under_test->delete_processor_from_track_async(proc_id, _track_id);
+    _event_dispatcher_mockup->execute_engine_event(_audio_engine.get());
+    EXPECT_EQ(ext::ControlStatus::ERROR, delete_future.get());
+}
@@ -38,7 +38,7 @@ protected:
     void TearDown() {}
 
     EngineMockup _test_engine{TEST_SAMPLE_RATE};
-    MidiDispatcher _midi_dispatcher{_test_engine.event_dispatcher()};
+    MidiDispatcher _midi_dispatcher{_test_engine.event_dispatcher(), _test_engine.metrics()};
     sushi::ext::ControlMockup _controller; // TODO: Maybe just the ParameterControllerMockup?
     MidiController _midi_controller{&_test_engine, &_midi_dispatcher, _controller.parameter_controller_mockup()};
     EventDispatcherMockup* _test_dispatcher;
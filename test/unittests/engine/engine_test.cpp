@@ -71,6 +71,26 @@ TEST_F(TestClipDetector, TestClipping)
     ASSERT_FALSE(queue.pop(notification));
 }
 
+class EventRecordingProcessor : public DummyProcessor
+{
+public:
+    EventRecordingProcessor(HostControl host_control) : DummyProcessor(host_control) {}
+
+    void process_event(const RtEvent& event) override
+    {
+        recorded_events.push_back(event);
+    }
+
+    void process_events(RtEventSpan events) override
+    {
+        batches++;
+        Processor::process_events(events);
+    }
+
+    std::vector<RtEvent> recorded_events;
+    int batches{0};
+};
+
 /*
 * Engine tests
 */
@@ -167,6 +187,40 @@ TEST_F(TestEngine, TestOutputMixing)
     test_utils::assert_buffer_value(2.0f, main_bus, test_utils::DECIBEL_ERROR);
 }
 
+TEST_F(TestEngine, TestProcessSeparateChannels)
+{
+    auto [status, track_id] = _module_under_test->create_track("test_track", 2);
+    ASSERT_EQ(EngineReturnStatus::OK, status);
+    _module_under_test->connect_audio_input_bus(0, 0, track_id);
+    _module_under_test->connect_audio_output_bus(1, 0, track_id);
+
+    /* Every channel in its own buffer, as when wrapping audio server buffers */
+    std::vector<std::array<float, AUDIO_CHUNK_SIZE>> in_data(TEST_CHANNEL_COUNT);
+    std::vector<std::array<float, AUDIO_CHUNK_SIZE>> out_data(TEST_CHANNEL_COUNT);
+    ChunkChannelBuffers in_channels;
+    ChunkChannelBuffers out_channels;
+    for (int c = 0; c < TEST_CHANNEL_COUNT; ++c)
+    {
+        in_data[c].fill(0.5f + 0.1f * c);
+        out_data[c].fill(3.0f);
+        in_channels.push_back(ChunkSampleBuffer::create_from_raw_pointer(in_data[c].data(), 0, 1));
+        out_channels.push_back(ChunkSampleBuffer::create_from_raw_pointer(out_data[c].data(), 0, 1));
+    }
+    ControlBuffer control_buffer;
+
+    _module_under_test->process_chunk(&in_channels, &out_channels, &control_buffer, &control_buffer, Time(0), 0);
+
+    /* Input bus 0 is routed to output bus 1 and the output is written in place */
+    for (int c = 0; c < TEST_CHANNEL_COUNT; ++c)
+    {
+        float expected = c == 2 ? 0.5f : c == 3 ? 0.6f : 0.0f;
+        for (auto sample : out_data[c])
+        {
+            ASSERT_NEAR(expected, sample, test_utils::DECIBEL_ERROR);
+        }
+    }
+}
+
 TEST_F(TestEngine, TestCreateEmptyTrack)
 {
     auto [status, track_id] = _module_under_test->create_track("left", 2);
@@ -501,6 +555,91 @@ TEST_F(TestEngine, TestCvRouting)
     // We should have a non-zero value in this slot
     ASSERT_NE(0.0f, out_controls.cv_values[1]);
 }
+TEST_F(TestEngine, TestAudioRateCvRouting)
+{
+    /* Pass cv at audio rate through an empty track */
+    auto [track_status, track_id] = _module_under_test->create_track("cv_track", 1);
+    ASSERT_EQ(EngineReturnStatus::OK, track_status);
+
+    auto status = _module_under_test->set_cv_input_channels(2);
+    ASSERT_EQ(EngineReturnStatus::OK, status);
+    status = _module_under_test->set_cv_output_channels(2);
+    ASSERT_EQ(EngineReturnStatus::OK, status);
+
+    EXPECT_EQ(EngineReturnStatus::INVALID_CHANNEL, _module_under_test->connect_cv_to_track("cv_track", 0, 2));
+    EXPECT_EQ(EngineReturnStatus::INVALID_CHANNEL, _module_under_test->connect_cv_from_track("cv_track", 1, 0));
+    EXPECT_EQ(EngineReturnStatus::INVALID_TRACK, _module_under_test->connect_cv_to_track("no_track", 0, 1));
+    ASSERT_EQ(EngineReturnStatus::OK, _module_under_test->connect_cv_to_track("cv_track", 0, 1));
+    ASSERT_EQ(EngineReturnStatus::OK, _module_under_test->connect_cv_from_track("cv_track", 0, 0));
+
+    ChunkSampleBuffer in_buffer(1);
+    ChunkSampleBuffer out_buffer(1);
+    ControlBuffer in_controls;
+    ControlBuffer out_controls;
+    float* cv_in = in_controls.cv_buffers.channel(1);
+    for (int i = 0; i < AUDIO_CHUNK_SIZE; ++i)
+    {
+        cv_in[i] = static_cast<float>(i) / AUDIO_CHUNK_SIZE;
+    }
+    _module_under_test->process_chunk(&in_buffer, &out_buffer, &in_controls, &out_controls, Time(0), 0);
+
+    EXPECT_TRUE(out_controls.audio_rate_cv[0]);
+    EXPECT_FALSE(out_controls.audio_rate_cv[1]);
+    const float* cv_out = out_controls.cv_buffers.channel(0);
+    for (int i = 0; i < AUDIO_CHUNK_SIZE; ++i)
+    {
+        ASSERT_FLOAT_EQ(cv_in[i], cv_out[i]);
+    }
+    EXPECT_FLOAT_EQ(cv_in[AUDIO_CHUNK_SIZE - 1], out_controls.cv_values[0]);
+}
+
+TEST_F(TestEngine, TestCvTrackConnectionClash)
+{
+    auto [track_status, track_id] = _module_under_test->create_track("cv_track", 2);
+    ASSERT_EQ(EngineReturnStatus::OK, track_status);
+    ASSERT_EQ(EngineReturnStatus::OK, _module_under_test->set_cv_input_channels(1));
+    ASSERT_EQ(EngineReturnStatus::OK, _module_under_test->connect_audio_input_channel(0, 0, track_id));
+
+    EXPECT_EQ(EngineReturnStatus::INVALID_CHANNEL, _module_under_test->connect_cv_to_track("cv_track", 0, 0));
+    ASSERT_EQ(EngineReturnStatus::OK, _module_under_test->connect_cv_to_track("cv_track", 1, 0));
+
+    // An audio connection made after the cv connection is replaced by the cv input
+    ASSERT_EQ(EngineReturnStatus::OK, _module_under_test->connect_audio_input_channel(0, 1, track_id));
+    ASSERT_EQ(EngineReturnStatus::OK, _module_under_test->connect_audio_output_channel(0, 1, track_id));
+
+    ChunkSampleBuffer in_buffer(1);
+    ChunkSampleBuffer out_buffer(1);
+    ControlBuffer in_controls;
+    ControlBuffer out_controls;
+    test_utils::fill_sample_buffer(in_buffer, 1.0f);
+    float* cv_in = in_controls.cv_buffers.channel(0);
+    std::fill(cv_in, cv_in + AUDIO_CHUNK_SIZE, 0.25f);
+    _module_under_test->process_chunk(&in_buffer, &out_buffer, &in_controls, &out_controls, Time(0), 0);
+    EXPECT_FLOAT_EQ(0.25f, out_buffer.channel(0)[0]);
+}
+
+TEST_F(TestEngine, TestDeleteTrackWithCvConnections)
+{
+    auto [track_status, track_id] = _module_under_test->create_track("cv_track", 1);
+    ASSERT_EQ(EngineReturnStatus::OK, track_status);
+    ASSERT_EQ(EngineReturnStatus::OK, _module_under_test->set_cv_input_channels(1));
+    ASSERT_EQ(EngineReturnStatus::OK, _module_under_test->set_cv_output_channels(1));
+    ASSERT_EQ(EngineReturnStatus::OK, _module_under_test->connect_cv_to_track("cv_track", 0, 0));
+    ASSERT_EQ(EngineReturnStatus::OK, _module_under_test->connect_cv_from_track("cv_track", 0, 0));
+
+    ASSERT_EQ(EngineReturnStatus::OK, _module_under_test->delete_track(track_id));
+    EXPECT_TRUE(_module_under_test->_cv_in_track_connections.empty());
+    EXPECT_TRUE(_module_under_test->_cv_out_track_connections.empty());
+
+    // Processing must not touch the deleted track
+    ChunkSampleBuffer in_buffer(1);
+    ChunkSampleBuffer out_buffer(1);
+    ControlBuffer in_controls;
+    ControlBuffer out_controls;
+    _module_under_test->process_chunk(&in_buffer, &out_buffer, &in_controls, &out_controls, Time(0), 0);
+    EXPECT_FALSE(out_controls.audio_rate_cv[0]);
+}
+
 TEST_F(TestEngine, TestGateRouting)
 {
     /* Build a cv/gate to midi to cv/gate chain and verify gate changes travel through it*/
@@ -548,4 +687,119 @@ TEST_F(TestEngine, TestGateRouting)
     // A gate high event on gate input 1 should result in a gate high on gate output 0
     ASSERT_TRUE(out_controls.gate_values[0]);
     ASSERT_EQ(1u, out_controls.gate_values.count());
-}
\ No newline at end of file
+}
+
+TEST_F(TestEngine, TestBatchedEventDelivery)
+{
+    HostControlMockup host_control;
+    EventRecordingProcessor processor_1(host_control.make_host_control_mockup());
+    EventRecordingProcessor processor_2(host_control.make_host_control_mockup());
+    ASSERT_TRUE(_module_under_test->_insert_processor_in_realtime_part(&processor_1));
+    ASSERT_TRUE(_module_under_test->_insert_processor_in_realtime_part(&processor_2));
+
+    /* Interleave events to the 2 processors, and one to a non-existing processor */
+    for (int i = 0; i < 5; ++i)
+    {
+        _module_under_test->send_rt_event(RtEvent::make_parameter_change_event(processor_1.id(), 0, 0, i));
+        _module_under_test->send_rt_event(RtEvent::make_parameter_change_event(processor_2.id(), 0, 0, 10 + i));
+    }
+    _module_under_test->send_rt_event(RtEvent::make_parameter_change_event(MAX_RT_PROCESSOR_ID + 5, 0, 0, 1.0f));
+
+    ChunkSampleBuffer in_buffer(TEST_CHANNEL_COUNT);
+    ChunkSampleBuffer out_buffer(TEST_CHANNEL_COUNT);
+    ControlBuffer control_buffer;
+    _module_under_test->process_chunk(&in_buffer, &out_buffer, &control_buffer, &control_buffer, Time(0), 0);
+
+    /* Each processor should get all its events in one batch, in the order they were sent */
+    EXPECT_EQ(1, processor_1.batches);
+    EXPECT_EQ(1, processor_2.batches);
+    ASSERT_EQ(5u, processor_1.recorded_events.size());
+    ASSERT_EQ(5u, processor_2.recorded_events.size());
+    for (int i = 0; i < 5; ++i)
+    {
+        EXPECT_FLOAT_EQ(i, processor_1.recorded_events[i].parameter_change_event()->value());
+        EXPECT_FLOAT_EQ(10 + i, processor_2.recorded_events[i].parameter_change_event()->value());
+    }
+
+    /* Nothing is left in the batch for the next chunk */
+    _module_under_test->process_chunk(&in_buffer, &out_buffer, &control_buffer, &control_buffer, Time(0), 0);
+    EXPECT_EQ(1, processor_1.batches);
+    EXPECT_EQ(5u, processor_1.recorded_events.size());
+
+    _module_under_test->_remove_processor_from_realtime_part(processor_1.id());
+    _module_under_test->_remove_processor_from_realtime_part(processor_2.id());
+}
+
+TEST_F(TestEngine, TestXrunReporting)
+{
+    auto [status, track_id] = _module_under_test->create_track("test_track", 2);
+    ASSERT_EQ(EngineReturnStatus::OK, status);
+    PluginInfo plugin_info;
+    plugin_info.uid = "sushi.testing.gain";
+    plugin_info.path = "";
+    plugin_info.type = PluginType::INTERNAL;
+    auto [load_status, plugin_id] = _module_under_test->create_processor(plugin_info, "gain");
+    ASSERT_EQ(EngineReturnStatus::OK, load_status);
+    ASSERT_EQ(EngineReturnStatus::OK, _module_under_test->add_plugin_to_track(plugin_id, track_id));
+
+    ChunkSampleBuffer in_buffer(TEST_CHANNEL_COUNT);
+    ChunkSampleBuffer out_buffer(TEST_CHANNEL_COUNT);
+    ControlBuffer control_buffer;
+    auto& queue = _module_under_test->_main_out_queue;
+    auto pop_xrun_report = [&]() -> std::optional<performance::XrunReport>
+    {
+        RtEvent event;
+        std::optional<performance::XrunReport> report;
+        while (queue.pop(event))
+        {
+            if (event.type() == RtEventType::XRUN_NOTIFICATION)
+            {
+                auto slot = event.xrun_notification_event()->report_slot();
+                report = slot->report;
+                slot->release();
+            }
+        }
+        return report;
+    };
+
+    _module_under_test->process_chunk(&in_buffer, &out_buffer, &control_buffer, &control_buffer, Time(0), 0);
+    EXPECT_FALSE(pop_xrun_report().has_value());
+
+    /* Shrink the chunk period to a few nanoseconds so that processing overruns it */
+    auto monitor = _module_under_test->xrun_monitor();
+    monitor->set_timing_period(1'000'000'000.0f, 1);
+    _module_under_test->process_chunk(&in_buffer, &out_buffer, &control_buffer, &control_buffer, Time(0), 0);
+    auto report = pop_xrun_report();
+    ASSERT_TRUE(report.has_value());
+    EXPECT_EQ(performance::XrunSource::ENGINE_OVERRUN, report->source);
+    EXPECT_GT(report->chunk_load, 1.0f);
+    /* Processors are only timed when timings are enabled */
+    ASSERT_EQ(1, report->node_count);
+    EXPECT_EQ(track_id, static_cast<int>(report->slowest_nodes[0].id));
+
+    _module_under_test->performance_timer()->enable(true);
+    _module_under_test->process_chunk(&in_buffer, &out_buffer, &control_buffer, &control_buffer, Time(0), 0);
+    _module_under_test->performance_timer()->enable(false);
+    report = pop_xrun_report();
+    ASSERT_TRUE(report.has_value());
+    ASSERT_EQ(2, report->node_count);
+    /* The track time includes its processors, so the track comes first */
+    EXPECT_EQ(track_id, static_cast<int>(report->slowest_nodes[0].id));
+    EXPECT_EQ(plugin_id, static_cast<int>(report->slowest_nodes[1].id));
+    EXPECT_GE(report->slowest_nodes[0].load, report->slowest_nodes[1].load);
+
+    /* Xruns reported by the frontend are attributed to the next chunk */
+    monitor->set_timing_period(SAMPLE_RATE, AUDIO_CHUNK_SIZE);
+    monitor->report_frontend_xrun();
+    _module_under_test->process_chunk(&in_buffer, &out_buffer, &control_buffer, &control_buffer, Time(0), 0);
+    report = pop_xrun_report();
+    ASSERT_TRUE(report.has_value());
+    EXPECT_EQ(performance::XrunSource::AUDIO_FRONTEND, report->source);
+    EXPECT_EQ(1, report->node_count);
+
+    auto counts = monitor->counts();
+    EXPECT_EQ(2, counts.engine_overruns);
+    EXPECT_EQ(1, counts.frontend_xruns);
+    monitor->reset_counts();
+    EXPECT_EQ(0, monitor->counts().engine_overruns);
+}
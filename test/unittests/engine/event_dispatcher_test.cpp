@@ -14,6 +14,8 @@ constexpr int DUMMY_POSTER_ID = 1;
 constexpr int DUMMY_STATUS = 100;
 constexpr float TEST_SAMPLE_RATE = 44100.0;
 constexpr auto EVENT_PROCESS_WAIT_TIME = std::chrono::milliseconds(1);
+// Long enough for the event loop never to flush by itself during a test
+constexpr auto NOTIFICATION_INTERVAL = std::chrono::seconds(10);
 
 bool completed = false;
 int completion_status = 0;
@@ -55,6 +57,21 @@ private:
     bool _received{false};
 };
 
+class NotificationRecordingPoster : public EventPoster
+{
+public:
+    int process(Event* event) override
+    {
+        auto typed_event = static_cast<ParameterChangeNotificationEvent*>(event);
+        _notifications.emplace_back(typed_event->parameter_id(), typed_event->float_value());
+        return EventStatus::HANDLED_OK;
+    };
+
+    int poster_id() override {return DUMMY_POSTER_ID;}
+
+    std::vector<std::pair<ObjectId, float>> _notifications;
+};
+
 class TestEventDispatcher : public ::testing::Test
 {
 public:
@@ -172,6 +189,64 @@ TEST_F(TestEventDispatcher, TestFromRtEventParameterChangeNotification)
     ASSERT_TRUE(_poster.event_received());
 }
 
+TEST_F(TestEventDispatcher, TestAggregatedParameterChangeNotifications)
+{
+    NotificationRecordingPoster rate_limited_poster;
+    NotificationRecordingPoster unlimited_poster;
+    _module_under_test->subscribe_to_parameter_change_notifications(&rate_limited_poster, NOTIFICATION_INTERVAL);
+    _module_under_test->subscribe_to_parameter_change_notifications(&unlimited_poster);
+
+    _in_rt_queue.push(RtEvent::make_parameter_change_event(10, 0, 1, 0.1f));
+    _in_rt_queue.push(RtEvent::make_parameter_change_event(10, 0, 2, 0.2f));
+    _in_rt_queue.push(RtEvent::make_parameter_change_event(10, 0, 1, 0.3f));
+    _in_rt_queue.push(RtEvent::make_parameter_change_event(10, 0, 1, 0.4f));
+    crank_event_loop_once();
+
+    // The unlimited listener gets every notification, the other none until the interval has passed
+    EXPECT_EQ(4u, unlimited_poster._notifications.size());
+    EXPECT_TRUE(rate_limited_poster._notifications.empty());
+
+    auto flush_time = std::chrono::system_clock::now() + NOTIFICATION_INTERVAL;
+    _module_under_test->_flush_parameter_notifications(flush_time);
+
+    // Only the latest value of each parameter is delivered, in order of first change
+    ASSERT_EQ(2u, rate_limited_poster._notifications.size());
+    EXPECT_EQ(1u, rate_limited_poster._notifications[0].first);
+    EXPECT_FLOAT_EQ(0.4f, rate_limited_poster._notifications[0].second);
+    EXPECT_EQ(2u, rate_limited_poster._notifications[1].first);
+    EXPECT_FLOAT_EQ(0.2f, rate_limited_poster._notifications[1].second);
+
+    // Nothing is sent again if no parameters changed
+    _module_under_test->_flush_parameter_notifications(flush_time + NOTIFICATION_INTERVAL);
+    EXPECT_EQ(2u, rate_limited_poster._notifications.size());
+}
+
+TEST_F(TestEventDispatcher, TestAggregatedNotificationsFromDeletedProcessor)
+{
+    NotificationRecordingPoster rate_limited_poster;
+    _module_under_test->subscribe_to_parameter_change_notifications(&rate_limited_poster, NOTIFICATION_INTERVAL);
+    auto& aggregator = *_module_under_test->_parameter_change_listeners.front().aggregator;
+
+    _in_rt_queue.push(RtEvent::make_parameter_change_event(10, 0, 1, 0.1f));
+    _in_rt_queue.push(RtEvent::make_parameter_change_event(11, 0, 2, 0.2f));
+    _in_rt_queue.push(RtEvent::make_parameter_change_event(12, 0, 3, 0.3f));
+    crank_event_loop_once();
+    EXPECT_EQ(3u, aggregator._entries.size());
+
+    // Notifications from deleted processors and tracks are dropped and their entries erased
+    _module_under_test->post_event(new AudioGraphNotificationEvent(AudioGraphNotificationEvent::Action::PROCESSOR_DELETED,
+                                                                   10, 0, IMMEDIATE_PROCESS));
+    _module_under_test->post_event(new AudioGraphNotificationEvent(AudioGraphNotificationEvent::Action::TRACK_DELETED,
+                                                                   0, 12, IMMEDIATE_PROCESS));
+    crank_event_loop_once();
+    EXPECT_EQ(1u, aggregator._entries.size());
+
+    _module_under_test->_flush_parameter_notifications(std::chrono::system_clock::now() + NOTIFICATION_INTERVAL);
+    ASSERT_EQ(1u, rate_limited_poster._notifications.size());
+    EXPECT_EQ(2u, rate_limited_poster._notifications[0].first);
+    EXPECT_FLOAT_EQ(0.2f, rate_limited_poster._notifications[0].second);
+}
+
 TEST_F(TestEventDispatcher, TestEngineNotificationForwarding)
 {
     auto event = new AudioGraphNotificationEvent(AudioGraphNotificationEvent::Action::PROCESSOR_ADDED_TO_TRACK,
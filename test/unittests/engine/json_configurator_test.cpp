@@ -48,7 +48,7 @@ protected:
     JsonConfigReturnStatus _make_track(const rapidjson::Value &track);
 
     AudioEngine _engine{SAMPLE_RATE};
-    MidiDispatcher _midi_dispatcher{_engine.event_dispatcher()};
+    MidiDispatcher _midi_dispatcher{_engine.event_dispatcher(), _engine.metrics()};
 
     sushi::ext::ControlMockup _controller;
 
@@ -66,12 +66,29 @@ TEST_F(TestJsonConfigurator, TestLoadAudioConfig)
 {
     auto [status, audio_config] = _module_under_test->load_audio_config();
     ASSERT_EQ(JsonConfigReturnStatus::OK, status);
+    ASSERT_TRUE(audio_config.audio_inputs.has_value());
+    ASSERT_EQ(8, audio_config.audio_inputs.value());
+    ASSERT_TRUE(audio_config.audio_outputs.has_value());
+    ASSERT_EQ(8, audio_config.audio_outputs.value());
     ASSERT_TRUE(audio_config.cv_inputs.has_value());
     ASSERT_EQ(1, audio_config.cv_inputs.value());
     ASSERT_TRUE(audio_config.cv_outputs.has_value());
     ASSERT_EQ(2, audio_config.cv_outputs.value());
 }
 
+TEST_F(TestJsonConfigurator, TestCopyConfiguration)
+{
+    auto status = _module_under_test->load_host_config();
+    ASSERT_EQ(JsonConfigReturnStatus::OK, status);
+
+    /* The copy should not need to read the file */
+    JsonConfigurator copy(&_engine, &_midi_dispatcher, _engine.processor_container(), "not_a_valid_file.json");
+    copy.copy_configuration(*_module_under_test);
+    auto [audio_status, audio_config] = copy.load_audio_config();
+    ASSERT_EQ(JsonConfigReturnStatus::OK, audio_status);
+    ASSERT_EQ(1, audio_config.cv_inputs.value_or(0));
+}
+
 TEST_F(TestJsonConfigurator, TestLoadHostConfig)
 {
     auto status = _module_under_test->load_host_config();
@@ -364,6 +381,12 @@ TEST_F(TestJsonConfigurator, TestCvGateSchema)
     ASSERT_FALSE(_module_under_test->_validate_against_schema(mutable_cfg, JsonSection::CV_GATE));
     cv_in["processor"] = "synth";
 
+    rapidjson::Value& cv_out = mutable_cfg["cv_control"]["cv_outputs"][1];
+    ASSERT_TRUE(_module_under_test->_validate_against_schema(mutable_cfg, JsonSection::CV_GATE));
+    cv_out.RemoveMember("channel");
+    ASSERT_FALSE(_module_under_test->_validate_against_schema(mutable_cfg, JsonSection::CV_GATE));
+    cv_out.AddMember("channel", 0, mutable_cfg.GetAllocator());
+
     rapidjson::Value& gate_out = mutable_cfg["cv_control"]["gate_outputs"][0];
     gate_out["mode"] = "sync__";
     ASSERT_FALSE(_module_under_test->_validate_against_schema(mutable_cfg,JsonSection::CV_GATE));
@@ -128,7 +128,7 @@ protected:
     EngineMockup _test_engine{48000};
     EventDispatcherMockup _test_dispatcher;
     DummyMidiFrontend _test_frontend;
-    MidiDispatcher _module_under_test{&_test_dispatcher};
+    MidiDispatcher _module_under_test{&_test_dispatcher, _test_engine.metrics()};
 };
 
 TEST_F(TestMidiDispatcher, TestKeyboardDataConnection)
@@ -187,6 +187,39 @@ TEST_F(TestMidiDispatcher, TestKeyboardDataConnection)
     EXPECT_TRUE(input_connections.size() == 0);
 }
 
+TEST_F(TestMidiDispatcher, TestRtInputPath)
+{
+    auto track_1 = _test_engine.processor_container()->track("track 1");
+    ObjectId track_id_1 = track_1->id();
+    RtInputQueue rt_queue(48000.0f);
+
+    _module_under_test.set_midi_inputs(5);
+    _module_under_test.connect_kb_to_track(1, track_id_1);
+    _module_under_test.connect_pc_to_processor(1, 40);
+    _module_under_test.set_rt_input_queue(&rt_queue);
+
+    /* Keyboard data should bypass the event dispatcher */
+    _module_under_test.send_midi(1, TEST_NOTE_ON_CH2, IMMEDIATE_PROCESS);
+    EXPECT_FALSE(_test_dispatcher.got_event());
+    RtEvent event;
+    ASSERT_TRUE(rt_queue.pop(event));
+    EXPECT_EQ(RtEventType::NOTE_ON, event.type());
+    EXPECT_EQ(track_id_1, event.processor_id());
+    EXPECT_EQ(0, event.sample_offset());
+    EXPECT_EQ(62, event.keyboard_event()->note());
+    EXPECT_FALSE(rt_queue.pop(event));
+
+    /* Program changes are not handled in the rt thread and still go through the dispatcher */
+    _module_under_test.send_midi(1, TEST_PRG_CH_CH5, IMMEDIATE_PROCESS);
+    EXPECT_TRUE(_test_dispatcher.got_event());
+    EXPECT_FALSE(rt_queue.pop(event));
+
+    _module_under_test.set_rt_input_queue(nullptr);
+    _module_under_test.send_midi(1, TEST_NOTE_ON_CH2, IMMEDIATE_PROCESS);
+    EXPECT_TRUE(_test_dispatcher.got_event());
+    EXPECT_FALSE(rt_queue.pop(event));
+}
+
 TEST_F(TestMidiDispatcher, TestKeyboardDataOutConnection)
 {
     auto track = _test_engine.processor_container()->track("track 1");
@@ -393,6 +426,37 @@ TEST_F(TestMidiDispatcher, TestCCDataConnection)
     EXPECT_TRUE(_test_dispatcher.got_event());
 }
 
+TEST_F(TestMidiDispatcher, TestRelativeCCConnection)
+{
+    RtInputQueue rt_queue(48000.0f);
+    _module_under_test.set_midi_inputs(5);
+    _module_under_test.set_rt_input_queue(&rt_queue);
+    _module_under_test.connect_cc_to_parameter(1, 40, 41, 67, 0, 127, true, midi::MidiChannel::OMNI);
+    _module_under_test.connect_cc_to_parameter(1, 42, 43, 67, 0, 127, true, midi::MidiChannel::OMNI);
+
+    /* Both connections should follow the same virtual absolute value, starting from 64 */
+    RtEvent event;
+    _module_under_test.send_midi(1, {0xB3, 67, 5, 0}, IMMEDIATE_PROCESS);
+    for (auto processor : {40u, 42u})
+    {
+        ASSERT_TRUE(rt_queue.pop(event));
+        EXPECT_EQ(processor, event.processor_id());
+        EXPECT_FLOAT_EQ(69.0f, event.parameter_change_event()->value());
+    }
+
+    /* A route edit should not reset relative controllers */
+    _module_under_test.disconnect_cc_from_parameter(1, 42, 67);
+    _module_under_test.send_midi(1, {0xB3, 67, 126, 0}, IMMEDIATE_PROCESS);
+    ASSERT_TRUE(rt_queue.pop(event));
+    EXPECT_EQ(40u, event.processor_id());
+    EXPECT_FLOAT_EQ(67.0f, event.parameter_change_event()->value());
+    EXPECT_FALSE(rt_queue.pop(event));
+
+    /* Controller numbers outside of the routable range should be ignored */
+    _module_under_test.send_midi(1, {0xB3, 121, 0, 0}, IMMEDIATE_PROCESS);
+    EXPECT_FALSE(rt_queue.pop(event));
+}
+
 TEST_F(TestMidiDispatcher, TestProgramChangeConnection)
 {
     auto processor = _test_engine.processor_container()->processor("processor");
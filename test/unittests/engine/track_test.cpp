@@ -129,6 +129,38 @@ TEST_F(TrackTest, TestRenderingWithProcessors)
     test_utils::assert_buffer_value(1.0f, out, test_utils::DECIBEL_ERROR);
 }
 
+TEST_F(TrackTest, TestSampledProcessorTimings)
+{
+    passthrough_plugin::PassthroughPlugin plugin_1(_host_control.make_host_control_mockup());
+    passthrough_plugin::PassthroughPlugin plugin_2(_host_control.make_host_control_mockup());
+    plugin_1.init(TEST_SAMPLE_RATE);
+    plugin_2.init(TEST_SAMPLE_RATE);
+    _module_under_test.add(&plugin_1);
+    _module_under_test.add(&plugin_2);
+
+    _timer.set_timing_period(TEST_SAMPLE_RATE, AUDIO_CHUNK_SIZE);
+    _timer.set_processor_sampling_interval(4);
+    _timer.enable(true);
+    _module_under_test.render();
+    _timer.enable(false);
+
+    /* Only the first processor is timed in the first chunk, the track always is */
+    EXPECT_TRUE(_timer.timings_for_node(_module_under_test.id()).has_value());
+    EXPECT_TRUE(_timer.timings_for_node(plugin_1.id()).has_value());
+    EXPECT_FALSE(_timer.timings_for_node(plugin_2.id()).has_value());
+    /* Processors not timed in a chunk are not in its render profile either */
+    EXPECT_NE(plugin_2.id(), _module_under_test.last_render_profile().slowest_processor);
+
+    /* The second processor is timed 3 chunks later */
+    _timer.enable(true);
+    for (int i = 0; i < 3; ++i)
+    {
+        _module_under_test.render();
+    }
+    _timer.enable(false);
+    EXPECT_TRUE(_timer.timings_for_node(plugin_2.id()).has_value());
+}
+
 TEST_F(TrackTest, TestPanAndGain)
 {
     passthrough_plugin::PassthroughPlugin plugin(_host_control.make_host_control_mockup());
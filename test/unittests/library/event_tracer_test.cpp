@@ -0,0 +1,160 @@
+#include <thread>
+
+#include "gtest/gtest.h"
+
+#define private public
+
+#include "library/event_tracer.cpp"
+
+using namespace sushi;
+using namespace sushi::performance;
+
+class TestEventTracer : public ::testing::Test
+{
+protected:
+    TestEventTracer() {}
+
+    void SetUp()
+    {
+        _module_under_test.enable(true);
+    }
+
+    void TearDown()
+    {
+        EventTracer::set_thread_source(TraceSource::NONE);
+    }
+
+    int slot_state(uint16_t trace_id)
+    {
+        return _module_under_test._state(_module_under_test._slots[_module_under_test._index(trace_id)].state.load());
+    }
+
+    MetricsRegistry _registry;
+    MetricsScope _metrics{_registry, ""};
+    EventTracer _module_under_test{_metrics};
+};
+
+TEST_F(TestEventTracer, TestDisabled)
+{
+    EventTracer::set_thread_source(TraceSource::MIDI, Time(1000));
+    _module_under_test.enable(false);
+    EXPECT_EQ(0, _module_under_test.begin_trace());
+    _module_under_test.enable(true);
+    EXPECT_NE(0, _module_under_test.begin_trace());
+}
+
+TEST_F(TestEventTracer, TestNoSource)
+{
+    EXPECT_EQ(0, _module_under_test.begin_trace());
+    {
+        ScopedTraceSource source(TraceSource::GRPC);
+        EXPECT_NE(0, _module_under_test.begin_trace());
+    }
+    EXPECT_EQ(0, _module_under_test.begin_trace());
+}
+
+TEST_F(TestEventTracer, TestLatencies)
+{
+    EventTracer::set_thread_source(TraceSource::MIDI, Time(1000));
+    auto id = _module_under_test.begin_trace();
+    ASSERT_NE(0, id);
+    _module_under_test.mark_dispatched(id, Time(3000));
+    _module_under_test.mark_delivered(id, Time(6000));
+    _module_under_test.collect();
+
+    auto dispatch = _module_under_test.latency(TraceSource::MIDI, TraceSegment::DISPATCH);
+    auto delivery = _module_under_test.latency(TraceSource::MIDI, TraceSegment::DELIVERY);
+    auto total = _module_under_test.latency(TraceSource::MIDI, TraceSegment::TOTAL);
+    EXPECT_FLOAT_EQ(2.0f, dispatch.max);
+    EXPECT_FLOAT_EQ(3.0f, delivery.max);
+    EXPECT_FLOAT_EQ(5.0f, total.max);
+    EXPECT_EQ(0.0f, _module_under_test.latency(TraceSource::OSC, TraceSegment::TOTAL).max);
+
+    /* The slot should be free to use again */
+    EXPECT_EQ(_module_under_test.FREE, slot_state(id));
+
+    _module_under_test.clear_latencies();
+    EXPECT_EQ(0.0f, _module_under_test.latency(TraceSource::MIDI, TraceSegment::TOTAL).max);
+}
+
+TEST_F(TestEventTracer, TestDeliveredOnlyOnce)
+{
+    EventTracer::set_thread_source(TraceSource::OSC, Time(1000));
+    auto id = _module_under_test.begin_trace();
+    _module_under_test.mark_delivered(id, Time(2000));
+    _module_under_test.mark_delivered(id, Time(9000));
+    _module_under_test.collect();
+    EXPECT_FLOAT_EQ(1.0f, _module_under_test.latency(TraceSource::OSC, TraceSegment::TOTAL).max);
+
+    /* Invalid ids are ignored */
+    _module_under_test.mark_delivered(0, Time(2000));
+    _module_under_test.mark_delivered(MAX_TRACED_EVENTS + 1, Time(2000));
+}
+
+TEST_F(TestEventTracer, TestFullTable)
+{
+    EventTracer::set_thread_source(TraceSource::GRPC, Time(1000));
+    for (int i = 0; i < MAX_TRACED_EVENTS; ++i)
+    {
+        ASSERT_NE(0, _module_under_test.begin_trace());
+    }
+    EXPECT_EQ(0, _module_under_test.begin_trace());
+}
+
+TEST_F(TestEventTracer, TestStaleTracesReleased)
+{
+    EventTracer::set_thread_source(TraceSource::GRPC, Time(1000));
+    auto id = _module_under_test.begin_trace();
+    _module_under_test._release_stale_traces(Time(1000) + STALE_TRACE_TIME / 2);
+    EXPECT_EQ(_module_under_test.ACTIVE, slot_state(id));
+    _module_under_test._release_stale_traces(Time(1000) + STALE_TRACE_TIME * 2);
+    EXPECT_EQ(_module_under_test.FREE, slot_state(id));
+}
+
+TEST_F(TestEventTracer, TestLateDeliveryOfReleasedTrace)
+{
+    EventTracer::set_thread_source(TraceSource::GRPC, Time(1000));
+    auto stale_id = _module_under_test.begin_trace();
+    ASSERT_NE(0, stale_id);
+    _module_under_test._release_stale_traces(Time(1000) + STALE_TRACE_TIME * 2);
+
+    /* Claim the same slot again for a new trace */
+    _module_under_test._next_slot = _module_under_test._index(stale_id);
+    EventTracer::set_thread_source(TraceSource::GRPC, Time(5000));
+    auto id = _module_under_test.begin_trace();
+    ASSERT_NE(0, id);
+    EXPECT_EQ(_module_under_test._index(stale_id), _module_under_test._index(id));
+    EXPECT_NE(stale_id, id);
+
+    /* The event from the released trace shows up late and must not complete the new one */
+    _module_under_test.mark_dispatched(stale_id, Time(6000));
+    _module_under_test.mark_delivered(stale_id, Time(90000));
+    EXPECT_EQ(_module_under_test.ACTIVE, slot_state(id));
+
+    _module_under_test.mark_delivered(id, Time(7000));
+    _module_under_test.collect();
+    EXPECT_FLOAT_EQ(2.0f, _module_under_test.latency(TraceSource::GRPC, TraceSegment::TOTAL).max);
+}
+
+TEST_F(TestEventTracer, TestGenerationWraps)
+{
+    EventTracer::set_thread_source(TraceSource::MIDI, Time(1000));
+    for (int i = 0; i < 100; ++i)
+    {
+        _module_under_test._next_slot = 5;
+        auto id = _module_under_test.begin_trace();
+        ASSERT_NE(0, id);
+        EXPECT_EQ(5, _module_under_test._index(id));
+        _module_under_test.mark_delivered(id, Time(2000));
+        _module_under_test.collect();
+        EXPECT_EQ(_module_under_test.FREE, slot_state(id));
+    }
+}
+
+TEST_F(TestEventTracer, TestImmediateArrival)
+{
+    EventTracer::set_thread_source(TraceSource::MIDI, IMMEDIATE_PROCESS);
+    auto before = get_current_time();
+    auto id = _module_under_test.begin_trace();
+    EXPECT_GE(_module_under_test._slots[_module_under_test._index(id)].arrival, before);
+}
@@ -0,0 +1,208 @@
+#include <fstream>
+#include <sstream>
+
+#include "gtest/gtest.h"
+
+#define private public
+
+#include "library/metrics.cpp"
+#include "library/metrics_exporter.cpp"
+
+using namespace sushi;
+using namespace sushi::performance;
+
+class TestMetricsRegistry : public ::testing::Test
+{
+protected:
+    TestMetricsRegistry() {}
+
+    MetricsRegistry _module_under_test;
+};
+
+TEST_F(TestMetricsRegistry, TestCounterAndGauge)
+{
+    auto counter = _module_under_test.counter("test_counter_total", "A counter");
+    counter->increment();
+    counter->increment(4);
+    EXPECT_EQ(5u, counter->value());
+    /* The same name returns the same counter */
+    EXPECT_EQ(counter, _module_under_test.counter("test_counter_total", "A counter"));
+
+    auto gauge = _module_under_test.gauge("test_gauge", "A gauge");
+    gauge->set(2.5);
+    gauge->add(-1.0);
+    EXPECT_DOUBLE_EQ(1.5, gauge->value());
+}
+
+TEST_F(TestMetricsRegistry, TestHistogram)
+{
+    auto histogram = _module_under_test.histogram("test_histogram", "A histogram", {1.0, 2.0});
+    histogram->observe(0.5);
+    histogram->observe(1.0);
+    histogram->observe(1.5);
+    histogram->observe(10);
+
+    EXPECT_EQ(2u, histogram->bucket_count(0));
+    EXPECT_EQ(1u, histogram->bucket_count(1));
+    EXPECT_EQ(1u, histogram->bucket_count(2));
+    EXPECT_EQ(4u, histogram->count());
+    EXPECT_DOUBLE_EQ(13.0, histogram->sum());
+}
+
+TEST_F(TestMetricsRegistry, TestPrometheusFormat)
+{
+    _module_under_test.counter("test_dropped_total{queue=\"in\"}", "Dropped events")->increment(2);
+    _module_under_test.gauge("test_load", "Load")->set(0.25);
+    _module_under_test.counter("test_dropped_total{queue=\"out\"}", "Dropped events")->increment(3);
+    _module_under_test.histogram("test_time", "Time", {0.5})->observe(1);
+
+    auto text = _module_under_test.prometheus_text();
+    EXPECT_EQ("# HELP test_dropped_total Dropped events\n"
+              "# TYPE test_dropped_total counter\n"
+              "test_dropped_total{queue=\"in\"} 2\n"
+              "test_dropped_total{queue=\"out\"} 3\n"
+              "# HELP test_load Load\n"
+              "# TYPE test_load gauge\n"
+              "test_load 0.25\n"
+              "# HELP test_time Time\n"
+              "# TYPE test_time histogram\n"
+              "test_time_bucket{le=\"0.5\"} 0\n"
+              "test_time_bucket{le=\"+Inf\"} 1\n"
+              "test_time_sum 1\n"
+              "test_time_count 1\n", text);
+}
+
+TEST_F(TestMetricsRegistry, TestScopeLabels)
+{
+    EXPECT_EQ("test_total", MetricsScope::add_labels("test_total", ""));
+    EXPECT_EQ("test_total{engine=\"0\"}", MetricsScope::add_labels("test_total", "engine=\"0\""));
+    EXPECT_EQ("test_total{engine=\"0\",queue=\"in\"}", MetricsScope::add_labels("test_total{queue=\"in\"}", "engine=\"0\""));
+
+    /* Metrics with the same name in different scopes are kept apart */
+    MetricsScope first(_module_under_test, "engine=\"0\"");
+    MetricsScope second(_module_under_test, "engine=\"1\"");
+    first.counter("test_chunks_total", "Chunks")->increment(2);
+    second.counter("test_chunks_total", "Chunks")->increment(5);
+    EXPECT_NE(first.counter("test_chunks_total", "Chunks"), second.counter("test_chunks_total", "Chunks"));
+    first.histogram("test_time", "Time", {0.5})->observe(1);
+
+    auto text = _module_under_test.prometheus_text();
+    EXPECT_EQ("# HELP test_chunks_total Chunks\n"
+              "# TYPE test_chunks_total counter\n"
+              "test_chunks_total{engine=\"0\"} 2\n"
+              "test_chunks_total{engine=\"1\"} 5\n"
+              "# HELP test_time Time\n"
+              "# TYPE test_time histogram\n"
+              "test_time_bucket{engine=\"0\",le=\"0.5\"} 0\n"
+              "test_time_bucket{engine=\"0\",le=\"+Inf\"} 1\n"
+              "test_time_sum{engine=\"0\"} 1\n"
+              "test_time_count{engine=\"0\"} 1\n", text);
+}
+
+TEST_F(TestMetricsRegistry, TestRemoveScope)
+{
+    MetricsScope first(_module_under_test, "engine=\"1\"");
+    MetricsScope second(_module_under_test, "engine=\"10\"");
+    first.counter("test_chunks_total", "Chunks");
+    first.gauge("test_load{queue=\"in\"}", "Load");
+    second.counter("test_chunks_total", "Chunks")->increment(3);
+    _module_under_test.counter("test_unlabelled_total", "Unlabelled");
+
+    first.remove_all();
+    EXPECT_EQ(2u, _module_under_test._metrics.size());
+    EXPECT_EQ("# HELP test_chunks_total Chunks\n"
+              "# TYPE test_chunks_total counter\n"
+              "test_chunks_total{engine=\"10\"} 3\n"
+              "# HELP test_unlabelled_total Unlabelled\n"
+              "# TYPE test_unlabelled_total counter\n"
+              "test_unlabelled_total 0\n", _module_under_test.prometheus_text());
+}
+
+int connect_to_socket(const std::string& socket_path)
+{
+    int client = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, socket_path.c_str(), sizeof(address.sun_path) - 1);
+    if (client >= 0 && connect(client, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0)
+    {
+        close(client);
+        return -1;
+    }
+    return client;
+}
+
+/* Enough metrics to fill the socket buffers of a client that doesn't read */
+void add_many_metrics(MetricsRegistry& registry)
+{
+    std::string long_label(200, 'x');
+    for (int i = 0; i < 4000; ++i)
+    {
+        registry.counter("test_counter_with_a_long_name_total{label=\"" + long_label + "\",index=\"" +
+                         std::to_string(i) + "\"}", "A counter");
+    }
+}
+
+TEST_F(TestMetricsRegistry, TestSocketClient)
+{
+    add_many_metrics(_module_under_test);
+    std::string socket_path = "test_metrics.sock";
+    MetricsExporter exporter(_module_under_test);
+    ASSERT_TRUE(exporter.set_socket(socket_path));
+    int client = connect_to_socket(socket_path);
+    ASSERT_GE(client, 0);
+
+    /* A client reading slower than the text is written still gets all of it */
+    std::string received;
+    std::thread reader([&]()
+    {
+        char buffer[4096];
+        ssize_t bytes;
+        while ((bytes = recv(client, buffer, sizeof(buffer), 0)) > 0)
+        {
+            received.append(buffer, bytes);
+        }
+    });
+    exporter._serve_socket(std::chrono::milliseconds(100));
+    reader.join();
+    close(client);
+    EXPECT_EQ(_module_under_test.prometheus_text(), received);
+}
+
+TEST_F(TestMetricsRegistry, TestSlowSocketClient)
+{
+    add_many_metrics(_module_under_test);
+    std::string socket_path = "test_metrics.sock";
+    MetricsExporter exporter(_module_under_test);
+    ASSERT_TRUE(exporter.set_socket(socket_path));
+    int client = connect_to_socket(socket_path);
+    ASSERT_GE(client, 0);
+
+    /* Serving a client that doesn't read must give up after the send timeout */
+    auto start = std::chrono::steady_clock::now();
+    exporter._serve_socket(std::chrono::milliseconds(100));
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(1));
+
+    /* The client gets the beginning of the text before the connection is closed */
+    char buffer[64]{};
+    EXPECT_GT(recv(client, buffer, sizeof(buffer) - 1, 0), 0);
+    EXPECT_EQ(0, std::string(buffer).find("# HELP test_counter_with_a_long_name_total"));
+    close(client);
+}
+
+TEST_F(TestMetricsRegistry, TestExportToFile)
+{
+    _module_under_test.counter("test_counter_total", "A counter")->increment();
+    std::string filename = "test_metrics.prom";
+
+    MetricsExporter exporter(_module_under_test);
+    EXPECT_FALSE(exporter.write_file());
+    exporter.set_file(filename);
+    ASSERT_TRUE(exporter.write_file());
+
+    std::ifstream file(filename);
+    std::stringstream contents;
+    contents << file.rdbuf();
+    EXPECT_EQ(_module_under_test.prometheus_text(), contents.str());
+    std::remove(filename.c_str());
+}
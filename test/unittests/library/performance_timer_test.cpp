@@ -1,9 +1,13 @@
+#include <sstream>
+
 #include "gtest/gtest.h"
 
 #define private public
 #define protected public
 
 #include "library/performance_timer.cpp"
+#include "library/trace_recorder.cpp"
+#include "library/xrun_monitor.h"
 
 using namespace sushi;
 using namespace sushi::performance;
@@ -103,3 +107,328 @@ TEST_F(TestPerformanceTimer, TestClearRecords)
     ASSERT_FLOAT_EQ(100.0f, t.min_case);
     ASSERT_FLOAT_EQ(0.0f, t.max_case);
 }
+
+TEST_F(TestPerformanceTimer, TestCollectAndDroppedTimings)
+{
+    /* Collecting in between keeps the queue from overflowing */
+    for (int i = 0; i < MAX_LOG_ENTRIES; ++i)
+    {
+        auto start = _module_under_test.start_timer();
+        _module_under_test.stop_timer(start, 1);
+        if (i % 1000 == 0)
+        {
+            _module_under_test.collect_timings();
+        }
+    }
+    EXPECT_EQ(0u, _module_under_test.dropped_timings());
+    _module_under_test._update_timings();
+    EXPECT_EQ(static_cast<uint64_t>(MAX_LOG_ENTRIES), _module_under_test._timings[1].since_reset.count());
+
+    /* Without collecting, entries that don't fit are counted */
+    for (int i = 0; i < MAX_LOG_ENTRIES + 10; ++i)
+    {
+        auto start = _module_under_test.start_timer();
+        _module_under_test.stop_timer(start, 1);
+    }
+    EXPECT_LE(10u, _module_under_test.dropped_timings());
+    _module_under_test._update_timings();
+    EXPECT_EQ(2 * static_cast<uint64_t>(MAX_LOG_ENTRIES) + 10 - _module_under_test.dropped_timings(),
+              _module_under_test._timings[1].since_reset.count());
+}
+
+TEST_F(TestPerformanceTimer, TestPercentiles)
+{
+    // 1000 timings of 10% of the period and 5 spikes of 150%
+    for (int i = 0; i < 1000; ++i)
+    {
+        auto start = _module_under_test.start_timer();
+        _module_under_test.stop_timer(virtual_wait(start, 1), 3);
+    }
+    for (int i = 0; i < 5; ++i)
+    {
+        auto start = _module_under_test.start_timer();
+        _module_under_test.stop_timer(virtual_wait(start, 15), 3);
+    }
+    _module_under_test._update_timings();
+
+    auto timings = _module_under_test.timings_for_node(3);
+    ASSERT_TRUE(timings.has_value());
+    auto recent = timings.value().recent;
+    EXPECT_NEAR(0.1f, recent.p50, 0.01f);
+    EXPECT_NEAR(0.1f, recent.p99, 0.01f);
+    EXPECT_NEAR(1.5f, recent.p99_9, 0.15f);
+    EXPECT_NEAR(1.5f, recent.max, 0.01f);
+    EXPECT_FLOAT_EQ(recent.p99_9, timings.value().since_reset.p99_9);
+
+    // The spikes should leave the rolling window but not the totals since reset
+    for (int i = 0; i < ROLLING_WINDOW_INTERVALS; ++i)
+    {
+        _module_under_test._update_timings();
+    }
+    timings = _module_under_test.timings_for_node(3);
+    EXPECT_FLOAT_EQ(0.0f, timings.value().recent.max);
+    EXPECT_NEAR(1.5f, timings.value().since_reset.max, 0.01f);
+
+    ASSERT_TRUE(_module_under_test.clear_timings_for_node(3));
+    timings = _module_under_test.timings_for_node(3);
+    EXPECT_FLOAT_EQ(0.0f, timings.value().since_reset.max);
+}
+
+TEST(TestLatencyHistogram, TestPercentileEstimates)
+{
+    LatencyHistogram histogram;
+    EXPECT_FLOAT_EQ(0.0f, histogram.percentile(0.5f));
+    for (int i = 1; i <= 100; ++i)
+    {
+        histogram.add(i * 0.01f);
+    }
+    EXPECT_EQ(100u, histogram.count());
+    EXPECT_FLOAT_EQ(1.0f, histogram.max());
+    // Estimates are bucket upper edges, so never below the true value and within one bucket
+    EXPECT_GE(histogram.percentile(0.5f), 0.5f);
+    EXPECT_LE(histogram.percentile(0.5f), 0.5f * 1.1f);
+    EXPECT_GE(histogram.percentile(0.9f), 0.9f);
+    EXPECT_LE(histogram.percentile(0.9f), 0.9f * 1.1f);
+    EXPECT_FLOAT_EQ(1.0f, histogram.percentile(1.0f));
+
+    // Values outside the range end up in the first and last buckets
+    histogram.add(0.0f);
+    histogram.add(1000.0f);
+    EXPECT_FLOAT_EQ(1000.0f, histogram.max());
+    EXPECT_FLOAT_EQ(1000.0f, histogram.percentile(1.0f));
+
+    LatencyHistogram other;
+    other.add(2000.0f);
+    histogram.merge(other);
+    EXPECT_EQ(103u, histogram.count());
+    EXPECT_FLOAT_EQ(2000.0f, histogram.max());
+
+    histogram.clear();
+    EXPECT_EQ(0u, histogram.count());
+    EXPECT_FLOAT_EQ(0.0f, histogram.percentile(0.99f));
+}
+
+TEST_F(TestPerformanceTimer, TestWorkerQueues)
+{
+    _module_under_test._enabled = false;
+    _module_under_test.set_rt_worker_count(2);
+    _module_under_test._enabled = true;
+    ASSERT_EQ(2u, _module_under_test._worker_queues.size());
+
+    auto start = _module_under_test.start_timer();
+    _module_under_test.stop_timer(virtual_wait(start, 2), 1, 0);
+    start = _module_under_test.start_timer();
+    _module_under_test.stop_timer(virtual_wait(start, 4), 1, 1);
+    start = _module_under_test.start_timer();
+    _module_under_test.stop_timer(virtual_wait(start, 4), 2, 1);
+    EXPECT_TRUE(_module_under_test._entry_queue.wasEmpty());
+
+    _module_under_test._update_timings();
+    EXPECT_TRUE(_module_under_test._worker_queues[0]->wasEmpty());
+    EXPECT_TRUE(_module_under_test._worker_queues[1]->wasEmpty());
+
+    // Timings from both workers should be merged into the same node
+    auto timings = _module_under_test.timings_for_node(1);
+    ASSERT_TRUE(timings.has_value());
+    EXPECT_NEAR(0.2f, timings.value().min_case, 0.01f);
+    EXPECT_NEAR(0.4f, timings.value().max_case, 0.01f);
+    EXPECT_TRUE(_module_under_test.timings_for_node(2).has_value());
+}
+
+TEST(TestTraceRecorder, TestChromeTraceOutput)
+{
+    TraceRecorder recorder;
+    recorder.set_threads({"Audio thread", "Audio worker 0"});
+    recorder.record(0, 1, std::chrono::microseconds(10), std::chrono::microseconds(20));
+    EXPECT_FALSE(recorder.enabled());
+
+    recorder.enable(true);
+    recorder.record(0, 1, std::chrono::microseconds(100), std::chrono::microseconds(150));
+    recorder.record(1, 2, std::chrono::microseconds(110), std::chrono::microseconds(140));
+    // Out of range threads should be ignored
+    recorder.record(2, 3, std::chrono::microseconds(110), std::chrono::microseconds(140));
+
+    std::ostringstream output;
+    recorder.write_chrome_trace(output, [](int id) {return id == 1 ? "Track \"1\"" : "Proc " + std::to_string(id);});
+    auto trace = output.str();
+    EXPECT_TRUE(recorder.enabled());
+
+    EXPECT_EQ(0u, trace.find("{\"traceEvents\":["));
+    EXPECT_NE(std::string::npos, trace.find("\"args\":{\"name\":\"Audio thread\"}"));
+    EXPECT_NE(std::string::npos, trace.find("\"args\":{\"name\":\"Audio worker 0\"}"));
+    EXPECT_NE(std::string::npos, trace.find("{\"name\":\"Track \\\"1\\\"\",\"ph\":\"X\",\"pid\":1,\"tid\":0,\"ts\":0.000,\"dur\":50.000}"));
+    EXPECT_NE(std::string::npos, trace.find("{\"name\":\"Proc 2\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":10.000,\"dur\":30.000}"));
+    EXPECT_EQ(std::string::npos, trace.find("Proc 3"));
+
+    recorder.clear();
+    output.str("");
+    recorder.write_chrome_trace(output, [](int) {return "";});
+    EXPECT_EQ(std::string::npos, output.str().find("\"ph\":\"X\""));
+}
+
+TEST(TestTraceRecorder, TestLongTimestamps)
+{
+    TraceRecorder recorder;
+    recorder.set_threads({"Audio thread"});
+    recorder.enable(true);
+    recorder.record(0, 1, std::chrono::nanoseconds(0), std::chrono::nanoseconds(500));
+    // 2.5 s after the first section, with sub microsecond parts that must not be rounded off
+    recorder.record(0, 1, std::chrono::nanoseconds(2'500'000'250), std::chrono::nanoseconds(2'500'012'750));
+
+    std::ostringstream output;
+    recorder.write_chrome_trace(output, [](int) {return "";});
+    auto trace = output.str();
+    EXPECT_NE(std::string::npos, trace.find("\"ts\":0.000,\"dur\":0.500}"));
+    EXPECT_NE(std::string::npos, trace.find("\"ts\":2500000.250,\"dur\":12.500}"));
+    EXPECT_EQ(std::string::npos, trace.find("e+"));
+
+    // The stream formatting is restored
+    output.str("");
+    output << 0.5;
+    EXPECT_EQ("0.5", output.str());
+}
+
+TEST_F(TestPerformanceTimer, TestTracingWithoutTimings)
+{
+    _module_under_test._enabled = false;
+    _module_under_test.set_rt_worker_count(2);
+    _module_under_test.enable_tracing(true);
+    auto start = _module_under_test.start_timer();
+    EXPECT_GT(start.count(), 0);
+    _module_under_test.stop_timer(start, 5, 0);
+    _module_under_test.stop_trace(start, 6);
+    _module_under_test.stop_timer_rt_safe(start, 7);
+
+    // Only traced, not part of the statistics
+    EXPECT_TRUE(_module_under_test._worker_queues[0]->wasEmpty());
+    EXPECT_TRUE(_module_under_test._entry_queue.wasEmpty());
+    auto& threads = _module_under_test._trace_recorder._threads;
+    ASSERT_EQ(4u, threads.size());
+    EXPECT_EQ(1u, threads[0]->write_index);
+    EXPECT_EQ(1u, threads[1]->write_index);
+    EXPECT_EQ(0u, threads[2]->write_index);
+    EXPECT_EQ(1u, threads[3]->write_index);
+}
+
+TEST_F(TestPerformanceTimer, TestSingleWorkerTracesOnAudioThread)
+{
+    _module_under_test._enabled = false;
+    _module_under_test.set_rt_worker_count(1);
+    _module_under_test.enable_tracing(true);
+    auto start = _module_under_test.start_timer();
+    _module_under_test.stop_timer(start, 5, 0);
+    _module_under_test.stop_trace(start, 6);
+
+    // Tracks are processed on the main audio thread when there is only one worker
+    auto& threads = _module_under_test._trace_recorder._threads;
+    ASSERT_EQ(2u, threads.size());
+    EXPECT_EQ(2u, threads[0]->write_index);
+    EXPECT_EQ(0u, threads[1]->write_index);
+
+    std::ostringstream output;
+    _module_under_test._trace_recorder.write_chrome_trace(output, [](int) {return "";});
+    EXPECT_EQ(std::string::npos, output.str().find("Audio worker"));
+}
+
+TEST(TestTraceRecorder, TestWriteWhileRecording)
+{
+    TraceRecorder recorder;
+    recorder.set_threads({"Audio thread"});
+    recorder.enable(true);
+    std::atomic_bool running{true};
+    std::thread audio_thread([&]()
+    {
+        int64_t time = 0;
+        while (running)
+        {
+            recorder.record(0, 1, std::chrono::nanoseconds(time), std::chrono::nanoseconds(time + 10));
+            time += 10;
+        }
+    });
+    for (int i = 0; i < 10; ++i)
+    {
+        std::ostringstream output;
+        recorder.write_chrome_trace(output, [](int) {return "";});
+        EXPECT_TRUE(recorder.enabled());
+        recorder.clear();
+    }
+    running = false;
+    audio_thread.join();
+}
+
+TEST(TestXrunMonitor, TestSlowestNodes)
+{
+    XrunReport report;
+    report.add_node(1, 0.1f);
+    report.add_node(2, 0.5f);
+    report.add_node(3, 0.05f);
+    report.add_node(4, 0.3f);
+    report.add_node(5, 0.2f);
+    report.add_node(6, 0.01f);
+
+    ASSERT_EQ(XRUN_SNAPSHOT_NODES, report.node_count);
+    EXPECT_EQ(2u, report.slowest_nodes[0].id);
+    EXPECT_EQ(4u, report.slowest_nodes[1].id);
+    EXPECT_EQ(5u, report.slowest_nodes[2].id);
+    EXPECT_EQ(1u, report.slowest_nodes[3].id);
+    EXPECT_FLOAT_EQ(0.5f, report.slowest_nodes[0].load);
+}
+
+TEST(TestXrunMonitor, TestChunkChecks)
+{
+    MetricsRegistry registry;
+    MetricsScope metrics(registry, "");
+    XrunMonitor monitor(metrics);
+    monitor.set_timing_period(48000, 48);
+    EXPECT_FLOAT_EQ(0.5f, monitor.load(std::chrono::microseconds(500)));
+
+    EXPECT_EQ(nullptr, monitor.check_chunk(std::chrono::microseconds(900)));
+    auto slot = monitor.check_chunk(std::chrono::microseconds(1500));
+    ASSERT_NE(nullptr, slot);
+    EXPECT_EQ(XrunSource::ENGINE_OVERRUN, slot->report.source);
+    EXPECT_FLOAT_EQ(1.5f, slot->report.chunk_load);
+    EXPECT_EQ(0, slot->report.node_count);
+    slot->release();
+
+    /* Multiple frontend xruns before the next chunk give one report */
+    monitor.report_frontend_xrun();
+    monitor.report_frontend_xrun();
+    slot = monitor.check_chunk(std::chrono::microseconds(100));
+    ASSERT_NE(nullptr, slot);
+    EXPECT_EQ(XrunSource::AUDIO_FRONTEND, slot->report.source);
+    slot->release();
+    EXPECT_EQ(nullptr, monitor.check_chunk(std::chrono::microseconds(100)));
+
+    auto counts = monitor.counts();
+    EXPECT_EQ(1, counts.engine_overruns);
+    EXPECT_EQ(2, counts.frontend_xruns);
+    monitor.reset_counts();
+    EXPECT_EQ(0, monitor.counts().frontend_xruns);
+}
+
+TEST(TestXrunMonitor, TestSlotsNotReusedUntilReleased)
+{
+    MetricsRegistry registry;
+    MetricsScope metrics(registry, "");
+    XrunMonitor monitor(metrics);
+    monitor.set_timing_period(48000, 48);
+    std::vector<XrunReportSlot*> slots;
+    for (int i = 0; i < XRUN_REPORT_SLOTS; ++i)
+    {
+        auto slot = monitor.check_chunk(std::chrono::microseconds(1500));
+        ASSERT_NE(nullptr, slot);
+        EXPECT_EQ(slots.end(), std::find(slots.begin(), slots.end(), slot));
+        slot->report.add_node(i, 1.0f);
+        slots.push_back(slot);
+    }
+
+    /* All slots are held by the receiver, further xruns are only counted */
+    EXPECT_EQ(nullptr, monitor.check_chunk(std::chrono::microseconds(1500)));
+    EXPECT_EQ(XRUN_REPORT_SLOTS + 1, monitor.counts().engine_overruns);
+    EXPECT_EQ(3, static_cast<int>(slots[3]->report.slowest_nodes[0].id));
+
+    slots[3]->release();
+    auto slot = monitor.check_chunk(std::chrono::microseconds(1500));
+    EXPECT_EQ(slots[3], slot);
+    EXPECT_EQ(0, slot->report.node_count);
+}
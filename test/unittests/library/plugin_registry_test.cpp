@@ -0,0 +1,118 @@
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "test_utils/host_control_mockup.h"
+#include "library/plugin_registry.h"
+
+using namespace sushi;
+using namespace sushi::engine;
+
+constexpr float TEST_SAMPLE_RATE = 48000;
+constexpr int TEST_THREADS = 8;
+constexpr int INSTANCES_PER_THREAD = 4;
+
+#ifdef NDEBUG
+constexpr char VST3_PLUGIN_FILE[] = "../VST3/Release/adelay.vst3";
+#else
+constexpr char VST3_PLUGIN_FILE[] = "../VST3/Debug/adelay.vst3";
+#endif
+
+class TestPluginRegistry : public ::testing::Test
+{
+protected:
+    TestPluginRegistry() : _host_control(_hc.make_host_control_mockup(TEST_SAMPLE_RATE)) {}
+
+    /* Instantiate the plugin from several threads at once and check that every
+     * instantiation returns the expected status */
+    void instantiate_concurrently(const PluginInfo& plugin_info, ProcessorReturnCode expected_status)
+    {
+        std::vector<ProcessorReturnCode> statuses(TEST_THREADS * INSTANCES_PER_THREAD, ProcessorReturnCode::ERROR);
+        std::vector<std::shared_ptr<Processor>> instances(statuses.size());
+        std::vector<std::thread> threads;
+        for (int t = 0; t < TEST_THREADS; ++t)
+        {
+            threads.emplace_back([&, t]()
+            {
+                for (int i = 0; i < INSTANCES_PER_THREAD; ++i)
+                {
+                    int index = t * INSTANCES_PER_THREAD + i;
+                    auto [status, instance] = _module_under_test.new_instance(plugin_info, _host_control, TEST_SAMPLE_RATE);
+                    statuses[index] = status;
+                    instances[index] = instance;
+                }
+            });
+        }
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+        for (unsigned int i = 0; i < statuses.size(); ++i)
+        {
+            EXPECT_EQ(expected_status, statuses[i]);
+            if (expected_status == ProcessorReturnCode::OK)
+            {
+                EXPECT_NE(nullptr, instances[i]);
+            }
+        }
+    }
+
+    HostControlMockup _hc;
+    HostControl _host_control;
+    PluginRegistry _module_under_test;
+};
+
+TEST_F(TestPluginRegistry, TestConcurrentInternalInstantiation)
+{
+    PluginInfo plugin_info;
+    plugin_info.uid = "sushi.testing.gain";
+    plugin_info.path = "";
+    plugin_info.type = PluginType::INTERNAL;
+    instantiate_concurrently(plugin_info, ProcessorReturnCode::OK);
+}
+
+TEST_F(TestPluginRegistry, TestConcurrentVst2xInstantiation)
+{
+    PluginInfo plugin_info;
+    plugin_info.uid = "";
+    plugin_info.type = PluginType::VST2X;
+#ifdef SUSHI_BUILD_WITH_VST2
+    char* full_plugin_path = realpath("libvst2_test_plugin.so", NULL);
+    plugin_info.path = full_plugin_path;
+    free(full_plugin_path);
+    instantiate_concurrently(plugin_info, ProcessorReturnCode::OK);
+#else
+    plugin_info.path = "libvst2_test_plugin.so";
+    instantiate_concurrently(plugin_info, ProcessorReturnCode::UNSUPPORTED_OPERATION);
+#endif
+}
+
+TEST_F(TestPluginRegistry, TestConcurrentVst3xInstantiation)
+{
+    PluginInfo plugin_info;
+    plugin_info.uid = "ADelay";
+    plugin_info.type = PluginType::VST3X;
+#ifdef SUSHI_BUILD_WITH_VST3
+    char* full_plugin_path = realpath(VST3_PLUGIN_FILE, NULL);
+    plugin_info.path = full_plugin_path;
+    free(full_plugin_path);
+    instantiate_concurrently(plugin_info, ProcessorReturnCode::OK);
+#else
+    plugin_info.path = VST3_PLUGIN_FILE;
+    instantiate_concurrently(plugin_info, ProcessorReturnCode::UNSUPPORTED_OPERATION);
+#endif
+}
+
+TEST_F(TestPluginRegistry, TestConcurrentLv2Instantiation)
+{
+    PluginInfo plugin_info;
+    plugin_info.uid = "";
+    plugin_info.path = "http://lv2plug.in/plugins/eg-amp";
+    plugin_info.type = PluginType::LV2;
+#ifdef SUSHI_BUILD_WITH_LV2
+    instantiate_concurrently(plugin_info, ProcessorReturnCode::OK);
+#else
+    instantiate_concurrently(plugin_info, ProcessorReturnCode::UNSUPPORTED_OPERATION);
+#endif
+}
@@ -0,0 +1,73 @@
+#include <atomic>
+#include <thread>
+
+#include "gtest/gtest.h"
+
+#include "library/rcu_pointer.h"
+
+using namespace sushi;
+
+constexpr int PUBLISH_COUNT = 100;
+
+class TestRcuPointer : public ::testing::Test
+{
+protected:
+    TestRcuPointer() {}
+
+    RcuPointer<int> _module_under_test{std::make_unique<int>(0)};
+};
+
+TEST_F(TestRcuPointer, TestReadAndPublish)
+{
+    EXPECT_EQ(0, *_module_under_test.read());
+    _module_under_test.publish(std::make_unique<int>(5));
+    EXPECT_EQ(5, *_module_under_test.read());
+}
+
+TEST_F(TestRcuPointer, TestReaderKeepsDataAlive)
+{
+    std::atomic_bool published{false};
+    std::thread writer;
+    {
+        auto guard = _module_under_test.read();
+        writer = std::thread([&]()
+        {
+            _module_under_test.publish(std::make_unique<int>(1));
+            published = true;
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        /* The writer must wait for the guard before deleting the old data */
+        EXPECT_FALSE(published);
+        EXPECT_EQ(0, *guard);
+
+        /* Readers started after the publish see the new data */
+        EXPECT_EQ(1, *_module_under_test.read());
+    }
+    writer.join();
+    EXPECT_TRUE(published);
+}
+
+TEST_F(TestRcuPointer, TestPublishWithContinuousReaders)
+{
+    /* Overlapping readers, so that there is never a moment without readers */
+    std::atomic_bool running{true};
+    auto reader = [&]()
+    {
+        while (running)
+        {
+            auto guard = _module_under_test.read();
+            EXPECT_GE(*guard, 0);
+        }
+    };
+    std::thread reader_1(reader);
+    std::thread reader_2(reader);
+
+    for (int i = 1; i <= PUBLISH_COUNT; ++i)
+    {
+        _module_under_test.publish(std::make_unique<int>(i));
+    }
+    running = false;
+    reader_1.join();
+    reader_2.join();
+    EXPECT_EQ(PUBLISH_COUNT, *_module_under_test.read());
+}
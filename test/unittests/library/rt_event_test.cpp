@@ -244,3 +244,26 @@ TEST(TestRealtimeEvents, TestIsKeyboardEvent)
     EXPECT_TRUE(is_keyboard_event(event));
 }
 
+
+TEST(TestRealtimeEvents, TestTraceId)
+{
+    auto event = RtEvent::make_note_on_event(1, 2, 0, 3, 1.0f);
+    EXPECT_EQ(0, event.trace_id());
+    event.set_trace_id(1234);
+    EXPECT_EQ(1234, event.trace_id());
+    /* The trace id must not overlap the event data */
+    EXPECT_EQ(RtEventType::NOTE_ON, event.type());
+    EXPECT_EQ(1u, event.processor_id());
+    EXPECT_EQ(2, event.sample_offset());
+    EXPECT_EQ(3, event.keyboard_event()->note());
+}
+
+TEST(TestRealtimeEvents, TestSetSampleOffset)
+{
+    auto event = RtEvent::make_parameter_change_event(1, 0, 2, 0.5f);
+    event.set_sample_offset(17);
+    EXPECT_EQ(17, event.sample_offset());
+    EXPECT_EQ(RtEventType::FLOAT_PARAMETER_CHANGE, event.type());
+    EXPECT_EQ(2u, event.parameter_change_event()->param_id());
+    EXPECT_FLOAT_EQ(0.5f, event.parameter_change_event()->value());
+}
@@ -1,4 +1,5 @@
 #include <algorithm>
+#include <vector>
 #include "gtest/gtest.h"
 
 #include "library/sample_buffer.h"
@@ -189,6 +190,31 @@ TEST(TestSampleBuffer, TestInterleaving)
     }
 }
 
+TEST(TestSampleBuffer, TestMultichannelInterleaving)
+{
+    /* Covers both the fixed channel count and the generic paths */
+    for (int channels = 1; channels <= 9; ++channels)
+    {
+        std::vector<float> interleaved(AUDIO_CHUNK_SIZE * channels);
+        for (int i = 0; i < AUDIO_CHUNK_SIZE * channels; ++i)
+        {
+            interleaved[i] = static_cast<float>(i);
+        }
+        SampleBuffer<AUDIO_CHUNK_SIZE> buffer(channels);
+        buffer.from_interleaved(interleaved.data());
+        for (int c = 0; c < channels; ++c)
+        {
+            for (int n = 0; n < AUDIO_CHUNK_SIZE; ++n)
+            {
+                ASSERT_FLOAT_EQ(static_cast<float>(n * channels + c), buffer.channel(c)[n]);
+            }
+        }
+
+        std::vector<float> output(AUDIO_CHUNK_SIZE * channels, 0.0f);
+        buffer.to_interleaved(output.data());
+        ASSERT_EQ(interleaved, output);
+    }
+}
 
 TEST (TestSampleBuffer, TestGain)
 {
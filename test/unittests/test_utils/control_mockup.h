@@ -32,7 +32,9 @@ constexpr PlayingMode           DEFAULT_PLAYING_MODE = PlayingMode::PLAYING;
 constexpr SyncMode              DEFAULT_SYNC_MODE = SyncMode::INTERNAL;
 constexpr TimeSignature         DEFAULT_TIME_SIGNATURE = TimeSignature{4, 4};
 constexpr ControlStatus         DEFAULT_CONTROL_STATUS = ControlStatus::OK;
-constexpr CpuTimings            DEFAULT_TIMINGS = CpuTimings{1.0f, 0.5f, 1.5f};
+constexpr CpuTimings            DEFAULT_TIMINGS = CpuTimings{1.0f, 0.5f, 1.5f, {0.9f, 1.2f, 1.4f, 1.5f, 1.5f}, {0.9f, 1.2f, 1.4f, 1.5f, 1.5f}};
+constexpr XrunCounts            DEFAULT_XRUN_COUNTS = XrunCounts{3, 2};
+constexpr auto                  DEFAULT_METRICS = "sushi_engine_chunks_total 0\n";
 constexpr int                   DEFAULT_PROGRAM_ID = 1;
 constexpr auto                  DEFAULT_PROGRAM_NAME = "program 1";
 const std::vector<std::string>  DEFAULT_PROGRAMS = {DEFAULT_PROGRAM_NAME, "program 2"};
@@ -192,6 +194,41 @@ public:
         return _return_status;
     }
 
+    bool get_tracing_enabled() const override
+    {
+        return DEFAULT_TIMING_STATISTICS_ENABLED;
+    }
+
+    void set_tracing_enabled(bool enabled) override
+    {
+        _args_from_last_call.clear();
+        _args_from_last_call["enabled"] = std::to_string(enabled);
+        _recently_called = true;
+    }
+
+    ControlStatus write_trace_to_file(const std::string& filename) override
+    {
+        _args_from_last_call.clear();
+        _args_from_last_call["filename"] = filename;
+        _recently_called = true;
+        return _return_status;
+    }
+
+    std::pair<ControlStatus, XrunCounts> get_xrun_counts() const override
+    {
+        return {_return_status, DEFAULT_XRUN_COUNTS};
+    }
+
+    ControlStatus reset_xrun_counts() override
+    {
+        _recently_called = true;
+        return _return_status;
+    }
+
+    std::string get_metrics() const override
+    {
+        return DEFAULT_METRICS;
+    }
 };
 
 class KeyboardControllerMockup : public KeyboardController, public TestableController
@@ -374,6 +411,13 @@ public:
         _recently_called = true;
         return _return_status;
     }
+
+    std::future<ControlStatus> delete_processor_from_track_async(int processor_id, int track_id) override
+    {
+        std::promise<ControlStatus> promise;
+        promise.set_value(delete_processor_from_track(processor_id, track_id));
+        return promise.get_future();
+    }
 };
 
 class ProgramControllerMockup : public ProgramController, public TestableController
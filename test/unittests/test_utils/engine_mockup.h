@@ -1,6 +1,8 @@
 #ifndef SUSHI_ENGINE_MOCKUP_H
 #define SUSHI_ENGINE_MOCKUP_H
 
+#include <algorithm>
+#include <atomic>
 #include <memory>
 
 #include "engine/base_engine.h"
@@ -184,6 +186,18 @@ public:
         process_called = true;
     }
 
+    void
+    process_chunk(ChunkChannelBuffers* in_channels,
+                  ChunkChannelBuffers* out_channels,
+                  ControlBuffer*, ControlBuffer*, Time, int64_t) override
+    {
+        for (size_t c = 0; c < std::min(in_channels->size(), out_channels->size()); ++c)
+        {
+            (*out_channels)[c] = (*in_channels)[c];
+        }
+        process_called = true;
+    }
+
     void set_output_latency(Time /*latency*/) override {}
 
     void set_tempo(float /*tempo*/) override {}
@@ -210,12 +224,18 @@ public:
         return &_processor_container;
     }
 
-    bool process_called{false};
+    performance::XrunMonitor* xrun_monitor() override
+    {
+        return &_xrun_monitor;
+    }
+
+    std::atomic<bool> process_called{false};
     bool got_event{false};
     bool got_rt_event{false};
 private:
     EventDispatcherMockup       _event_dispatcher;
     ProcessorContainerMockup    _processor_container;
+    performance::XrunMonitor    _xrun_monitor{_metrics};
 };
 
 // TODO: Should this really be here, or is it too specific for the engine_mockup scope,
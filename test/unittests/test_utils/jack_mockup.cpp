@@ -19,6 +19,8 @@ struct _jack_client
 {
     JackProcessCallback callback_function;
     void* instance;
+    JackXRunCallback xrun_callback_function{nullptr};
+    void* xrun_instance{nullptr};
     _jack_port mocked_ports[10];
 };
 
@@ -61,6 +63,15 @@ int jack_set_process_callback (jack_client_t* client,
     return 0;
 }
 
+int jack_set_xrun_callback (jack_client_t* client,
+                            JackXRunCallback xrun_callback,
+                            void* arg)
+{
+    client->xrun_instance = arg;
+    client->xrun_callback_function = xrun_callback;
+    return 0;
+}
+
 int jack_set_sample_rate_callback (jack_client_t* /*client*/,
                                    JackSampleRateCallback /*callback*/,
                                    void* /*arg*/)
@@ -69,6 +80,18 @@ int jack_set_sample_rate_callback (jack_client_t* /*client*/,
 }
 
 
+int jack_set_buffer_size_callback (jack_client_t* /*client*/,
+                                   JackBufferSizeCallback /*callback*/,
+                                   void* /*arg*/)
+{
+    return 0;
+}
+
+jack_nframes_t jack_get_buffer_size (jack_client_t* /*client*/)
+{
+    return JACK_NFRAMES;
+}
+
 int jack_set_latency_callback (jack_client_t* /*client*/,
                                JackLatencyCallback /*latency_callback*/,
                                void* /*arg*/)
@@ -120,6 +143,8 @@ void jack_port_get_latency_range (jack_port_t* /*port*/, jack_latency_callback_m
     return;
 }
 
+void jack_port_set_latency_range (jack_port_t* /*port*/, jack_latency_callback_mode_t /*mode*/,
+                                  jack_latency_range_t* /*range*/) {}
 
 /* Functions below are only added for completion, not implemented
  * and shouldn't be called*/